@@ -13,7 +13,9 @@
 #include <ctype.h>
 #include <getopt.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include "arrow_ipc.h"
 #include "float2.h"
@@ -39,17 +41,44 @@ typedef struct arrowColumn
 	int			num_children;
 } arrowColumn;
 
+/*
+ * dumpTask - a range of rows in a record batch; each worker thread renders
+ * a task into its private buffer, then writes out the buffer in task order.
+ */
+typedef struct
+{
+	ArrowRecordBatch *rbatch;
+	const char *rb_chunk;
+	int64_t		row_index;
+	int64_t		nrows;
+	bool		prefetch;	/* first task of the record batch */
+} dumpTask;
+
+#define DUMP_TASK_NROWS		65536
+
 /* static variables */
 static ArrowFileInfo *arrow_files = NULL;
 static int		   *arrow_fdescs = NULL;
 static int			arrow_num_files = -1;
 static arrowColumn *arrow_columns = NULL;
 static int			arrow_num_columns = 0;
+static int		   *dump_columns = NULL;		/* --columns */
+static int			dump_num_columns = 0;
+static const char  *dump_column_names = NULL;
 static const char  *output_filename = NULL;
 static FILE		   *output_filp = NULL;
 static bool			print_header = false;
 static char			csv_delimiter = ',';
-static char			current_context = 'n';
+static int			num_worker_threads = -1;	/* --num-threads */
+static dumpTask	   *dump_tasks = NULL;
+static uint32_t		dump_num_tasks = 0;
+static uint32_t		dump_next_task = 0;			/* atomic */
+static uint32_t		dump_next_write = 0;		/* protected by dump_lock */
+static pthread_mutex_t dump_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dump_cond = PTHREAD_COND_INITIALIZER;
+static long			page_size;
+static __thread char current_context = 'n';
+static __thread SQLbuffer *output_buf = NULL;
 static int64_t		num_skip_rows = -1;			/* --offset */
 static int64_t		num_dump_rows = -1;			/* --limit */
 static const char  *create_table_name = NULL;	/* --create-table */
@@ -66,6 +95,10 @@ usage(void)
 		  "  --header       dump column names as csv header\n"
 		  "  --offset NUM   skip first NUM rows\n"
 		  "  --limit NUM    dump only NUM rows\n"
+		  "  --columns=COLUMNS dump only the specified columns\n"
+		  "                 (comma separated column names)\n"
+		  "  -n|--num-threads=N_THREADS number of worker threads\n"
+		  "                 (default: number of CPUs)\n"
 		  "\n"
 		  "  --create-table=TABLE_NAME  dump with CREATE TABLE statement\n"
 		  "  --tablespace=TABLESPACE    specify tablespace of the table, if any\n"
@@ -95,13 +128,20 @@ sql_buffer_printf(SQLbuffer *buf, const char *fmt, ...)
 		va_end(ap);
 		if (sz < 0)
 			Elog("failed on vsnprintf: %m");
-		if (buf->usage + sz <= buf->length)
+		/* vsnprintf() needs one more byte for the terminator */
+		if (buf->usage + sz < buf->length)
 			break;
-		sql_buffer_expand(buf, buf->length + sz + 1024);
+		sql_buffer_expand(buf, buf->usage + sz + 1024);
 	}
 	buf->usage += sz;
 }
 
+static inline void
+sql_buffer_puts(SQLbuffer *buf, const char *str)
+{
+	sql_buffer_append(buf, str, strlen(str));
+}
+
 static const char *
 __quote_ident(const char *ident)
 {
@@ -148,7 +188,7 @@ printNullDatum(void)
 {
 	/* print "null" only if List elements */
 	if (current_context == 'e')
-		fprintf(output_filp, "null");
+		sql_buffer_printf(output_buf, "null");
 }
 
 static void
@@ -252,7 +292,7 @@ static bool
 print_arrow_int8(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int8_t);
-	fprintf(output_filp, "%d", (int)datum);
+	sql_buffer_printf(output_buf, "%d", (int)datum);
 	return true;
 }
 
@@ -260,7 +300,7 @@ static bool
 print_arrow_uint8(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint8_t);
-	fprintf(output_filp, "%u", (unsigned int)datum);
+	sql_buffer_printf(output_buf, "%u", (unsigned int)datum);
 	return true;
 }
 
@@ -268,7 +308,7 @@ static bool
 print_arrow_int16(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int16_t);
-	fprintf(output_filp, "%d", (int)datum);
+	sql_buffer_printf(output_buf, "%d", (int)datum);
 	return true;
 }
 
@@ -276,7 +316,7 @@ static bool
 print_arrow_uint16(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint16_t);
-	fprintf(output_filp, "%u", (unsigned int)datum);
+	sql_buffer_printf(output_buf, "%u", (unsigned int)datum);
 	return true;
 }
 
@@ -284,7 +324,7 @@ static bool
 print_arrow_int32(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
-	fprintf(output_filp, "%d", datum);
+	sql_buffer_printf(output_buf, "%d", datum);
 	return true;
 }
 
@@ -292,7 +332,7 @@ static bool
 print_arrow_uint32(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint32_t);
-	fprintf(output_filp, "%u", datum);
+	sql_buffer_printf(output_buf, "%u", datum);
 	return true;
 }
 
@@ -300,7 +340,7 @@ static bool
 print_arrow_int64(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
-	fprintf(output_filp, "%ld", datum);
+	sql_buffer_printf(output_buf, "%ld", datum);
 	return true;
 }
 
@@ -308,7 +348,7 @@ static bool
 print_arrow_uint64(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
-	fprintf(output_filp, "%lu", datum);
+	sql_buffer_printf(output_buf, "%lu", datum);
 	return true;
 }
 
@@ -316,7 +356,7 @@ static bool
 print_arrow_float2(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(uint16_t);
-	fprintf(output_filp, "%f", fp16_to_fp64(datum));
+	sql_buffer_printf(output_buf, "%f", fp16_to_fp64(datum));
 	return true;
 }
 
@@ -324,7 +364,7 @@ static bool
 print_arrow_float4(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(float);
-	fprintf(output_filp, "%f", (double)datum);
+	sql_buffer_printf(output_buf, "%f", (double)datum);
 	return true;
 }
 
@@ -332,25 +372,30 @@ static bool
 print_arrow_float8(ARROW_PRINT_DATUM_ARGS)
 {
 	ARROW_PRINT_DATUM_SETUP_INLINE(double);
-	fprintf(output_filp, "%f", datum);
+	sql_buffer_printf(output_buf, "%f", datum);
 	return true;
 }
 
 static bool
 __print_arrow_utf8_common(const char *addr, size_t sz, const char *quote)
 {
+	char   *pos;
 	size_t	i;
 
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_puts(output_buf, quote);
+	/* worst case if all the characters are quoted */
+	sql_buffer_expand(output_buf, output_buf->usage + 2 * sz);
+	pos = output_buf->data + output_buf->usage;
 	for (i=0; i < sz; i++)
 	{
 		int		c = (unsigned char)addr[i];
 
 		if (c == '"')
-			fputc('"', output_filp);
-		fputc(c, output_filp);
+			*pos++ = '"';
+		*pos++ = c;
 	}
-	fprintf(output_filp, "%s", quote);
+	output_buf->usage = pos - output_buf->data;
+	sql_buffer_puts(output_buf, quote);
 	return true;
 }
 
@@ -384,15 +429,15 @@ __print_arrow_binary_common(const char *addr, size_t sz, const char *quote)
 	static const char hextbl[] = "0123456789abcdef";
 	size_t	i;
 
-	fprintf(output_filp, "%s\\x", quote);
+	sql_buffer_printf(output_buf, "%s\\x", quote);
 	for (i=0; i < sz; i++)
 	{
 		int		c = (unsigned char)addr[i];
 
-		fputc(hextbl[(c >> 4) & 0x0f], output_filp);
-		fputc(hextbl[(c & 0x0f)], output_filp);
+		sql_buffer_append_char(output_buf, hextbl[(c >> 4) & 0x0f], 1);
+		sql_buffer_append_char(output_buf, hextbl[(c & 0x0f)], 1);
 	}
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_puts(output_buf, quote);
 	return true;
 }
 
@@ -431,9 +476,9 @@ print_arrow_bool(ARROW_PRINT_DATUM_ARGS)
 		return false;
 
 	if ((bitmap[k] & mask) != 0)
-		fprintf(output_filp, "true");
+		sql_buffer_printf(output_buf, "true");
 	else
-		fprintf(output_filp, "false");
+		sql_buffer_printf(output_buf, "false");
 	return true;
 }
 
@@ -456,12 +501,12 @@ print_arrow_decimal128(ARROW_PRINT_DATUM_ARGS)
 	/* zero handling */
 	if (datum == 0)
 	{
-		fputc('0', output_filp);
+		sql_buffer_append_char(output_buf, '0', 1);
 		if (scale > 0)
 		{
-			fputc('.', output_filp);
+			sql_buffer_append_char(output_buf, '.', 1);
 			while (scale-- > 0)
-				fputc('0', output_filp);
+				sql_buffer_append_char(output_buf, '0', 1);
 		}
 		return true;
 	}
@@ -508,7 +553,7 @@ print_arrow_decimal128(ARROW_PRINT_DATUM_ARGS)
 
 	if (negative)
 		*--pos = '-';
-	fprintf(output_filp, "%s", pos);
+	sql_buffer_printf(output_buf, "%s", pos);
 	return true;
 }
 
@@ -521,7 +566,7 @@ print_arrow_date_day(ARROW_PRINT_DATUM_ARGS)
 	/* to seconds from the epoch */
 	t = (time_t)datum * 86400LL;
 	gmtime_r(&t, &tm);
-	fprintf(output_filp, "%s%04d-%02d-%02d%s",
+	sql_buffer_printf(output_buf, "%s%04d-%02d-%02d%s",
 			quote,
 			tm.tm_year + 1900,
 			tm.tm_mon + 1,
@@ -541,7 +586,7 @@ print_arrow_date_ms(ARROW_PRINT_DATUM_ARGS)
 	msec = datum % 1000;
 	t = datum / 1000;
 	gmtime_r(&t, &tm);
-	fprintf(output_filp, "%s%04d-%02d-%02d %02d:%02d:%02d.%03d%s",
+	sql_buffer_printf(output_buf, "%s%04d-%02d-%02d %02d:%02d:%02d.%03d%s",
 			quote,
 			tm.tm_year + 1900,
 			tm.tm_mon + 1,
@@ -564,7 +609,7 @@ print_arrow_time_sec(ARROW_PRINT_DATUM_ARGS)
 	datum /= 60;
 	min = datum % 60;
 	datum /= 60;
-	fprintf(output_filp, "%s%02u:%02u:%02u%s",
+	sql_buffer_printf(output_buf, "%s%02u:%02u:%02u%s",
 			quote,
 			datum, min, sec,
 			quote);
@@ -583,7 +628,7 @@ print_arrow_time_ms(ARROW_PRINT_DATUM_ARGS)
 	datum /= 60;
 	min = datum % 60;
 	datum /= 60;
-	fprintf(output_filp, "%s%02u:%02u:%02u.%03u%s",
+	sql_buffer_printf(output_buf, "%s%02u:%02u:%02u.%03u%s",
 			quote,
 			datum, min, sec, ms,
 			quote);
@@ -602,7 +647,7 @@ print_arrow_time_us(ARROW_PRINT_DATUM_ARGS)
 	datum /= 60;
 	min = datum % 60;
 	datum /= 60;
-	fprintf(output_filp, "%s%02d:%02d:%02d.%06d%s",
+	sql_buffer_printf(output_buf, "%s%02d:%02d:%02d.%06d%s",
 			quote,
 			(uint32_t)datum, min, sec, us,
 			quote);
@@ -621,7 +666,7 @@ print_arrow_time_ns(ARROW_PRINT_DATUM_ARGS)
 	datum /= 60;
 	min = datum % 60;
 	datum /= 60;
-	fprintf(output_filp, "%s%02d:%02d:%02d.%09d%s",
+	sql_buffer_printf(output_buf, "%s%02d:%02d:%02d.%09d%s",
 			quote,
 			(uint32_t)datum, min, sec, ns,
 			quote);
@@ -656,7 +701,7 @@ print_arrow_timestamp_sec(ARROW_PRINT_DATUM_ARGS)
 		gmtime_r(&t, &tm);
 	else
 		localtime_r(&t, &tm);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%04d-%02d-%02d %02d:%02d:%02d%s",
 			quote,
 			tm.tm_year + 1900,
@@ -684,7 +729,7 @@ print_arrow_timestamp_ms(ARROW_PRINT_DATUM_ARGS)
 		gmtime_r(&t, &tm);
 	else
 		localtime_r(&t, &tm);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%04d-%02d-%02d %02d:%02d:%02d.%03u%s",
 			quote,
 			tm.tm_year + 1900,
@@ -713,7 +758,7 @@ print_arrow_timestamp_us(ARROW_PRINT_DATUM_ARGS)
 		gmtime_r(&t, &tm);
 	else
 		localtime_r(&t, &tm);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%04d-%02d-%02d %02d:%02d:%02d.%06u%s",
 			quote,
 			tm.tm_year + 1900,
@@ -742,7 +787,7 @@ print_arrow_timestamp_ns(ARROW_PRINT_DATUM_ARGS)
 		gmtime_r(&t, &tm);
 	else
 		localtime_r(&t, &tm);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%04d-%02d-%02d %02d:%02d:%02d.%09u%s",
 			quote,
 			tm.tm_year + 1900,
@@ -770,20 +815,20 @@ print_arrow_interval_ym(ARROW_PRINT_DATUM_ARGS)
 	}
 	year = datum / 12;
 	mon = datum % 12;
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_puts(output_buf, quote);
 	if (year != 0 && mon != 0)
-		fprintf(output_filp, "%d %s %d %s",
+		sql_buffer_printf(output_buf, "%d %s %d %s",
 				year, (year > 1 ? "years" : "year"),
 				mon, (mon > 1 ? "months" : "month"));
 	else if (year != 0)
-		fprintf(output_filp, "%d %s",
+		sql_buffer_printf(output_buf, "%d %s",
 				year, (year > 1 ? "years" : "year"));
 	else
-		fprintf(output_filp, "%d %s",
+		sql_buffer_printf(output_buf, "%d %s",
 				mon, (mon > 1 ? "months" : "month"));
 	if (negative)
-		fprintf(output_filp, " ago");
-	fprintf(output_filp, "%s", quote);
+		sql_buffer_printf(output_buf, " ago");
+	sql_buffer_puts(output_buf, quote);
 	return true;
 }
 
@@ -809,24 +854,24 @@ print_arrow_interval_dt(ARROW_PRINT_DATUM_ARGS)
 	min = datum % 60;
 	datum /= 60;
 	hour = datum;
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_puts(output_buf, quote);
 	if (days != 0)
 	{
 		if (hour != 0 || min != 0 || sec != 0)
-			fprintf(output_filp, "%d %s %02d:%02d:%02d",
+			sql_buffer_printf(output_buf, "%d %s %02d:%02d:%02d",
 					days, (days > 1 ? "days" : "day"),
 					hour, min, sec);
 	}
 	else
 	{
-		fprintf(output_filp, "%02d:%02d:%02d",
+		sql_buffer_printf(output_buf, "%02d:%02d:%02d",
 				hour, min, sec);
 	}
 	if (msec != 0)
-		fprintf(output_filp, ".%03d", msec);
+		sql_buffer_printf(output_buf, ".%03d", msec);
 	if (negative)
-		fprintf(output_filp, " ago");
-	fprintf(output_filp, "%s", quote);
+		sql_buffer_printf(output_buf, " ago");
+	sql_buffer_puts(output_buf, quote);
 	return true;
 }
 
@@ -836,16 +881,16 @@ print_arrow_fixedsizebinary(ARROW_PRINT_DATUM_ARGS)
 	int32_t		i, width = column->arrow_type.FixedSizeBinary.byteWidth;
 	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
 
-	fprintf(output_filp, "%s\\x", quote);
+	sql_buffer_printf(output_buf, "%s\\x", quote);
 	for (i=0; i < width; i++)
 	{
 		static const char *hextbl = "0123456789abcdef";
 		int		c = addr[i];
 
-		fputc(hextbl[(c >> 4) & 0x0f], output_filp);
-		fputc(hextbl[(c & 0x0f)], output_filp);
+		sql_buffer_append_char(output_buf, hextbl[(c >> 4) & 0x0f], 1);
+		sql_buffer_append_char(output_buf, hextbl[(c & 0x0f)], 1);
 	}
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_puts(output_buf, quote);
 	return true;
 }
 
@@ -855,7 +900,7 @@ print_arrow_macaddr(ARROW_PRINT_DATUM_ARGS)
 	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
 	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
 	assert(width == 6);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%02x:%02x:%02x:%02x:%02x:%02x%s",
 			quote,
 			(unsigned char)addr[0],
@@ -874,7 +919,7 @@ print_arrow_inet4(ARROW_PRINT_DATUM_ARGS)
 	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
 	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
     assert(width == 4);
-	fprintf(output_filp,
+	sql_buffer_printf(output_buf,
 			"%s%u.%u.%u.%u%s",
 			quote,
 			(unsigned char)addr[0],
@@ -921,7 +966,7 @@ print_arrow_inet6(ARROW_PRINT_DATUM_ARGS)
 	}
 
 	/* print out IPv6 */
-	fprintf(output_filp, "%s", quote);
+	sql_buffer_puts(output_buf, quote);
 	for (i=0; i < 8; i++)
 	{
 		if (zero_base >= 0 &&
@@ -929,28 +974,28 @@ print_arrow_inet6(ARROW_PRINT_DATUM_ARGS)
 			i <  zero_base + zero_len)
 		{
 			if (i == zero_base)
-				fputc(':', output_filp);
+				sql_buffer_append_char(output_buf, ':', 1);
 			continue;
 		}
 		if (i > 0)
-			fputc(':', output_filp);
+			sql_buffer_append_char(output_buf, ':', 1);
 		/* Is this address an encapsulated IPv4? */
 		if (i == 6 && zero_base == 0 && ((zero_len == 6) ||
 										 (zero_len == 7 && words[7] != 0x0001) ||
 										 (zero_len == 5 && words[5] == 0xffff)))
 		{
-			fprintf(output_filp, "%u.%u.%u.%u",
+			sql_buffer_printf(output_buf, "%u.%u.%u.%u",
 					(unsigned char)addr[12],
 					(unsigned char)addr[13],
 					(unsigned char)addr[14],
 					(unsigned char)addr[15]);
 			break;
 		}
-		fprintf(output_filp, "%x", words[i]);
+		sql_buffer_printf(output_buf, "%x", words[i]);
 	}
 	if (zero_base >= 0 && zero_base + zero_len == 8)
-		fputc(':', output_filp);
-	fprintf(output_filp, "%s", quote);
+		sql_buffer_append_char(output_buf, ':', 1);
+	sql_buffer_puts(output_buf, quote);
 	return true;
 }
 
@@ -975,16 +1020,16 @@ print_arrow_list(ARROW_PRINT_DATUM_ARGS)
 	child = &column->children[0];
 	__buffers = buffers + (child->buffer_index -
 						   column->buffer_index);
-	fprintf(output_filp, "%s[", quote);
+	sql_buffer_printf(output_buf, "%s[", quote);
 	current_context = 'e';
 	for (i=head; i < tail; i++)
 	{
 		if (i > head)
-			fprintf(output_filp, ",");
+			sql_buffer_printf(output_buf, ",");
 		printArrowDatum(child, __buffers, rb_chunk, i, "");
 	}
 	current_context = saved_context;
-	fprintf(output_filp, "%s]", quote);
+	sql_buffer_printf(output_buf, "%s]", quote);
 	return true;
 }
 
@@ -994,7 +1039,7 @@ print_arrow_struct(ARROW_PRINT_DATUM_ARGS)
 	char		saved_context = current_context;
 	int			j;
 
-	fprintf(output_filp, "%s(", quote);
+	sql_buffer_printf(output_buf, "%s(", quote);
 	current_context = 'e';
 	for (j=0; j < column->num_children; j++)
 	{
@@ -1002,11 +1047,11 @@ print_arrow_struct(ARROW_PRINT_DATUM_ARGS)
 		ArrowBuffer *__buffers = buffers + (child->buffer_index -
 											column->buffer_index);
 		if (j > 0)
-			fprintf(output_filp, "%c", csv_delimiter);
+			sql_buffer_printf(output_buf, "%c", csv_delimiter);
 		printArrowDatum(child, __buffers, rb_chunk, index, "");
 	}
 	current_context = saved_context;
-	fprintf(output_filp, "%s)", quote);
+	sql_buffer_printf(output_buf, "%s)", quote);
 	return true;
 }
 
@@ -1349,9 +1394,9 @@ printCreateTable(void)
 	int		j;
 
 	/* type declarations */
-	for (j=0; j < arrow_num_columns; j++)
+	for (j=0; j < dump_num_columns; j++)
 	{
-		arrowColumn *col = &arrow_columns[j];
+		arrowColumn *col = &arrow_columns[dump_columns[j]];
 
 		if (col->arrow_type.node.tag == ArrowNodeTag__Struct)
 			printCreateType(col);
@@ -1359,9 +1404,9 @@ printCreateTable(void)
 	fprintf(output_filp,
 			"CREATE TABLE %s (\n",
 			quote_ident(create_table_name));
-	for (j=0; j < arrow_num_columns; j++)
+	for (j=0; j < dump_num_columns; j++)
 	{
-		arrowColumn *col = &arrow_columns[j];
+		arrowColumn *col = &arrow_columns[dump_columns[j]];
 
 		if (j > 0)
 			fprintf(output_filp, ",\n");
@@ -1382,75 +1427,305 @@ printCreateTable(void)
 	fprintf(output_filp, ";\n");
 }
 
+/*
+ * setupDumpColumns - parse the --columns option
+ */
 static void
-printRecordBatch(ArrowRecordBatch *rbatch, const char *rb_chunk)
+setupDumpColumns(void)
 {
-	int64_t		i, j;
+	char	   *temp, *tok, *pos;
+	int			j;
 
-	/* consider --offset */
-	if (num_skip_rows < 0)
-		i = 0;
-	else
+	dump_columns = palloc(sizeof(int) * arrow_num_columns);
+	if (!dump_column_names)
 	{
-		i = num_skip_rows;
-		if (num_skip_rows > rbatch->length)
-			num_skip_rows -= rbatch->length;
-		else
-			num_skip_rows = 0;
+		for (j=0; j < arrow_num_columns; j++)
+			dump_columns[j] = j;
+		dump_num_columns = arrow_num_columns;
+		return;
 	}
-
-	while (i < rbatch->length && num_dump_rows != 0)
+	temp = alloca(strlen(dump_column_names) + 1);
+	strcpy(temp, dump_column_names);
+	for (tok = strtok_r(temp, ",", &pos);
+		 tok != NULL;
+		 tok = strtok_r(NULL, ",", &pos))
 	{
+		/* trim whitespaces */
+		char   *end = tok + strlen(tok) - 1;
+
+		while (isspace(*tok))
+			tok++;
+		while (end >= tok && isspace(*end))
+			*end-- = '\0';
+
 		for (j=0; j < arrow_num_columns; j++)
 		{
-			arrowColumn	   *column = &arrow_columns[j];
+			if (strcmp(arrow_columns[j].colname, tok) == 0)
+				break;
+		}
+		if (j >= arrow_num_columns)
+			Elog("--columns: column '%s' was not found", tok);
+		if (dump_num_columns >= arrow_num_columns)
+			Elog("--columns: too many columns in '%s'", dump_column_names);
+		dump_columns[dump_num_columns++] = j;
+	}
+	if (dump_num_columns == 0)
+		Elog("--columns: no valid columns in '%s'", dump_column_names);
+}
+
+/*
+ * setupTimestampTimezone
+ *
+ * __assign_timestamp_timezone() is not thread-safe because it modifies
+ * the TZ environment variable. So, we assign the timezone prior to the
+ * worker threads, and fall back to the single thread mode if multiple
+ * timezones are used by the dumped columns.
+ */
+static void
+__setupTimestampTimezone(arrowColumn *column, const char **p_timezone)
+{
+	int		j;
+
+	if (column->arrow_type.node.tag == ArrowNodeTag__Timestamp &&
+		column->arrow_type.Timestamp.timezone)
+	{
+		const char *timezone = column->arrow_type.Timestamp.timezone;
+
+		if (!*p_timezone)
+		{
+			__assign_timestamp_timezone(&column->arrow_type.Timestamp);
+			*p_timezone = timezone;
+		}
+		else if (strcmp(*p_timezone, timezone) != 0)
+			num_worker_threads = 1;
+	}
+	for (j=0; j < column->num_children; j++)
+		__setupTimestampTimezone(&column->children[j], p_timezone);
+}
+
+static void
+setupTimestampTimezone(void)
+{
+	const char *timezone = NULL;
+	int			j;
+
+	for (j=0; j < dump_num_columns; j++)
+		__setupTimestampTimezone(&arrow_columns[dump_columns[j]], &timezone);
+}
+
+/*
+ * setupDumpTasks - map the source files, then split the record batches
+ * into the tasks, according to the --offset and --limit options.
+ */
+static void
+setupDumpTasks(void)
+{
+	uint32_t	nrooms = 0;
+	int64_t		skip_rows = (num_skip_rows < 0 ? 0 : num_skip_rows);
+	int64_t		remain_rows = num_dump_rows;	/* negative for no limit */
+	int			i, k;
+
+	for (i=0; i < arrow_num_files && remain_rows != 0; i++)
+	{
+		ArrowFileInfo *af_info = &arrow_files[i];
+		size_t		file_sz = af_info->stat_buf.st_size;
+		size_t		mmap_sz;
+		char	   *mmap_head;
+
+		mmap_sz = (file_sz + page_size - 1) & ~(page_size - 1);
+		mmap_head = mmap(NULL, mmap_sz, PROT_READ, MAP_SHARED,
+						 arrow_fdescs[i], 0);
+		if (mmap_head == MAP_FAILED)
+			Elog("failed on mmap: %m");
+		/*
+		 * When --columns is given, the buffers of the other columns shall
+		 * not be touched, so we prefetch the buffers to be dumped for each
+		 * record batch, instead of the sequential read-ahead.
+		 */
+		if (madvise(mmap_head, mmap_sz, (dump_num_columns < arrow_num_columns
+										 ? MADV_RANDOM
+										 : MADV_SEQUENTIAL)) != 0)
+			Elog("failed on madvise: %m");
+
+		for (k=0; k < af_info->footer._num_recordBatches && remain_rows != 0; k++)
+		{
+			ArrowBlock *block = &af_info->footer.recordBatches[k];
+			ArrowRecordBatch *rbatch = &af_info->recordBatches[k].body.recordBatch;
+			int64_t		row_index;
+			int64_t		nrows;
+
+			if (skip_rows >= rbatch->length)
+			{
+				skip_rows -= rbatch->length;
+				continue;
+			}
+			if (rbatch->compression)
+				Elog("arrow2csv does not support compressed record batch");
+			row_index = skip_rows;
+			skip_rows = 0;
+			nrows = rbatch->length - row_index;
+			if (remain_rows >= 0 && nrows > remain_rows)
+				nrows = remain_rows;
+			if (remain_rows > 0)
+				remain_rows -= nrows;
+			while (nrows > 0)
+			{
+				dumpTask   *task;
+
+				if (dump_num_tasks >= nrooms)
+				{
+					nrooms = (nrooms == 0 ? 1000 : 2 * nrooms);
+					dump_tasks = repalloc(dump_tasks, sizeof(dumpTask) * nrooms);
+				}
+				task = &dump_tasks[dump_num_tasks++];
+				task->rbatch = rbatch;
+				task->rb_chunk = mmap_head + block->offset + block->metaDataLength;
+				task->row_index = row_index;
+				task->nrows = (nrows < DUMP_TASK_NROWS ? nrows : DUMP_TASK_NROWS);
+				task->prefetch = (task == dump_tasks ||
+								  task[-1].rbatch != rbatch);
+				row_index += task->nrows;
+				nrows -= task->nrows;
+			}
+		}
+		/* the mapping is kept until the end of the process */
+	}
+}
+
+/*
+ * prefetchRecordBatch - kicks read-ahead of the buffers to be dumped
+ */
+static void
+prefetchRecordBatch(dumpTask *task)
+{
+	ArrowRecordBatch *rbatch = task->rbatch;
+	int			j, k;
+
+	if (dump_num_columns == arrow_num_columns)
+		return;		/* MADV_SEQUENTIAL works well */
+	for (j=0; j < dump_num_columns; j++)
+	{
+		arrowColumn *column = &arrow_columns[dump_columns[j]];
+
+		for (k=0; k < column->buffer_count; k++)
+		{
+			ArrowBuffer *buffer;
+			uintptr_t	head, tail;
+
+			if (column->buffer_index + k >= rbatch->_num_buffers)
+				break;
+			buffer = &rbatch->buffers[column->buffer_index + k];
+			if (buffer->length == 0)
+				continue;
+			head = (uintptr_t)(task->rb_chunk + buffer->offset);
+			tail = head + buffer->length;
+			head &= ~(page_size - 1);
+			(void)madvise((void *)head, tail - head, MADV_WILLNEED);
+		}
+	}
+}
+
+static void
+printRecordBatch(dumpTask *task)
+{
+	ArrowRecordBatch *rbatch = task->rbatch;
+	int64_t		i, j;
+
+	for (i = task->row_index; i < task->row_index + task->nrows; i++)
+	{
+		for (j=0; j < dump_num_columns; j++)
+		{
+			int				cindex = dump_columns[j];
+			arrowColumn	   *column = &arrow_columns[cindex];
 			ArrowBuffer	   *buffers;
 
 			if (j > 0)
-				fprintf(output_filp, "%c", csv_delimiter);
-			if (j >= rbatch->_num_nodes)
+				sql_buffer_append_char(output_buf, csv_delimiter, 1);
+			if (cindex >= rbatch->_num_nodes)
 				printNullDatum();
-			else if (i >= rbatch->nodes[j].length)
+			else if (i >= rbatch->nodes[cindex].length)
 				printNullDatum();
 			else
 			{
 				assert(column->buffer_index +
 					   column->buffer_count <= rbatch->_num_buffers);
 				buffers = rbatch->buffers + column->buffer_index;
-				printArrowDatum(column, buffers, rb_chunk, i, "\"");
+				printArrowDatum(column, buffers, task->rb_chunk, i, "\"");
 			}
 		}
-		fprintf(output_filp, "\r\n");
-		i++;
-		if (num_dump_rows > 0)
-			num_dump_rows--;
+		sql_buffer_append(output_buf, "\r\n", 2);
+	}
+}
+
+/*
+ * dumpWorkerMain - renders the tasks into the private buffer, then writes
+ * them out in order.
+ */
+static void *
+dumpWorkerMain(void *__arg)
+{
+	SQLbuffer	buf;
+	uint32_t	index;
+
+	sql_buffer_init(&buf);
+	output_buf = &buf;
+	while ((index = __atomic_fetch_add(&dump_next_task, 1,
+									   __ATOMIC_SEQ_CST)) < dump_num_tasks)
+	{
+		dumpTask   *task = &dump_tasks[index];
+
+		if (task->prefetch)
+			prefetchRecordBatch(task);
+		sql_buffer_clear(&buf);
+		printRecordBatch(task);
+
+		/* wait for the previous tasks being written */
+		pthread_mutex_lock(&dump_lock);
+		while (dump_next_write != index)
+			pthread_cond_wait(&dump_cond, &dump_lock);
+		pthread_mutex_unlock(&dump_lock);
+
+		if (buf.usage > 0 &&
+			fwrite(buf.data, buf.usage, 1, output_filp) != 1)
+			Elog("failed on fwrite: %m");
+
+		pthread_mutex_lock(&dump_lock);
+		dump_next_write++;
+		pthread_cond_broadcast(&dump_cond);
+		pthread_mutex_unlock(&dump_lock);
 	}
+	output_buf = NULL;
+	if (buf.data)
+		pfree(buf.data);
+	return NULL;
 }
 
 static void
-dumpArrowFile(ArrowFileInfo *af_info, int fdesc)
+dumpArrowFiles(void)
 {
-	static long	__PAGE_SIZE = -1;
-	size_t		file_sz = af_info->stat_buf.st_size;
-	size_t		mmap_sz;
-	char	   *mmap_head;
+	pthread_t  *threads;
 	int			i;
 
-	if (__PAGE_SIZE < 0)
-		__PAGE_SIZE = sysconf(_SC_PAGESIZE);
-	mmap_sz = (file_sz + __PAGE_SIZE - 1) & ~(__PAGE_SIZE - 1);
-	mmap_head = mmap(NULL, mmap_sz, PROT_READ, MAP_SHARED, fdesc, 0);
-	if (mmap_head == MAP_FAILED)
-		Elog("failed on mmap: %m");
-	for (i=0; i < af_info->footer._num_recordBatches; i++)
+	setupDumpTasks();
+	if (num_worker_threads > dump_num_tasks)
+		num_worker_threads = dump_num_tasks;
+	if (num_worker_threads <= 1)
 	{
-		ArrowBlock *block = &af_info->footer.recordBatches[i];
-		char	   *rb_chunk = (mmap_head + block->offset + block->metaDataLength);
-		ArrowRecordBatch *rbatch = &af_info->recordBatches[i].body.recordBatch;
-
-		printRecordBatch(rbatch, rb_chunk);
+		dumpWorkerMain(NULL);
+		return;
+	}
+	threads = alloca(sizeof(pthread_t) * num_worker_threads);
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_create(&threads[i], NULL,
+									dumpWorkerMain, NULL)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_join(threads[i], NULL)) != 0)
+			Elog("failed on pthread_join: %m");
 	}
-	munmap(mmap_head, mmap_sz);
 }
 
 int
@@ -1461,6 +1736,8 @@ main(int argc, char * const argv[])
 		{"header",       no_argument,       NULL, 1002},
 		{"offset",       required_argument, NULL, 1004},
 		{"limit",        required_argument, NULL, 1005},
+		{"columns",      required_argument, NULL, 1006},
+		{"num-threads",  required_argument, NULL, 'n'},
 		/* CREATE TABLE & COPY FROM */
 		{"create-table", required_argument, NULL, 1200},
 		{"tablespace",   required_argument, NULL, 1201},
@@ -1471,7 +1748,7 @@ main(int argc, char * const argv[])
 	};
 	int		i, j, c;
 
-	while ((c = getopt_long(argc, argv, "o:h", long_options, NULL)) >= 0)
+	while ((c = getopt_long(argc, argv, "o:n:h", long_options, NULL)) >= 0)
 	{
 		switch (c)
 		{
@@ -1499,6 +1776,18 @@ main(int argc, char * const argv[])
 				if (num_dump_rows < 0)
 					Elog("--limit=%s is not a numeric value", optarg);
 				break;
+			case 1006:	/* --columns */
+				if (dump_column_names)
+					Elog("--columns was specified twice");
+				dump_column_names = optarg;
+				break;
+			case 'n':	/* --num-threads */
+				if (num_worker_threads > 0)
+					Elog("-n|--num-threads was specified twice");
+				num_worker_threads = atoi(optarg);
+				if (num_worker_threads < 1)
+					Elog("-n|--num-threads=%s is not a valid value", optarg);
+				break;
 			case 1200:	/* --create-table */
 				if (create_table_name)
 					Elog("--create-table was specified twice");
@@ -1525,7 +1814,10 @@ main(int argc, char * const argv[])
 		Elog("--tablespace must be used with --create-table");
 	if (partition_name && !create_table_name)
 		Elog("--partition-of must be used with --create-table");
-	
+	if (num_worker_threads < 0)
+		num_worker_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	page_size = sysconf(_SC_PAGESIZE);
+
 	/* arrow files */
 	if (optind >= argc)
 		Elog("no input arrow files given");
@@ -1589,6 +1881,9 @@ main(int argc, char * const argv[])
 		}
 	}
 	
+	setupDumpColumns();
+	setupTimestampTimezone();
+
 	/* open the output file, if necessary */
 	if (!output_filename)
 		output_filp = stdout;
@@ -1610,18 +1905,17 @@ main(int argc, char * const argv[])
 	/* Dump column names */
 	if (print_header)
 	{
-		for (j=0; j < arrow_num_columns; j++)
+		for (j=0; j < dump_num_columns; j++)
 		{
-			const char *colname = arrow_columns[j].colname;
+			const char *colname = arrow_columns[dump_columns[j]].colname;
 			if (j > 0)
 				fprintf(output_filp, "%c", csv_delimiter);
 			fprintf(output_filp, "%s", __quote_ident(colname));
 		}
 		fprintf(output_filp, "\r\n");
 	}
-	/* Dump Arrpw files */
-	for (i=0; i < arrow_num_files; i++)
-		dumpArrowFile(&arrow_files[i], arrow_fdescs[i]);
+	/* Dump Arrow files */
+	dumpArrowFiles();
 	if (create_table_name && num_dump_rows != 0)
 		fprintf(output_filp, "\\.\r\n");
 	return 0;
@@ -0,0 +1,1517 @@
+/*
+ * arrowmerge.c
+ *
+ * A tool to merge many small Apache Arrow files into a large one
+ *
+ * ----
+ * Copyright 2011-2021 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2021 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include <dirent.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include "arrow_ipc.h"
+#include "float2.h"
+
+/*
+ * mergeSourceFile / mergeSourceBatch - record batches of the source files
+ */
+typedef struct
+{
+	const char	   *filename;
+	dev_t			st_dev;			/* to identify the output file */
+	ino_t			st_ino;
+	ArrowFileInfo	af_info;
+} mergeSourceFile;
+
+typedef struct
+{
+	int				file_index;
+	ArrowBlock	   *block;
+	ArrowRecordBatch *rbatch;
+} mergeSourceBatch;
+
+/*
+ * mergeField - a field of the schema, with index of the FieldNode/Buffer
+ */
+typedef struct mergeField
+{
+	ArrowField	   *field;
+	int				node_index;
+	int				buffer_index;
+	int				unitsz;			/* width of fixed-length values */
+	int				num_children;
+	struct mergeField *children;
+} mergeField;
+
+/*
+ * mergeSlice - a range of an array in the source record batch
+ */
+typedef struct
+{
+	const char	   *body;			/* head of the record batch body */
+	ArrowRecordBatch *rbatch;
+	int64_t			offset;			/* first row of the slice */
+	int64_t			length;			/* number of rows in the slice */
+} mergeSlice;
+
+/*
+ * mergeJob - a set of consecutive source record batches to be merged
+ */
+typedef struct
+{
+	int				first;			/* index of the first source batch */
+	int				nbatches;		/* number of the source batches */
+	int64_t			nrows;			/* number of rows */
+} mergeJob;
+
+/*
+ * mergeWorker - state of the worker thread
+ */
+typedef struct
+{
+	pthread_t		thread;
+	int				worker_id;
+	SQLtable	   *table;			/* private copy of the output table */
+	ArrowFieldNode *nodes;
+	ArrowBuffer	   *buffers;
+	/* body of the record batch */
+	struct iovec   *iov;
+	int				iov_cnt;
+	int				iov_len;
+	size_t			body_sz;
+	/* memory chunks allocated for the body */
+	void		  **chunks;
+	int				chunks_cnt;
+	int				chunks_len;
+	/* mmap of the source record batches */
+	struct iovec   *mmaps;
+	int				mmaps_cnt;
+	int				mmaps_len;
+	/* min/max statistics for each top-level field */
+	SQLstat		   *stats;
+} mergeWorker;
+
+/* command options */
+static const char  *output_filename = NULL;
+static size_t		batch_segment_sz = 0;
+static int			num_worker_threads = 0;
+static char		   *stat_embedded_columns = NULL;
+static int			shows_progress = 0;
+
+/* static variables */
+static mergeSourceFile *source_files = NULL;
+static int			num_source_files = 0;
+static int			max_source_files = 0;
+static mergeSourceBatch *source_batches = NULL;
+static int			num_source_batches = 0;
+static mergeJob	   *merge_jobs = NULL;
+static int			num_merge_jobs = 0;
+static mergeField  *merge_fields = NULL;
+static int			num_merge_fields = 0;
+static int			num_field_nodes = 0;
+static int			num_buffers = 0;
+static SQLtable	   *merge_table = NULL;
+static char		   *merge_temp_filename = NULL;	/* until rename(2) */
+static pthread_mutex_t merge_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t merge_cond = PTHREAD_COND_INITIALIZER;
+static int			merge_next_file = 0;	/* atomic */
+static int			merge_next_job = 0;		/* atomic */
+static int			merge_next_write = 0;	/* protected by merge_lock */
+static long			page_size = 0;
+static char			arrow_zero_padding[64];	/* ARROWALIGN(1) */
+
+static void
+usage(void)
+{
+	fputs("Usage:\n"
+		  "  arrowmerge [OPTION] FILE_OR_DIR [...]\n"
+		  "\n"
+		  "General options:\n"
+		  "  -o, --output=FILENAME  result file in Apache Arrow format\n"
+		  "  -s, --segment-size=SIZE size of record batch for each\n"
+		  "      (default: 256MB)\n"
+		  "  -n, --num-threads=N_THREADS number of worker threads\n"
+		  "      (default: number of CPU cores)\n"
+		  "  -S, --stat=COLUMNS     embeds min/max statistics for each record\n"
+		  "                         batch, in addition to the columns that\n"
+		  "                         have statistics in the source files.\n"
+		  "      --progress         shows progress of the job.\n"
+		  "      --help             shows this message.\n"
+		  "\n"
+		  "Source arguments may be directories; then, all the *.arrow files\n"
+		  "in the directory are merged.\n"
+		  "\n"
+		  "Report bugs to <pgstrom@heterodb.com>.\n",
+		  stderr);
+	exit(1);
+}
+
+/*
+ * addSourceFile
+ */
+static void
+__addSourceFile(const char *filename)
+{
+	if (num_source_files >= max_source_files)
+	{
+		max_source_files = (max_source_files == 0 ? 1000 : 2 * max_source_files);
+		source_files = repalloc(source_files,
+								sizeof(mergeSourceFile) * max_source_files);
+	}
+	memset(&source_files[num_source_files], 0, sizeof(mergeSourceFile));
+	source_files[num_source_files++].filename = filename;
+}
+
+static int
+__compareFileNames(const void *a, const void *b)
+{
+	return strcmp(*((const char **)a), *((const char **)b));
+}
+
+static void
+addSourceFile(const char *pathname)
+{
+	struct stat	stat_buf;
+	DIR		   *dir;
+	struct dirent *dent;
+	char	  **names = NULL;
+	int			nitems = 0;
+	int			nrooms = 0;
+	int			i;
+
+	if (stat(pathname, &stat_buf) != 0)
+		Elog("failed on stat('%s'): %m", pathname);
+	if (!S_ISDIR(stat_buf.st_mode))
+	{
+		__addSourceFile(pathname);
+		return;
+	}
+	/* all the *.arrow files in the directory, in the order of names */
+	dir = opendir(pathname);
+	if (!dir)
+		Elog("failed on opendir('%s'): %m", pathname);
+	while ((dent = readdir(dir)) != NULL)
+	{
+		size_t		len = strlen(dent->d_name);
+		char	   *fname;
+
+		if (len <= 6 || strcmp(dent->d_name + len - 6, ".arrow") != 0)
+			continue;
+		fname = palloc(strlen(pathname) + len + 2);
+		sprintf(fname, "%s/%s", pathname, dent->d_name);
+		if (nitems >= nrooms)
+		{
+			nrooms = (nrooms == 0 ? 1000 : 2 * nrooms);
+			names = repalloc(names, sizeof(char *) * nrooms);
+		}
+		names[nitems++] = fname;
+	}
+	closedir(dir);
+
+	if (nitems > 0)
+	{
+		qsort(names, nitems, sizeof(char *), __compareFileNames);
+		for (i=0; i < nitems; i++)
+			__addSourceFile(names[i]);
+	}
+	pfree(names);
+}
+
+/*
+ * parse_options
+ */
+static void
+parse_options(int argc, char * const argv[])
+{
+	static struct option long_options[] = {
+		{"output",       required_argument, NULL, 'o'},
+		{"segment-size", required_argument, NULL, 's'},
+		{"num-threads",  required_argument, NULL, 'n'},
+		{"stat",         required_argument, NULL, 'S'},
+		{"progress",     no_argument,       NULL, 1001},
+		{"help",         no_argument,       NULL, 9999},
+		{NULL, 0, NULL, 0},
+	};
+	int			c, i;
+	char	   *end;
+
+	while ((c = getopt_long(argc, argv, "o:s:n:S:h",
+							long_options, NULL)) >= 0)
+	{
+		switch (c)
+		{
+			case 'o':	/* --output */
+				if (output_filename)
+					Elog("-o, --output was specified twice");
+				output_filename = optarg;
+				break;
+
+			case 's':	/* --segment-size */
+				if (batch_segment_sz != 0)
+					Elog("-s, --segment-size was specified twice");
+				batch_segment_sz = strtoul(optarg, &end, 10);
+				if (strcasecmp(end, "k") == 0 || strcasecmp(end, "kb") == 0)
+					batch_segment_sz <<= 10;
+				else if (strcasecmp(end, "m") == 0 || strcasecmp(end, "mb") == 0)
+					batch_segment_sz <<= 20;
+				else if (strcasecmp(end, "g") == 0 || strcasecmp(end, "gb") == 0)
+					batch_segment_sz <<= 30;
+				else if (*end != '\0')
+					Elog("unrecognized segment size '%s'", optarg);
+				break;
+
+			case 'n':	/* --num-threads */
+				if (num_worker_threads != 0)
+					Elog("-n, --num-threads was specified twice");
+				num_worker_threads = strtol(optarg, &end, 10);
+				if (*end != '\0' || num_worker_threads < 1)
+					Elog("invalid number of threads '%s'", optarg);
+				break;
+
+			case 'S':	/* --stat */
+				if (stat_embedded_columns)
+					Elog("-S, --stat was specified twice");
+				stat_embedded_columns = optarg;
+				break;
+
+			case 1001:	/* --progress */
+				shows_progress = 1;
+				break;
+
+			default:
+				usage();
+				break;
+		}
+	}
+	if (!output_filename)
+		Elog("-o, --output=FILENAME must be specified");
+	if (optind >= argc)
+		Elog("no source arrow files given");
+	for (i=optind; i < argc; i++)
+		addSourceFile(argv[i]);
+	if (num_source_files == 0)
+		Elog("no source arrow files found");
+	if (batch_segment_sz == 0)
+		batch_segment_sz = (1UL << 28);		/* 256MB in default */
+	if (batch_segment_sz > (1UL << 31))
+		Elog("too large segment size; must be less than 2GB");
+	if (num_worker_threads == 0)
+	{
+		num_worker_threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if (num_worker_threads < 1)
+			num_worker_threads = 1;
+	}
+}
+
+/*
+ * __mergeFieldIsCompatible
+ */
+static bool
+__mergeFieldIsCompatible(ArrowField *a, ArrowField *b)
+{
+	int		j;
+
+	if (strcmp(a->name, b->name) != 0 ||
+		a->type.node.tag != b->type.node.tag ||
+		a->_num_children != b->_num_children ||
+		a->dictionary != NULL || b->dictionary != NULL)
+		return false;
+	switch (a->type.node.tag)
+	{
+		case ArrowNodeTag__Int:
+			if (a->type.Int.bitWidth  != b->type.Int.bitWidth ||
+				a->type.Int.is_signed != b->type.Int.is_signed)
+				return false;
+			break;
+		case ArrowNodeTag__FloatingPoint:
+			if (a->type.FloatingPoint.precision != b->type.FloatingPoint.precision)
+				return false;
+			break;
+		case ArrowNodeTag__Decimal:
+			if (a->type.Decimal.precision != b->type.Decimal.precision ||
+				a->type.Decimal.scale     != b->type.Decimal.scale ||
+				a->type.Decimal.bitWidth  != b->type.Decimal.bitWidth)
+				return false;
+			break;
+		case ArrowNodeTag__Date:
+			if (a->type.Date.unit != b->type.Date.unit)
+				return false;
+			break;
+		case ArrowNodeTag__Time:
+			if (a->type.Time.unit     != b->type.Time.unit ||
+				a->type.Time.bitWidth != b->type.Time.bitWidth)
+				return false;
+			break;
+		case ArrowNodeTag__Timestamp:
+			if (a->type.Timestamp.unit != b->type.Timestamp.unit)
+				return false;
+			if (a->type.Timestamp.timezone || b->type.Timestamp.timezone)
+			{
+				if (!a->type.Timestamp.timezone ||
+					!b->type.Timestamp.timezone ||
+					strcmp(a->type.Timestamp.timezone,
+						   b->type.Timestamp.timezone) != 0)
+					return false;
+			}
+			break;
+		case ArrowNodeTag__Interval:
+			if (a->type.Interval.unit != b->type.Interval.unit)
+				return false;
+			break;
+		case ArrowNodeTag__FixedSizeBinary:
+			if (a->type.FixedSizeBinary.byteWidth != b->type.FixedSizeBinary.byteWidth)
+				return false;
+			break;
+		case ArrowNodeTag__FixedSizeList:
+			if (a->type.FixedSizeList.listSize != b->type.FixedSizeList.listSize)
+				return false;
+			break;
+		case ArrowNodeTag__Map:
+			if (a->type.Map.keysSorted != b->type.Map.keysSorted)
+				return false;
+			break;
+		default:
+			break;
+	}
+	for (j=0; j < a->_num_children; j++)
+	{
+		if (!__mergeFieldIsCompatible(&a->children[j], &b->children[j]))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * setupMergeField
+ */
+static void
+setupMergeField(mergeField *mf, ArrowField *field)
+{
+	ArrowType  *t = &field->type;
+	int			nbuffers = 2;	/* nullmap + values in most cases */
+	int			j;
+
+	if (field->dictionary)
+		Elog("field '%s' is dictionary encoded; not supported", field->name);
+	memset(mf, 0, sizeof(mergeField));
+	mf->field = field;
+	mf->node_index = num_field_nodes++;
+	mf->buffer_index = num_buffers;
+	switch (t->node.tag)
+	{
+		case ArrowNodeTag__Int:
+			mf->unitsz = t->Int.bitWidth / 8;
+			break;
+		case ArrowNodeTag__FloatingPoint:
+			mf->unitsz = (t->FloatingPoint.precision == ArrowPrecision__Half ? 2 :
+						  t->FloatingPoint.precision == ArrowPrecision__Single ? 4 : 8);
+			break;
+		case ArrowNodeTag__Decimal:
+			mf->unitsz = (t->Decimal.bitWidth > 0 ? t->Decimal.bitWidth / 8 : 16);
+			break;
+		case ArrowNodeTag__Date:
+			mf->unitsz = (t->Date.unit == ArrowDateUnit__Day ? 4 : 8);
+			break;
+		case ArrowNodeTag__Time:
+			mf->unitsz = t->Time.bitWidth / 8;
+			break;
+		case ArrowNodeTag__Timestamp:
+			mf->unitsz = 8;
+			break;
+		case ArrowNodeTag__Interval:
+			mf->unitsz = (t->Interval.unit == ArrowIntervalUnit__Year_Month ? 4 :
+						  t->Interval.unit == ArrowIntervalUnit__Day_Time ? 8 : 16);
+			break;
+		case ArrowNodeTag__FixedSizeBinary:
+			mf->unitsz = t->FixedSizeBinary.byteWidth;
+			break;
+		case ArrowNodeTag__Bool:
+			break;
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+			nbuffers = 3;	/* nullmap + offsets + values */
+			break;
+		case ArrowNodeTag__List:
+		case ArrowNodeTag__Map:
+			if (field->_num_children != 1)
+				Elog("field '%s' must have one child", field->name);
+			break;		/* nullmap + offsets */
+		case ArrowNodeTag__FixedSizeList:
+			if (field->_num_children != 1)
+				Elog("field '%s' must have one child", field->name);
+			nbuffers = 1;	/* nullmap only */
+			break;
+		case ArrowNodeTag__Struct:
+			nbuffers = 1;	/* nullmap only */
+			break;
+		default:
+			Elog("field '%s' has unsupported type: %s",
+				 field->name, arrowNodeName(&t->node));
+	}
+	num_buffers += nbuffers;
+
+	if (field->_num_children > 0)
+	{
+		mf->num_children = field->_num_children;
+		mf->children = palloc0(sizeof(mergeField) * field->_num_children);
+		for (j=0; j < field->_num_children; j++)
+			setupMergeField(&mf->children[j], &field->children[j]);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Routines to embed min/max statistics
+ *
+ * ----------------------------------------------------------------
+ */
+static int
+write_int128_stat(SQLfield *attr, char *buf, size_t len,
+				  const SQLstat__datum *datum)
+{
+	int128_t	ival = datum->i128;
+	char		temp[64];
+	char	   *pos = temp + sizeof(temp) - 1;
+	bool		is_minus = false;
+	uint128_t	uval;
+
+	if (ival < 0)
+	{
+		is_minus = true;
+		uval = -(uint128_t)ival;
+	}
+	else
+		uval = ival;
+	*pos = '\0';
+	do {
+		*--pos = ('0' + (uval % 10));
+		uval /= 10;
+	} while (uval != 0);
+
+	return snprintf(buf, len, "%s%s", (is_minus ? "-" : ""), pos);
+}
+
+static int
+write_float16_stat(SQLfield *attr, char *buf, size_t len,
+				   const SQLstat__datum *datum)
+{
+	half_t		ival = fp32_to_fp16(datum->f32);
+
+	return snprintf(buf, len, "%u", (uint32_t)ival);
+}
+
+static int
+write_float32_stat(SQLfield *attr, char *buf, size_t len,
+				   const SQLstat__datum *datum)
+{
+	return snprintf(buf, len, "%d", datum->i32);
+}
+
+static int
+write_float64_stat(SQLfield *attr, char *buf, size_t len,
+				   const SQLstat__datum *datum)
+{
+	return snprintf(buf, len, "%ld", datum->i64);
+}
+
+/*
+ * __enableFieldStats - integer-like types are kept as int128, as
+ * arrow_fdw parses all the statistics by __atoi128().
+ */
+static bool
+__enableFieldStats(SQLfield *column)
+{
+	ArrowType  *t = &column->arrow_type;
+
+	switch (t->node.tag)
+	{
+		case ArrowNodeTag__Int:
+		case ArrowNodeTag__Date:
+		case ArrowNodeTag__Time:
+		case ArrowNodeTag__Timestamp:
+			column->write_stat = write_int128_stat;
+			break;
+		case ArrowNodeTag__Decimal:
+			if (t->Decimal.bitWidth != 0 && t->Decimal.bitWidth != 128)
+				return false;
+			column->write_stat = write_int128_stat;
+			break;
+		case ArrowNodeTag__FloatingPoint:
+			switch (t->FloatingPoint.precision)
+			{
+				case ArrowPrecision__Half:
+					column->write_stat = write_float16_stat;
+					break;
+				case ArrowPrecision__Single:
+					column->write_stat = write_float32_stat;
+					break;
+				case ArrowPrecision__Double:
+					column->write_stat = write_float64_stat;
+					break;
+				default:
+					return false;
+			}
+			break;
+		default:
+			return false;
+	}
+	column->stat_enabled = true;
+	return true;
+}
+
+static inline bool
+__bitmapIsSet(const uint8_t *bitmap, int64_t index)
+{
+	return (bitmap[index >> 3] & (1 << (index & 7))) != 0;
+}
+
+#define __STAT_UPDATE(STAT,FIELD,VALUE)			\
+	do {										\
+		if (!(STAT)->is_valid)					\
+		{										\
+			(STAT)->min.FIELD = (VALUE);		\
+			(STAT)->max.FIELD = (VALUE);		\
+			(STAT)->is_valid = true;			\
+		}										\
+		else if ((STAT)->min.FIELD > (VALUE))	\
+			(STAT)->min.FIELD = (VALUE);		\
+		else if ((STAT)->max.FIELD < (VALUE))	\
+			(STAT)->max.FIELD = (VALUE);		\
+	} while(0)
+
+static void
+updateFieldStats(mergeField *mf, SQLstat *stat,
+				 mergeSlice *slices, int nslices)
+{
+	ArrowType  *t = &mf->field->type;
+	bool		is_signed = true;
+	int			k;
+
+	if (t->node.tag == ArrowNodeTag__Int)
+		is_signed = t->Int.is_signed;
+	for (k=0; k < nslices; k++)
+	{
+		mergeSlice	   *s = &slices[k];
+		ArrowBuffer	   *nullmap = &s->rbatch->buffers[mf->buffer_index];
+		ArrowBuffer	   *values = &s->rbatch->buffers[mf->buffer_index + 1];
+		const uint8_t  *bitmap = NULL;
+		const char	   *addr = s->body + values->offset;
+		int64_t			i;
+
+		if (nullmap->length > 0)
+			bitmap = (const uint8_t *)(s->body + nullmap->offset);
+		for (i = s->offset; i < s->offset + s->length; i++)
+		{
+			const char *pos = addr + mf->unitsz * i;
+
+			if (bitmap && !__bitmapIsSet(bitmap, i))
+				continue;
+			if (t->node.tag == ArrowNodeTag__FloatingPoint)
+			{
+				if (mf->unitsz == sizeof(half_t))
+					__STAT_UPDATE(stat, f32, fp16_to_fp32(*((half_t *)pos)));
+				else if (mf->unitsz == sizeof(float))
+					__STAT_UPDATE(stat, f32, *((float *)pos));
+				else
+					__STAT_UPDATE(stat, f64, *((double *)pos));
+				continue;
+			}
+			switch (mf->unitsz)
+			{
+				case 1:
+					__STAT_UPDATE(stat, i128, (is_signed
+											   ? (int128_t)*((int8_t *)pos)
+											   : (int128_t)*((uint8_t *)pos)));
+					break;
+				case 2:
+					__STAT_UPDATE(stat, i128, (is_signed
+											   ? (int128_t)*((int16_t *)pos)
+											   : (int128_t)*((uint16_t *)pos)));
+					break;
+				case 4:
+					__STAT_UPDATE(stat, i128, (is_signed
+											   ? (int128_t)*((int32_t *)pos)
+											   : (int128_t)*((uint32_t *)pos)));
+					break;
+				case 8:
+					__STAT_UPDATE(stat, i128, (is_signed
+											   ? (int128_t)*((int64_t *)pos)
+											   : (int128_t)*((uint64_t *)pos)));
+					break;
+				case 16:
+					{
+						int128_t	ival;
+
+						memcpy(&ival, pos, sizeof(int128_t));
+						__STAT_UPDATE(stat, i128, ival);
+					}
+					break;
+				default:
+					Elog("Bug? unexpected unit size of the statistics (%d)",
+						 mf->unitsz);
+			}
+		}
+	}
+}
+
+/*
+ * setupMergeTable
+ */
+static void
+__setupMergeColumn(SQLfield *column, ArrowField *field)
+{
+	int		j, k;
+
+	column->field_name = (char *)field->name;
+	column->arrow_type = field->type;
+	if (field->type.node.tag == ArrowNodeTag__Struct)
+	{
+		column->nfields = field->_num_children;
+		column->subfields = palloc0(sizeof(SQLfield) * field->_num_children);
+		for (j=0; j < field->_num_children; j++)
+			__setupMergeColumn(&column->subfields[j], &field->children[j]);
+	}
+	else if (field->_num_children > 0)
+	{
+		column->element = palloc0(sizeof(SQLfield));
+		__setupMergeColumn(column->element, &field->children[0]);
+	}
+	/* custom metadata except for the min/max statistics */
+	if (field->_num_custom_metadata > 0)
+	{
+		column->customMetadata = palloc0(sizeof(ArrowKeyValue) *
+										 field->_num_custom_metadata);
+		for (k=0; k < field->_num_custom_metadata; k++)
+		{
+			ArrowKeyValue  *kv = &field->custom_metadata[k];
+
+			if (strcmp(kv->key, "min_values") == 0 ||
+				strcmp(kv->key, "max_values") == 0)
+			{
+				/* statistics are recomputed if source file has */
+				__enableFieldStats(column);
+				continue;
+			}
+			column->customMetadata[column->numCustomMetadata++] = *kv;
+		}
+	}
+}
+
+static void
+setupMergeTable(void)
+{
+	ArrowSchema *schema = &source_files[0].af_info.footer.schema;
+	SQLtable   *table;
+	int			j;
+
+	table = palloc0(offsetof(SQLtable, columns[schema->_num_fields]));
+	table->fdesc = -1;
+	table->segment_sz = batch_segment_sz;
+	table->nfields = schema->_num_fields;
+	table->numFieldNodes = num_field_nodes;
+	table->numBuffers = num_buffers;
+	table->customMetadata = schema->custom_metadata;
+	table->numCustomMetadata = schema->_num_custom_metadata;
+	for (j=0; j < schema->_num_fields; j++)
+		__setupMergeColumn(&table->columns[j], &schema->fields[j]);
+
+	/* additional min/max statistics by --stat */
+	if (stat_embedded_columns)
+	{
+		char   *buffer = alloca(strlen(stat_embedded_columns) + 1);
+		char   *name, *pos;
+
+		strcpy(buffer, stat_embedded_columns);
+		for (name = strtok_r(buffer, ",", &pos);
+			 name != NULL;
+			 name = strtok_r(NULL, ",", &pos))
+		{
+			bool	found = false;
+
+			while (*name == ' ' || *name == '\t')
+				name++;
+			for (j=0; j < table->nfields; j++)
+			{
+				SQLfield   *column = &table->columns[j];
+
+				if (strcmp(column->field_name, name) == 0)
+				{
+					if (!__enableFieldStats(column))
+						Elog("field [%s; %s] does not support min/max statistics",
+							 name, column->arrow_type.node.tagName);
+					found = true;
+				}
+			}
+			if (!found)
+				Elog("field name [%s], specified by --stat option, was not found",
+					 name);
+		}
+	}
+	for (j=0; j < table->nfields; j++)
+	{
+		if (table->columns[j].stat_enabled)
+			table->has_statistics = true;
+	}
+	merge_table = table;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Routines to read the source files
+ *
+ * ----------------------------------------------------------------
+ */
+static void
+checkSourceFile(mergeSourceFile *sfile)
+{
+	ArrowSchema *a = &source_files[0].af_info.footer.schema;
+	ArrowSchema *b = &sfile->af_info.footer.schema;
+	int			i, j;
+
+	if (sfile->af_info.footer._num_dictionaries > 0)
+		Elog("Arrow file '%s' has dictionary batches; not supported",
+			 sfile->filename);
+	if (a->_num_fields != b->_num_fields)
+		Elog("Arrow file '%s' and '%s' has different number of the fields",
+			 source_files[0].filename, sfile->filename);
+	for (j=0; j < a->_num_fields; j++)
+	{
+		if (!__mergeFieldIsCompatible(&a->fields[j], &b->fields[j]))
+			Elog("Arrow file '%s' and '%s' has incompatible field '%s'",
+				 source_files[0].filename, sfile->filename,
+				 a->fields[j].name);
+	}
+	for (i=0; i < sfile->af_info.footer._num_recordBatches; i++)
+	{
+		ArrowRecordBatch *rbatch = &sfile->af_info.recordBatches[i].body.recordBatch;
+
+		if (rbatch->compression)
+			Elog("Arrow file '%s' has compressed record batch; not supported",
+				 sfile->filename);
+		if (rbatch->_num_nodes != num_field_nodes ||
+			rbatch->_num_buffers != num_buffers)
+			Elog("Arrow file '%s' has corrupted record batch (nodes=%d, buffers=%d)",
+				 sfile->filename, rbatch->_num_nodes, rbatch->_num_buffers);
+	}
+}
+
+static void
+readSourceFile(mergeSourceFile *sfile)
+{
+	struct stat	stat_buf;
+	int		fdesc;
+
+	fdesc = open(sfile->filename, O_RDONLY);
+	if (fdesc < 0)
+		Elog("failed on open('%s'): %m", sfile->filename);
+	if (fstat(fdesc, &stat_buf) != 0)
+		Elog("failed on fstat('%s'): %m", sfile->filename);
+	sfile->st_dev = stat_buf.st_dev;
+	sfile->st_ino = stat_buf.st_ino;
+	readArrowFileDesc(fdesc, &sfile->af_info);
+	sfile->af_info.filename = sfile->filename;
+	close(fdesc);
+}
+
+static void *
+readSourceFilesMain(void *__priv)
+{
+	int		index;
+
+	while ((index = __atomic_fetch_add(&merge_next_file, 1,
+									   __ATOMIC_SEQ_CST)) < num_source_files)
+	{
+		mergeSourceFile *sfile = &source_files[index];
+
+		readSourceFile(sfile);
+		checkSourceFile(sfile);
+	}
+	return NULL;
+}
+
+/*
+ * readSourceFiles - reads the metadata of the source files in parallel,
+ * then builds the list of source record batches and merge jobs.
+ */
+static void
+readSourceFiles(void)
+{
+	pthread_t  *threads = alloca(sizeof(pthread_t) * num_worker_threads);
+	ArrowSchema *schema;
+	mergeJob   *job = NULL;
+	size_t		job_sz = 0;
+	int			i, j;
+
+	/* the first file defines the schema */
+	readSourceFile(&source_files[0]);
+	schema = &source_files[0].af_info.footer.schema;
+	num_merge_fields = schema->_num_fields;
+	merge_fields = palloc0(sizeof(mergeField) * num_merge_fields);
+	for (j=0; j < num_merge_fields; j++)
+		setupMergeField(&merge_fields[j], &schema->fields[j]);
+	checkSourceFile(&source_files[0]);
+
+	merge_next_file = 1;
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_create(&threads[i], NULL,
+									readSourceFilesMain, NULL)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_join(threads[i], NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+	}
+
+	/* list of the source record batches */
+	for (i=0; i < num_source_files; i++)
+		num_source_batches += source_files[i].af_info.footer._num_recordBatches;
+	if (num_source_batches == 0)
+		Elog("no record batches in the source files");
+	source_batches = palloc0(sizeof(mergeSourceBatch) * num_source_batches);
+	merge_jobs = palloc0(sizeof(mergeJob) * num_source_batches);
+	for (i=0, j=0; i < num_source_files; i++)
+	{
+		ArrowFileInfo *af_info = &source_files[i].af_info;
+		int		k;
+
+		for (k=0; k < af_info->footer._num_recordBatches; k++, j++)
+		{
+			mergeSourceBatch *sbatch = &source_batches[j];
+			size_t		sz;
+
+			sbatch->file_index = i;
+			sbatch->block = &af_info->footer.recordBatches[k];
+			sbatch->rbatch = &af_info->recordBatches[k].body.recordBatch;
+			if (sbatch->rbatch->length == 0)
+				continue;
+			/* a new merge job, if the record batch would exceed the size */
+			sz = sbatch->block->bodyLength;
+			if (!job || job_sz + sz > batch_segment_sz)
+			{
+				job = &merge_jobs[num_merge_jobs++];
+				job->first = j;
+				job_sz = 0;
+			}
+			job->nbatches = j - job->first + 1;
+			job->nrows += sbatch->rbatch->length;
+			job_sz += sz;
+		}
+	}
+	assert(j == num_source_batches);
+	if (num_merge_jobs == 0)
+		Elog("no rows in the source files");
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Routines to build the body of the merged record batch
+ *
+ * ----------------------------------------------------------------
+ */
+static void
+__appendBodyIOV(mergeWorker *w, void *addr, size_t sz)
+{
+	if (sz == 0)
+		return;
+	if (w->iov_cnt >= w->iov_len)
+	{
+		w->iov_len = (w->iov_len == 0 ? 1000 : 2 * w->iov_len);
+		w->iov = repalloc(w->iov, sizeof(struct iovec) * w->iov_len);
+	}
+	w->iov[w->iov_cnt].iov_base = addr;
+	w->iov[w->iov_cnt].iov_len  = sz;
+	w->iov_cnt++;
+	w->body_sz += sz;
+}
+
+static void *
+__allocBodyChunk(mergeWorker *w, size_t sz)
+{
+	void   *chunk = palloc0(ARROWALIGN(sz));
+
+	if (w->chunks_cnt >= w->chunks_len)
+	{
+		w->chunks_len = (w->chunks_len == 0 ? 100 : 2 * w->chunks_len);
+		w->chunks = repalloc(w->chunks, sizeof(void *) * w->chunks_len);
+	}
+	w->chunks[w->chunks_cnt++] = chunk;
+	return chunk;
+}
+
+/*
+ * __closeBodyBuffer - pads the buffer, then set up ArrowBuffer
+ */
+static void
+__closeBodyBuffer(mergeWorker *w, int bindex, size_t head)
+{
+	ArrowBuffer *bnode = &w->buffers[bindex];
+	size_t		gap = ARROWALIGN(w->body_sz) - w->body_sz;
+
+	__appendBodyIOV(w, arrow_zero_padding, gap);
+	initArrowNode(bnode, Buffer);
+	bnode->offset = head;
+	bnode->length = w->body_sz - head;
+}
+
+static void
+__copyBitmap(uint8_t *dst, int64_t dst_pos,
+			 const uint8_t *src, int64_t src_pos, int64_t nbits)
+{
+	int64_t		i;
+
+	if ((dst_pos & 7) == 0 && (src_pos & 7) == 0)
+	{
+		/* fast path, if both of bitmaps are aligned */
+		memcpy(dst + (dst_pos >> 3), src + (src_pos >> 3), nbits >> 3);
+		i = (nbits & ~7L);
+	}
+	else
+		i = 0;
+	for (; i < nbits; i++)
+	{
+		if (__bitmapIsSet(src, src_pos + i))
+			dst[(dst_pos + i) >> 3] |= (1 << ((dst_pos + i) & 7));
+	}
+}
+
+static int64_t
+__countNulls(const uint8_t *bitmap, int64_t pos, int64_t nbits)
+{
+	int64_t		i, count = 0;
+
+	for (i=0; i < nbits; i++)
+	{
+		if (!__bitmapIsSet(bitmap, pos + i))
+			count++;
+	}
+	return count;
+}
+
+/*
+ * mergeNullmap - the null bitmap is omitted if no nulls at all
+ */
+static void
+mergeNullmap(mergeWorker *w, mergeField *mf,
+			 mergeSlice *slices, int nslices, int64_t nrows)
+{
+	ArrowFieldNode *fnode = &w->nodes[mf->node_index];
+	int64_t		null_count = 0;
+	int64_t		pos;
+	size_t		head = w->body_sz;
+	uint8_t	   *bitmap;
+	int			k;
+
+	for (k=0; k < nslices; k++)
+	{
+		mergeSlice	   *s = &slices[k];
+		ArrowFieldNode *snode = &s->rbatch->nodes[mf->node_index];
+		ArrowBuffer	   *sbuf = &s->rbatch->buffers[mf->buffer_index];
+
+		if (sbuf->length == 0 || snode->null_count == 0)
+			continue;
+		if (s->offset == 0 && s->length == snode->length)
+			null_count += snode->null_count;
+		else
+			null_count += __countNulls((const uint8_t *)(s->body + sbuf->offset),
+									   s->offset, s->length);
+	}
+	initArrowNode(fnode, FieldNode);
+	fnode->length = nrows;
+	fnode->null_count = null_count;
+
+	if (null_count > 0)
+	{
+		bitmap = __allocBodyChunk(w, (nrows + 7) / 8);
+		for (k=0, pos=0; k < nslices; pos += slices[k++].length)
+		{
+			mergeSlice	   *s = &slices[k];
+			ArrowBuffer	   *sbuf = &s->rbatch->buffers[mf->buffer_index];
+
+			if (sbuf->length > 0)
+				__copyBitmap(bitmap, pos,
+							 (const uint8_t *)(s->body + sbuf->offset),
+							 s->offset, s->length);
+			else
+			{
+				int64_t		i;
+
+				for (i=0; i < s->length; i++)
+					bitmap[(pos + i) >> 3] |= (1 << ((pos + i) & 7));
+			}
+		}
+		__appendBodyIOV(w, bitmap, (nrows + 7) / 8);
+	}
+	__closeBodyBuffer(w, mf->buffer_index, head);
+}
+
+/*
+ * mergeFieldBody
+ */
+static void
+mergeFieldBody(mergeWorker *w, mergeField *mf,
+			   mergeSlice *slices, int nslices)
+{
+	ArrowType  *t = &mf->field->type;
+	int64_t		nrows = 0;
+	size_t		head;
+	int			j, k;
+
+	for (k=0; k < nslices; k++)
+		nrows += slices[k].length;
+	mergeNullmap(w, mf, slices, nslices, nrows);
+
+	head = w->body_sz;
+	switch (t->node.tag)
+	{
+		case ArrowNodeTag__Bool:
+			{
+				uint8_t	   *bitmap = __allocBodyChunk(w, (nrows + 7) / 8);
+				int64_t		pos = 0;
+
+				for (k=0; k < nslices; k++)
+				{
+					mergeSlice	   *s = &slices[k];
+					ArrowBuffer	   *sbuf = &s->rbatch->buffers[mf->buffer_index + 1];
+
+					__copyBitmap(bitmap, pos,
+								 (const uint8_t *)(s->body + sbuf->offset),
+								 s->offset, s->length);
+					pos += s->length;
+				}
+				__appendBodyIOV(w, bitmap, (nrows + 7) / 8);
+				__closeBodyBuffer(w, mf->buffer_index + 1, head);
+			}
+			break;
+
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+		case ArrowNodeTag__List:
+		case ArrowNodeTag__Map:
+			{
+				uint32_t   *offsets = __allocBodyChunk(w, sizeof(uint32_t) * (nrows + 1));
+				mergeSlice *cslices = alloca(sizeof(mergeSlice) * nslices);
+				int64_t		pos = 0;
+				uint64_t	curr = 0;
+
+				for (k=0; k < nslices; k++)
+				{
+					mergeSlice	   *s = &slices[k];
+					ArrowBuffer	   *sbuf = &s->rbatch->buffers[mf->buffer_index + 1];
+					const uint32_t *soff = (const uint32_t *)(s->body + sbuf->offset);
+					uint32_t		base = soff[s->offset];
+					int64_t			i;
+
+					for (i=0; i < s->length; i++)
+						offsets[pos++] = curr + (soff[s->offset + i] - base);
+					curr += (soff[s->offset + s->length] - base);
+					if (curr > INT_MAX)
+						Elog("field '%s' exceeds the limit of 32bit offsets; try smaller --segment-size",
+							 mf->field->name);
+					/* range of the values or children */
+					cslices[k].body   = s->body;
+					cslices[k].rbatch = s->rbatch;
+					cslices[k].offset = base;
+					cslices[k].length = soff[s->offset + s->length] - base;
+				}
+				offsets[pos] = curr;
+				__appendBodyIOV(w, offsets, sizeof(uint32_t) * (nrows + 1));
+				__closeBodyBuffer(w, mf->buffer_index + 1, head);
+
+				if (t->node.tag == ArrowNodeTag__Utf8 ||
+					t->node.tag == ArrowNodeTag__Binary)
+				{
+					/* zero-copy concatenation of the values */
+					head = w->body_sz;
+					for (k=0; k < nslices; k++)
+					{
+						mergeSlice	   *s = &slices[k];
+						ArrowBuffer	   *sbuf = &s->rbatch->buffers[mf->buffer_index + 2];
+
+						__appendBodyIOV(w, (char *)s->body + sbuf->offset + cslices[k].offset,
+										cslices[k].length);
+					}
+					__closeBodyBuffer(w, mf->buffer_index + 2, head);
+				}
+				else
+				{
+					mergeFieldBody(w, &mf->children[0], cslices, nslices);
+				}
+			}
+			break;
+
+		case ArrowNodeTag__FixedSizeList:
+			{
+				mergeSlice *cslices = alloca(sizeof(mergeSlice) * nslices);
+				int64_t		unitsz = t->FixedSizeList.listSize;
+
+				for (k=0; k < nslices; k++)
+				{
+					cslices[k].body   = slices[k].body;
+					cslices[k].rbatch = slices[k].rbatch;
+					cslices[k].offset = slices[k].offset * unitsz;
+					cslices[k].length = slices[k].length * unitsz;
+				}
+				mergeFieldBody(w, &mf->children[0], cslices, nslices);
+			}
+			break;
+
+		case ArrowNodeTag__Struct:
+			for (j=0; j < mf->num_children; j++)
+				mergeFieldBody(w, &mf->children[j], slices, nslices);
+			break;
+
+		default:
+			/* zero-copy concatenation of the fixed-length values */
+			assert(mf->unitsz > 0);
+			for (k=0; k < nslices; k++)
+			{
+				mergeSlice	   *s = &slices[k];
+				ArrowBuffer	   *sbuf = &s->rbatch->buffers[mf->buffer_index + 1];
+
+				__appendBodyIOV(w, (char *)s->body + sbuf->offset + mf->unitsz * s->offset,
+								mf->unitsz * s->length);
+			}
+			__closeBodyBuffer(w, mf->buffer_index + 1, head);
+			break;
+	}
+}
+
+/*
+ * mmapSourceBatch - maps the body of the source record batch
+ */
+static const char *
+mmapSourceBatch(mergeWorker *w, mergeSourceBatch *sbatch, int *p_fdesc, int *p_findex)
+{
+	ArrowBlock *block = sbatch->block;
+	off_t		offset = block->offset & ~(page_size - 1);
+	size_t		length = block->offset + block->metaDataLength + block->bodyLength - offset;
+	char	   *addr;
+
+	if (*p_findex != sbatch->file_index)
+	{
+		if (*p_fdesc >= 0)
+			close(*p_fdesc);
+		*p_findex = sbatch->file_index;
+		*p_fdesc = open(source_files[*p_findex].filename, O_RDONLY);
+		if (*p_fdesc < 0)
+			Elog("failed on open('%s'): %m", source_files[*p_findex].filename);
+	}
+	addr = mmap(NULL, length, PROT_READ, MAP_SHARED, *p_fdesc, offset);
+	if (addr == MAP_FAILED)
+		Elog("failed on mmap('%s'): %m", source_files[*p_findex].filename);
+	if (w->mmaps_cnt >= w->mmaps_len)
+	{
+		w->mmaps_len = (w->mmaps_len == 0 ? 100 : 2 * w->mmaps_len);
+		w->mmaps = repalloc(w->mmaps, sizeof(struct iovec) * w->mmaps_len);
+	}
+	w->mmaps[w->mmaps_cnt].iov_base = addr;
+	w->mmaps[w->mmaps_cnt].iov_len  = length;
+	w->mmaps_cnt++;
+
+	return addr + (block->offset - offset) + block->metaDataLength;
+}
+
+/*
+ * writeMergeJob
+ *
+ * The record batches are written in the order of the jobs, to keep the order
+ * of the source rows. Only reservation of the file position and registration
+ * of the ArrowBlock are serialized; the data is written in parallel.
+ */
+static void
+writeMergeJob(mergeWorker *w, int job_index, mergeJob *job)
+{
+	SQLtable   *table = w->table;
+	ArrowRecordBatch rbatch;
+	ArrowBlock	block;
+	size_t		length;
+	int			rb_index;
+	int			j;
+
+	initArrowNode(&rbatch, RecordBatch);
+	rbatch.length = job->nrows;
+	rbatch.nodes = w->nodes;
+	rbatch._num_nodes = num_field_nodes;
+	rbatch.buffers = w->buffers;
+	rbatch._num_buffers = num_buffers;
+
+	table->__iov_cnt = 0;
+	table->f_pos = 0;
+	length = setupArrowRecordBatchMessageIOV(table, &rbatch, w->iov, w->iov_cnt);
+
+	pthread_mutex_lock(&merge_lock);
+	while (merge_next_write != job_index)
+		pthread_cond_wait(&merge_cond, &merge_lock);
+	initArrowNode(&block, Block);
+	block.offset = merge_table->f_pos;
+	block.metaDataLength = table->__iov[0].iov_len;
+	block.bodyLength = length - block.metaDataLength;
+	merge_table->f_pos += length;
+	rb_index = sql_table_append_record_batch(merge_table, &block);
+	for (j=0; j < merge_table->nfields; j++)
+	{
+		SQLfield   *column = &merge_table->columns[j];
+
+		if (column->stat_enabled)
+			memcpy(&column->stat_datum, &w->stats[j], sizeof(SQLstat));
+	}
+	saveArrowRecordBatchStats(merge_table, rb_index);
+	merge_next_write++;
+	pthread_cond_broadcast(&merge_cond);
+	pthread_mutex_unlock(&merge_lock);
+
+	table->f_pos = block.offset;
+	arrowFileWriteIOV(table);
+
+	if (shows_progress)
+		printf("Record Batch[%d]: offset=%lu length=%lu (meta=%u, body=%lu) nitems=%ld\n",
+			   rb_index,
+			   block.offset,
+			   length,
+			   block.metaDataLength,
+			   block.bodyLength,
+			   job->nrows);
+}
+
+static void *
+mergeWorkerMain(void *__priv)
+{
+	mergeWorker *w = __priv;
+	int			job_index;
+
+	w->nodes = palloc0(sizeof(ArrowFieldNode) * num_field_nodes);
+	w->buffers = palloc0(sizeof(ArrowBuffer) * num_buffers);
+	w->stats = palloc0(sizeof(SQLstat) * num_merge_fields);
+
+	while ((job_index = __atomic_fetch_add(&merge_next_job, 1,
+										   __ATOMIC_SEQ_CST)) < num_merge_jobs)
+	{
+		mergeJob   *job = &merge_jobs[job_index];
+		mergeSlice *slices = alloca(sizeof(mergeSlice) * job->nbatches);
+		int			nslices = 0;
+		int			fdesc = -1;
+		int			findex = -1;
+		int			j, k;
+
+		for (k=0; k < job->nbatches; k++)
+		{
+			mergeSourceBatch *sbatch = &source_batches[job->first + k];
+			mergeSlice *s;
+
+			if (sbatch->rbatch->length == 0)
+				continue;	/* skip empty record batch */
+			s = &slices[nslices++];
+			s->body   = mmapSourceBatch(w, sbatch, &fdesc, &findex);
+			s->rbatch = sbatch->rbatch;
+			s->offset = 0;
+			s->length = sbatch->rbatch->length;
+		}
+		if (fdesc >= 0)
+			close(fdesc);
+
+		/* build the body, and min/max statistics */
+		w->iov_cnt = 0;
+		w->body_sz = 0;
+		for (j=0; j < num_merge_fields; j++)
+		{
+			mergeFieldBody(w, &merge_fields[j], slices, nslices);
+			memset(&w->stats[j], 0, sizeof(SQLstat));
+			if (merge_table->columns[j].stat_enabled)
+				updateFieldStats(&merge_fields[j], &w->stats[j],
+								 slices, nslices);
+		}
+		writeMergeJob(w, job_index, job);
+
+		/* cleanup */
+		while (w->chunks_cnt > 0)
+			pfree(w->chunks[--w->chunks_cnt]);
+		while (w->mmaps_cnt > 0)
+		{
+			struct iovec *m = &w->mmaps[--w->mmaps_cnt];
+
+			if (munmap(m->iov_base, m->iov_len) != 0)
+				Elog("failed on munmap: %m");
+		}
+	}
+	return NULL;
+}
+
+/*
+ * openOutputFile - creates a temporary file in the same directory of the
+ * output file. It replaces the output file by rename(2) on the successful
+ * completion, so the source files are never overwritten during the merge.
+ */
+static void
+__cleanupOutputFile(void)
+{
+	if (merge_temp_filename)
+		unlink(merge_temp_filename);
+}
+
+static int
+openOutputFile(void)
+{
+	struct stat	stat_buf;
+	const char *base;
+	mode_t		mask;
+	int			fdesc;
+	int			i;
+
+	if (stat(output_filename, &stat_buf) == 0)
+	{
+		for (i=0; i < num_source_files; i++)
+		{
+			mergeSourceFile *sfile = &source_files[i];
+
+			if (sfile->st_dev == stat_buf.st_dev &&
+				sfile->st_ino == stat_buf.st_ino)
+				Elog("output file '%s' is also the source file '%s'",
+					 output_filename, sfile->filename);
+		}
+	}
+	else if (errno != ENOENT)
+		Elog("failed on stat('%s'): %m", output_filename);
+
+	base = strrchr(output_filename, '/');
+	base = (base ? base + 1 : output_filename);
+	merge_temp_filename = palloc(strlen(output_filename) + 10);
+	sprintf(merge_temp_filename, "%.*s.%s.XXXXXX",
+			(int)(base - output_filename), output_filename, base);
+	fdesc = mkstemp(merge_temp_filename);
+	if (fdesc < 0)
+		Elog("failed on mkstemp('%s'): %m", merge_temp_filename);
+	atexit(__cleanupOutputFile);
+	/* mkstemp(3) creates the file with 0600 */
+	mask = umask(0);
+	umask(mask);
+	if (fchmod(fdesc, 0644 & ~mask) != 0)
+		Elog("failed on fchmod('%s'): %m", merge_temp_filename);
+	return fdesc;
+}
+
+static void
+closeOutputFile(int fdesc)
+{
+	if (fsync(fdesc) != 0)
+		Elog("failed on fsync('%s'): %m", merge_temp_filename);
+	if (close(fdesc) != 0)
+		Elog("failed on close('%s'): %m", merge_temp_filename);
+	if (rename(merge_temp_filename, output_filename) != 0)
+		Elog("failed on rename('%s','%s'): %m",
+			 merge_temp_filename, output_filename);
+	pfree(merge_temp_filename);
+	merge_temp_filename = NULL;
+}
+
+/*
+ * Entrypoint of arrowmerge
+ */
+int main(int argc, char * const argv[])
+{
+	mergeWorker *workers;
+	int			fdesc;
+	int			i;
+
+	parse_options(argc, argv);
+	page_size = sysconf(_SC_PAGESIZE);
+
+	/* read the metadata of the source files */
+	readSourceFiles();
+	setupMergeTable();
+
+	/* open & setup result file */
+	fdesc = openOutputFile();
+	merge_table->fdesc = fdesc;
+	merge_table->filename = output_filename;
+	arrowFileWrite(merge_table, "ARROW1\0\0", 8);
+	writeArrowSchema(merge_table);
+
+	/* launch the worker threads */
+	if (num_worker_threads > num_merge_jobs)
+		num_worker_threads = num_merge_jobs;
+	workers = palloc0(sizeof(mergeWorker) * num_worker_threads);
+	for (i=0; i < num_worker_threads; i++)
+	{
+		mergeWorker *w = &workers[i];
+
+		w->worker_id = i;
+		w->table = palloc0(offsetof(SQLtable, columns));
+		w->table->fdesc = fdesc;
+		w->table->filename = output_filename;
+		if ((errno = pthread_create(&w->thread, NULL,
+									mergeWorkerMain, w)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_join(workers[i].thread, NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+	}
+	/* write out footer portion */
+	writeArrowFooter(merge_table);
+	closeOutputFile(fdesc);
+
+	if (shows_progress)
+		printf("%d files (%d record batches) were merged into %d record batches\n",
+			   num_source_files, num_source_batches, num_merge_jobs);
+	return 0;
+}
+
+/*
+ * memory allocation handlers
+ */
+void *
+palloc(size_t sz)
+{
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void *
+palloc0(size_t sz)
+{
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	memset(ptr, 0, sz);
+	return ptr;
+}
+
+char *
+pstrdup(const char *str)
+{
+	char   *ptr = strdup(str);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void *
+repalloc(void *old, size_t sz)
+{
+	char   *ptr = realloc(old, sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void
+pfree(void *ptr)
+{
+	free(ptr);
+}
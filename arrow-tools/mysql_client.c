@@ -10,6 +10,7 @@
 #include <mysql/mysql.h>
 #include "sql2arrow.h"
 #include <ctype.h>
+#include <strings.h>
 #include <limits.h>
 #include <stdarg.h>
 
@@ -859,6 +860,12 @@ mysql_setup_attribute(MYSQL *conn,
 typedef struct {
 	MYSQL	   *conn;
 	MYSQL_RES  *res;
+	/* if sqldb_unfetch_results is called */
+	bool		refetch;
+	MYSQL_ROW	row;
+	unsigned long *row_sz;
+	/* if sqldb_import_snapshot is called */
+	bool		consistent_snapshot;
 } MYSTATE;
 
 /*
@@ -932,7 +939,9 @@ sqldb_server_connect(const char *sqldb_hostname,
 		mysql_num_rows(res) != 1)
 		Elog("unexpected query result for '%s'", query);
 	row = mysql_fetch_row(res);
-	if (strcmp(row[0], "SYSTEM") == 0)
+	if (mysql_timezone)
+		;	/* already set by the leader connection, if --parallel */
+	else if (strcmp(row[0], "SYSTEM") == 0)
 		mysql_timezone = pstrdup(row[1]);
 	else
 		mysql_timezone = pstrdup(row[0]);
@@ -951,6 +960,228 @@ sqldb_server_connect(const char *sqldb_hostname,
 	return mystate;
 }
 
+/*
+ * sqldb_export_snapshot
+ *
+ * MySQL has no way to export a snapshot, so the leader acquires the global
+ * read lock instead. The workers start their transactions WITH CONSISTENT
+ * SNAPSHOT while no transactions can commit, thus, all of them see the same
+ * database state. The lock is released when the leader closes the connection
+ * as soon as all the workers start their transactions, prior to the queries.
+ * The returned identifier is informational only.
+ */
+char *
+sqldb_export_snapshot(void *sqldb_state)
+{
+	MYSTATE	   *mystate = (MYSTATE *)sqldb_state;
+	MYSQL	   *conn = mystate->conn;
+	const char *query;
+	char		buf[80];
+
+	query = "FLUSH TABLES WITH READ LOCK";
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s\n"
+			 "\n"
+			 "HINT: --parallel needs RELOAD privilege to take a consistent snapshot\n",
+			 query, mysql_error(conn));
+	sprintf(buf, "mysql-thread-%lu", mysql_thread_id(conn));
+
+	return pstrdup(buf);
+}
+
+/*
+ * sqldb_import_snapshot
+ *
+ * It starts a transaction under the global read lock by the leader.
+ */
+void
+sqldb_import_snapshot(void *sqldb_state, const char *snapshot)
+{
+	MYSTATE	   *mystate = (MYSTATE *)sqldb_state;
+	MYSQL	   *conn = mystate->conn;
+	const char *query;
+
+	query = "SET SESSION TRANSACTION ISOLATION LEVEL REPEATABLE READ";
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(conn));
+	query = "START TRANSACTION WITH CONSISTENT SNAPSHOT, READ ONLY";
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(conn));
+	mystate->consistent_snapshot = true;
+}
+
+static char *
+__mysql_quote_identifier(const char *ident)
+{
+	char	   *buf = palloc(2 * strlen(ident) + 3);
+	char	   *pos = buf;
+
+	*pos++ = '`';
+	while (*ident != '\0')
+	{
+		if (*ident == '`')
+			*pos++ = '`';
+		*pos++ = *ident++;
+	}
+	*pos++ = '`';
+	*pos = '\0';
+
+	return buf;
+}
+
+static char *
+__mysql_key_to_cstring(__int128 value, char *buf)
+{
+	/* the key is in the range of either int64 or uint64 */
+	if (value < 0)
+		sprintf(buf, "%lld", (long long)value);
+	else
+		sprintf(buf, "%llu", (unsigned long long)value);
+	return buf;
+}
+
+/*
+ * sqldb_parallel_commands
+ *
+ * It splits the table into the disjoint ranges of the first primary key
+ * column (or the --split-by column) for each worker, according to the min
+ * and max values of the column. The first worker also scans NULLs.
+ */
+char **
+sqldb_parallel_commands(void *sqldb_state,
+						const char *sqldb_tablename,
+						const char *sqldb_split_column,
+						int num_workers)
+{
+	MYSTATE	   *mystate = (MYSTATE *)sqldb_state;
+	MYSQL	   *conn = mystate->conn;
+	MYSQL_RES  *res;
+	MYSQL_ROW	row;
+	MYSQL_FIELD *my_field;
+	char	   *keyname;
+	char	   *query;
+	char	  **commands;
+	bool		is_empty = false;
+	__int128	kmin = 0;
+	__int128	kmax = 0;
+	char		buf1[80], buf2[80];
+	int			j, k;
+
+	query = palloc(strlen(sqldb_tablename) + 200);
+	if (sqldb_split_column)
+		keyname = __mysql_quote_identifier(sqldb_split_column);
+	else
+	{
+		sprintf(query,
+				"SHOW KEYS FROM %s"
+				" WHERE Key_name = 'PRIMARY' AND Seq_in_index = 1",
+				sqldb_tablename);
+		if (mysql_query(conn, query) != 0)
+			Elog("failed on mysql_query('%s'): %s",
+				 query, mysql_error(conn));
+		res = mysql_store_result(conn);
+		if (!res)
+			Elog("failed on mysql_store_result: %s", mysql_error(conn));
+		if (mysql_num_rows(res) != 1)
+			Elog("table '%s' has no primary key, use --split-by=COLUMN",
+				 sqldb_tablename);
+		row = mysql_fetch_row(res);
+		keyname = NULL;
+		for (j=0; j < mysql_num_fields(res); j++)
+		{
+			my_field = mysql_fetch_field_direct(res, j);
+			if (strcasecmp(my_field->name, "Column_name") == 0 && row[j])
+			{
+				keyname = __mysql_quote_identifier(row[j]);
+				break;
+			}
+		}
+		if (!keyname)
+			Elog("unexpected query result for '%s'", query);
+		mysql_free_result(res);
+	}
+
+	/* quick min/max probe */
+	query = repalloc(query, strlen(sqldb_tablename) + 2 * strlen(keyname) + 200);
+	sprintf(query, "SELECT MIN(%s), MAX(%s) FROM %s",
+			keyname, keyname, sqldb_tablename);
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(conn));
+	res = mysql_store_result(conn);
+	if (!res)
+		Elog("failed on mysql_store_result: %s", mysql_error(conn));
+	if (mysql_num_fields(res) != 2 ||
+		mysql_num_rows(res) != 1)
+		Elog("unexpected query result for '%s'", query);
+	my_field = mysql_fetch_field_direct(res, 0);
+	switch (my_field->type)
+	{
+		case MYSQL_TYPE_TINY:
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_YEAR:
+		case MYSQL_TYPE_INT24:
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_LONGLONG:
+			break;
+		default:
+			Elog("--parallel needs an integer column to split the table '%s', but %s is not",
+				 sqldb_tablename, keyname);
+	}
+	row = mysql_fetch_row(res);
+	if (!row[0] || !row[1])
+		is_empty = true;
+	else if ((my_field->flags & UNSIGNED_FLAG) != 0)
+	{
+		kmin = strtoull(row[0], NULL, 10);
+		kmax = strtoull(row[1], NULL, 10);
+	}
+	else
+	{
+		kmin = strtoll(row[0], NULL, 10);
+		kmax = strtoll(row[1], NULL, 10);
+	}
+	mysql_free_result(res);
+
+	commands = palloc0(sizeof(char *) * num_workers);
+	for (k=0; k < num_workers; k++)
+	{
+		__int128	width = kmax - kmin + 1;
+		__int128	lower = kmin + (width * k) / num_workers;
+		__int128	upper = kmin + (width * (k+1)) / num_workers;
+		char	   *cmd = palloc(strlen(sqldb_tablename) +
+								 2 * strlen(keyname) + 200);
+
+		if (is_empty)
+			sprintf(cmd, "SELECT * FROM %s%s", sqldb_tablename,
+					k == 0 ? "" : " WHERE false");
+		else if (k == 0)
+			sprintf(cmd, "SELECT * FROM %s"
+					" WHERE %s < %s OR %s IS NULL",
+					sqldb_tablename,
+					keyname, __mysql_key_to_cstring(upper, buf1),
+					keyname);
+		else if (k == num_workers - 1)
+			sprintf(cmd, "SELECT * FROM %s"
+					" WHERE %s >= %s",
+					sqldb_tablename,
+					keyname, __mysql_key_to_cstring(lower, buf1));
+		else
+			sprintf(cmd, "SELECT * FROM %s"
+					" WHERE %s >= %s AND %s < %s",
+					sqldb_tablename,
+					keyname, __mysql_key_to_cstring(lower, buf1),
+					keyname, __mysql_key_to_cstring(upper, buf2));
+		commands[k] = cmd;
+	}
+	pfree(keyname);
+	pfree(query);
+
+	return commands;
+}
+
 /*
  * sqldb_begin_query
  */
@@ -967,11 +1198,15 @@ sqldb_begin_query(void *sqldb_state,
 	int			j, nfields;
 	const char *query;
 
-	/* start transaction with read-only mode */
-	query = "START TRANSACTION READ ONLY";
-	if (mysql_query(conn, query) != 0)
-		Elog("failed on mysql_query('%s'): %s",
-			 query, mysql_error(conn));
+	if (!mystate->consistent_snapshot)
+	{
+		/* start transaction with read-only mode */
+		query = "START TRANSACTION READ ONLY";
+		if (mysql_query(conn, query) != 0)
+			Elog("failed on mysql_query('%s'): %s",
+				 query, mysql_error(conn));
+	}
+	/* elsewhere, sqldb_import_snapshot already started the transaction */
 
 	/* exec SQL command  */
 	if (mysql_query(conn, sqldb_command) != 0)
@@ -1021,11 +1256,22 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 	size_t		usage = 0;
 	int			j;
 
-	row = mysql_fetch_row(mystate->res);
-	if (!row)
-		return false;
-
-	row_sz = mysql_fetch_lengths(mystate->res);
+	if (mystate->refetch)
+	{
+		/* the last row is valid until the next mysql_fetch_row() */
+		mystate->refetch = false;
+		row = mystate->row;
+		row_sz = mystate->row_sz;
+	}
+	else
+	{
+		row = mysql_fetch_row(mystate->res);
+		if (!row)
+			return false;
+		row_sz = mysql_fetch_lengths(mystate->res);
+		mystate->row = row;
+		mystate->row_sz = row_sz;
+	}
 	for (j=0; j < table->nfields; j++)
 	{
 		SQLfield   *column = &table->columns[j];
@@ -1040,6 +1286,18 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 	return true;
 }
 
+/*
+ * sqldb_unfetch_results
+ */
+void
+sqldb_unfetch_results(void *sqldb_state)
+{
+	MYSTATE	   *mystate = (MYSTATE *)sqldb_state;
+
+	assert(!mystate->refetch && mystate->row != NULL);
+	mystate->refetch = true;
+}
+
 void
 sqldb_close_connection(void *sqldb_state)
 {
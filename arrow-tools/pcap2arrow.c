@@ -74,7 +74,6 @@ static __thread uint32_t *current_interface_id = NULL;	/* for PCAP-NG */
  */
 typedef struct
 {
-	int					refcnt;
 	SQLtable			table;
 } arrowFileDesc;
 #define PCAP_SCHEMA_MAX_NFIELDS		50
@@ -83,16 +82,42 @@ typedef struct
 #define IP4ADDR_LEN		4
 #define IP6ADDR_LEN		16
 
-static pthread_mutex_t *arrow_file_desc_locks;
-static arrowFileDesc  **arrow_file_desc_array = NULL;
+static arrowFileDesc  **arrow_file_desc_array = NULL;	/* owned by writers */
 static uint64_t			arrow_file_desc_selector = 0;
 static int				arrow_file_desc_nums = 1;
 
-/* static variables for worker threads */
-static pthread_mutex_t	arrow_workers_mutex;
-static pthread_cond_t	arrow_workers_cond;
-static bool			   *arrow_workers_completed;
-static SQLtable		  **arrow_chunks_array;			/* chunk buffer per-thread */
+/*
+ * pcapChunk - a record batch buffer handed over from the worker to the writer
+ */
+typedef struct pcapChunk
+{
+	struct pcapChunk   *next;		/* link of the lock-free list */
+	int					owner;		/* worker-id of the owner */
+	size_t				length;		/* length of the record batch */
+	SQLtable			table;		/* must be the last */
+} pcapChunk;
+#define PCAP_NUM_SPARE_CHUNKS		2	/* per worker */
+
+typedef struct
+{
+	SQLtable		   *chunk;		/* chunk buffer currently filled up */
+	pcapChunk		   *free_list;	/* pushed by the writers */
+	pcapChunk		   *local_list;	/* private to the worker */
+	sem_t				free_sem;	/* # of free chunks */
+} pcapWorkerState;
+
+typedef struct
+{
+	pthread_t			thread;
+	int					f_index;	/* index of arrow_file_desc_array */
+	pcapChunk		   *queue;		/* pushed by the workers */
+	sem_t				queue_sem;	/* # of enqueued chunks (at least) */
+} pcapWriterState;
+
+/* static variables for worker/writer threads */
+static pcapWorkerState *pcap_worker_states = NULL;
+static pcapWriterState *pcap_writer_states = NULL;
+static bool				pcap_writer_shutdown = false;
 static sem_t			pcap_worker_sem;
 
 /* static variable for PF-RING capture mode */
@@ -107,17 +132,55 @@ static int				pfring_desc_nums = -1;
 
 typedef struct
 {
-	pcap_t			   *pcap_handle;
-	FILE			   *pcap_filp;
+	int					pcap_fdesc;
 	const char		   *pcap_filename;
 	uint32_t			pcap_magic;
-	char				pcap_errbuf[PCAP_ERRBUF_SIZE];
+	size_t				pcap_file_sz;
+	const char		   *pcap_mmap_head;	/* NULL, if --direct-io */
 } pcapFileDesc;
 
 static pcapFileDesc	   *pcap_file_desc_array = NULL;
-static volatile int		pcap_file_desc_selector = 0;
+static uint64_t			pcap_file_desc_selector = 0;
 static int				pcap_file_desc_nums = 0;
 
+/*
+ * The input files are split into ranges on the record/block boundaries
+ * by the quick scan at the beginning, then decoded by worker threads
+ * concurrently. A large file is also processed in parallel.
+ */
+#define PCAP_FILE_RANGE_MIN_SIZE	(1UL << 20)		/* 1MB */
+#define PCAP_FILE_RANGE_MAX_SIZE	(64UL << 20)	/* 64MB */
+#define PCAP_READER_WINDOW_SIZE		(4UL << 20)		/* 4MB */
+
+typedef struct
+{
+	pcapFileDesc	   *pfdesc;
+	void			   *section;	/* pcapngSectionState, if PCAPNG */
+	size_t				head;
+	size_t				tail;
+} pcapFileRange;
+
+static pcapFileRange   *pcap_file_range_array = NULL;
+static uint32_t			pcap_file_range_nums = 0;
+static uint32_t			pcap_file_range_nrooms = 0;
+static uint64_t			pcap_file_range_selector = 0;
+static pthread_mutex_t	pcap_file_range_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t pcap_file_scan_barrier;
+
+/*
+ * pcapReader - per-thread accessor to the input file; it references
+ * the mmap'ed file image, or reads the file into the private window
+ * using O_DIRECT if --direct-io is given.
+ */
+typedef struct
+{
+	pcapFileDesc	   *pfdesc;
+	char			   *window;
+	size_t				window_sz;
+	size_t				window_base;
+	size_t				window_len;
+} pcapReader;
+
 /* capture statistics */
 static uint64_t			stat_raw_packet_length = 0;
 static uint64_t			stat_ip4_packet_count = 0;
@@ -155,45 +218,20 @@ static volatile bool	do_shutdown = false;
 #endif
 
 static inline void
-pthreadMutexInit(pthread_mutex_t *mutex)
+semWait(sem_t *sem)
 {
-	if ((errno = pthread_mutex_init(mutex, NULL)) != 0)
-		Elog("failed on pthread_mutex_init: %m");
-}
-
-static inline void
-pthreadMutexLock(pthread_mutex_t *mutex)
-{
-	if ((errno = pthread_mutex_lock(mutex)) != 0)
-		Elog("failed on pthread_mutex_lock: %m");
-}
-
-static inline void
-pthreadMutexUnlock(pthread_mutex_t *mutex)
-{
-	if ((errno = pthread_mutex_unlock(mutex)) != 0)
-        Elog("failed on pthread_mutex_unlock: %m");
-}
-
-static inline void
-pthreadCondInit(pthread_cond_t *cond)
-{
-	if ((errno = pthread_cond_init(cond, NULL)) != 0)
-        Elog("failed on pthread_cond_init: %m");
-}
-
-static inline void
-pthreadCondWait(pthread_cond_t *cond, pthread_mutex_t *mutex)
-{
-	if ((errno = pthread_cond_wait(cond, mutex)) != 0)
-		Elog("failed on pthread_cond_wait: %m");
+	while (sem_wait(sem) != 0)
+	{
+		if (errno != EINTR)
+			Elog("failed on sem_wait: %m");
+	}
 }
 
 static inline void
-pthreadCondBroadcast(pthread_cond_t *cond)
+semPost(sem_t *sem)
 {
-	if ((errno = pthread_cond_broadcast(cond)) != 0)
-		Elog("failed on pthread_cond_broadcast: %m");
+	if (sem_post(sem) != 0)
+		Elog("failed on sem_post: %m");
 }
 
 /*
@@ -226,16 +264,6 @@ on_sigint_handler(int signal)
 		for (i=0; i < pfring_desc_nums; i++)
 			pfring_breakloop(pfring_desc_array[i]);
 	}
-	if (pcap_file_desc_array)
-	{
-		for (i=0; i < pcap_file_desc_nums; i++)
-		{
-			pcap_t *pcap_handle = pcap_file_desc_array[i].pcap_handle;
-
-			if (pcap_handle)
-				pcap_breakloop(pcap_handle);
-		}
-	}
 	errno = errno_saved;
 }
 
@@ -1485,7 +1513,6 @@ retry:
 	/* Setup arrowFileDesc */
 	outfd = palloc0(offsetof(arrowFileDesc,
 							 table.columns[PCAP_SCHEMA_MAX_NFIELDS]));
-	outfd->refcnt = 0;
 	outfd->table.fdesc = fdesc;
 	outfd->table.filename = pstrdup(path);
 	arrowPcapSchemaInit(&outfd->table);
@@ -1500,7 +1527,7 @@ retry:
 		int		flags = fcntl(fdesc, F_GETFL);
 
 		flags |= O_DIRECT;
-		if (fcntl(fdesc, F_SETFL, &flags) != 0)
+		if (fcntl(fdesc, F_SETFL, flags) != 0)
 			Elog("failed on fcntl('%s', F_SETFL, O_DIRECT): %m", path);
 		outfd->table.f_pos = DIRECT_IO_ALIGN(outfd->table.f_pos);
 	}
@@ -1590,71 +1617,111 @@ arrowFileDirectWriteIOV(SQLtable *chunk, size_t length)
 	chunk->__iov_cnt = 0;	/* rewind iovec */
 }
 
+/*
+ * pcapChunkListPush / pcapChunkListPopAll
+ *
+ * lock-free list to hand over the chunks between the workers and writers.
+ * Only one thread pops the entire list at once, so it is free from ABA.
+ */
+static inline void
+pcapChunkListPush(pcapChunk **p_head, pcapChunk *pchunk)
+{
+	pcapChunk  *head = __atomic_load_n(p_head, __ATOMIC_RELAXED);
+
+	do {
+		pchunk->next = head;
+	} while (!__atomic_compare_exchange_n(p_head, &head, pchunk,
+										  true,
+										  __ATOMIC_RELEASE,
+										  __ATOMIC_RELAXED));
+}
+
+static inline pcapChunk *
+pcapChunkListPopAll(pcapChunk **p_head)
+{
+	return __atomic_exchange_n(p_head, NULL, __ATOMIC_ACQUIRE);
+}
+
 /*
  * arrowChunkWriteOut
+ *
+ * It hands over the record batch in the chunk buffer to the writer thread.
+ * The contents of the chunk buffer are swapped with a free one owned by
+ * this worker, so the caller can continue to fill up the same chunk.
  */
 static void
 arrowChunkWriteOut(SQLtable *chunk)
 {
-	arrowFileDesc *outfd = NULL;
-	ArrowBlock	block;
-	size_t		meta_sz;
-	size_t		length;
-	int			f_index;
-	bool		close_file = false;
+	pcapWorkerState *ws = &pcap_worker_states[worker_id];
+	pcapWriterState *wr;
+	pcapChunk  *pchunk;
+	size_t		sz = offsetof(SQLtable, columns[chunk->nfields]);
+	void	   *temp = alloca(sz);
+
+	Assert(chunk->fdesc < 0);
+	if (chunk->nitems == 0)
+		return;
+	/* get a free chunk; wait for the writers, if none */
+	semWait(&ws->free_sem);
+	if (!ws->local_list)
+		ws->local_list = pcapChunkListPopAll(&ws->free_list);
+	pchunk = ws->local_list;
+	Assert(pchunk != NULL && pchunk->table.nitems == 0);
+	ws->local_list = pchunk->next;
+
+	/* swap the contents; SQLtable has no pointers to itself */
+	memcpy(temp, &pchunk->table, sz);
+	memcpy(&pchunk->table, chunk, sz);
+	memcpy(chunk, temp, sz);
 
 	/*
 	 * writeArrowXXXX() routines setup iov array if table->fdesc < 0.
+	 * So, serialization of the RecordBatch message is also done by the
+	 * worker, and the writer just issues i/o.
 	 */
-	Assert(chunk->fdesc < 0);
-	length = setupArrowRecordBatchIOV(chunk);
+	pchunk->length = setupArrowRecordBatchIOV(&pchunk->table);
 	if (enable_direct_io)
-		length = DIRECT_IO_ALIGN(length);
+		pchunk->length = DIRECT_IO_ALIGN(pchunk->length);
 
-	/*
-	 * attach file descriptor
-	 */
-	f_index = atomicAdd64(&arrow_file_desc_selector, 1) % arrow_file_desc_nums;
-	pthreadMutexLock(&arrow_file_desc_locks[f_index]);
-	for (;;)
-	{
-		outfd = arrow_file_desc_array[f_index];
-		if (outfd->table.f_pos < output_filesize_limit)
-		{
-			/* Ok, [base ... base + usage) is reserved */
-			chunk->fdesc    = outfd->table.fdesc;
-			chunk->filename = outfd->table.filename;
-			chunk->f_pos    = outfd->table.f_pos;
+	/* enqueue to the writer */
+	wr = &pcap_writer_states[atomicAdd64(&arrow_file_desc_selector, 1) %
+							 arrow_file_desc_nums];
+	pcapChunkListPush(&wr->queue, pchunk);
+	semPost(&wr->queue_sem);
+}
 
-			outfd->table.f_pos += length;
-			outfd->refcnt++;
-			break;
-		}
-		else
-		{
-			/* exceeds the limit, so switch the output file */
-			arrow_file_desc_array[f_index] = arrowOpenOutputFile();
-			if (outfd->refcnt == 0)
-			{
-				pthreadMutexUnlock(&arrow_file_desc_locks[f_index]);
-				/* ...and close the file, if nobody is writing */
-				arrowCloseOutputFile(outfd);
-				pthreadMutexLock(&arrow_file_desc_locks[f_index]);
-			}
-		}
-	}
-	pthreadMutexUnlock(&arrow_file_desc_locks[f_index]);
+/*
+ * arrowChunkWriteOutFile - write out the chunk by the writer thread
+ */
+static void
+arrowChunkWriteOutFile(pcapWriterState *wr, pcapChunk *pchunk)
+{
+	SQLtable   *chunk = &pchunk->table;
+	arrowFileDesc *outfd = arrow_file_desc_array[wr->f_index];
+	ArrowBlock	block;
+	size_t		meta_sz;
 
+	/* exceeds the limit, so switch the output file */
+	if (outfd->table.f_pos >= output_filesize_limit)
+	{
+		arrowCloseOutputFile(outfd);
+		outfd = arrowOpenOutputFile();
+		arrow_file_desc_array[wr->f_index] = outfd;
+	}
 	/* ok, write out record batch (see writeArrowRecordBatch) */
+	chunk->fdesc    = outfd->table.fdesc;
+	chunk->filename = outfd->table.filename;
+	chunk->f_pos    = outfd->table.f_pos;
+
 	Assert(chunk->__iov_cnt > 0 &&
-		   chunk->__iov[0].iov_len <= length);
+		   chunk->__iov[0].iov_len <= pchunk->length);
 	meta_sz = chunk->__iov[0].iov_len;
 
 	memset(&block, 0, sizeof(ArrowBlock));
 	initArrowNode(&block, Block);
 	block.offset = chunk->f_pos;
 	block.metaDataLength = meta_sz;
-	block.bodyLength = length - meta_sz;
+	block.bodyLength = pchunk->length - meta_sz;
 
 	if (!enable_direct_io)
 	{
@@ -1664,28 +1731,10 @@ arrowChunkWriteOut(SQLtable *chunk)
 	else
 	{
 		/* write-out by direct-io */
-		arrowFileDirectWriteIOV(chunk, length);
+		arrowFileDirectWriteIOV(chunk, pchunk->length);
 	}
-
-	/*
-	 * Ok, append ArrowBlock and detach file descriptor
-	 */
-	pthreadMutexLock(&arrow_file_desc_locks[f_index]);
-	if (!outfd->table.recordBatches)
-		outfd->table.recordBatches = palloc0(sizeof(ArrowBlock) * 40);
-	else
-	{
-		length = sizeof(ArrowBlock) * (outfd->table.numRecordBatches + 1);
-		outfd->table.recordBatches = repalloc(outfd->table.recordBatches, length);
-	}
-	outfd->table.recordBatches[outfd->table.numRecordBatches++] = block;
-
-	Assert(outfd->refcnt > 0);
-	if (--outfd->refcnt == 0 && arrow_file_desc_array[f_index] != outfd)
-		close_file = true;
-	pthreadMutexUnlock(&arrow_file_desc_locks[f_index]);
-	if (close_file)
-		arrowCloseOutputFile(outfd);
+	outfd->table.f_pos += pchunk->length;
+	sql_table_append_record_batch(&outfd->table, &block);
 
 	/* reset chunk buffer */
 	chunk->fdesc = -1;
@@ -1694,146 +1743,51 @@ arrowChunkWriteOut(SQLtable *chunk)
 }
 
 /*
- * arrowMergeChunkWriteOut
+ * pcap_writer_main
  */
-static inline int
-__arrowMergeChunkOneOptions(option_item *__option_items,
-							SQLfield *element,
-							uint32_t start, uint32_t end)
-{
-	uint32_t	index;
-	int			nitems = 0;
-	SQLfield   *sopt_type = &element->subfields[0];
-	SQLfield   *sopt_data = &element->subfields[1];
-
-	Assert(element->nitems == sopt_type->nitems &&
-		   element->nitems == sopt_data->nitems);
-	
-	if (element->nullcount != 0 ||
-		sopt_type->nullcount != 0 ||
-		sopt_data->nullcount != 0)
-		Elog("Data corruption? IPv4/IPv6/Tcp options should contains not NULLs");
-	
-	for (index=start; index < end; index++)
-	{
-		option_item *item = &__option_items[nitems++];
-		uint32_t	off;
-
-		item->option_type = ((uint8_t *)sopt_type->values.data)[index];
-		off = ((uint32_t *)sopt_data->values.data)[index];
-		item->option_sz = ((uint32_t *)sopt_data->values.data)[index+1] - off;
-		item->option_addr = (sopt_data->extra.data + off);
-	}
-	return nitems;
-}
+static void *
+pcap_writer_main(void *__arg)
+{
+	pcapWriterState *wr = (pcapWriterState *)__arg;
 
-static inline void
-__arrowMergeChunkOneRow(SQLtable *dchunk,
-						SQLtable *schunk, size_t index)
-{
-	size_t		usage = 0;
-	int			j;
-
-	Assert(dchunk->nfields == schunk->nfields);
-	for (j=0; j < schunk->nfields; j++)
-	{
-		option_item	__option_items[256];
-		SQLfield   *dcolumn = &dchunk->columns[j];
-		SQLfield   *scolumn = &schunk->columns[j];
-		void	   *addr;
-		size_t		sz, off;
-		uint64_t	val;
-		uint32_t	start, end;
-		int			nitems;
-		struct timeval ts_buf;
-
-		Assert(schunk->nitems == scolumn->nitems);
-		if (scolumn->nullcount > 0 &&
-			(scolumn->nullmap.data[index>>3] & (1<<(index&7))) == 0)
+	for (;;)
+	{
+		pcapChunk  *list;
+		pcapChunk  *pchunk;
+		pcapChunk  *next;
+		pcapChunk  *fifo = NULL;
+		bool		shutdown;
+
+		semWait(&wr->queue_sem);
+		/* must be checked prior to the pop, for no pending chunks */
+		shutdown = __atomic_load_n(&pcap_writer_shutdown, __ATOMIC_ACQUIRE);
+		list = pcapChunkListPopAll(&wr->queue);
+		if (!list)
 		{
-			usage += dcolumn->put_value(dcolumn, NULL, 0);
+			if (shutdown)
+				break;
 			continue;
 		}
-
-		Assert(scolumn->arrow_type.node.tag == dcolumn->arrow_type.node.tag);
-		switch (scolumn->arrow_type.node.tag)
+		/* reverse the list to write out chunks in the enqueued order */
+		for (pchunk = list; pchunk != NULL; pchunk = next)
 		{
-			case ArrowNodeTag__Timestamp:
-				Assert(scolumn->arrow_type.Timestamp.unit == ArrowTimeUnit__MicroSecond);
-				val = ((uint64_t *)scolumn->values.data)[index];
-				ts_buf.tv_sec = val / 1000000;
-				ts_buf.tv_usec = val % 1000000;
-				sz = sizeof(struct timeval);
-				addr = &ts_buf;
-				break;
-
-			case ArrowNodeTag__Int:
-				sz = scolumn->arrow_type.Int.bitWidth / 8;
-				Assert(sz == sizeof(uint8_t)  ||
-					   sz == sizeof(uint16_t) ||
-					   sz == sizeof(uint32_t) ||
-					   sz == sizeof(uint64_t));
-				addr = scolumn->values.data + sz * index;
-				break;
-
-			case ArrowNodeTag__Binary:
-				off = ((uint32_t *)scolumn->values.data)[index];
-				sz = ((uint32_t *)scolumn->values.data)[index+1] - off;
-				addr = scolumn->extra.data + off;
-				break;
-
-			case ArrowNodeTag__FixedSizeBinary:
-				Assert(scolumn->arrow_type.FixedSizeBinary.byteWidth ==
-					   dcolumn->arrow_type.FixedSizeBinary.byteWidth);
-				sz = scolumn->arrow_type.FixedSizeBinary.byteWidth;
-				addr = scolumn->values.data + sz * index;
-				break;
-
-			case ArrowNodeTag__List:
-				/* List::Struct<Uint8,Binary> */
-				start = ((uint32_t *)scolumn->values.data)[index];
-				end = ((uint32_t *)scolumn->values.data)[index+1];
-				nitems = __arrowMergeChunkOneOptions(__option_items,
-													 scolumn->element,
-													 start, end);
-				if (nitems == 0)
-				{
-					sz = 0;
-					addr = NULL;
-				}						
-				else
-				{
-					sz = sizeof(option_item) * nitems;
-					addr = __option_items;
-				}
-				break;
-			default:
-				Elog("Bug? unexpected ArrowType (tag: %d)",
-					 scolumn->arrow_type.node.tag);
+			next = pchunk->next;
+			pchunk->next = fifo;
+			fifo = pchunk;
 		}
-		usage += dcolumn->put_value(dcolumn, addr, sz);
-	}
-	dchunk->nitems++;
-	dchunk->usage = usage;
-}
-
-static void
-arrowMergeChunkWriteOut(SQLtable *dchunk, SQLtable *schunk)
-{
-	size_t		i;
-	
-	for (i=0; i < schunk->nitems; i++)
-	{
-		/* merge one row */
-		__arrowMergeChunkOneRow(dchunk, schunk, i);
-
-		/* write out buffer */
-		if (dchunk->usage >= record_batch_threshold)
+		for (pchunk = fifo; pchunk != NULL; pchunk = next)
 		{
-			arrowChunkWriteOut(dchunk);
-			sql_table_clear(dchunk);
+			pcapWorkerState *ws = &pcap_worker_states[pchunk->owner];
+
+			next = pchunk->next;
+			arrowChunkWriteOutFile(wr, pchunk);
+			/* give back the chunk to the owner */
+			sql_table_clear(&pchunk->table);
+			pcapChunkListPush(&ws->free_list, pchunk);
+			semPost(&ws->free_sem);
 		}
 	}
+	return NULL;
 }
 
 /*
@@ -1991,44 +1945,6 @@ execCapturePackets(pfring *pd, SQLtable *chunk)
 	return 0;
 }
 
-/*
- * final_merge_pending_chunks
- */
-static void *
-final_merge_pending_chunks(SQLtable *chunk)
-{
-	int		phase;
-
-	Assert(worker_id >= 0 && worker_id < num_threads);
-	/* merge pending chunks */
-	for (phase = 0; (worker_id & ((1UL << (phase + 1)) - 1)) == 0; phase++)
-	{
-		int		buddy = worker_id + (1UL << phase);
-
-		if (buddy >= num_threads)
-			break;
-		pthreadMutexLock(&arrow_workers_mutex);
-		while (!arrow_workers_completed[buddy])
-		{
-			pthreadCondWait(&arrow_workers_cond,
-							&arrow_workers_mutex);
-		}
-		pthreadMutexUnlock(&arrow_workers_mutex);
-
-		arrowMergeChunkWriteOut(chunk, arrow_chunks_array[buddy]);
-	}
-	if (worker_id == 0 && chunk->nitems > 0)
-		arrowChunkWriteOut(chunk);
-	
-	/* Ok, this worker exit */
-	pthreadMutexLock(&arrow_workers_mutex);
-	arrow_workers_completed[worker_id] = true;
-	pthreadCondBroadcast(&arrow_workers_cond);
-	pthreadMutexUnlock(&arrow_workers_mutex);
-
-	return NULL;
-}
-
 /*
  * pfring_worker_main
  */
@@ -2039,7 +1955,7 @@ pfring_worker_main(void *__arg)
 
 	/* assign worker-id of this thread */
 	worker_id = (long)__arg;
-	chunk = arrow_chunks_array[worker_id];
+	chunk = pcap_worker_states[worker_id].chunk;
 
 	while (!do_shutdown)
 	{
@@ -2071,46 +1987,218 @@ pfring_worker_main(void *__arg)
 		if (status > 0)
 			arrowChunkWriteOut(chunk);
 	}
-	return final_merge_pending_chunks(chunk);
+	/* write out the partially filled chunk */
+	arrowChunkWriteOut(chunk);
+	return NULL;
 }
 
 /*
- * process_one_pcap_file
+ * pcapReaderFetch - returns the pointer to the file image at the offset,
+ * or NULL if the range is beyond the end of file. The returned pointer
+ * is valid until the next call of pcapReaderFetch on the same reader.
  */
+static const unsigned char *
+pcapReaderFetch(pcapReader *reader, size_t offset, size_t length)
+{
+	pcapFileDesc   *pfdesc = reader->pfdesc;
+	size_t			base, sz, len;
+	ssize_t			nbytes;
+
+	if (offset + length > pfdesc->pcap_file_sz)
+		return NULL;
+	if (pfdesc->pcap_mmap_head)
+		return (const unsigned char *)(pfdesc->pcap_mmap_head + offset);
+
+	/* --direct-io; load the file image to the window */
+	if (offset < reader->window_base ||
+		offset + length > reader->window_base + reader->window_len)
+	{
+		base = (offset & ~(PAGESIZE - 1));
+		sz = PAGE_ALIGN(offset + length) - base;
+		if (sz < PCAP_READER_WINDOW_SIZE)
+			sz = PCAP_READER_WINDOW_SIZE;
+		if (!reader->window)
+		{
+			reader->window = mmap(NULL, sz,
+								  PROT_READ | PROT_WRITE,
+								  MAP_PRIVATE | MAP_ANONYMOUS,
+								  -1, 0);
+			if (reader->window == MAP_FAILED)
+				Elog("failed on mmap(sz=%zu): %m", sz);
+			reader->window_sz = sz;
+		}
+		else if (sz > reader->window_sz)
+		{
+			reader->window = mremap(reader->window, reader->window_sz,
+									sz, MREMAP_MAYMOVE);
+			if (reader->window == MAP_FAILED)
+				Elog("failed on mremap(sz=%zu -> %zu): %m",
+					 reader->window_sz, sz);
+			reader->window_sz = sz;
+		}
+		for (len=0; len < reader->window_sz; len += nbytes)
+		{
+			nbytes = pread(pfdesc->pcap_fdesc,
+						   reader->window + len,
+						   reader->window_sz - len,
+						   base + len);
+			if (nbytes < 0)
+			{
+				if (errno == EINTR)
+				{
+					nbytes = 0;
+					continue;
+				}
+				Elog("failed on pread('%s'): %m", pfdesc->pcap_filename);
+			}
+			if (nbytes == 0)
+				break;	/* EOF */
+		}
+		reader->window_base = base;
+		reader->window_len = len;
+		if (offset + length > base + len)
+			Elog("file '%s' was truncated during the scan",
+				 pfdesc->pcap_filename);
+	}
+	return (const unsigned char *)(reader->window + (offset - reader->window_base));
+}
+
 static void
-process_one_pcap_file(SQLtable *chunk, pcapFileDesc *pfdesc)
+pcapReaderRelease(pcapReader *reader)
 {
-	const u_char *buffer;
+	if (reader->window)
+		munmap(reader->window, reader->window_sz);
+	memset(reader, 0, sizeof(pcapReader));
+}
 
-	pfdesc->pcap_handle =
-		pcap_fopen_offline_with_tstamp_precision(pfdesc->pcap_filp,
-												 PCAP_TSTAMP_PRECISION_MICRO,
-												 pfdesc->pcap_errbuf);
-	if (!pfdesc->pcap_handle)
-		Elog("failed on open pcap file ('%s'): %s",
-			 pfdesc->pcap_filename,
-			 pfdesc->pcap_errbuf);
+/*
+ * pcapFileRangeSize - size of the ranges to be split
+ */
+static size_t
+pcapFileRangeSize(pcapFileDesc *pfdesc)
+{
+	size_t		range_sz = pfdesc->pcap_file_sz / (4 * num_threads);
 
-	while (!do_shutdown)
+	if (range_sz < PCAP_FILE_RANGE_MIN_SIZE)
+		range_sz = PCAP_FILE_RANGE_MIN_SIZE;
+	if (range_sz > PCAP_FILE_RANGE_MAX_SIZE)
+		range_sz = PCAP_FILE_RANGE_MAX_SIZE;
+	return range_sz;
+}
+
+/*
+ * pcapFileRangeAppend
+ */
+static void
+pcapFileRangeAppend(pcapFileDesc *pfdesc, void *section,
+					size_t head, size_t tail)
+{
+	pcapFileRange  *range;
+
+	if (head >= tail)
+		return;
+	pthread_mutex_lock(&pcap_file_range_lock);
+	if (pcap_file_range_nums >= pcap_file_range_nrooms)
 	{
-		struct pcap_pkthdr hdr;
-		struct pfring_pkthdr __hdr;
+		pcap_file_range_nrooms = 2 * pcap_file_range_nrooms + 40;
+		pcap_file_range_array = repalloc(pcap_file_range_array,
+										 sizeof(pcapFileRange) *
+										 pcap_file_range_nrooms);
+	}
+	range = &pcap_file_range_array[pcap_file_range_nums++];
+	range->pfdesc = pfdesc;
+	range->section = section;
+	range->head = head;
+	range->tail = tail;
+	pthread_mutex_unlock(&pcap_file_range_lock);
+}
 
-		buffer = pcap_next(pfdesc->pcap_handle, &hdr);
-		if (!buffer)
+/*
+ * Routines to handle PCAP files
+ */
+#define PCAP_FILE_HEADER_SZ		24
+#define PCAP_RECORD_HEADER_SZ	16
+#define PCAP_RECORD_MAX_CAPLEN	(1U << 20)
+
+static inline void
+__fetch_pcap_record_header(pcapFileDesc *pfdesc,
+						   const unsigned char *pos,
+						   uint32_t hdr[4])
+{
+	memcpy(hdr, pos, sizeof(uint32_t) * 4);
+	if (pfdesc->pcap_magic == PCAP_MAGIC_LE)
+	{
+		hdr[0] = __builtin_bswap32(hdr[0]);		/* ts_sec */
+		hdr[1] = __builtin_bswap32(hdr[1]);		/* ts_usec */
+		hdr[2] = __builtin_bswap32(hdr[2]);		/* incl_len */
+		hdr[3] = __builtin_bswap32(hdr[3]);		/* orig_len */
+	}
+	if (hdr[2] > PCAP_RECORD_MAX_CAPLEN)
+		Elog("pcap file '%s' looks corrupted", pfdesc->pcap_filename);
+}
+
+/*
+ * scan_one_pcap_file - walks on the record headers to split the file
+ */
+static void
+scan_one_pcap_file(pcapFileDesc *pfdesc, pcapReader *reader)
+{
+	size_t		range_sz = pcapFileRangeSize(pfdesc);
+	size_t		head = PCAP_FILE_HEADER_SZ;
+	size_t		pos = PCAP_FILE_HEADER_SZ;
+	const unsigned char *addr;
+	uint32_t	hdr[4];
+
+	while (!do_shutdown)
+	{
+		addr = pcapReaderFetch(reader, pos, PCAP_RECORD_HEADER_SZ);
+		if (!addr)
 			break;
-		__hdr.ts = hdr.ts;
-		__hdr.caplen = hdr.caplen;
-		__hdr.len = hdr.len;
-		__execCaptureOnePacket(chunk, &__hdr, buffer);
-		if (chunk->usage >= record_batch_threshold)
+		__fetch_pcap_record_header(pfdesc, addr, hdr);
+		if (pos + PCAP_RECORD_HEADER_SZ + hdr[2] > pfdesc->pcap_file_sz)
+			break;		/* truncated last record */
+		pos += PCAP_RECORD_HEADER_SZ + hdr[2];
+		if (pos - head >= range_sz)
 		{
-			arrowChunkWriteOut(chunk);
-			sql_table_clear(chunk);
+			pcapFileRangeAppend(pfdesc, NULL, head, pos);
+			head = pos;
 		}
 	}
-	/* close */
-	pcap_close(pfdesc->pcap_handle);
+	pcapFileRangeAppend(pfdesc, NULL, head, pos);
+}
+
+/*
+ * process_one_pcap_range
+ */
+static void
+process_one_pcap_range(SQLtable *chunk, pcapFileRange *range,
+					   pcapReader *reader)
+{
+	pcapFileDesc   *pfdesc = range->pfdesc;
+	size_t			pos = range->head;
+	const unsigned char *addr;
+
+	while (pos < range->tail && !do_shutdown)
+	{
+		struct pfring_pkthdr __hdr;
+		uint32_t	hdr[4];
+
+		addr = pcapReaderFetch(reader, pos, PCAP_RECORD_HEADER_SZ);
+		if (!addr)
+			Elog("pcap file '%s' looks corrupted", pfdesc->pcap_filename);
+		__fetch_pcap_record_header(pfdesc, addr, hdr);
+		addr = pcapReaderFetch(reader, pos, PCAP_RECORD_HEADER_SZ + hdr[2]);
+		if (!addr)
+			Elog("pcap file '%s' looks corrupted", pfdesc->pcap_filename);
+		__hdr.ts.tv_sec = hdr[0];
+		__hdr.ts.tv_usec = hdr[1];
+		__hdr.caplen = hdr[2];
+		__hdr.len = hdr[3];
+		__execCaptureOnePacket(chunk, &__hdr, addr + PCAP_RECORD_HEADER_SZ);
+		if (chunk->usage >= record_batch_threshold)
+			arrowChunkWriteOut(chunk);
+		pos += PCAP_RECORD_HEADER_SZ + hdr[2];
+	}
 }
 
 /* ================================================================
@@ -2218,7 +2306,6 @@ typedef struct
 /* pcapngSectionState */
 typedef struct
 {
-	FILE	   *filp;
 	const char *filename;
 	bool		little_endian;
 	uint16_t	major;
@@ -2260,9 +2347,9 @@ pmemdup(const void *addr, size_t sz)
 	return result;
 }
 
-static inline unsigned char *
+static inline const unsigned char *
 __fetch_pcapng_options(pcapngSectionState *section,
-					   unsigned char *pos, unsigned char *end,
+					   const unsigned char *pos, const unsigned char *end,
 					   uint16_t *p_code, uint16_t *p_len)
 {
 	uint16_t	__code;
@@ -2287,13 +2374,13 @@ __fetch_pcapng_options(pcapngSectionState *section,
 }
 
 static bool
-__process_pcapng_interface_description(SQLtable *chunk, pcapngSectionState *section,
-									   pcapngInterfaceDescriptionBlock *idb)
+__process_pcapng_interface_description(pcapngSectionState *section,
+									   const pcapngInterfaceDescriptionBlock *idb)
 {
 	pcapngInterfaceState *i_state;
 	uint32_t		interface_id;
 	uint32_t		block_sz;
-	unsigned char  *pos, *end;
+	const unsigned char *pos, *end;
 	size_t			sz;
 
 	interface_id = section->_num_if_states++;
@@ -2308,7 +2395,7 @@ __process_pcapng_interface_description(SQLtable *chunk, pcapngSectionState *sect
 	i_state->link_type = __to_host16(idb->link_type);
 	i_state->snaplen = __to_host32(idb->snaplen);
 	pos = idb->options;
-	end = (unsigned char *)idb + block_sz - sizeof(uint32_t);
+	end = (const unsigned char *)idb + block_sz - sizeof(uint32_t);
 	while (pos < end)
 	{
 		pcapngIPv4addr *ipv4;
@@ -2391,7 +2478,7 @@ __process_pcapng_interface_description(SQLtable *chunk, pcapngSectionState *sect
 
 static bool
 __process_pcapng_simple_packet(SQLtable *chunk, pcapngSectionState *section,
-							   pcapngSimplePacketBlock *spb)
+							   const pcapngSimplePacketBlock *spb)
 {
 	uint32_t	block_sz = __to_host32(spb->c.block_length);
 	struct pfring_pkthdr phdr;
@@ -2401,11 +2488,8 @@ __process_pcapng_simple_packet(SQLtable *chunk, pcapngSectionState *section,
 									   packet_data) - sizeof(uint32_t));
 	phdr.len = __to_host32(spb->original_packat_len);
 	__execCaptureOnePacket(chunk, &phdr, spb->packet_data);
-    if (chunk->usage >= record_batch_threshold)
-    {
+	if (chunk->usage >= record_batch_threshold)
 		arrowChunkWriteOut(chunk);
-        sql_table_clear(chunk);
-	}
 	return true;
 }
 
@@ -2424,14 +2508,14 @@ static unsigned int __power_of_ten[] = {
 
 static bool
 __process_pcapng_enhanced_packet(SQLtable *chunk, pcapngSectionState *section,
-								 pcapngEnhancedPacketBlock *epb)
+								 const pcapngEnhancedPacketBlock *epb)
 {
 	pcapngInterfaceState *i_state;
 	struct pfring_pkthdr phdr;
 	uint32_t	block_sz = __to_host32(epb->c.block_length);
 	uint32_t	interface_id = __to_host32(epb->interface_id);
 	uint64_t	ts_raw;
-	unsigned char *pos, *end;
+	const unsigned char *pos, *end;
 
 	if (interface_id >= section->_num_if_states)
 		Elog("pcapng file '%s' looks corrupted", section->filename);
@@ -2475,7 +2559,7 @@ __process_pcapng_enhanced_packet(SQLtable *chunk, pcapngSectionState *section,
 
 	/* parse EPB options */
 	pos = epb->packet_data + INTALIGN(phdr.caplen);
-	end = (unsigned char *)epb + block_sz - sizeof(uint32_t);
+	end = (const unsigned char *)epb + block_sz - sizeof(uint32_t);
 	while (pos < end)
 	{
 		uint16_t	__code;
@@ -2507,159 +2591,61 @@ __process_pcapng_enhanced_packet(SQLtable *chunk, pcapngSectionState *section,
 
 	__execCaptureOnePacket(chunk, &phdr, epb->packet_data);
 	if (chunk->usage >= record_batch_threshold)
-	{
 		arrowChunkWriteOut(chunk);
-		sql_table_clear(chunk);
-	}
-	return true;
-}
-
-/*
- * process_one_pcapng_block
- */
-static bool
-process_one_pcapng_block(SQLtable *chunk, pcapngSectionState *section)
-{
-	pcapngBlockHeaderCommon hc;
-	uint32_t	block_type;
-	uint32_t	block_sz;
-	uint32_t   *checker;
-	void	   *buffer;
-
-	if (fread(&hc, sizeof(pcapngBlockHeaderCommon), 1, section->filp) != 1)
-	{
-		if (feof(section->filp))
-			return false;
-		Elog("failed on fread('%s'): %m", section->filename);
-	}
-
-	if (hc.block_type == PCAPNG_TYPE__SECTION_HEADER_BLOCK)
-	{
-		if (fseek(section->filp, -sizeof(pcapngBlockHeaderCommon), SEEK_CUR) < 0)
-			Elog("failed on fseek('%s'): %m", section->filename);
-		return false;
-	}
-	block_type = __to_host32(hc.block_type);
-	block_sz = __to_host32(hc.block_length);
-	buffer = alloca(block_sz);
-	if (fread(buffer + sizeof(pcapngBlockHeaderCommon),
-			  block_sz - sizeof(pcapngBlockHeaderCommon), 1,
-			  section->filp) != 1)
-	{
-		if (feof(section->filp))
-			return false;
-		Elog("failed on fread('%s'): %m", section->filename);
-	}
-	checker = (uint32_t *)((char *)buffer + block_sz - sizeof(uint32_t));
-	if (block_sz != __to_host32(*checker))
-		Elog("pcapng file '%s' looks corrupted", section->filename);
-	memcpy(buffer, &hc, sizeof(pcapngBlockHeaderCommon));
-
-	/* check section boundary overrun */
-	if (section->section_sz != ~0UL)
-	{
-		long	curr_pos = ftell(section->filp);
-
-		if (curr_pos < 0)
-			Elog("failed on ftell('%s'): %m", section->filename);
-		if (curr_pos < section->section_head ||
-			curr_pos >= section->section_head + section->section_sz)
-			return false;	/* out of section */
-	}
-
-	switch (block_type)
-	{
-		case PCAPNG_TYPE__INTERFACE_DESCRIPTION_BLOCK:
-			if (!__process_pcapng_interface_description(chunk, section, buffer))
-				return false;
-			break;
-		case PCAPNG_TYPE__SIMPLE_PACKET_BLOCK:
-			if (!__process_pcapng_simple_packet(chunk, section, buffer))
-				return false;
-			break;
-		case PCAPNG_TYPE__ENHANCED_PACKET_BLOCK:
-			if (!__process_pcapng_enhanced_packet(chunk, section, buffer))
-				return false;
-			break;
-		default:
-			/* unknown block - ignored */
-			break;
-	}
 	return true;
 }
 
 /*
- * process_one_pcapng_section
+ * __process_pcapng_section_header
  */
-static void
-process_one_pcapng_section(SQLtable *chunk, pcapngSectionState *section)
+static uint32_t
+__process_pcapng_section_header(pcapngSectionState *section,
+								pcapReader *reader, size_t offset)
 {
-	pcapngSectionHeaderBlock hdr;
-	long		section_head;
+	const pcapngSectionHeaderBlock *shb;
 	uint32_t	block_sz;
-	uint32_t	options_sz;
-	unsigned char *pos, *end;
-	uint32_t   *saved_interface_id;
-
-	if (fread(&hdr, offsetof(pcapngSectionHeaderBlock,
-							 options), 1, section->filp) != 1)
-	{
-		if (feof(section->filp))
-			return;		/* EOF */
-		Elog("failed on fread('%s'): %m", section->filename);
-	}
-	section_head = ftell(section->filp);
-	if (section_head < offsetof(pcapngSectionHeaderBlock, options))
-		Elog("failed on ftell('%s'): %m", section->filename);
-	section_head -= offsetof(pcapngSectionHeaderBlock, options);
+	const unsigned char *pos, *end;
 
+	shb = (const pcapngSectionHeaderBlock *)
+		pcapReaderFetch(reader, offset, offsetof(pcapngSectionHeaderBlock,
+												 options));
+	if (!shb)
+		return 0;		/* EOF */
 	/* confirm byte ordering */
-	if (hdr.byte_order == 0x1a2b3c4dU)
+	if (shb->byte_order == 0x1a2b3c4dU)
 		section->little_endian = true;
-	else if (hdr.byte_order == 0x4d3c2b1aU)
+	else if (shb->byte_order == 0x4d3c2b1aU)
 		section->little_endian = false;
 	else
 		Elog("pcapng file '%s' looks corrupted", section->filename);
 
-	section->major = __to_host16(hdr.major);
-	section->minor = __to_host16(hdr.minor);
-	section->section_head = section_head;
-	section->section_sz = __to_host64(hdr.section_length);
+	block_sz = __to_host32(shb->c.block_length);
+	if (block_sz < offsetof(pcapngSectionHeaderBlock,
+							options) + sizeof(uint32_t) ||
+		(block_sz & 3) != 0)
+		Elog("pcapng file '%s' looks corrupted", section->filename);
+	shb = (const pcapngSectionHeaderBlock *)
+		pcapReaderFetch(reader, offset, block_sz);
+	if (!shb)
+		return 0;		/* EOF */
+	section->major = __to_host16(shb->major);
+	section->minor = __to_host16(shb->minor);
+	section->section_head = offset + block_sz;
+	section->section_sz = __to_host64(shb->section_length);
 
 	/* parse options */
-	block_sz = __to_host32(hdr.c.block_length);
-	options_sz = block_sz - offsetof(pcapngSectionHeaderBlock, options);
-	if (options_sz < sizeof(uint32_t))
-		Elog("pcapng file '%s' looks corrupted", section->filename);
-	pos = alloca(options_sz);
-	end = pos + options_sz - sizeof(uint32_t);
-	if (fread(pos, options_sz, 1, section->filp) != 1)
-	{
-		if (feof(section->filp))
-			return;		/* EOF */
-		Elog("failed on fread('%s'): %m", section->filename);
-	}
-	if (block_sz != __to_host32(*((uint32_t *)end)))
+	pos = shb->options;
+	end = (const unsigned char *)shb + block_sz - sizeof(uint32_t);
+	if (block_sz != __to_host32(*((const uint32_t *)end)))
 		Elog("pcapng file '%s' looks corrupted", section->filename);
 	while (pos < end)
 	{
 		uint16_t	__code;
 		uint16_t	__len;
 
-		if (pos + sizeof(uint16_t) > end)
-			Elog("pcapng file '%s' looks corrupted", section->filename);
-		__code = __to_host16(*((uint16_t *)pos));
-		pos += sizeof(uint16_t);
-		/* opt_endofopt? */
-		if (__code == 0)
+		pos = __fetch_pcapng_options(section, pos, end, &__code, &__len);
+		if (!pos)
 			break;
-		if (pos + sizeof(uint16_t) > end)
-			Elog("pcapng file '%s' looks corrupted", section->filename);
-		__len = __to_host16(*((uint16_t *)pos));
-		pos += sizeof(uint16_t);
-		if (pos + __len > end)
-			Elog("pcapng file '%s' looks corrupted", section->filename);
-
 		switch (__code)
 		{
 			case 1:		/* opt_comment */
@@ -2686,91 +2672,127 @@ process_one_pcapng_section(SQLtable *chunk, pcapngSectionState *section)
 		}
 		pos += INTALIGN(__len);
 	}
+	return block_sz;
+}
+
+/*
+ * scan_one_pcapng_file - walks on the block headers to split the file.
+ *
+ * Section headers and interface descriptions are processed here, so
+ * the ranges can be decoded independently later; the section state
+ * is kept until the end of the process.
+ */
+static void
+scan_one_pcapng_file(pcapFileDesc *pfdesc, pcapReader *reader)
+{
+	pcapngSectionState *section = NULL;
+	size_t		range_sz = pcapFileRangeSize(pfdesc);
+	size_t		head = 0;
+	size_t		pos = 0;
 
-	/* walk on the following blocks */
-	saved_interface_id = current_interface_id;
-	while (!feof(section->filp))
+	while (!do_shutdown)
 	{
-		if (section->section_sz != ~0UL)
-		{
-			long		curr_pos = ftell(section->filp);
+		const pcapngBlockHeaderCommon *hc;
+		const unsigned char *block;
+		uint32_t	block_type;
+		uint32_t	block_sz;
 
-			if (curr_pos < 0)
-				Elog("failed on ftell('%s'): %m", section->filename);
-			if (curr_pos >= section->section_head + section->section_sz)
-				break;
+		hc = (const pcapngBlockHeaderCommon *)
+			pcapReaderFetch(reader, pos, sizeof(pcapngBlockHeaderCommon));
+		if (!hc)
+			break;		/* EOF */
+		if (hc->block_type == PCAPNG_TYPE__SECTION_HEADER_BLOCK)
+		{
+			if (section)
+				pcapFileRangeAppend(pfdesc, section, head, pos);
+			section = palloc0(sizeof(pcapngSectionState));
+			section->filename = pfdesc->pcap_filename;
+			block_sz = __process_pcapng_section_header(section, reader, pos);
+			if (block_sz == 0)
+				break;	/* EOF */
+			pos += block_sz;
+			head = pos;
+			continue;
+		}
+		if (!section || (section->section_sz != ~0UL &&
+						 pos >= section->section_head + section->section_sz))
+		{
+			/* out of section; move to the next section head, if any */
+			if (section)
+				pcapFileRangeAppend(pfdesc, section, head, pos);
+			section = NULL;
+			pos += sizeof(uint32_t);
+			head = pos;
+			continue;
+		}
+		block_type = __to_host32(hc->block_type);
+		block_sz = __to_host32(hc->block_length);
+		if (block_sz < sizeof(pcapngBlockHeaderCommon) + sizeof(uint32_t) ||
+			(block_sz & 3) != 0)
+			Elog("pcapng file '%s' looks corrupted", pfdesc->pcap_filename);
+		block = pcapReaderFetch(reader, pos, block_sz);
+		if (!block)
+			break;		/* truncated last block */
+		if (block_sz != __to_host32(*((const uint32_t *)
+									  (block + block_sz - sizeof(uint32_t)))))
+			Elog("pcapng file '%s' looks corrupted", pfdesc->pcap_filename);
+		if (block_type == PCAPNG_TYPE__INTERFACE_DESCRIPTION_BLOCK)
+			__process_pcapng_interface_description(section, (const void *)block);
+		pos += block_sz;
+		if (pos - head >= range_sz)
+		{
+			pcapFileRangeAppend(pfdesc, section, head, pos);
+			head = pos;
 		}
-		if (!process_one_pcapng_block(chunk, section))
-			break;
-	}
-	current_interface_id = saved_interface_id;
-	
-	/* move to the next section head, if any */
-	if (section->section_sz != ~0UL)
-	{
-		if (fseek(section->filp,
-				  section->section_head +
-				  section->section_sz, SEEK_SET) < 0)
-			Elog("failed on fseek('%s'): %m", section->filename);
 	}
+	if (section)
+		pcapFileRangeAppend(pfdesc, section, head, pos);
 }
 
 /*
- * process_one_pcapng_file
+ * process_one_pcapng_range
  */
 static void
-process_one_pcapng_file(SQLtable *chunk, pcapFileDesc *pfdesc)
+process_one_pcapng_range(SQLtable *chunk, pcapFileRange *range,
+						 pcapReader *reader)
 {
-	pcapngSectionState section;
-	uint32_t	magic;
-	int			i;
+	pcapngSectionState *section = range->section;
+	uint32_t   *saved_interface_id = current_interface_id;
+	size_t		pos = range->head;
 
-	memset(&section, 0, sizeof(pcapngSectionState));
-	for (;;)
+	while (pos < range->tail && !do_shutdown)
 	{
-		if (fread(&magic, sizeof(uint32_t), 1, pfdesc->pcap_filp) != 1)
-		{
-			if (feof(pfdesc->pcap_filp))
-				break;	/* EOF */
-			Elog("failed on fread('%s'): %m", pfdesc->pcap_filename);
-		}
-		if (magic != PCAPNG_MAGIC)
-			continue;
-		if (fseek(pfdesc->pcap_filp, -sizeof(uint32_t), SEEK_CUR) < 0)
-			Elog("failed on fseek('%s'): %m", pfdesc->pcap_filename);
-		memset(&section, 0, sizeof(pcapngSectionState));
-		section.filp = pfdesc->pcap_filp;
-		section.filename = pfdesc->pcap_filename;
-		process_one_pcapng_section(chunk, &section);
-
-		/* cleanup section */
-		for (i=0; i < section._num_if_states; i++)
+		const pcapngBlockHeaderCommon *hc;
+		const unsigned char *block;
+		uint32_t	block_type;
+		uint32_t	block_sz;
+
+		hc = (const pcapngBlockHeaderCommon *)
+			pcapReaderFetch(reader, pos, sizeof(pcapngBlockHeaderCommon));
+		if (!hc)
+			Elog("pcapng file '%s' looks corrupted", section->filename);
+		block_type = __to_host32(hc->block_type);
+		block_sz = __to_host32(hc->block_length);
+		block = pcapReaderFetch(reader, pos, block_sz);
+		if (!block)
+			Elog("pcapng file '%s' looks corrupted", section->filename);
+		switch (block_type)
 		{
-			pcapngInterfaceState *if_state = &section.if_states[i];
-
-			if (if_state->if_name)
-				pfree(if_state->if_name);
-			if (if_state->if_description)
-				pfree(if_state->if_description);
-			if (if_state->if_ipv4addr)
-				pfree(if_state->if_ipv4addr);
-			if (if_state->if_ipv6addr)
-				pfree(if_state->if_ipv6addr);
-			if (if_state->if_os)
-				pfree(if_state->if_os);
-			if (if_state->if_hardware)
-				pfree(if_state->if_hardware);
+			case PCAPNG_TYPE__SIMPLE_PACKET_BLOCK:
+				__process_pcapng_simple_packet(chunk, section,
+											   (const void *)block);
+				break;
+			case PCAPNG_TYPE__ENHANCED_PACKET_BLOCK:
+				__process_pcapng_enhanced_packet(chunk, section,
+												 (const void *)block);
+				break;
+			default:
+				/* IDB is already processed on the scan; others are ignored */
+				break;
 		}
-		if (section.shb_hardware)
-			pfree(section.shb_hardware);
-		if (section.shb_os)
-			pfree(section.shb_os);
-		if (section.shb_userappl)
-			pfree(section.shb_userappl);
-		if (section.if_states)
-			pfree(section.if_states);
-		memset(&section, 0, sizeof(pcapngSectionState));
+		pos += block_sz;
 	}
+	current_interface_id = saved_interface_id;
 }
 
 /*
@@ -2780,29 +2802,64 @@ static void *
 pcap_file_worker_main(void *__arg)
 {
 	SQLtable   *chunk;
-	int			i;
-	
+	pcapReader	reader;
+	uint64_t	i;
+	int			rv;
+
 	/* assign worker-id of this thread */
 	worker_id = (long)__arg;
-	chunk = arrow_chunks_array[worker_id];
+	chunk = pcap_worker_states[worker_id].chunk;
+	memset(&reader, 0, sizeof(pcapReader));
 
-	for (i = worker_id;
-		 i < pcap_file_desc_nums && !do_shutdown;
-		 i += num_threads)
+	/* 1st phase: split the input files into ranges */
+	while ((i = atomicAdd64(&pcap_file_desc_selector, 1)) < pcap_file_desc_nums &&
+		   !do_shutdown)
 	{
 		pcapFileDesc   *pfdesc = &pcap_file_desc_array[i];
 
+		reader.pfdesc = pfdesc;
+		reader.window_base = 0;
+		reader.window_len = 0;
 		if (pfdesc->pcap_magic == PCAPNG_MAGIC)
-			process_one_pcapng_file(chunk, pfdesc);
+			scan_one_pcapng_file(pfdesc, &reader);
 		else if (pfdesc->pcap_magic == PCAP_MAGIC_LE ||
 				 pfdesc->pcap_magic == PCAP_MAGIC_BE)
-			process_one_pcap_file(chunk, pfdesc);
+			scan_one_pcap_file(pfdesc, &reader);
 		else
 			Elog("Bug? unknown file magic '%08x' of '%s'",
 				 pfdesc->pcap_magic,
 				 pfdesc->pcap_filename);
-    }
-	return final_merge_pending_chunks(chunk);
+	}
+	rv = pthread_barrier_wait(&pcap_file_scan_barrier);
+	if (rv != 0 && rv != PTHREAD_BARRIER_SERIAL_THREAD)
+		Elog("failed on pthread_barrier_wait: %s", strerror(rv));
+
+	/* 2nd phase: decode the ranges concurrently */
+	while ((i = atomicAdd64(&pcap_file_range_selector, 1)) < pcap_file_range_nums &&
+		   !do_shutdown)
+	{
+		pcapFileRange  *range = &pcap_file_range_array[i];
+		pcapFileDesc   *pfdesc = range->pfdesc;
+
+		if (reader.pfdesc != pfdesc)
+		{
+			reader.pfdesc = pfdesc;
+			reader.window_base = 0;
+			reader.window_len = 0;
+		}
+		if (pfdesc->pcap_mmap_head)
+			madvise((void *)(pfdesc->pcap_mmap_head + (range->head & ~(PAGESIZE-1))),
+					range->tail - (range->head & ~(PAGESIZE-1)),
+					MADV_WILLNEED);
+		if (pfdesc->pcap_magic == PCAPNG_MAGIC)
+			process_one_pcapng_range(chunk, range, &reader);
+		else
+			process_one_pcap_range(chunk, range, &reader);
+	}
+	pcapReaderRelease(&reader);
+	/* write out the partially filled chunk */
+	arrowChunkWriteOut(chunk);
+	return NULL;
 }
 
 /*
@@ -2834,7 +2891,7 @@ usage(int status)
 		  "     --parallel-write=N_FILES\n"
 		  "       opens multiple output files simultaneously (default: 1)\n"
 		  "     --chunk-size=SIZE : size of record batch (default: 128MB)\n"
-		  "     --direct-io : enables O_DIRECT for write-i/o\n"
+		  "     --direct-io : enables O_DIRECT for read/write-i/o\n"
 		  "  -l|--limit=LIMIT : (default: no limit)\n"
 		  "  -p|--protocol=PROTO\n"
 		  "       PROTO is a comma separated string contains\n"
@@ -3040,24 +3097,49 @@ parse_options(int argc, char *argv[])
 		{
 			pcapFileDesc   *pfdesc = &pcap_file_desc_array[i];
 			const char	   *filename = argv[optind + i];
-			FILE		   *filp;
+			struct stat		stat_buf;
 			uint32_t		magic;
+			int				fdesc;
 
-			filp = fopen(filename, "rb");
-			if (!filp)
+			fdesc = open(filename, O_RDONLY);
+			if (fdesc < 0)
 				Elog("failed to open '%s': %m", filename);
+			if (fstat(fdesc, &stat_buf) != 0)
+				Elog("failed on fstat('%s'): %m", filename);
 			/* check magic */
-			if (fread(&magic, sizeof(uint32_t), 1, filp) != 1)
+			if (pread(fdesc, &magic, sizeof(uint32_t), 0) != sizeof(uint32_t))
 				Elog("failed to read '%s' magic: %m", filename);
-			rewind(filp);
 			if (magic != PCAP_MAGIC_LE &&
 				magic != PCAP_MAGIC_BE &&
 				magic != PCAPNG_MAGIC)
 				Elog("magic of '%s' is neither PCAP nor PCAPNG (%08x)",
 					 filename, magic);
-			pfdesc->pcap_filp = filp;
+			pfdesc->pcap_fdesc = fdesc;
 			pfdesc->pcap_filename = pstrdup(filename);
 			pfdesc->pcap_magic = magic;
+			pfdesc->pcap_file_sz = stat_buf.st_size;
+			if (enable_direct_io)
+			{
+				/* read the file by O_DIRECT, bypassing the page cache */
+				int		flags = fcntl(fdesc, F_GETFL);
+
+				if (fcntl(fdesc, F_SETFL, flags | O_DIRECT) != 0)
+					Elog("failed on fcntl('%s', F_SETFL, O_DIRECT): %m",
+						 filename);
+			}
+			else
+			{
+				void   *mmap_head;
+
+				mmap_head = mmap(NULL, pfdesc->pcap_file_sz,
+								 PROT_READ, MAP_SHARED,
+								 fdesc, 0);
+				if (mmap_head == MAP_FAILED)
+					Elog("failed on mmap('%s'): %m", filename);
+				if (madvise(mmap_head, pfdesc->pcap_file_sz, MADV_SEQUENTIAL) != 0)
+					Elog("failed on madvise('%s'): %m", filename);
+				pfdesc->pcap_mmap_head = mmap_head;
+			}
 		}
 		pcap_file_desc_nums = nfiles;
 	}
@@ -3107,7 +3189,7 @@ parse_options(int argc, char *argv[])
 	else
 	{
 		if (num_threads < 0)
-			num_threads = pcap_file_desc_nums;
+			num_threads = NCPUS;
 		if (num_pcap_threads >= 0)
 			Elog("--pcap-threads cannot be used with PCAP input files");
 		if (pfring_desc_nums >= 0)
@@ -3312,28 +3394,48 @@ int main(int argc, char *argv[])
 	/* parse command line options */
 	parse_options(argc, argv);
 	/* chunk-buffer pre-allocation */
-	arrow_chunks_array = palloc0(sizeof(SQLtable *) * num_threads);
+	pcap_worker_states = palloc0(sizeof(pcapWorkerState) * num_threads);
 	for (i=0; i < num_threads; i++)
 	{
+		pcapWorkerState *ws = &pcap_worker_states[i];
 		SQLtable   *chunk;
+		int			k;
 
 		chunk = palloc0(offsetof(SQLtable,
 								 columns[PCAP_SCHEMA_MAX_NFIELDS]));
 		arrowPcapSchemaInit(chunk);
 		chunk->fdesc = -1;
-		arrow_chunks_array[i] = chunk;
+		ws->chunk = chunk;
+		for (k=0; k < PCAP_NUM_SPARE_CHUNKS; k++)
+		{
+			pcapChunk  *pchunk;
+
+			pchunk = palloc0(offsetof(pcapChunk,
+									  table.columns[PCAP_SCHEMA_MAX_NFIELDS]));
+			arrowPcapSchemaInit(&pchunk->table);
+			pchunk->table.fdesc = -1;
+			pchunk->owner = i;
+			pchunk->next = ws->local_list;
+			ws->local_list = pchunk;
+		}
+		if (sem_init(&ws->free_sem, 0, PCAP_NUM_SPARE_CHUNKS) != 0)
+			Elog("failed on sem_init: %m");
 	}
 
 	if (input_devname)
 		init_pfring_input();
 
 	/* open the output files, and related initialization */
-	arrow_file_desc_locks = palloc0(sizeof(pthread_mutex_t) * arrow_file_desc_nums);
 	arrow_file_desc_array = palloc0(sizeof(arrowFileDesc *) * arrow_file_desc_nums);
+	pcap_writer_states = palloc0(sizeof(pcapWriterState) * arrow_file_desc_nums);
 	for (i=0; i < arrow_file_desc_nums; i++)
 	{
-		pthreadMutexInit(&arrow_file_desc_locks[i]);
+		pcapWriterState *wr = &pcap_writer_states[i];
+
 		arrow_file_desc_array[i] = arrowOpenOutputFile();
+		wr->f_index = i;
+		if (sem_init(&wr->queue_sem, 0, 0) != 0)
+			Elog("failed on sem_init: %m");
 	}
 
 	if (num_pcap_threads >= 0)
@@ -3345,11 +3447,22 @@ int main(int argc, char *argv[])
 	signal(SIGINT, on_sigint_handler);
 	signal(SIGTERM, on_sigint_handler);
 	
-	/* launch worker threads */
-	pthreadMutexInit(&arrow_workers_mutex);
-	pthreadCondInit(&arrow_workers_cond);
-	arrow_workers_completed = palloc0(sizeof(bool) * num_threads);
+	/* launch writer threads */
+	for (i=0; i < arrow_file_desc_nums; i++)
+	{
+		pcapWriterState *wr = &pcap_writer_states[i];
 
+		rv = pthread_create(&wr->thread, NULL, pcap_writer_main, wr);
+		if (rv != 0)
+			Elog("failed on pthread_create: %s", strerror(rv));
+	}
+	/* launch worker threads */
+	if (!input_devname)
+	{
+		rv = pthread_barrier_init(&pcap_file_scan_barrier, NULL, num_threads);
+		if (rv != 0)
+			Elog("failed on pthread_barrier_init: %s", strerror(rv));
+	}
 	workers = alloca(sizeof(pthread_t) * num_threads);
 	for (i=0; i < num_threads; i++)
 	{
@@ -3378,6 +3491,17 @@ int main(int argc, char *argv[])
 		if (rv != 0)
 			Elog("failed on pthread_join: %s", strerror(rv));
 	}
+	/* wait for completion of the writers */
+	__atomic_store_n(&pcap_writer_shutdown, true, __ATOMIC_RELEASE);
+	for (i=0; i < arrow_file_desc_nums; i++)
+	{
+		pcapWriterState *wr = &pcap_writer_states[i];
+
+		semPost(&wr->queue_sem);
+		rv = pthread_join(wr->thread, NULL);
+		if (rv != 0)
+			Elog("failed on pthread_join: %s", strerror(rv));
+	}
 	/* close the output files */
 	for (i=0; i < arrow_file_desc_nums; i++)
 		arrowCloseOutputFile(arrow_file_desc_array[i]);
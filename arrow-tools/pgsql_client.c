@@ -50,6 +50,12 @@ typedef struct
 	PGresult   *res;
 	uint32_t	nitems;
 	uint32_t	index;
+	bool		cursor_opened;
+	/* if sqldb_unfetch_results is called */
+	bool		refetch;
+	uint32_t   *rows_index;
+	/* if --parallel is given */
+	char	   *snapshot;
 	/* if --nestloop is given */
 	uint32_t	n_depth;
 	PGSTATE_NL	nestloop[1];
@@ -981,6 +987,7 @@ sqldb_server_connect(const char *sqldb_hostname,
 	pgstate->conn = conn;
 	pgstate->res  = NULL;
 	pgstate->n_depth = n_depth;
+	pgstate->rows_index = palloc0(sizeof(uint32_t) * (n_depth + 1));
 	for (nlopt = sqldb_nestloop_list, i=0; nlopt; nlopt = nlopt->next, i++)
 	{
 		PGSTATE_NL *nl = &pgstate->nestloop[i];
@@ -997,6 +1004,137 @@ sqldb_server_connect(const char *sqldb_hostname,
 	return pgstate;
 }
 
+/*
+ * sqldb_export_snapshot
+ *
+ * It opens a read-only transaction on the leader connection, then exports
+ * its snapshot to be imported by the parallel workers. The leader must keep
+ * the transaction open until all the workers begin their queries.
+ */
+char *
+sqldb_export_snapshot(void *sqldb_state)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *snapshot;
+
+	res = PQexec(conn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
+	PQclear(res);
+
+	res = PQexec(conn, "SELECT pg_catalog.pg_export_snapshot()");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK ||
+		PQntuples(res) != 1 ||
+		PQgetisnull(res, 0, 0))
+		Elog("failed on pg_export_snapshot(): %s", PQresultErrorMessage(res));
+	snapshot = pstrdup(PQgetvalue(res, 0, 0));
+	PQclear(res);
+
+	return snapshot;
+}
+
+/*
+ * sqldb_import_snapshot
+ *
+ * It begins a read-only transaction with the snapshot of the leader, prior
+ * to the query; the leader can close its transaction once all the workers
+ * have imported the snapshot.
+ */
+void
+sqldb_import_snapshot(void *sqldb_state, const char *snapshot)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *query;
+
+	res = PQexec(conn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
+	PQclear(res);
+
+	query = palloc(strlen(snapshot) + 100);
+	sprintf(query, "SET TRANSACTION SNAPSHOT '%s'", snapshot);
+	res = PQexec(conn, query);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		Elog("unable to import snapshot '%s': %s",
+			 snapshot, PQresultErrorMessage(res));
+	PQclear(res);
+	pfree(query);
+
+	pgstate->snapshot = pstrdup(snapshot);
+}
+
+/*
+ * sqldb_parallel_commands
+ *
+ * It splits the table into the disjoint ctid ranges for each worker.
+ * The last worker also scans the blocks appended after the size check.
+ * pg2arrow has no --split-by option, so sqldb_split_column is always NULL.
+ */
+char **
+sqldb_parallel_commands(void *sqldb_state,
+						const char *sqldb_tablename,
+						const char *sqldb_split_column,
+						int num_workers)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *relname;
+	char	   *query;
+	char	  **commands;
+	uint64_t	nblocks;
+	int			k;
+
+	relname = PQescapeLiteral(conn, sqldb_tablename, strlen(sqldb_tablename));
+	if (!relname)
+		Elog("failed on PQescapeLiteral: %s", PQerrorMessage(conn));
+	query = palloc(strlen(relname) + 200);
+	sprintf(query,
+			"SELECT pg_catalog.pg_relation_size(%s::regclass) /"
+			"       pg_catalog.current_setting('block_size')::bigint",
+			relname);
+	res = PQexec(conn, query);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK ||
+		PQntuples(res) != 1 ||
+		PQgetisnull(res, 0, 0))
+		Elog("failed on checking size of the table '%s': %s",
+			 sqldb_tablename, PQresultErrorMessage(res));
+	nblocks = strtoul(PQgetvalue(res, 0, 0), NULL, 10);
+	PQclear(res);
+	PQfreemem(relname);
+	pfree(query);
+
+	commands = palloc0(sizeof(char *) * num_workers);
+	for (k=0; k < num_workers; k++)
+	{
+		uint64_t	lower = (nblocks * k) / num_workers;
+		uint64_t	upper = (nblocks * (k+1)) / num_workers;
+		char	   *cmd = palloc(strlen(sqldb_tablename) + 200);
+
+		if (k == 0 && k == num_workers - 1)
+			sprintf(cmd, "SELECT * FROM %s", sqldb_tablename);
+		else if (k == 0)
+			sprintf(cmd, "SELECT * FROM %s"
+					" WHERE ctid < '(%lu,0)'::tid",
+					sqldb_tablename, upper);
+		else if (k == num_workers - 1)
+			sprintf(cmd, "SELECT * FROM %s"
+					" WHERE ctid >= '(%lu,0)'::tid",
+					sqldb_tablename, lower);
+		else
+			sprintf(cmd, "SELECT * FROM %s"
+					" WHERE ctid >= '(%lu,0)'::tid"
+					"   AND ctid <  '(%lu,0)'::tid",
+					sqldb_tablename, lower, upper);
+		commands[k] = cmd;
+	}
+	return commands;
+}
+
 /*
  * sqldb_begin_query
  */
@@ -1011,11 +1149,15 @@ sqldb_begin_query(void *sqldb_state,
 	PGresult   *res;
 	char	   *query;
 
-	/* begin read-only transaction */
-	res = PQexec(conn, "BEGIN READ ONLY");
-	if (PQresultStatus(res) != PGRES_COMMAND_OK)
-		Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
-	PQclear(res);
+	if (!pgstate->snapshot)
+	{
+		/* begin read-only transaction */
+		res = PQexec(conn, "BEGIN READ ONLY");
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("unable to begin transaction: %s", PQresultErrorMessage(res));
+		PQclear(res);
+	}
+	/* elsewhere, sqldb_import_snapshot already began the transaction */
 
 	/* declare cursor */
 	query = palloc(strlen(sqldb_command) + 1024);
@@ -1025,6 +1167,7 @@ sqldb_begin_query(void *sqldb_state,
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
 		Elog("unable to declare a SQL cursor: %s", PQresultErrorMessage(res));
 	PQclear(res);
+	pgstate->cursor_opened = true;
 
 	/* move to the first tuple(-set) */
 	if (!pgsql_move_next(pgstate, NULL))
@@ -1040,14 +1183,15 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 {
 	PGSTATE	   *pgstate = sqldb_state;
 	PGresult   *res;
-	uint32_t   *rows_index;
+	uint32_t   *rows_index = pgstate->rows_index;
 	uint32_t	index;
 	int			depth = 0;
 	int			i, j, ncols;
 	size_t		usage = 0;
 
-	rows_index = alloca(sizeof(uint32_t) * (pgstate->n_depth + 1));
-	if (!pgsql_move_next(pgstate, rows_index))
+	if (pgstate->refetch)
+		pgstate->refetch = false;	/* the last row again */
+	else if (!pgsql_move_next(pgstate, rows_index))
 		return false;		/* end of the scan */
 
 	res = pgstate->res;
@@ -1092,6 +1236,22 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 	return true;
 }
 
+/*
+ * sqldb_unfetch_results
+ *
+ * It pushes back the last row; the next sqldb_fetch_results() returns the
+ * same row again. PGresult of the last row is still valid, because it is
+ * released only when pgsql_move_next() moves to the next one.
+ */
+void
+sqldb_unfetch_results(void *sqldb_state)
+{
+	PGSTATE	   *pgstate = sqldb_state;
+
+	assert(!pgstate->refetch);
+	pgstate->refetch = true;
+}
+
 void
 sqldb_close_connection(void *sqldb_state)
 {
@@ -1110,11 +1270,14 @@ sqldb_close_connection(void *sqldb_state)
 			PQclear(nl->res);
 	}
 	/* close the cursor */
-	res = PQexec(conn, "CLOSE " CURSOR_NAME);
-	if (PQresultStatus(res) != PGRES_COMMAND_OK)
-		Elog("failed on close cursor '%s': %s", CURSOR_NAME,
-			 PQresultErrorMessage(res));
-	PQclear(res);
+	if (pgstate->cursor_opened)
+	{
+		res = PQexec(conn, "CLOSE " CURSOR_NAME);
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			Elog("failed on close cursor '%s': %s", CURSOR_NAME,
+				 PQresultErrorMessage(res));
+		PQclear(res);
+	}
 	/* close the connection */
 	PQfinish(conn);
 }
@@ -12,6 +12,7 @@
 #include <ctype.h>
 #include <getopt.h>
 #include <limits.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -19,6 +20,7 @@
 
 /* command options */
 static char	   *sqldb_command = NULL;
+static char	   *sqldb_tablename = NULL;
 static char	   *output_filename = NULL;
 static char	   *append_filename = NULL;
 static size_t	batch_segment_sz = 0;
@@ -30,6 +32,14 @@ static char	   *sqldb_database = NULL;
 static char	   *dump_arrow_filename = NULL;
 static char	   *stat_embedded_columns = NULL;
 static int		shows_progress = 0;
+static int		num_parallel_workers = 0;
+static char	   *sqldb_split_column = NULL;
+static int		compression_codec = -1;
+static int		compression_level = 0;
+static char	   *dictionary_columns = NULL;
+static bool		dictionary_auto = false;
+static bool		no_fdw_compat = false;
+static char	   *cluster_by_columns = NULL;
 static userConfigOption *sqldb_session_configs = NULL;
 static nestLoopOption *sqldb_nestloop_options = NULL;
 
@@ -327,6 +337,24 @@ setup_output_file(SQLtable *table, const char *output_filename)
 	writeArrowSchema(table);
 }
 
+/*
+ * setup_result_file
+ */
+static void
+setup_result_file(SQLtable *table, int append_fdesc, ArrowFileInfo *af_info)
+{
+	if (!append_filename)
+		setup_output_file(table, output_filename);
+	else
+	{
+		table->fdesc = append_fdesc;
+		table->filename = append_filename;
+		setup_append_file(table, af_info);
+	}
+	/* write out dictionary batch, if any */
+	writeArrowDictionaryBatches(table);
+}
+
 static void
 shows_record_batch_progress(SQLtable *table, size_t nitems)
 {
@@ -560,6 +588,601 @@ enable_embedded_stats(SQLtable *table)
 	}
 }
 
+/*
+ * Dictionary encoding of Utf8 columns (--dictionary)
+ *
+ * Values of the dictionary columns are put on the Utf8 buffers as usual,
+ * then translated to the dictionary indexes just before each record batch
+ * is written out. The dictionaries grow during the scan, so DictionaryBatch
+ * messages are written once at the end, prior to the footer.
+ */
+#define DICTIONARY_AUTO_RATIO		0.10	/* # of distinct values / # of rows
+											 * in the first record batch */
+typedef struct
+{
+	SQLfield	   *column;
+	SQLdictionary  *dict;
+	SQLbuffer		indexes;
+} dictionaryOnWrite;
+
+static dictionaryOnWrite *dictionary_on_write_items = NULL;
+static int		dictionary_on_write_nitems = 0;
+static SQLdictionary *dictionary_on_write_list = NULL;
+
+static bool
+__dictionary_column_is_valid(SQLfield *column)
+{
+	return (column->arrow_type.node.tag == ArrowNodeTag__Utf8 &&
+			!column->enumdict &&
+			!column->element &&
+			!column->subfields);
+}
+
+static uint32_t
+__dictionary_lookup_label(SQLdictionary *dict, const char *label, uint32_t len)
+{
+	hashItem   *hitem;
+	uint32_t	hash, hindex;
+
+	hash = hash_any((const unsigned char *)label, len);
+	hindex = hash % dict->nslots;
+	for (hitem = dict->hslots[hindex]; hitem != NULL; hitem = hitem->next)
+	{
+		if (hitem->hash == hash &&
+			hitem->label_sz == len &&
+			memcmp(hitem->label, label, len) == 0)
+			return hitem->index;
+	}
+	/* not found, so add a new label */
+	hitem = palloc0(offsetof(hashItem, label[len+1]));
+	hitem->hash = hash;
+	hitem->index = dict->nitems++;
+	hitem->label_sz = len;
+	memcpy(hitem->label, label, len);
+	hitem->label[len] = '\0';
+
+	hitem->next = dict->hslots[hindex];
+	dict->hslots[hindex] = hitem;
+
+	sql_buffer_append(&dict->extra, label, len);
+	sql_buffer_append(&dict->values, &dict->extra.usage, sizeof(uint32_t));
+
+	return hitem->index;
+}
+
+static void
+__dictionary_encode_column(dictionaryOnWrite *dw)
+{
+	SQLfield   *column = dw->column;
+	uint32_t   *offsets = (uint32_t *)column->values.data;
+	const char *extra = column->extra.data;
+	const uint8_t *nullmap = (const uint8_t *)column->nullmap.data;
+	long		i;
+
+	sql_buffer_clear(&dw->indexes);
+	for (i=0; i < column->nitems; i++)
+	{
+		uint32_t	index = 0;
+
+		if (column->nullcount == 0 ||
+			(nullmap[i>>3] & (1 << (i & 7))) != 0)
+			index = __dictionary_lookup_label(dw->dict,
+											  extra + offsets[i],
+											  offsets[i+1] - offsets[i]);
+		sql_buffer_append(&dw->indexes, &index, sizeof(uint32_t));
+	}
+}
+
+static dictionaryOnWrite *
+__enable_dictionary_column(SQLtable *table, SQLfield *column)
+{
+	dictionaryOnWrite *dw;
+	SQLdictionary *dict;
+	int64_t		dict_id = 0;
+
+	/* dictionary-id must be unique in the file */
+	for (dict = table->sql_dict_list; dict; dict = dict->next)
+		if (dict_id <= dict->dict_id)
+			dict_id = dict->dict_id + 1;
+	for (dict = dictionary_on_write_list; dict; dict = dict->next)
+		if (dict_id <= dict->dict_id)
+			dict_id = dict->dict_id + 1;
+
+	dict = palloc0(offsetof(SQLdictionary, hslots[1024]));
+	dict->dict_id = dict_id;
+	sql_buffer_init(&dict->values);
+	sql_buffer_init(&dict->extra);
+	sql_buffer_append_zero(&dict->values, sizeof(uint32_t));
+	dict->nslots = 1024;
+	dict->next = dictionary_on_write_list;
+	dictionary_on_write_list = dict;
+
+	dictionary_on_write_items = repalloc(dictionary_on_write_items,
+										 sizeof(dictionaryOnWrite) *
+										 (dictionary_on_write_nitems + 1));
+	dw = &dictionary_on_write_items[dictionary_on_write_nitems++];
+	dw->column = column;
+	dw->dict = dict;
+	sql_buffer_init(&dw->indexes);
+	/* field shall be declared as dictionary encoded */
+	column->enumdict = dict;
+	/* Utf8 (nullmap, offsets, extra) -> Int32 indexes (nullmap, values) */
+	table->numBuffers--;
+
+	return dw;
+}
+
+static bool
+__dictionary_on_write(SQLfield *column)
+{
+	int		i;
+
+	for (i=0; i < dictionary_on_write_nitems; i++)
+	{
+		if (dictionary_on_write_items[i].column == column)
+			return true;
+	}
+	return false;
+}
+
+static void
+enable_dictionary_columns(SQLtable *table)
+{
+	char	   *buffer;
+	char	   *name, *pos;
+	int			j;
+
+	if (!dictionary_columns || dictionary_auto)
+		return;
+	buffer = alloca(strlen(dictionary_columns) + 1);
+	strcpy(buffer, dictionary_columns);
+	for (name = strtok_r(buffer, ",", &pos);
+		 name != NULL;
+		 name = strtok_r(NULL, ",", &pos))
+	{
+		bool	found = false;
+
+		name = __trim(name);
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *column = &table->columns[j];
+
+			if (strcmp(column->field_name, name) == 0)
+			{
+				if (!__dictionary_column_is_valid(column))
+					Elog("field [%s; %s] does not support dictionary encoding",
+						 name, column->arrow_type.node.tagName);
+				__enable_dictionary_column(table, column);
+				found = true;
+			}
+		}
+		if (!found)
+			Elog("field name [%s], specified by --dictionary option, was not found",
+				 name);
+	}
+}
+
+/*
+ * enable_dictionary_auto
+ *
+ * It tries dictionary encoding on the Utf8 columns using the first record
+ * batch, then keeps it only if the number of distinct values is small.
+ */
+static void
+enable_dictionary_auto(SQLtable *table)
+{
+	int			j;
+
+	if (!dictionary_auto)
+		return;
+	for (j=0; j < table->nfields; j++)
+	{
+		SQLfield   *column = &table->columns[j];
+		dictionaryOnWrite *dw;
+
+		if (!__dictionary_column_is_valid(column) || column->nitems == 0)
+			continue;
+		dw = __enable_dictionary_column(table, column);
+		__dictionary_encode_column(dw);
+		if (dw->dict->nitems > DICTIONARY_AUTO_RATIO * column->nitems)
+		{
+			/* revert, too many distinct values */
+			assert(dictionary_on_write_list == dw->dict);
+			dictionary_on_write_list = dw->dict->next;
+			column->enumdict = NULL;
+			table->numBuffers++;
+			dictionary_on_write_nitems--;
+		}
+		else if (shows_progress)
+		{
+			printf("Dictionary encoding was enabled on [%s] (%d distinct values in %ld rows)\n",
+				   column->field_name, dw->dict->nitems, column->nitems);
+		}
+	}
+}
+
+/*
+ * write_record_batch - a wrapper of writeArrowRecordBatch with dictionary
+ */
+static void
+write_record_batch(SQLtable *table)
+{
+	int			k;
+
+	/* replace the Utf8 buffer by the dictionary indexes */
+	for (k=0; k < dictionary_on_write_nitems; k++)
+	{
+		dictionaryOnWrite *dw = &dictionary_on_write_items[k];
+		SQLbuffer	temp;
+
+		__dictionary_encode_column(dw);
+		temp = dw->column->values;
+		dw->column->values = dw->indexes;
+		dw->indexes = temp;
+	}
+	writeArrowRecordBatch(table);
+	for (k=0; k < dictionary_on_write_nitems; k++)
+	{
+		dictionaryOnWrite *dw = &dictionary_on_write_items[k];
+		SQLbuffer	temp;
+
+		temp = dw->column->values;
+		dw->column->values = dw->indexes;
+		dw->indexes = temp;
+	}
+	shows_record_batch_progress(table, table->nitems);
+	sql_table_clear(table);
+}
+
+/*
+ * write_dictionary_on_write - writes out the dictionaries built on the scan
+ */
+static void
+write_dictionary_on_write(SQLtable *table)
+{
+	SQLdictionary *saved = table->sql_dict_list;
+
+	if (dictionary_on_write_list)
+	{
+		table->sql_dict_list = dictionary_on_write_list;
+		writeArrowDictionaryBatches(table);
+		table->sql_dict_list = saved;
+	}
+}
+
+/*
+ * Clustered export (--cluster-by)
+ *
+ * The query results are sorted by the cluster keys on the database server,
+ * then a record batch is closed only at the point where the cluster key
+ * changes, so a particular key never appears in two record batches and
+ * their min/max statistics on the leading key shall be disjoint.
+ * Once a record batch exceeds the segment size, the state of the fields
+ * is saved prior to each fetch; if the new row has a different key, it is
+ * rolled back and pushed back to the client for the next record batch.
+ */
+typedef struct
+{
+	long		nitems;
+	long		nullcount;
+	uint32_t	nullmap_usage;
+	uint32_t	values_usage;
+	uint32_t	extra_usage;
+	size_t		curr_usage;
+	SQLstat		stat_datum;
+} sqlFieldState;
+
+static int			   *cluster_keys = NULL;
+static int				num_cluster_keys = 0;
+static sqlFieldState   *cluster_field_state = NULL;
+
+static char *
+__quote_identifier(const char *ident)
+{
+#ifdef __MYSQL2ARROW__
+	const char	quote = '`';
+#else
+	const char	quote = '"';
+#endif
+	char	   *result = palloc(2 * strlen(ident) + 3);
+	char	   *pos = result;
+
+	*pos++ = quote;
+	for (; *ident != '\0'; ident++)
+	{
+		if (*ident == quote)
+			*pos++ = quote;
+		*pos++ = *ident;
+	}
+	*pos++ = quote;
+	*pos++ = '\0';
+
+	return result;
+}
+
+/*
+ * build_cluster_command
+ *
+ * It wraps the SQL command by ORDER BY on the cluster keys. Sorting is
+ * executed by the database server, so it may use its external merge sort
+ * and parallel workers according to its configuration (like work_mem).
+ */
+static char *
+build_cluster_command(const char *command, const char *cluster_by)
+{
+	char	   *buffer = alloca(strlen(cluster_by) + 1);
+	char	   *name, *pos;
+	char	   *result;
+	size_t		off;
+
+	result = palloc(strlen(command) + 4 * strlen(cluster_by) + 100);
+	off = sprintf(result, "SELECT * FROM (%s) __cluster ORDER BY", command);
+	strcpy(buffer, cluster_by);
+	for (name = strtok_r(buffer, ",", &pos);
+		 name != NULL;
+		 name = strtok_r(NULL, ",", &pos))
+	{
+		char   *ident = __quote_identifier(__trim(name));
+
+		off += sprintf(result + off, "%s %s",
+					   num_cluster_keys++ > 0 ? "," : "", ident);
+		pfree(ident);
+	}
+	if (num_cluster_keys == 0)
+		Elog("no cluster keys are specified by --cluster-by");
+	return result;
+}
+
+static int
+__count_sql_fields(SQLfield *column)
+{
+	int		j, count = 1;
+
+	if (column->element)
+		count += __count_sql_fields(column->element);
+	for (j=0; j < column->nfields; j++)
+		count += __count_sql_fields(&column->subfields[j]);
+	return count;
+}
+
+/*
+ * setup_cluster_keys
+ */
+static void
+setup_cluster_keys(SQLtable *table)
+{
+	char	   *buffer;
+	char	   *name, *pos;
+	int			i, j, count = 0;
+
+	if (!cluster_by_columns)
+		return;
+	cluster_keys = palloc0(sizeof(int) * num_cluster_keys);
+	buffer = alloca(strlen(cluster_by_columns) + 1);
+	strcpy(buffer, cluster_by_columns);
+	for (name = strtok_r(buffer, ",", &pos), i=0;
+		 name != NULL;
+		 name = strtok_r(NULL, ",", &pos), i++)
+	{
+		SQLfield   *column = NULL;
+
+		name = __trim(name);
+		for (j=0; j < table->nfields; j++)
+		{
+			if (strcmp(table->columns[j].field_name, name) == 0)
+			{
+				column = &table->columns[j];
+				break;
+			}
+		}
+		if (!column)
+			Elog("field name [%s], specified by --cluster-by option, was not found",
+				 name);
+		switch (column->arrow_type.node.tag)
+		{
+			case ArrowNodeTag__Bool:
+			case ArrowNodeTag__Int:
+			case ArrowNodeTag__FloatingPoint:
+			case ArrowNodeTag__Decimal:
+			case ArrowNodeTag__Date:
+			case ArrowNodeTag__Time:
+			case ArrowNodeTag__Timestamp:
+			case ArrowNodeTag__Interval:
+			case ArrowNodeTag__FixedSizeBinary:
+			case ArrowNodeTag__Utf8:
+			case ArrowNodeTag__Binary:
+			case ArrowNodeTag__LargeUtf8:
+			case ArrowNodeTag__LargeBinary:
+				if (!column->element && column->nfields == 0)
+					break;
+				/* fallthrough */
+			default:
+				Elog("field [%s; %s] is not supported as cluster key",
+					 name, column->arrow_type.node.tagName);
+		}
+		assert(i < num_cluster_keys);
+		cluster_keys[i] = j;
+	}
+	for (j=0; j < table->nfields; j++)
+		count += __count_sql_fields(&table->columns[j]);
+	cluster_field_state = palloc0(sizeof(sqlFieldState) * count);
+}
+
+static sqlFieldState *
+__save_field_state(SQLfield *column, sqlFieldState *fstate)
+{
+	int		j;
+
+	fstate->nitems        = column->nitems;
+	fstate->nullcount     = column->nullcount;
+	fstate->nullmap_usage = column->nullmap.usage;
+	fstate->values_usage  = column->values.usage;
+	fstate->extra_usage   = column->extra.usage;
+	fstate->curr_usage    = column->__curr_usage__;
+	if (column->stat_enabled)
+		memcpy(&fstate->stat_datum, &column->stat_datum, sizeof(SQLstat));
+	fstate++;
+	if (column->element)
+		fstate = __save_field_state(column->element, fstate);
+	for (j=0; j < column->nfields; j++)
+		fstate = __save_field_state(&column->subfields[j], fstate);
+	return fstate;
+}
+
+static sqlFieldState *
+__restore_field_state(SQLfield *column, sqlFieldState *fstate)
+{
+	int		j;
+
+	column->nitems         = fstate->nitems;
+	column->nullcount      = fstate->nullcount;
+	column->nullmap.usage  = fstate->nullmap_usage;
+	column->values.usage   = fstate->values_usage;
+	column->extra.usage    = fstate->extra_usage;
+	column->__curr_usage__ = fstate->curr_usage;
+	if (column->stat_enabled)
+		memcpy(&column->stat_datum, &fstate->stat_datum, sizeof(SQLstat));
+	fstate++;
+	if (column->element)
+		fstate = __restore_field_state(column->element, fstate);
+	for (j=0; j < column->nfields; j++)
+		fstate = __restore_field_state(&column->subfields[j], fstate);
+	return fstate;
+}
+
+/*
+ * __cluster_key_equals - checks whether the rows 'i' and 'j' has same value
+ */
+static inline bool
+__cluster_key_isnull(SQLfield *column, long i)
+{
+	if (column->nullcount == 0)
+		return false;
+	return (column->nullmap.data[i>>3] & (1 << (i & 7))) == 0;
+}
+
+static bool
+__cluster_key_equals(SQLfield *column, long i, long j)
+{
+	bool		i_isnull = __cluster_key_isnull(column, i);
+	bool		j_isnull = __cluster_key_isnull(column, j);
+	size_t		unitsz;
+
+	if (i_isnull || j_isnull)
+		return (i_isnull && j_isnull);
+
+	switch (column->arrow_type.node.tag)
+	{
+		case ArrowNodeTag__Bool:
+			return (((column->values.data[i>>3] >> (i & 7)) & 1) ==
+					((column->values.data[j>>3] >> (j & 7)) & 1));
+
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+			if (!column->enumdict || __dictionary_on_write(column))
+			{
+				uint32_t   *offsets = (uint32_t *)column->values.data;
+				uint32_t	len = offsets[i+1] - offsets[i];
+
+				return (len == offsets[j+1] - offsets[j] &&
+						memcmp(column->extra.data + offsets[i],
+							   column->extra.data + offsets[j], len) == 0);
+			}
+			/* enum type, values are dictionary indexes */
+			break;
+
+		case ArrowNodeTag__LargeUtf8:
+		case ArrowNodeTag__LargeBinary:
+			{
+				uint64_t   *offsets = (uint64_t *)column->values.data;
+				uint64_t	len = offsets[i+1] - offsets[i];
+
+				return (len == offsets[j+1] - offsets[j] &&
+						memcmp(column->extra.data + offsets[i],
+							   column->extra.data + offsets[j], len) == 0);
+			}
+		default:
+			break;
+	}
+	/* elsewhere, fixed-length values including nulls (zero-filled) */
+	unitsz = column->values.usage / column->nitems;
+	return (memcmp(column->values.data + unitsz * i,
+				   column->values.data + unitsz * j, unitsz) == 0);
+}
+
+/*
+ * fetch_next_results
+ *
+ * It fetches the next row using sqldb_fetch_results(), then returns 1 if
+ * the row is fetched, 0 if end of the scan, or -1 if the current record
+ * batch must be written out.
+ * In case of --cluster-by, once the record batch exceeds the segment size,
+ * it returns -1 on the first row with a different cluster key, after the
+ * row is rolled back. Only the leading key is checked
+ * until the record batch reaches twice of the segment size, then all the
+ * keys are checked. If a record batch reaches four times of the segment
+ * size, it is closed unconditionally, to avoid buffer overflow.
+ */
+static int
+fetch_next_results(void *sqldb_state, SQLtable *table)
+{
+	size_t		usage = table->usage;
+	long		nitems = table->nitems;
+	sqlFieldState *fstate;
+	int			k, nkeys;
+
+	if (!cluster_field_state)
+	{
+		if (!sqldb_fetch_results(sqldb_state, table))
+			return 0;
+		return (table->usage > table->segment_sz ? -1 : 1);
+	}
+	if (usage <= table->segment_sz || nitems == 0)
+		return sqldb_fetch_results(sqldb_state, table) ? 1 : 0;
+	if (usage > 4 * table->segment_sz)
+		return -1;
+	nkeys = (usage <= 2 * table->segment_sz ? 1 : num_cluster_keys);
+
+	/* save the current state, then fetch the next row */
+	for (k=0, fstate = cluster_field_state; k < table->nfields; k++)
+		fstate = __save_field_state(&table->columns[k], fstate);
+	if (!sqldb_fetch_results(sqldb_state, table))
+		return 0;
+	for (k=0; k < nkeys; k++)
+	{
+		SQLfield   *column = &table->columns[cluster_keys[k]];
+
+		if (!__cluster_key_equals(column, nitems - 1, nitems))
+		{
+			/* roll back the last row, for the next record batch */
+			fstate = cluster_field_state;
+			for (k=0; k < table->nfields; k++)
+				fstate = __restore_field_state(&table->columns[k], fstate);
+			table->usage = usage;
+			table->nitems = nitems;
+			sqldb_unfetch_results(sqldb_state);
+			return -1;
+		}
+	}
+	return 1;
+}
+
+/*
+ * enable_body_compression
+ */
+static void
+enable_body_compression(SQLtable *table)
+{
+	if (compression_codec >= 0)
+	{
+		table->compression = palloc0(sizeof(ArrowBodyCompression));
+		initArrowNode(table->compression, BodyCompression);
+		table->compression->codec = compression_codec;
+		table->compression->method = ArrowBodyCompressionMethod__BUFFER;
+		table->compression_level = compression_level;
+	}
+}
+
 static void
 usage(void)
 {
@@ -585,9 +1208,38 @@ usage(void)
 		  "  -S, --stat[=COLUMNS] embeds min/max statistics for each record batch\n"
 		  "                       COLUMNS is a comma-separated list of the target\n"
 		  "                       columns if partially enabled.\n"
+		  "      --parallel=N_WORKERS\n"
+		  "                       runs the query on N_WORKERS connections that\n"
+		  "                       share a consistent snapshot. With -t, the table\n"
+#ifdef __PG2ARROW__
+		  "                       is split into ctid ranges. With -c, $(WORKER_ID)\n"
+#endif
+#ifdef __MYSQL2ARROW__
+		  "                       is split into the primary key ranges (or the\n"
+		  "                       ranges of --split-by column). With -c, $(WORKER_ID)\n"
+#endif
+		  "                       and $(N_WORKERS) tokens in the command are\n"
+		  "                       replaced to scan a disjoint key range.\n"
+#ifdef __MYSQL2ARROW__
+		  "      --split-by=COLUMN\n"
+		  "                       integer column to split the table with -t,\n"
+		  "                       instead of the primary key.\n"
+#endif
 		  "\n"
 		  "Arrow format options:\n"
 		  "  -s, --segment-size=SIZE size of record batch for each\n"
+		  "      --compress=CODEC[:LEVEL]\n"
+		  "                       compresses the record batch buffers;\n"
+		  "                       CODEC is either of lz4 or zstd.\n"
+		  "      --dictionary=auto|COLUMNS\n"
+		  "                       dictionary encoding on the text columns.\n"
+		  "                       'auto' enables it if the first record batch\n"
+		  "                       contains few distinct values.\n"
+		  "      --no-fdw-compat  allows --compress and --dictionary options,\n"
+		  "                       although Arrow_Fdw cannot read the result.\n"
+		  "      --cluster-by=COLUMNS\n"
+		  "                       sorts the results by the COLUMNS, and splits\n"
+		  "                       record batches on the boundary of the keys.\n"
 		  "\n"
 		  "Connection options:\n"
 		  "  -h, --host=HOSTNAME  database server host\n"
@@ -638,6 +1290,14 @@ parse_options(int argc, char * const argv[])
 		{"inner-join",   required_argument, NULL, 1004},
 		{"outer-join",   required_argument, NULL, 1005},
 		{"stat",         optional_argument, NULL, 'S'},
+		{"compress",     required_argument, NULL, 1007},
+		{"dictionary",   required_argument, NULL, 1008},
+		{"no-fdw-compat", no_argument,      NULL, 1011},
+		{"cluster-by",   required_argument, NULL, 1009},
+		{"parallel",     required_argument, NULL, 1006},
+#ifdef __MYSQL2ARROW__
+		{"split-by",     required_argument, NULL, 1010},
+#endif /* __MYSQL2ARROW__ */
 		{"help",         no_argument,       NULL, 9999},
 		{NULL, 0, NULL, 0},
 	};
@@ -687,6 +1347,7 @@ parse_options(int argc, char * const argv[])
 				if (!sqldb_command)
 					Elog("out of memory");
 				sprintf(sqldb_command, "SELECT * FROM %s", optarg);
+				sqldb_tablename = optarg;
 				break;
 
 			case 'o':
@@ -811,6 +1472,79 @@ parse_options(int argc, char * const argv[])
 				}
 				break;
 #endif	/* __PG2ARROW__ */
+			case 1006:		/* --parallel */
+				{
+					char   *end;
+
+					if (num_parallel_workers > 0)
+						Elog("--parallel option was supplied twice");
+					num_parallel_workers = strtol(optarg, &end, 10);
+					if (*end != '\0' || num_parallel_workers < 1)
+						Elog("--parallel=N_WORKERS must be a positive integer: %s",
+							 optarg);
+				}
+				break;
+#ifdef __MYSQL2ARROW__
+			case 1010:		/* --split-by */
+				if (sqldb_split_column)
+					Elog("--split-by option was supplied twice");
+				sqldb_split_column = optarg;
+				break;
+#endif	/* __MYSQL2ARROW__ */
+			case 1007:		/* --compress */
+				{
+					char   *temp = pstrdup(optarg);
+					char   *level = strchr(temp, ':');
+
+					if (compression_codec >= 0)
+						Elog("--compress option was supplied twice");
+					if (level)
+						*level++ = '\0';
+					if (strcasecmp(temp, "lz4") == 0)
+					{
+#ifndef HAVE_LIBLZ4
+						Elog("--compress=lz4 is not supported in this build");
+#endif
+						compression_codec = ArrowCompressionType__LZ4_FRAME;
+					}
+					else if (strcasecmp(temp, "zstd") == 0)
+					{
+#ifndef HAVE_LIBZSTD
+						Elog("--compress=zstd is not supported in this build");
+#endif
+						compression_codec = ArrowCompressionType__ZSTD;
+					}
+					else
+						Elog("unknown compression codec: %s", optarg);
+					if (level)
+					{
+						char   *end;
+
+						compression_level = strtol(level, &end, 10);
+						if (*level == '\0' || *end != '\0')
+							Elog("invalid compression level: %s", optarg);
+					}
+				}
+				break;
+
+			case 1008:		/* --dictionary */
+				if (dictionary_columns)
+					Elog("--dictionary option was supplied twice");
+				dictionary_columns = optarg;
+				if (strcmp(optarg, "auto") == 0)
+					dictionary_auto = true;
+				break;
+
+			case 1011:		/* --no-fdw-compat */
+				no_fdw_compat = true;
+				break;
+
+			case 1009:		/* --cluster-by */
+				if (cluster_by_columns)
+					Elog("--cluster-by option was supplied twice");
+				cluster_by_columns = optarg;
+				break;
+
 			case 'S':		/* --stat */
 				{
 					if (stat_embedded_columns)
@@ -860,10 +1594,347 @@ parse_options(int argc, char * const argv[])
 	}
 	if (!sqldb_command)
 		Elog("Neither -c nor -t options are supplied");
+	if ((compression_codec >= 0 || dictionary_columns) && !no_fdw_compat)
+		Elog("Arrow_Fdw cannot read the %s, built by --%s option\n"
+			 "\n"
+			 "HINT: --no-fdw-compat allows it, if the result is used by other Apache Arrow software\n",
+			 compression_codec >= 0 ? "compressed record batches" : "dictionary-encoded columns",
+			 compression_codec >= 0 ? "compress" : "dictionary");
+	if (dictionary_columns && append_filename)
+		Elog("--dictionary and --append are exclusive");
+	if (dictionary_columns && num_parallel_workers > 1)
+		Elog("--dictionary and --parallel are exclusive");
+	if (cluster_by_columns)
+	{
+		if (num_parallel_workers > 1)
+			Elog("--cluster-by and --parallel are exclusive");
+		sqldb_command = build_cluster_command(sqldb_command,
+											  cluster_by_columns);
+	}
+	if (num_parallel_workers > 1 &&
+		!sqldb_tablename &&
+		!strstr(sqldb_command, "$(WORKER_ID)"))
+		Elog("--parallel with -c requires $(WORKER_ID) token in the command to split the results");
+	if (sqldb_split_column && (num_parallel_workers < 2 || !sqldb_tablename))
+		Elog("--split-by must be used with --parallel and -t");
 	if (batch_segment_sz == 0)
 		batch_segment_sz = (1UL << 28);		/* 256MB in default */
 }
 
+/*
+ * Parallel mode (--parallel=N_WORKERS)
+ *
+ * The leader connection exports its snapshot, then each worker opens its own
+ * connection with the snapshot imported, and runs the query on a disjoint
+ * range of the source. Workers build record batches on their own buffers,
+ * then write them out at the file offset reserved on the shared table.
+ * Only the reservation and the ArrowBlock registration are serialized.
+ */
+typedef struct
+{
+	pthread_t	thread;
+	int			worker_id;
+	char	   *command;
+	void	   *sqldb_state;
+	SQLtable   *table;
+} sqlWorkerState;
+
+static char			   *parallel_snapshot = NULL;
+static ArrowFileInfo   *parallel_af_info = NULL;
+static int				parallel_append_fdesc = -1;
+static SQLtable		   *parallel_main_table = NULL;
+static pthread_mutex_t	parallel_main_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t parallel_setup_barrier;
+
+static void
+parallelBarrierWait(void)
+{
+	int		rv = pthread_barrier_wait(&parallel_setup_barrier);
+
+	if (rv != 0 && rv != PTHREAD_BARRIER_SERIAL_THREAD)
+	{
+		errno = rv;
+		Elog("failed on pthread_barrier_wait: %m");
+	}
+}
+
+static char *
+__replaceWorkerTokens(const char *command, int worker_id, int num_workers)
+{
+	char	   *buf = palloc(strlen(command) * 2 + 100);
+	char	   *dest = buf;
+	const char *pos = command;
+
+	while (*pos != '\0')
+	{
+		if (strncmp(pos, "$(WORKER_ID)", 12) == 0)
+		{
+			dest += sprintf(dest, "%d", worker_id);
+			pos += 12;
+		}
+		else if (strncmp(pos, "$(N_WORKERS)", 12) == 0)
+		{
+			dest += sprintf(dest, "%d", num_workers);
+			pos += 12;
+		}
+		else
+			*dest++ = *pos++;
+	}
+	*dest = '\0';
+
+	return buf;
+}
+
+static void
+parallelWriteRecordBatch(SQLtable *table)
+{
+	SQLtable   *main_table = parallel_main_table;
+	ArrowBlock	block;
+	size_t		length;
+	size_t		meta_sz;
+	int			rb_index;
+
+	table->__iov_cnt = 0;				/* reset iov */
+	length = setupArrowRecordBatchIOV(table);
+	assert(table->__iov_cnt > 0 &&
+		   table->__iov[0].iov_len <= length);
+	meta_sz = table->__iov[0].iov_len;	/* metadata chunk */
+
+	/* reserve the region to write */
+	pthread_mutex_lock(&parallel_main_lock);
+	table->f_pos = main_table->f_pos;
+	main_table->f_pos += length;
+	pthread_mutex_unlock(&parallel_main_lock);
+
+	initArrowNode(&block, Block);
+	block.offset = table->f_pos;
+	block.metaDataLength = meta_sz;
+	block.bodyLength = length - meta_sz;
+
+	arrowFileWriteIOV(table);
+
+	/* register the record batch */
+	pthread_mutex_lock(&parallel_main_lock);
+	rb_index = sql_table_append_record_batch(main_table, &block);
+	shows_record_batch_progress(main_table, table->nitems);
+	pthread_mutex_unlock(&parallel_main_lock);
+
+	saveArrowRecordBatchStats(table, rb_index);
+}
+
+static void *
+parallelWorkerMain(void *__priv)
+{
+	sqlWorkerState *worker = __priv;
+	SQLdictionary  *sql_dict_list = NULL;
+	SQLtable	   *table;
+
+	worker->sqldb_state = sqldb_server_connect(sqldb_hostname,
+											   sqldb_port_num,
+											   sqldb_username,
+											   sqldb_password,
+											   sqldb_database,
+											   sqldb_session_configs,
+											   sqldb_nestloop_options);
+	sqldb_import_snapshot(worker->sqldb_state, parallel_snapshot);
+	/* the leader releases its snapshot (or lock) once imported by all */
+	parallelBarrierWait();
+
+	if (parallel_af_info)
+		sql_dict_list = loadArrowDictionaryBatches(parallel_append_fdesc,
+												   parallel_af_info);
+	table = sqldb_begin_query(worker->sqldb_state,
+							  worker->command,
+							  parallel_af_info,
+							  sql_dict_list);
+	if (table)
+	{
+		table->segment_sz = batch_segment_sz;
+		enable_embedded_stats(table);
+		enable_body_compression(table);
+	}
+	worker->table = table;
+
+	/* wait for the leader to write out the header portion */
+	parallelBarrierWait();
+	parallelBarrierWait();
+
+	if (table)
+	{
+		table->fdesc = parallel_main_table->fdesc;
+		table->filename = parallel_main_table->filename;
+		while (sqldb_fetch_results(worker->sqldb_state, table))
+		{
+			if (table->usage > batch_segment_sz)
+			{
+				parallelWriteRecordBatch(table);
+				sql_table_clear(table);
+			}
+		}
+		if (table->nitems > 0)
+		{
+			parallelWriteRecordBatch(table);
+			sql_table_clear(table);
+		}
+	}
+	sqldb_close_connection(worker->sqldb_state);
+
+	return NULL;
+}
+
+static int
+parallelLeaderMain(void)
+{
+	void		   *sqldb_state;
+	sqlWorkerState *workers;
+	char		  **commands = NULL;
+	ArrowFileInfo	af_info;
+	SQLtable	   *table = NULL;
+	SQLtable	   *main_table;
+	ArrowKeyValue  *kv;
+	size_t			sz;
+	int				j, k;
+
+	/* open the leader connection, and export its snapshot */
+	sqldb_state = sqldb_server_connect(sqldb_hostname,
+									   sqldb_port_num,
+									   sqldb_username,
+									   sqldb_password,
+									   sqldb_database,
+									   sqldb_session_configs,
+									   sqldb_nestloop_options);
+	/*
+	 * Split the table prior to the snapshot export; the ranges are open at
+	 * both ends, so rows inserted in the meantime are also scanned. It keeps
+	 * the global read lock of mysql2arrow as short as possible.
+	 */
+	if (sqldb_tablename)
+		commands = sqldb_parallel_commands(sqldb_state,
+										   sqldb_tablename,
+										   sqldb_split_column,
+										   num_parallel_workers);
+	parallel_snapshot = sqldb_export_snapshot(sqldb_state);
+	/* read the original arrow file, if --append mode */
+	if (append_filename)
+	{
+		parallel_append_fdesc = open(append_filename, O_RDWR, 0644);
+		if (parallel_append_fdesc < 0)
+			Elog("failed on open('%s'): %m", append_filename);
+		readArrowFileDesc(parallel_append_fdesc, &af_info);
+		parallel_af_info = &af_info;
+	}
+
+	/* launch the workers */
+	if ((errno = pthread_barrier_init(&parallel_setup_barrier, NULL,
+									  num_parallel_workers + 1)) != 0)
+		Elog("failed on pthread_barrier_init: %m");
+	workers = palloc0(sizeof(sqlWorkerState) * num_parallel_workers);
+	for (k=0; k < num_parallel_workers; k++)
+	{
+		sqlWorkerState *worker = &workers[k];
+
+		worker->worker_id = k;
+		if (commands)
+			worker->command = commands[k];
+		else
+			worker->command = __replaceWorkerTokens(sqldb_command, k,
+													num_parallel_workers);
+		if ((errno = pthread_create(&worker->thread, NULL,
+									parallelWorkerMain, worker)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	/* wait for all the workers to import the snapshot */
+	parallelBarrierWait();
+	sqldb_close_connection(sqldb_state);
+	/* wait for all the workers to begin the query */
+	parallelBarrierWait();
+
+	for (k=0; k < num_parallel_workers; k++)
+	{
+		if (workers[k].table)
+		{
+			table = workers[k].table;
+			break;
+		}
+	}
+	if (!table)
+		Elog("Empty results by the query: %s", sqldb_command);
+
+	/*
+	 * The main table shares the schema definition with the workers, but
+	 * owns the file descriptor, position and the array of record batches.
+	 */
+	sz = offsetof(SQLtable, columns[table->nfields]);
+	main_table = palloc0(sz);
+	memcpy(main_table, table, sz);
+	main_table->f_pos = 0;
+	main_table->__iov_len = 0;
+	main_table->__iov_cnt = 0;
+	main_table->__iov = NULL;
+	main_table->recordBatches = NULL;
+	main_table->numRecordBatches = 0;
+	main_table->usage = 0;
+	main_table->nitems = 0;
+
+	/* save the SQL command as custom metadata */
+	kv = palloc0(sizeof(ArrowKeyValue));
+	initArrowNode(kv, KeyValue);
+	kv->key = "sql_command";
+	kv->_key_len = 11;
+	kv->value = sqldb_command;
+	kv->_value_len = strlen(sqldb_command);
+	main_table->customMetadata = kv;
+	main_table->numCustomMetadata = 1;
+
+	/* open & setup result file */
+	if (!append_filename)
+		setup_output_file(main_table, output_filename);
+	else
+	{
+		main_table->fdesc = parallel_append_fdesc;
+		main_table->filename = append_filename;
+		setup_append_file(main_table, &af_info);
+	}
+	/* write out dictionary batch, if any */
+	writeArrowDictionaryBatches(main_table);
+	parallel_main_table = main_table;
+
+	/* kick the workers, then wait for their completion */
+	parallelBarrierWait();
+	for (k=0; k < num_parallel_workers; k++)
+	{
+		if ((errno = pthread_join(workers[k].thread, NULL)) != 0)
+			Elog("failed on pthread_join: %m");
+	}
+
+	/* merge min/max statistics of the workers */
+	for (k=0; k < num_parallel_workers; k++)
+	{
+		SQLtable   *__table = workers[k].table;
+
+		if (!__table)
+			continue;
+		for (j=0; j < main_table->nfields; j++)
+		{
+			SQLfield   *field = &main_table->columns[j];
+			SQLstat	   *curr, *next;
+
+			for (curr = __table->columns[j].stat_list; curr; curr = next)
+			{
+				next = curr->next;
+				curr->next = field->stat_list;
+				field->stat_list = curr;
+			}
+			__table->columns[j].stat_list = NULL;
+		}
+	}
+	/* write out footer portion */
+	writeArrowFooter(main_table);
+	close(main_table->fdesc);
+
+	return 0;
+}
+
 /*
  * Entrypoint of pg2arrow / mysql2arrow
  */
@@ -875,12 +1946,16 @@ int main(int argc, char * const argv[])
 	SQLtable	   *table;
 	ArrowKeyValue  *kv;
 	SQLdictionary  *sql_dict_list = NULL;
+	int				status;
 	
 	parse_options(argc, argv);
 
 	/* special case if --dump=FILENAME */
 	if (dump_arrow_filename)
 		return dumpArrowFile(dump_arrow_filename);
+	/* run the query by multiple connections, if --parallel=N_WORKERS */
+	if (num_parallel_workers > 1)
+		return parallelLeaderMain();
 
 	/* open connection */
 	sqldb_state = sqldb_server_connect(sqldb_hostname,
@@ -906,9 +1981,15 @@ int main(int argc, char * const argv[])
 							  sql_dict_list);
 	if (!table)
 		Elog("Empty results by the query: %s", sqldb_command);
+	table->fdesc = -1;
 	table->segment_sz = batch_segment_sz;
 	/* enables embedded min/max statistics, if any */
 	enable_embedded_stats(table);
+	/* enables dictionary encoding and body compression, if any */
+	enable_dictionary_columns(table);
+	enable_body_compression(table);
+	/* setup cluster keys, if --cluster-by */
+	setup_cluster_keys(table);
 
 	/* save the SQL command as custom metadata */
 	kv = palloc0(sizeof(ArrowKeyValue));
@@ -920,35 +2001,36 @@ int main(int argc, char * const argv[])
 	table->customMetadata = kv;
 	table->numCustomMetadata = 1;
 
-	/* open & setup result file */
-	if (!append_filename)
-		setup_output_file(table, output_filename);
-	else
-	{
-		table->fdesc = append_fdesc;
-		table->filename = append_filename;
-		setup_append_file(table, &af_info);
-	}
-	/* write out dictionary batch, if any */
-	writeArrowDictionaryBatches(table);
-	
+	/*
+	 * open & setup result file, unless --dictionary=auto; that defers it
+	 * until the first record batch is built, because schema definition
+	 * depends on the choice of dictionary encoding.
+	 */
+	if (!dictionary_auto)
+		setup_result_file(table, append_fdesc, &af_info);
+
 	/* main loop to fetch and write result */
-	while (sqldb_fetch_results(sqldb_state, table))
+	while ((status = fetch_next_results(sqldb_state, table)) != 0)
 	{
-		if (table->usage > batch_segment_sz)
+		if (status < 0)
 		{
-			writeArrowRecordBatch(table);
-			shows_record_batch_progress(table, table->nitems);
-			sql_table_clear(table);
+			if (table->fdesc < 0)
+			{
+				enable_dictionary_auto(table);
+				setup_result_file(table, append_fdesc, &af_info);
+			}
+			write_record_batch(table);
 		}
 	}
-	if (table->nitems > 0)
+	if (table->fdesc < 0)
 	{
-		writeArrowRecordBatch(table);
-		shows_record_batch_progress(table, table->nitems);
-		sql_table_clear(table);
+		enable_dictionary_auto(table);
+		setup_result_file(table, append_fdesc, &af_info);
 	}
-	/* write out footer portion */
+	if (table->nitems > 0)
+		write_record_batch(table);
+	/* write out dictionaries built on the scan, and footer portion */
+	write_dictionary_on_write(table);
 	writeArrowFooter(table);
 
 	/* cleanup */
@@ -35,15 +35,29 @@ sqldb_begin_query(void *sqldb_state,
 				  SQLdictionary *dictionary_list);
 extern bool
 sqldb_fetch_results(void *sqldb_state, SQLtable *table);
+extern void
+sqldb_unfetch_results(void *sqldb_state);
 
 extern void
 sqldb_close_connection(void *sqldb_state);
 
+/* parallel mode */
+extern char *
+sqldb_export_snapshot(void *sqldb_state);
+extern void
+sqldb_import_snapshot(void *sqldb_state, const char *snapshot);
+extern char **
+sqldb_parallel_commands(void *sqldb_state,
+						const char *sqldb_tablename,
+						const char *sqldb_split_column,
+						int num_workers);
+
 /* misc functions */
 extern void	   *palloc(size_t sz);
 extern void	   *palloc0(size_t sz);
 extern char	   *pstrdup(const char *str);
 extern void	   *repalloc(void *ptr, size_t sz);
+extern void		pfree(void *ptr);
 extern uint32_t	hash_any(const unsigned char *k, int keylen);
 
 #endif	/* SQL2ARROW_H */
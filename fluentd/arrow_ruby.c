@@ -10,13 +10,18 @@
  * it under the terms of the PostgreSQL License.
  */
 #include <ruby.h>
+#include <ruby/thread.h>
 #include <ctype.h>
 #include <libgen.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdarg.h>
 #include <sys/file.h>
 #include "float2.h"
-#define Elog(fmt,...)							\
-	rb_raise(rb_eException, "%s:%d " fmt,		\
-			 __FILE__, __LINE__, ##__VA_ARGS__)
+#ifndef __ARROW_ELOG_CALLBACK__
+#error "__ARROW_ELOG_CALLBACK__ must be defined, also for arrow_write.c"
+#endif
 #include "arrow_ipc.h"
 
 /*
@@ -74,23 +79,72 @@ rb_puts(VALUE obj)
 	return rb_funcall(rb_mKernel, rb_intern("puts"), 1, obj);
 }
 
+/*
+ * Error handling
+ *
+ * Elog() raises a Ruby exception on the Ruby threads. On the background
+ * writer thread, that is not a Ruby thread and does not hold the GVL, it
+ * saves the error message and errno, then jumps back to the writer's main
+ * loop; the error is re-raised later on the Ruby thread.
+ */
+static __thread bool	is_background_writer = false;
+static __thread sigjmp_buf *background_writer_jmpbuf = NULL;
+static __thread int		background_writer_errno = 0;
+static __thread char	background_writer_errmsg[1024];
+
+void
+__arrowElog(const char *filename, int lineno, const char *fmt, ...)
+{
+	int			errno_saved = errno;
+	char		buf[sizeof(background_writer_errmsg)];
+	va_list		ap;
+	int			off;
+
+	off = snprintf(buf, sizeof(buf), "%s:%d ", filename, lineno);
+	errno = errno_saved;	/* for %m */
+	va_start(ap, fmt);
+	vsnprintf(buf + off, sizeof(buf) - off, fmt, ap);
+	va_end(ap);
+
+	if (is_background_writer)
+	{
+		assert(background_writer_jmpbuf != NULL);
+		background_writer_errno = errno_saved;
+		strcpy(background_writer_errmsg, buf);
+		siglongjmp(*background_writer_jmpbuf, 1);
+	}
+	rb_raise(rb_eException, "%s", buf);
+}
+
 /*
  * memory allocation wrapper
+ *
+ * Not ruby_xmalloc(), because the background writer thread, that is not
+ * a Ruby thread, also allocates / releases the buffers.
  */
+static inline void *
+__palloc_check(void *ptr, size_t sz)
+{
+	if (!ptr)
+	{
+		if (!is_background_writer)
+			rb_memerror();
+		errno = ENOMEM;
+		Elog("out of memory (sz=%zu)", sz);
+	}
+	return ptr;
+}
+
 void *
 palloc(size_t sz)
 {
-	return ruby_xmalloc(sz);
+	return __palloc_check(malloc(sz), sz);
 }
 
 void *
 palloc0(size_t sz)
 {
-	void   *ptr = ruby_xmalloc(sz);
-
-	memset(ptr, 0, sz);
-
-	return ptr;
+	return __palloc_check(calloc(1, sz), sz);
 }
 
 char *
@@ -118,13 +172,13 @@ pstrdup_ruby(VALUE datum)
 void *
 repalloc(void *old, size_t sz)
 {
-	return ruby_xrealloc(old, sz);
+	return __palloc_check(realloc(old, sz), sz);
 }
 
 void
 pfree(void *ptr)
 {
-	ruby_xfree(ptr);
+	free(ptr);
 }
 
 /* ----------------------------------------------------------------
@@ -1626,6 +1680,8 @@ __arrowFileWriteParseParams(VALUE self,
 				LONG2NUM(f_threshold << 20));
 }
 
+static void __arrowFileWriteSetupState(VALUE self);
+
 static VALUE
 rb_ArrowFileWrite__initialize(VALUE self,
 							  VALUE __pathname,
@@ -1637,6 +1693,7 @@ rb_ArrowFileWrite__initialize(VALUE self,
 	__arrowFileWritePathnameValidator(self, __pathname);
 	__arrowFileWriteParseSchemaDefs(self, __schema_defs);
 	__arrowFileWriteParseParams(self, __params);
+	__arrowFileWriteSetupState(self);
 
 	return self;
 }
@@ -1829,12 +1886,12 @@ arrowFileSetupNewFile(SQLtable *table)
 static SQLstat *
 __arrowFieldParseStats(ArrowField *af_field)
 {
-	SQLstat	   *stat_values;
+	SQLstat	   *stat_list = NULL;
+	SQLstat	  **stat_tail = &stat_list;
 	char	   *min_values = NULL;
 	char	   *max_values = NULL;
 	char	   *tok1, *pos1;
 	char	   *tok2, *pos2;
-	uint32_t	nrooms = 500;
 	uint32_t	i, nitems;
 
 	for (i=0; i < af_field->_num_custom_metadata; i++)
@@ -1857,31 +1914,28 @@ __arrowFieldParseStats(ArrowField *af_field)
 	if (!min_values || !max_values)
 		Elog("column [%s] has no min/max statistics", af_field->name);
 
-	stat_values = palloc(sizeof(SQLstat) * nrooms);
+	/*
+	 * SQLstat items are allocated individually, because the table buffer
+	 * is reused for the next file; see __arrowFileResetFileState()
+	 */
 	for (tok1 = strtok_r(min_values, ",", &pos1),
 		 tok2 = strtok_r(max_values, ",", &pos2), nitems = 0;
 		 tok1 != NULL && tok2 != NULL;
 		 tok1 = strtok_r(NULL, ",", &pos1),
 		 tok2 = strtok_r(NULL, ",", &pos2), nitems++)
 	{
-		SQLstat	   *stat;
+		SQLstat	   *stat = palloc(sizeof(SQLstat));
 		bool		__isnull = false;
 
-		if (nitems >= nrooms)
-		{
-			nrooms = 2 * nrooms;
-			stat_values = repalloc(stat_values, sizeof(SQLstat) * nrooms);
-		}
-		stat = &stat_values[nitems];
-		stat->next = NULL;	/* set later */
+		stat->next = NULL;
 		stat->rb_index = nitems;
 		stat->min.i128 = __atoi128(trim_cstring(tok1), &__isnull);
 		stat->max.i128 = __atoi128(trim_cstring(tok2), &__isnull);
 		stat->is_valid = !__isnull;
+		*stat_tail = stat;
+		stat_tail = &stat->next;
 	}
-	for (i=1; i < nitems; i++)
-		stat_values[i-1].next = &stat_values[i];
-	return stat_values;
+	return stat_list;
 }
 
 static void
@@ -1997,13 +2051,6 @@ arrowFileSetupAppend(SQLtable *table)
 	table->f_pos = offset;
 }
 
-typedef struct
-{
-	VALUE		self;
-	VALUE		chunk;
-	SQLtable   *table;
-} WriteChunkArgs;
-
 static SQLtable *
 __arrowFileCreateTable(VALUE self)
 {
@@ -2102,34 +2149,561 @@ __arrowFileReleaseTable(SQLtable *table)
 	}
 }
 
+/*
+ * __arrowFileResetFileState
+ *
+ * resets the state related to the destination file, but keeps the values
+ * in the buffer.
+ */
+static void
+__arrowFileResetFileState(SQLtable *table)
+{
+	int		j;
+
+	if (table->fdesc >= 0)
+		arrowFileCloseFile(table);
+	table->f_pos = 0;
+	if (table->recordBatches)
+		pfree(table->recordBatches);
+	table->recordBatches = NULL;
+	table->numRecordBatches = 0;
+	for (j=0; j < table->nfields; j++)
+	{
+		SQLfield   *column = &table->columns[j];
+		SQLstat	   *curr, *next;
+
+		for (curr = column->stat_list; curr; curr = next)
+		{
+			next = curr->next;
+			pfree(curr);
+		}
+		column->stat_list = NULL;
+	}
+}
+
+/*
+ * Savepoint of the buffer; values appended by a failed call are rolled back.
+ */
+typedef struct
+{
+	long		nitems;
+	long		nullcount;
+	size_t		nullmap_usage;
+	size_t		values_usage;
+	size_t		extra_usage;
+	size_t		curr_usage;
+	SQLstat		stat_datum;
+} SQLfieldSavepoint;
+
+static SQLfieldSavepoint *
+__arrowFileTableSavepoint(SQLtable *table)
+{
+	SQLfieldSavepoint *sp = palloc(sizeof(SQLfieldSavepoint) * table->nfields);
+	int			j;
+
+	for (j=0; j < table->nfields; j++)
+	{
+		SQLfield   *column = &table->columns[j];
+
+		sp[j].nitems = column->nitems;
+		sp[j].nullcount = column->nullcount;
+		sp[j].nullmap_usage = column->nullmap.usage;
+		sp[j].values_usage = column->values.usage;
+		sp[j].extra_usage = column->extra.usage;
+		sp[j].curr_usage = column->__curr_usage__;
+		memcpy(&sp[j].stat_datum, &column->stat_datum, sizeof(SQLstat));
+	}
+	return sp;
+}
+
+static void
+__arrowFileTableRollback(SQLtable *table, SQLfieldSavepoint *sp)
+{
+	long		nitems = -1;
+	int			j;
+
+	for (j=0; j < table->nfields; j++)
+	{
+		SQLfield   *column = &table->columns[j];
+
+		column->nitems = sp[j].nitems;
+		column->nullcount = sp[j].nullcount;
+		column->nullmap.usage = sp[j].nullmap_usage;
+		column->values.usage = sp[j].values_usage;
+		column->extra.usage = sp[j].extra_usage;
+		column->__curr_usage__ = sp[j].curr_usage;
+		memcpy(&column->stat_datum, &sp[j].stat_datum, sizeof(SQLstat));
+		nitems = sp[j].nitems;
+	}
+	if (nitems >= 0)
+		table->nitems = nitems;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Background writer
+ *
+ * ArrowFileWrite owns two SQLtable buffers. The Ruby thread appends values
+ * to the current buffer, and hands it over to the writer thread on flush;
+ * then, it continues to append values to the other buffer while the record
+ * batch is written out in the background.
+ * The destination file is opened (and validated, if append) by the Ruby
+ * thread prior to the hand-over, so errors are raised as usual exceptions.
+ *
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	pthread_mutex_t	lock;
+	pthread_cond_t	cond;
+	pthread_t		writer;
+	bool			writer_running;
+	bool			shutdown;		/* stop request to the writer */
+	bool			interrupted;	/* interrupt of the Ruby thread */
+	SQLtable	   *curr;			/* buffer being appended */
+	SQLtable	   *pending;		/* buffer being written, or NULL */
+	SQLtable	   *tables[2];
+	VALUE			field_names;	/* Array of frozen String */
+	/* image to restore the file, if the background write failed */
+	off_t			undo_offset;
+	char		   *undo_image;		/* former footer, if append */
+	size_t			undo_length;
+	/* error of the background writer, to be raised on the Ruby thread */
+	int				error_code;		/* errno */
+	char		   *error_message;	/* or NULL */
+} ArrowFileWriteState;
+
+static void
+__arrowFileWriteStopWriter(ArrowFileWriteState *state)
+{
+	if (state->writer_running)
+	{
+		pthread_mutex_lock(&state->lock);
+		state->shutdown = true;
+		pthread_cond_broadcast(&state->cond);
+		pthread_mutex_unlock(&state->lock);
+
+		pthread_join(state->writer, NULL);
+		state->writer_running = false;
+		state->shutdown = false;
+	}
+}
+
+static void
+rb_ArrowFileWriteState__mark(void *__state)
+{
+	ArrowFileWriteState *state = __state;
+
+	rb_gc_mark(state->field_names);
+}
+
+static void
+rb_ArrowFileWriteState__free(void *__state)
+{
+	ArrowFileWriteState *state = __state;
+	int		i;
+
+	/* values not flushed yet are discarded */
+	__arrowFileWriteStopWriter(state);
+	for (i=0; i < 2; i++)
+	{
+		SQLtable   *table = state->tables[i];
+
+		if (table)
+		{
+			__arrowFileResetFileState(table);
+			__arrowFileReleaseTable(table);
+			pfree(table);
+		}
+	}
+	if (state->undo_image)
+		pfree(state->undo_image);
+	if (state->error_message)
+		pfree(state->error_message);
+	pthread_cond_destroy(&state->cond);
+	pthread_mutex_destroy(&state->lock);
+	xfree(state);
+}
+
+static const rb_data_type_t arrowFileWriteStateType = {
+	"ArrowFileWrite",
+	{
+		rb_ArrowFileWriteState__mark,
+		rb_ArrowFileWriteState__free,
+		NULL,
+	},
+	NULL,
+	NULL,
+	0
+};
+
+static VALUE
+rb_ArrowFileWrite__alloc(VALUE klass)
+{
+	ArrowFileWriteState *state;
+	VALUE		self;
+
+	self = TypedData_Make_Struct(klass, ArrowFileWriteState,
+								 &arrowFileWriteStateType, state);
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->cond, NULL);
+	state->field_names = Qnil;
+	return self;
+}
+
+static ArrowFileWriteState *
+__arrowFileWriteGetState(VALUE self)
+{
+	ArrowFileWriteState *state;
+
+	TypedData_Get_Struct(self, ArrowFileWriteState,
+						 &arrowFileWriteStateType, state);
+	if (!state->curr)
+		Elog("ArrowFileWrite is not initialized");
+	return state;
+}
+
+static void
+__arrowFileWriteSetupState(VALUE self)
+{
+	ArrowFileWriteState *state;
+	SQLtable   *table;
+	int			j;
+
+	TypedData_Get_Struct(self, ArrowFileWriteState,
+						 &arrowFileWriteStateType, state);
+	if (state->curr)
+		Elog("ArrowFileWrite is already initialized");
+	state->tables[0] = __arrowFileCreateTable(self);
+	state->tables[1] = __arrowFileCreateTable(self);
+	state->curr = table = state->tables[0];
+
+	state->field_names = rb_ary_new_capa(table->nfields);
+	for (j=0; j < table->nfields; j++)
+	{
+		VALUE	fname = rb_str_new_cstr(table->columns[j].field_name);
+
+		rb_ary_push(state->field_names, rb_obj_freeze(fname));
+	}
+}
+
+/*
+ * __arrowFileWriterRestore - restores the file image prior to the failed
+ * write, then the chunk can be written again. It must not raise errors.
+ */
+static void
+__arrowFileWriterRestore(ArrowFileWriteState *state, SQLtable *table)
+{
+	size_t		offset = 0;
+	ssize_t		nbytes;
+
+	while (offset < state->undo_length)
+	{
+		nbytes = pwrite(table->fdesc,
+						state->undo_image + offset,
+						state->undo_length - offset,
+						state->undo_offset + offset);
+		if (nbytes <= 0)
+		{
+			if (nbytes < 0 && errno == EINTR)
+				continue;
+			fprintf(stderr, "unable to restore '%s' on write failure: %m\n",
+					table->filename);
+			return;
+		}
+		offset += nbytes;
+	}
+	if (ftruncate(table->fdesc, state->undo_offset + state->undo_length) != 0)
+		fprintf(stderr, "unable to restore '%s' on write failure: %m\n",
+				table->filename);
+}
+
+/*
+ * __arrowFileWriterMain - writes out the pending buffer in the background.
+ * It must not touch any Ruby objects, nor raise Ruby exceptions.
+ */
+static void *
+__arrowFileWriterMain(void *__arg)
+{
+	ArrowFileWriteState *state = __arg;
+	SQLtable   *table;
+	sigjmp_buf	jmpbuf;
+
+	is_background_writer = true;
+	pthread_mutex_lock(&state->lock);
+	for (;;)
+	{
+		if (state->pending)
+		{
+			char   *errmsg = NULL;
+			int		errcode = 0;
+
+			table = state->pending;
+			pthread_mutex_unlock(&state->lock);
+
+			if (sigsetjmp(jmpbuf, 0) == 0)
+			{
+				background_writer_jmpbuf = &jmpbuf;
+				/* write out a new record-batch */
+				writeArrowRecordBatch(table);
+				/* write out a new footer */
+				writeArrowFooter(table);
+				if (fdatasync(table->fdesc) != 0)
+				{
+					errcode = errno;
+					errmsg = strdup("failed on fdatasync");
+				}
+			}
+			else
+			{
+				errcode = background_writer_errno;
+				errmsg = strdup(background_writer_errmsg);
+			}
+			background_writer_jmpbuf = NULL;
+			if (errcode != 0 || errmsg != NULL)
+			{
+				if (!errmsg && asprintf(&errmsg, "failed on write('%s')",
+										table->filename) < 0)
+					errmsg = NULL;
+				__arrowFileWriterRestore(state, table);
+			}
+			/* close the file, and unlock */
+			__arrowFileResetFileState(table);
+			sql_table_clear(table);
+
+			pthread_mutex_lock(&state->lock);
+			if (errmsg || errcode != 0)
+			{
+				/* only the first error is reported */
+				if (!state->error_message && state->error_code == 0)
+				{
+					state->error_code = (errcode != 0 ? errcode : EIO);
+					state->error_message = errmsg;
+				}
+				else if (errmsg)
+					free(errmsg);
+			}
+			state->pending = NULL;
+			pthread_cond_broadcast(&state->cond);
+		}
+		else if (state->shutdown)
+			break;
+		else
+			pthread_cond_wait(&state->cond, &state->lock);
+	}
+	pthread_mutex_unlock(&state->lock);
+
+	return NULL;
+}
+
+static void
+__arrowFileWriteStartWriter(ArrowFileWriteState *state)
+{
+	sigset_t	sigmask;
+	sigset_t	sigmask_saved;
+	int			rv;
+
+	if (state->writer_running)
+		return;
+	/* signals shall be delivered to the Ruby threads */
+	sigfillset(&sigmask);
+	pthread_sigmask(SIG_SETMASK, &sigmask, &sigmask_saved);
+	rv = pthread_create(&state->writer, NULL, __arrowFileWriterMain, state);
+	pthread_sigmask(SIG_SETMASK, &sigmask_saved, NULL);
+	if (rv != 0)
+		Elog("failed on pthread_create: %s", strerror(rv));
+	state->writer_running = true;
+}
+
+static void *
+__arrowFileWriteWaitNoGVL(void *__arg)
+{
+	ArrowFileWriteState *state = __arg;
+
+	pthread_mutex_lock(&state->lock);
+	while (state->pending && !state->interrupted)
+		pthread_cond_wait(&state->cond, &state->lock);
+	state->interrupted = false;
+	pthread_mutex_unlock(&state->lock);
+
+	return NULL;
+}
+
+static void
+__arrowFileWriteUnblock(void *__arg)
+{
+	ArrowFileWriteState *state = __arg;
+
+	pthread_mutex_lock(&state->lock);
+	state->interrupted = true;
+	pthread_cond_broadcast(&state->cond);
+	pthread_mutex_unlock(&state->lock);
+}
+
+/*
+ * __arrowFileWriteSync - waits for completion of the background write,
+ * then raises the error of the background writer, if any.
+ */
+static void
+__arrowFileWriteSync(ArrowFileWriteState *state)
+{
+	bool	busy;
+	int		errcode;
+	char   *errmsg;
+	VALUE	message;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&state->lock);
+		busy = (state->pending != NULL);
+		pthread_mutex_unlock(&state->lock);
+		if (!busy)
+			break;
+		rb_thread_call_without_gvl(__arrowFileWriteWaitNoGVL, state,
+								   __arrowFileWriteUnblock, state);
+		rb_thread_check_ints();
+	}
+	if (state->undo_image)
+		pfree(state->undo_image);
+	state->undo_image = NULL;
+	state->undo_length = 0;
+
+	pthread_mutex_lock(&state->lock);
+	errcode = state->error_code;
+	errmsg = state->error_message;
+	state->error_code = 0;
+	state->error_message = NULL;
+	pthread_mutex_unlock(&state->lock);
+	if (errcode != 0)
+	{
+		message = rb_str_new_cstr(errmsg ? errmsg : "background write failed");
+		free(errmsg);
+		rb_syserr_fail_str(errcode, message);
+	}
+}
+
+/*
+ * __arrowFileWriteSaveUndo - saves the file image to be overwritten by the
+ * background writer, to restore it on write failure.
+ */
+static void
+__arrowFileWriteSaveUndo(ArrowFileWriteState *state, SQLtable *table,
+						 bool is_new_file)
+{
+	struct stat	stat_buf;
+	size_t		offset = 0;
+	ssize_t		nbytes;
+
+	assert(!state->undo_image);
+	if (is_new_file)
+	{
+		/* truncate to the empty file; it shall be set up again */
+		state->undo_offset = 0;
+		state->undo_length = 0;
+		return;
+	}
+	if (fstat(table->fdesc, &stat_buf) != 0)
+		Elog("failed on fstat('%s'): %m", table->filename);
+	assert(stat_buf.st_size >= table->f_pos);
+	state->undo_offset = table->f_pos;
+	state->undo_length = stat_buf.st_size - table->f_pos;
+	state->undo_image = palloc(state->undo_length + 1);
+	while (offset < state->undo_length)
+	{
+		nbytes = pread(table->fdesc,
+					   state->undo_image + offset,
+					   state->undo_length - offset,
+					   state->undo_offset + offset);
+		if (nbytes <= 0)
+		{
+			if (nbytes < 0 && errno == EINTR)
+				continue;
+			Elog("failed on pread('%s'): %m", table->filename);
+		}
+		offset += nbytes;
+	}
+}
+
+/*
+ * __arrowFileWriteFlush - hands over the current buffer to the writer
+ */
+static void
+__arrowFileWriteFlush(VALUE self, ArrowFileWriteState *state)
+{
+	SQLtable   *table = state->curr;
+
+	/* only one record batch can be written at once */
+	__arrowFileWriteSync(state);
+	if (table->nitems == 0)
+		return;
+	/* open the destination file */
+	if (arrowFileOpenFile(self, table))
+	{
+		__arrowFileWriteSaveUndo(state, table, true);
+		arrowFileSetupNewFile(table);
+	}
+	else
+	{
+		arrowFileSetupAppend(table);
+		__arrowFileWriteSaveUndo(state, table, false);
+	}
+	__arrowFileWriteStartWriter(state);
+
+	pthread_mutex_lock(&state->lock);
+	state->pending = table;
+	state->curr = (table == state->tables[0]
+				   ? state->tables[1]
+				   : state->tables[0]);
+	pthread_cond_broadcast(&state->cond);
+	pthread_mutex_unlock(&state->lock);
+}
+
+typedef struct
+{
+	VALUE		self;
+	VALUE		data;		/* chunk or columns */
+	ArrowFileWriteState *state;
+	SQLfieldSavepoint *savepoint;
+} WriteChunkArgs;
+
 static VALUE
 __arrowFileWriteRow(RB_BLOCK_CALL_FUNC_ARGLIST(__yield, __private))
 {
 	WriteChunkArgs *args = (WriteChunkArgs *)__private;
-	SQLtable   *table = args->table;
+	ArrowFileWriteState *state = args->state;
+	SQLtable   *table = state->curr;
 	VALUE		tag;
 	VALUE		ts;
 	VALUE		record;
 	int			j;
 
-	tag = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(0));
-	ts = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(1));
-	record = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(2));
+	if (TYPE(__yield) == T_ARRAY)
+	{
+		tag = rb_ary_entry(__yield, 0);
+		ts = rb_ary_entry(__yield, 1);
+		record = rb_ary_entry(__yield, 2);
+	}
+	else
+	{
+		tag = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(0));
+		ts = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(1));
+		record = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(2));
+	}
 	for (j=0; j < table->nfields; j++)
 	{
 		SQLfield   *column = &table->columns[j];
+		VALUE		fname = RARRAY_AREF(state->field_names, j);
 		VALUE		datum;
 
 		if (column->sql_type.fluent.ts_column)
 			datum = ts;
 		else if (column->sql_type.fluent.tag_column)
 			datum = tag;
+		else if (TYPE(record) == T_HASH)
+			datum = rb_hash_lookup2(record, fname, Qnil);
 		else
-		{
-			datum = rb_funcall(record, rb_intern("fetch"), 2,
-							   rb_str_new_cstr(column->field_name), Qnil);
-		}
-		column->put_value(column, (const char *)datum, -1);
+			datum = rb_funcall(record, rb_intern("fetch"), 2, fname, Qnil);
+		sql_field_put_value(column, (const char *)datum, -1);
 	}
 	table->nitems++;
 
@@ -2140,67 +2714,212 @@ static VALUE
 __arrowFileWriteChunk(VALUE __args)
 {
 	WriteChunkArgs *args = (WriteChunkArgs *)__args;
-	SQLtable   *table;
 
-	/* setup SQLtable buffer */
-	args->table = table = __arrowFileCreateTable(args->self);
+	/* raise the error of the previous record batch, if any */
+	__arrowFileWriteSync(args->state);
 	/* iterate chunk to fill up the buffer */
-	rb_block_call(args->chunk,
+	rb_block_call(args->data,
 				  rb_intern("each"),
 				  0,
 				  NULL,
 				  __arrowFileWriteRow,
 				  __args);
-	/* open the destination file */
-	if (arrowFileOpenFile(args->self, args->table))
-		arrowFileSetupNewFile(args->table);
-	else
-		arrowFileSetupAppend(args->table);
-	/* write out a new record-batch */
-	writeArrowRecordBatch(table);
-	/* write out a new footer */
-	writeArrowFooter(table);
-	/* close the file, and unlock */
-	arrowFileCloseFile(table);
+	/* hand over the buffer to the writer as a new record-batch */
+	__arrowFileWriteFlush(args->self, args->state);
 
 	return Qtrue;
 }
 
+/*
+ * __arrowFileAppendColumns - appends arrays of values, column by column
+ */
 static VALUE
-rb_ArrowFileWrite__writeChunk(VALUE self,
-							  VALUE chunk)
+__arrowFileAppendColumns(VALUE __args)
 {
-	WriteChunkArgs args;
-	VALUE		retval;
-	int			status;
+	WriteChunkArgs *args = (WriteChunkArgs *)__args;
+	ArrowFileWriteState *state = args->state;
+	SQLtable   *table = state->curr;
+	VALUE		columns = args->data;
+	VALUE	   *arrays = alloca(sizeof(VALUE) * table->nfields);
+	long		i, nrows = -1;
+	int			j;
 
-	memset(&args, 0, sizeof(WriteChunkArgs));
-	args.self  = self;
-	args.chunk = chunk;
+	/* raise the error of the previous record batch, if any */
+	__arrowFileWriteSync(state);
+	if (TYPE(columns) == T_HASH)
+	{
+		for (j=0; j < table->nfields; j++)
+			arrays[j] = rb_hash_lookup2(columns,
+										RARRAY_AREF(state->field_names, j),
+										Qnil);
+	}
+	else if (TYPE(columns) == T_ARRAY)
+	{
+		if (RARRAY_LEN(columns) != table->nfields)
+			Elog("appendColumns: number of columns mismatch (%ld of %d)",
+				 RARRAY_LEN(columns), table->nfields);
+		for (j=0; j < table->nfields; j++)
+			arrays[j] = rb_ary_entry(columns, j);
+	}
+	else
+		Elog("appendColumns: columns must be Array or Hash");
 
-	retval = rb_protect(__arrowFileWriteChunk, (VALUE)&args, &status);
-	if (status != 0)
+	for (j=0; j < table->nfields; j++)
 	{
-		if (args.table)
+		if (arrays[j] == Qnil)
+			continue;	/* all NULLs */
+		if (TYPE(arrays[j]) != T_ARRAY)
+			Elog("appendColumns: column [%s] must be Array",
+				 table->columns[j].field_name);
+		if (nrows < 0)
+			nrows = RARRAY_LEN(arrays[j]);
+		else if (nrows != RARRAY_LEN(arrays[j]))
+			Elog("appendColumns: column [%s] has %ld items, but %ld expected",
+				 table->columns[j].field_name,
+				 RARRAY_LEN(arrays[j]), nrows);
+	}
+	if (nrows <= 0)
+		return INT2NUM(0);
+
+	for (j=0; j < table->nfields; j++)
+	{
+		SQLfield   *column = &table->columns[j];
+		VALUE		array = arrays[j];
+
+		if (array == Qnil)
 		{
-			if (args.table->fdesc >= 0)
-				close(args.table->fdesc);
-			__arrowFileReleaseTable(args.table);
+			for (i=0; i < nrows; i++)
+				sql_field_put_value(column, (const char *)Qnil, -1);
 		}
+		else
+		{
+			for (i=0; i < nrows; i++)
+				sql_field_put_value(column, (const char *)RARRAY_AREF(array, i), -1);
+		}
+	}
+	table->nitems += nrows;
+
+	return LONG2NUM(nrows);
+}
+
+static VALUE
+__arrowFileWriteProtect(VALUE (*func)(VALUE), WriteChunkArgs *args)
+{
+	ArrowFileWriteState *state = args->state;
+	SQLtable   *table = state->curr;
+	VALUE		retval;
+	int			status;
+
+	args->savepoint = __arrowFileTableSavepoint(table);
+	retval = rb_protect(func, (VALUE)args, &status);
+	if (status != 0)
+	{
+		/* the buffer is not handed over, if any errors */
+		assert(state->curr == table);
+		__arrowFileResetFileState(table);
+		__arrowFileTableRollback(table, args->savepoint);
+		pfree(args->savepoint);
 		rb_jump_tag(status);
 	}
-	assert(args.table->fdesc < 0);
-	__arrowFileReleaseTable(args.table);
+	pfree(args->savepoint);
 
 	return retval;
 }
 
+static VALUE
+rb_ArrowFileWrite__writeChunk(VALUE self,
+							  VALUE chunk)
+{
+	WriteChunkArgs args;
+
+	memset(&args, 0, sizeof(WriteChunkArgs));
+	args.self  = self;
+	args.data  = chunk;
+	args.state = __arrowFileWriteGetState(self);
+
+	return __arrowFileWriteProtect(__arrowFileWriteChunk, &args);
+}
+
+static VALUE
+rb_ArrowFileWrite__appendColumns(VALUE self,
+								 VALUE columns)
+{
+	WriteChunkArgs args;
+
+	memset(&args, 0, sizeof(WriteChunkArgs));
+	args.self  = self;
+	args.data  = columns;
+	args.state = __arrowFileWriteGetState(self);
+
+	return __arrowFileWriteProtect(__arrowFileAppendColumns, &args);
+}
+
+static VALUE
+__arrowFileWriteFlushProtected(VALUE __args)
+{
+	WriteChunkArgs *args = (WriteChunkArgs *)__args;
+
+	__arrowFileWriteFlush(args->self, args->state);
+
+	return Qtrue;
+}
+
+static VALUE
+rb_ArrowFileWrite__flush(VALUE self)
+{
+	WriteChunkArgs args;
+
+	memset(&args, 0, sizeof(WriteChunkArgs));
+	args.self  = self;
+	args.state = __arrowFileWriteGetState(self);
+
+	return __arrowFileWriteProtect(__arrowFileWriteFlushProtected, &args);
+}
+
+static VALUE
+rb_ArrowFileWrite__sync(VALUE self)
+{
+	__arrowFileWriteSync(__arrowFileWriteGetState(self));
+
+	return Qtrue;
+}
+
+static VALUE
+__arrowFileWriteCloseBody(VALUE self)
+{
+	rb_ArrowFileWrite__flush(self);
+	__arrowFileWriteSync(__arrowFileWriteGetState(self));
+
+	return Qtrue;
+}
+
+static VALUE
+__arrowFileWriteCloseEnsure(VALUE self)
+{
+	/* stop the writer, even if the last record batch failed */
+	__arrowFileWriteStopWriter(__arrowFileWriteGetState(self));
+
+	return Qnil;
+}
+
+static VALUE
+rb_ArrowFileWrite__close(VALUE self)
+{
+	return rb_ensure(__arrowFileWriteCloseBody, self,
+					 __arrowFileWriteCloseEnsure, self);
+}
+
 void
 Init_arrow_file_write(void)
 {
 	VALUE	klass;
 
 	klass = rb_define_class("ArrowFileWrite",  rb_cObject);
+	rb_define_alloc_func(klass, rb_ArrowFileWrite__alloc);
 	rb_define_method(klass, "initialize", rb_ArrowFileWrite__initialize, 3);
 	rb_define_method(klass, "writeChunk", rb_ArrowFileWrite__writeChunk, 1);
+	rb_define_method(klass, "appendColumns", rb_ArrowFileWrite__appendColumns, 1);
+	rb_define_method(klass, "flush", rb_ArrowFileWrite__flush, 0);
+	rb_define_method(klass, "sync", rb_ArrowFileWrite__sync, 0);
+	rb_define_method(klass, "close", rb_ArrowFileWrite__close, 0);
 }
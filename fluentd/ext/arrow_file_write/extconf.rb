@@ -1,3 +1,3 @@
 require 'mkmf'
-$CFLAGS='-D_GNU_SOURCE'
+$CFLAGS='-D_GNU_SOURCE -D__ARROW_ELOG_CALLBACK__'
 create_makefile('arrow_file_write')
@@ -6,7 +6,7 @@ module Fluent
     class ArrowFileOutput < Fluent::Plugin::Output
       Fluent::Plugin.register_output("arrow_file", self)
 
-      helpers :inject, :compat_parameters
+      helpers :inject, :compat_parameters, :timer
 
       desc "The Path of the arrow file"
       config_param :path, :string
@@ -25,6 +25,11 @@ module Fluent
       def prefer_buffered_processing
         true
       end
+
+      # chunks are committed after the background writer completes
+      def prefer_delayed_commit
+        true
+      end
   
       def multi_workers_ready?
         false
@@ -35,6 +40,15 @@ module Fluent
         super
 
         @af=ArrowFileWrite.new(@path,@schema_defs,{"ts_column" => @ts_column,"tag_column" => @tag_column,"filesize_threshold" => @filesize_threshold})
+        @af_lock = Mutex.new
+        @pending_chunk_id = nil
+      end
+
+      def start
+        super
+        timer_execute(:out_arrow_file_commit, 1) do
+          commit_pending_chunk
+        end
       end
 
       def format(tag,time,record)
@@ -47,7 +61,44 @@ module Fluent
       end
 
       def write(chunk)
-        @af.writeChunk(chunk)
+        @af_lock.synchronize do
+          @af.writeChunk(chunk)
+          @af.sync
+        end
+      end
+
+      def try_write(chunk)
+        # commit (or rollback) the previous chunk prior to the next one
+        commit_pending_chunk
+        @af_lock.synchronize do
+          @af.writeChunk(chunk)
+          @pending_chunk_id = chunk.unique_id
+        end
+      end
+
+      # waits for completion of the background writer, then commits the
+      # last chunk; or rollbacks it to retry, if the writer failed.
+      def commit_pending_chunk
+        @af_lock.synchronize do
+          chunk_id = @pending_chunk_id
+          next if chunk_id.nil?
+          @pending_chunk_id = nil
+          begin
+            @af.sync
+          rescue => e
+            log.warn "failed to write chunk into arrow file", path: @path, chunk_id: dump_unique_id_hex(chunk_id), error: e
+            rollback_write(chunk_id, update_retry: true)
+          else
+            commit_write(chunk_id)
+          end
+        end
+      end
+
+      def shutdown
+        # wait for completion of the background writer
+        commit_pending_chunk
+        @af.close
+        super
       end
     end
   end
@@ -595,6 +595,8 @@ typedef struct
 	ArrowFooter		footer;
 	ArrowMessage   *dictionaries;	/* array of ArrowDictionaryBatch */
 	ArrowMessage   *recordBatches;	/* array of ArrowRecordBatch */
+	size_t			stream_tail;	/* end of the last complete message, if
+									 * read as IPC stream (no valid footer) */
 } ArrowFileInfo;
 
 #endif		/* !__CUDACC__ */
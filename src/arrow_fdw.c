@@ -71,6 +71,11 @@ typedef struct ArrowFileState
 	const char *dpu_path;	/* relative pathname, if DPU */
 	struct stat	stat_buf;
 	List	   *rb_list;	/* list of RecordBatchState */
+	size_t		stream_tail;	/* end of the last message, if no footer */
+	/* virtual partition columns, if any */
+	int			nvirtuals;	/* number of virtual columns */
+	Datum	   *virt_values;
+	bool	   *virt_isnull;
 } ArrowFileState;
 
 /*
@@ -100,7 +105,9 @@ struct ArrowFdwState
 	File				curr_filp;		/* current arrow file to read */
 	kern_data_store	   *curr_kds;		/* current chunk to read */
 	uint32_t			curr_index;		/* current index on the chunk */
+	ArrowFileState	   *curr_af_state;	/* arrow file of the current chunk */
 	List			   *af_states_list;	/* list of ArrowFileState */
+	int					nfiles_pruned;	/* # of files pruned by partition keys */
 	uint32_t			rb_nitems;		/* number of record-batches */
 	RecordBatchState   *rb_states[FLEXIBLE_ARRAY_MEMBER]; /* flatten RecordBatchState */
 };
@@ -157,6 +164,7 @@ struct arrowMetadataCache
 	off_t		rb_offset;	/* offset from the head */
 	size_t		rb_length;	/* length of the entire RecordBatch */
 	int64		rb_nitems;	/* number of items */
+	size_t		stream_tail; /* end of the last message, if no footer */
 	/* per column information */
 	int			nfields;
 	dlist_head	fields;		/* list of arrowMetadataFieldCache */
@@ -167,6 +175,14 @@ struct arrowMetadataCache
  * Metadata cache management
  */
 #define ARROW_METADATA_HASH_NSLOTS		2000
+#define ARROW_PENDING_WRITES_NSLOTS		128
+typedef struct
+{
+	TransactionId xid;			/* writer transaction, or invalid if free */
+	int			nbatches;		/* # of committed record batches */
+	struct stat	stat_buf;		/* stat(2) of the committed state */
+} arrowPendingWrite;
+
 typedef struct
 {
 	LWLock		mutex;
@@ -176,6 +192,10 @@ typedef struct
 	dlist_head	free_mcaches;	/* list of arrowMetadataCache */
 	dlist_head	free_fcaches;	/* list of arrowMetadataFieldCache */
 	dlist_head	hash_slots[ARROW_METADATA_HASH_NSLOTS];
+	/* arrow files being written by the in-progress transactions */
+	slock_t		pending_lock;
+	int			num_pending;
+	arrowPendingWrite pending[ARROW_PENDING_WRITES_NSLOTS];
 } arrowMetadataCacheHead;
 
 /*
@@ -188,6 +208,8 @@ static arrowMetadataCacheHead *arrow_metadata_cache = NULL;
 static bool					arrow_fdw_enabled;	/* GUC */
 static bool					arrow_fdw_stats_hint_enabled;	/* GUC */
 static int					arrow_metadata_cache_size_kb;	/* GUC */
+static int					arrow_metadata_parallel_workers;	/* GUC */
+static int					arrow_write_batch_size_kb;	/* GUC */
 
 /* ----------------------------------------------------------------
  *
@@ -561,6 +583,29 @@ lookupArrowMetadataCache(struct stat *stat_buf, bool has_exclusive)
 	return NULL;
 }
 
+/*
+ * lookupArrowMetadataCacheStale
+ *
+ * It returns the metadata cache of the same file, but already stale.
+ */
+static arrowMetadataCache *
+lookupArrowMetadataCacheStale(struct stat *stat_buf)
+{
+	uint32_t	hindex = arrowMetadataHashIndex(stat_buf);
+	dlist_iter	iter;
+
+	dlist_foreach(iter, &arrow_metadata_cache->hash_slots[hindex])
+	{
+		arrowMetadataCache *mcache
+			= dlist_container(arrowMetadataCache, chain, iter.cur);
+
+		if (stat_buf->st_dev == mcache->stat_buf.st_dev &&
+			stat_buf->st_ino == mcache->stat_buf.st_ino)
+			return mcache;
+	}
+	return NULL;
+}
+
 /* ----------------------------------------------------------------
  *
  * buildArrowStatsBinary
@@ -677,7 +722,7 @@ __parseArrowFieldStatsBinary(arrowFieldStatsBinary *bstats,
 			case ArrowNodeTag__Int:
 			case ArrowNodeTag__FloatingPoint:
 				stat_values[index].min.datum = (Datum)__min;
-				stat_values[index].max.datum = (Datum)__min;
+				stat_values[index].max.datum = (Datum)__max;
 				break;
 
 			case ArrowNodeTag__Decimal:
@@ -1199,6 +1244,7 @@ __buildArrowFileStateByCache(const char *filename,
 	af_state = palloc0(sizeof(ArrowFileState));
 	af_state->filename = pstrdup(filename);
 	memcpy(&af_state->stat_buf, &mcache->stat_buf, sizeof(struct stat));
+	af_state->stream_tail = mcache->stream_tail;
 
 	while (mcache)
 	{
@@ -1757,10 +1803,14 @@ __buildRecordBatchStateOne(ArrowSchema *schema,
 /*
  * readArrowFile
  */
+static void	__arrowFdwCheckUndoFile(const char *filename, int fdesc);
+
 static bool
 readArrowFile(const char *filename, ArrowFileInfo *af_info, bool missing_ok)
 {
-    File	filp = PathNameOpenFile(filename, O_RDONLY | PG_BINARY);
+	File		filp;
+
+	filp = PathNameOpenFile(filename, O_RDONLY | PG_BINARY);
 
 	if (filp < 0)
 	{
@@ -1770,6 +1820,8 @@ readArrowFile(const char *filename, ArrowFileInfo *af_info, bool missing_ok)
 				(errcode_for_file_access(),
 				 errmsg("could not open file \"%s\": %m", filename)));
 	}
+	/* never read the file half-written by the crashed writer */
+	__arrowFdwCheckUndoFile(filename, FileGetRawDesc(filp));
 	readArrowFileDesc(FileGetRawDesc(filp), af_info);
 	FileClose(filp);
 	if (af_info->dictionaries != NULL)
@@ -1799,6 +1851,7 @@ __buildArrowFileStateByFile(const char *filename, Bitmapset **p_stat_attrs)
 	af_state = palloc0(sizeof(ArrowFileInfo));
 	af_state->filename = pstrdup(filename);
 	memcpy(&af_state->stat_buf, &af_info.stat_buf, sizeof(struct stat));
+	af_state->stream_tail = af_info.stream_tail;
 
 	arrow_bstats = buildArrowStatsBinary(&af_info.footer, p_stat_attrs);
 	for (int i=0; i < af_info.footer._num_recordBatches; i++)
@@ -1818,6 +1871,80 @@ __buildArrowFileStateByFile(const char *filename, Bitmapset **p_stat_attrs)
 	return af_state;
 }
 
+/*
+ * __buildArrowFileStateByTail
+ *
+ * Arrow files being written (IPC stream, or no valid footer yet) grow by
+ * appending record batches, so the stale metadata-cache is still valid for
+ * the record batches already cached. It parses only the message headers
+ * appended after them, instead of the entire file.
+ */
+static ArrowFileState *
+__buildArrowFileStateByTail(const char *filename, struct stat *stat_buf)
+{
+	arrowMetadataCache *mcache;
+	ArrowFileState *af_state = NULL;
+	ArrowFileInfo	af_info;
+	RecordBatchState *rb_state;
+	size_t			stream_tail = 0;
+	char			tail[6];	/* strlen("ARROW1") */
+	File			filp;
+	int				rb_index;
+
+	if (!S_ISREG(stat_buf->st_mode))
+		return NULL;
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
+	mcache = lookupArrowMetadataCacheStale(stat_buf);
+	if (mcache &&
+		mcache->stream_tail > 0 &&
+		mcache->stream_tail <= stat_buf->st_size &&
+		mcache->stat_buf.st_size <= stat_buf->st_size)
+	{
+		af_state = __buildArrowFileStateByCache(filename, mcache, NULL);
+		stream_tail = mcache->stream_tail;
+	}
+	LWLockRelease(&arrow_metadata_cache->mutex);
+	if (!af_state)
+		return NULL;
+
+	filp = PathNameOpenFile(filename, O_RDONLY | PG_BINARY);
+	if (filp < 0)
+		return NULL;
+	/* once the footer is written, read the entire file as usual */
+	if (FileRead(filp, tail, sizeof(tail),
+				 stat_buf->st_size - sizeof(tail),
+				 WAIT_EVENT_DATA_FILE_READ) == sizeof(tail) &&
+		memcmp(tail, "ARROW1", sizeof(tail)) == 0)
+	{
+		FileClose(filp);
+		return NULL;
+	}
+	readArrowStreamDesc(FileGetRawDesc(filp), stream_tail, &af_info);
+	FileClose(filp);
+	if (af_info.dictionaries != NULL)
+		elog(ERROR, "DictionaryBatch is not supported at '%s'", filename);
+	rb_state = linitial(af_state->rb_list);
+	if (af_info.footer.schema._num_fields != rb_state->nfields)
+		return NULL;	/* not a growing file? */
+
+	memcpy(&af_state->stat_buf, &af_info.stat_buf, sizeof(struct stat));
+	af_state->stream_tail = af_info.stream_tail;
+	rb_index = list_length(af_state->rb_list);
+	for (int i=0; i < af_info.footer._num_recordBatches; i++)
+	{
+		ArrowBlock	     *block  = &af_info.footer.recordBatches[i];
+		ArrowRecordBatch *rbatch = &af_info.recordBatches[i].body.recordBatch;
+
+		rb_state = __buildRecordBatchStateOne(&af_info.footer.schema,
+											  af_state, rb_index++,
+											  block, rbatch);
+		af_state->rb_list = lappend(af_state->rb_list, rb_state);
+	}
+	elog(DEBUG2, "arrow_fdw: '%s' metadata-cache is refreshed by %d record batches",
+		 filename, af_info.footer._num_recordBatches);
+	return af_state;
+}
+
 
 static arrowMetadataFieldCache *
 __buildArrowMetadataFieldCache(RecordBatchFieldState *rb_field)
@@ -1888,6 +2015,7 @@ __buildArrowMetadataCacheNoLock(ArrowFileState *af_state)
 		mcache->rb_offset = rb_state->rb_offset;
 		mcache->rb_length = rb_state->rb_length;
 		mcache->rb_nitems = rb_state->rb_nitems;
+		mcache->stream_tail = af_state->stream_tail;
 		mcache->nfields   = rb_state->nfields;
 		dlist_init(&mcache->fields);
 		if (!mcache_head)
@@ -1919,17 +2047,200 @@ __buildArrowMetadataCacheNoLock(ArrowFileState *af_state)
 	SpinLockRelease(&arrow_metadata_cache->lru_lock);
 }
 
+/*
+ * Hive-style partition support
+ *
+ * Arrow files stored under the directories like 'date=2026-10-01/region=eu'
+ * have virtual partition columns; 'date' and 'region' in this example.
+ * These columns shall be defined next to the fields of the arrow files
+ * on the foreign table, then filled up by the values in the pathname.
+ */
+#define HIVE_DEFAULT_PARTITION		"__HIVE_DEFAULT_PARTITION__"
+
+static int
+__hexdigit(int c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/*
+ * lookupHivePartitionValue
+ *
+ * It looks up the 'key=value' directory component in the filename.
+ * If the key is found, it returns true and *p_value is set to the value,
+ * or NULL if default partition.
+ */
+static bool
+lookupHivePartitionValue(const char *filename, const char *key, char **p_value)
+{
+	const char *base = strrchr(filename, '/');
+	const char *pos = filename;
+	int			keylen = strlen(key);
+	bool		found = false;
+
+	while (base && pos < base)
+	{
+		const char *tail = strchr(pos, '/');
+
+		if (!tail)
+			break;
+		if (tail - pos > keylen &&
+			strncmp(pos, key, keylen) == 0 &&
+			pos[keylen] == '=')
+		{
+			const char *src = pos + keylen + 1;
+			char	   *dst;
+			char	   *value;
+
+			/* decode the escaped characters like '%2F' */
+			value = dst = palloc(tail - src + 1);
+			while (src < tail)
+			{
+				if (src[0] == '%' && tail - src >= 3 &&
+					__hexdigit(src[1]) >= 0 &&
+					__hexdigit(src[2]) >= 0)
+				{
+					*dst++ = (__hexdigit(src[1]) << 4) | __hexdigit(src[2]);
+					src += 3;
+				}
+				else
+					*dst++ = *src++;
+			}
+			*dst = '\0';
+			/* deeper directory component overrides */
+			if (strcmp(value, HIVE_DEFAULT_PARTITION) == 0)
+				*p_value = NULL;
+			else
+				*p_value = value;
+			found = true;
+		}
+		pos = tail + 1;
+	}
+	return found;
+}
+
+static bool
+__fetchHivePartitionDatum(const char *filename,
+						  Form_pg_attribute attr,
+						  Datum *p_datum, bool *p_isnull)
+{
+	char	   *value;
+	Oid			typinput;
+	Oid			typioparam;
+
+	if (!lookupHivePartitionValue(filename, NameStr(attr->attname), &value))
+		return false;
+	if (!value)
+	{
+		*p_datum  = 0;
+		*p_isnull = true;
+	}
+	else
+	{
+		getTypeInputInfo(attr->atttypid, &typinput, &typioparam);
+		*p_datum  = OidInputFunctionCall(typinput, value,
+										 typioparam,
+										 attr->atttypmod);
+		*p_isnull = false;
+	}
+	return true;
+}
+
+/*
+ * lookupArrowPendingWrite
+ *
+ * It checks whether the arrow file is being written by an in-progress
+ * transaction, and returns its committed state if any.
+ */
+static bool
+lookupArrowPendingWrite(struct stat *stat_buf, arrowPendingWrite *result)
+{
+	bool	found = false;
+
+	if (arrow_metadata_cache->num_pending == 0)
+		return false;
+	SpinLockAcquire(&arrow_metadata_cache->pending_lock);
+	for (int i=0; i < ARROW_PENDING_WRITES_NSLOTS; i++)
+	{
+		arrowPendingWrite *pw = &arrow_metadata_cache->pending[i];
+
+		if (TransactionIdIsValid(pw->xid) &&
+			pw->stat_buf.st_dev == stat_buf->st_dev &&
+			pw->stat_buf.st_ino == stat_buf->st_ino)
+		{
+			memcpy(result, pw, sizeof(arrowPendingWrite));
+			found = true;
+			break;
+		}
+	}
+	SpinLockRelease(&arrow_metadata_cache->pending_lock);
+
+	return found;
+}
+
+/*
+ * __buildArrowFileStateOnPendingWrite
+ *
+ * The record batches appended by the in-progress transaction are invisible
+ * to others, so it builds ArrowFileState from the metadata-cache of the
+ * committed state, registered prior to any writes.
+ */
+static ArrowFileState *
+__buildArrowFileStateOnPendingWrite(const char *filename,
+									arrowPendingWrite *pw,
+									Bitmapset **p_stat_attrs)
+{
+	arrowMetadataCache *mcache;
+	ArrowFileState *af_state;
+
+	if (TransactionIdIsCurrentTransactionId(pw->xid))
+		return __buildArrowFileStateByFile(filename, p_stat_attrs);
+	if (pw->nbatches == 0)
+		return NULL;
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
+	mcache = lookupArrowMetadataCache(&pw->stat_buf, false);
+	if (!mcache)
+	{
+		LWLockRelease(&arrow_metadata_cache->mutex);
+		ereport(ERROR,
+				(errcode(ERRCODE_LOCK_NOT_AVAILABLE),
+				 errmsg("arrow_fdw: '%s' is being written by the concurrent transaction, and its metadata-cache was already evicted",
+						filename)));
+	}
+	af_state = __buildArrowFileStateByCache(filename, mcache, p_stat_attrs);
+	LWLockRelease(&arrow_metadata_cache->mutex);
+	/* cut off the record batches in-progress */
+	af_state->rb_list = list_truncate(af_state->rb_list, pw->nbatches);
+
+	return af_state;
+}
+
 static ArrowFileState *
 BuildArrowFileState(Relation frel, const char *filename, Bitmapset **p_stat_attrs)
 {
 	arrowMetadataCache *mcache;
 	ArrowFileState *af_state;
 	RecordBatchState *rb_state;
+	arrowPendingWrite pw;
 	struct stat		stat_buf;
 	TupleDesc		tupdesc;
 
 	if (stat(filename, &stat_buf) != 0)
 		elog(ERROR, "failed on stat('%s'): %m", filename);
+	if (lookupArrowPendingWrite(&stat_buf, &pw))
+	{
+		af_state = __buildArrowFileStateOnPendingWrite(filename, &pw,
+													   p_stat_attrs);
+		if (!af_state)
+			return NULL;
+		goto compatibility_checks;
+	}
 	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
 	mcache = lookupArrowMetadataCache(&stat_buf, false);
 	if (mcache)
@@ -1943,7 +2254,9 @@ BuildArrowFileState(Relation frel, const char *filename, Bitmapset **p_stat_attr
 		LWLockRelease(&arrow_metadata_cache->mutex);
 
 		/* here is no valid metadata-cache, so build it from the raw file */
-		af_state = __buildArrowFileStateByFile(filename, p_stat_attrs);
+		af_state = __buildArrowFileStateByTail(filename, &stat_buf);
+		if (!af_state)
+			af_state = __buildArrowFileStateByFile(filename, p_stat_attrs);
 		if (!af_state)
 			return NULL;	/* file not found? */
 
@@ -1954,13 +2267,38 @@ BuildArrowFileState(Relation frel, const char *filename, Bitmapset **p_stat_attr
 	}
 	LWLockRelease(&arrow_metadata_cache->mutex);
 
-	/* compatibility checks */
+compatibility_checks:
 	rb_state = linitial(af_state->rb_list);
 	tupdesc = RelationGetDescr(frel);
-	if (tupdesc->natts != rb_state->nfields)
+	if (tupdesc->natts < rb_state->nfields)
 		elog(ERROR, "arrow_fdw: foreign table '%s' is not compatible to '%s'",
 			 RelationGetRelationName(frel), filename);
-	for (int j=0; j < tupdesc->natts; j++)
+	/* the tail columns should be virtual partition columns */
+	if (tupdesc->natts > rb_state->nfields)
+	{
+		af_state->nvirtuals = tupdesc->natts - rb_state->nfields;
+		af_state->virt_values = palloc0(sizeof(Datum) * af_state->nvirtuals);
+		af_state->virt_isnull = palloc0(sizeof(bool)  * af_state->nvirtuals);
+		for (int j=rb_state->nfields; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute	attr = TupleDescAttr(tupdesc, j);
+			int		k = j - rb_state->nfields;
+
+			if (attr->attisdropped)
+			{
+				af_state->virt_isnull[k] = true;
+				continue;
+			}
+			if (!__fetchHivePartitionDatum(filename, attr,
+										   &af_state->virt_values[k],
+										   &af_state->virt_isnull[k]))
+				elog(ERROR, "arrow_fdw: foreign table '%s' column '%s' is neither a field of '%s' nor a partition key of the path",
+					 RelationGetRelationName(frel),
+					 NameStr(attr->attname),
+					 filename);
+		}
+	}
+	for (int j=0; j < rb_state->nfields; j++)
 	{
 		Form_pg_attribute	attr = TupleDescAttr(tupdesc, j);
 		RecordBatchFieldState *rb_field = &rb_state->fields[j];
@@ -1976,6 +2314,175 @@ BuildArrowFileState(Relation frel, const char *filename, Bitmapset **p_stat_attr
 	return af_state;
 }
 
+/* ----------------------------------------------------------------
+ *
+ * Parallel metadata-cache loader
+ *
+ * When a foreign table maps many arrow files (usually, by 'dir' option),
+ * parsing of the footers one-by-one dominates the query startup time.
+ * So, it launches parallel workers to build the metadata-cache of the
+ * cache-missed files prior to BuildArrowFileState() by the leader.
+ * ----------------------------------------------------------------
+ */
+#define ARROW_METADATA_PARALLEL_KEY			0xa770f5c1e0000001UL
+#define ARROW_METADATA_PARALLEL_MIN_FILES	8	/* min # of files per worker */
+
+typedef struct
+{
+	pg_atomic_uint32 file_index;	/* next file to be parsed */
+	uint32_t	nfiles;
+	uint32_t	fname_offset[FLEXIBLE_ARRAY_MEMBER];
+} arrowMetadataParallelState;
+
+static void
+__preloadArrowMetadataCacheOne(const char *filename)
+{
+	arrowMetadataCache *mcache;
+	ArrowFileState *af_state;
+	arrowPendingWrite pw;
+	struct stat		stat_buf;
+
+	if (stat(filename, &stat_buf) != 0)
+		return;		/* leader will report the error later */
+	if (lookupArrowPendingWrite(&stat_buf, &pw))
+		return;		/* committed state is already cached by the writer */
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
+	mcache = lookupArrowMetadataCache(&stat_buf, false);
+	LWLockRelease(&arrow_metadata_cache->mutex);
+	if (mcache)
+		return;		/* already built by the concurrent session */
+
+	af_state = __buildArrowFileStateByTail(filename, &stat_buf);
+	if (!af_state)
+		af_state = __buildArrowFileStateByFile(filename, NULL);
+	if (!af_state)
+		return;
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_EXCLUSIVE);
+	mcache = lookupArrowMetadataCache(&af_state->stat_buf, true);
+	if (!mcache)
+		__buildArrowMetadataCacheNoLock(af_state);
+	LWLockRelease(&arrow_metadata_cache->mutex);
+}
+
+static void
+__preloadArrowMetadataCacheLoop(arrowMetadataParallelState *pm_state)
+{
+	MemoryContext	memcxt;
+	MemoryContext	oldcxt;
+	uint32_t		index;
+
+	memcxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "arrow metadata preloader",
+								   ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(memcxt);
+	for (;;)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		index = pg_atomic_fetch_add_u32(&pm_state->file_index, 1);
+		if (index >= pm_state->nfiles)
+			break;
+		__preloadArrowMetadataCacheOne((const char *)pm_state +
+									   pm_state->fname_offset[index]);
+		MemoryContextReset(memcxt);
+	}
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(memcxt);
+}
+
+/*
+ * pgstromArrowFdwMetadataWorkerMain - entrypoint of the parallel worker
+ */
+PUBLIC_FUNCTION(void)
+pgstromArrowFdwMetadataWorkerMain(dsm_segment *seg, shm_toc *toc)
+{
+	arrowMetadataParallelState *pm_state;
+
+	pm_state = shm_toc_lookup(toc, ARROW_METADATA_PARALLEL_KEY, false);
+	__preloadArrowMetadataCacheLoop(pm_state);
+}
+
+static void
+arrowFdwPreloadMetadataCache(List *filesList)
+{
+	ParallelContext *pcxt;
+	arrowMetadataParallelState *pm_state;
+	List	   *missList = NIL;
+	ListCell   *lc;
+	size_t		sz;
+	char	   *pos;
+	int			nworkers;
+	uint32_t	i;
+
+	if (arrow_metadata_parallel_workers <= 0 ||
+		IsParallelWorker() ||
+		!IsUnderPostmaster ||
+		!ActiveSnapshotSet() ||
+		list_length(filesList) < 2 * ARROW_METADATA_PARALLEL_MIN_FILES)
+		return;
+
+	/* pick up the files that have no valid metadata-cache */
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
+	foreach (lc, filesList)
+	{
+		char	   *fname = strVal(lfirst(lc));
+		struct stat	stat_buf;
+
+		if (stat(fname, &stat_buf) != 0)
+			continue;
+		if (!lookupArrowMetadataCache(&stat_buf, false))
+			missList = lappend(missList, fname);
+	}
+	LWLockRelease(&arrow_metadata_cache->mutex);
+
+	nworkers = Min(list_length(missList) / ARROW_METADATA_PARALLEL_MIN_FILES,
+				   arrow_metadata_parallel_workers);
+	if (nworkers < 1)
+	{
+		list_free(missList);
+		return;
+	}
+
+	/* setup the shared state */
+	sz = offsetof(arrowMetadataParallelState, fname_offset[list_length(missList)]);
+	foreach (lc, missList)
+		sz += strlen((char *)lfirst(lc)) + 1;
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("pg_strom",
+								 "pgstromArrowFdwMetadataWorkerMain",
+								 nworkers);
+	shm_toc_estimate_chunk(&pcxt->estimator, sz);
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+	InitializeParallelDSM(pcxt);
+
+	pm_state = shm_toc_allocate(pcxt->toc, sz);
+	pg_atomic_init_u32(&pm_state->file_index, 0);
+	pm_state->nfiles = list_length(missList);
+	pos = (char *)&pm_state->fname_offset[pm_state->nfiles];
+	i = 0;
+	foreach (lc, missList)
+	{
+		const char *fname = lfirst(lc);
+
+		pm_state->fname_offset[i++] = (pos - (char *)pm_state);
+		strcpy(pos, fname);
+		pos += strlen(fname) + 1;
+	}
+	shm_toc_insert(pcxt->toc, ARROW_METADATA_PARALLEL_KEY, pm_state);
+
+	/* launch the workers; the leader also parses the files */
+	LaunchParallelWorkers(pcxt);
+	elog(DEBUG2, "arrow_fdw: parsing %u files by %d parallel workers",
+		 pm_state->nfiles, pcxt->nworkers_launched);
+	__preloadArrowMetadataCacheLoop(pm_state);
+	WaitForParallelWorkersToFinish(pcxt);
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+	list_free(missList);
+}
+
 /*
  * baseRelIsArrowFdw
  */
@@ -2011,6 +2518,23 @@ RelationIsArrowFdw(Relation frel)
 	return false;
 }
 
+/*
+ * baseRelHasArrowVirtualRefs
+ *
+ * It checks whether the scan on the arrow_fdw references any virtual
+ * partition columns; that are not supported by the xPU devices.
+ */
+bool
+baseRelHasArrowVirtualRefs(RelOptInfo *baserel)
+{
+	List	   *priv_list = (List *)baserel->fdw_private;
+
+	if (baseRelIsArrowFdw(baserel) &&
+		IsA(priv_list, List) && list_length(priv_list) == 3)
+		return (intVal(lthird(priv_list)) != 0);
+	return false;
+}
+
 /*
  * GetOptimalGpusForArrowFdw
  */
@@ -2021,7 +2545,7 @@ GetOptimalGpusForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
 	Bitmapset  *optimal_gpus = NULL;
 
 	if (baseRelIsArrowFdw(baserel) &&
-		IsA(priv_list, List) && list_length(priv_list) == 2)
+		IsA(priv_list, List) && list_length(priv_list) == 3)
 	{
 		List	   *af_list = linitial(priv_list);
 		ListCell   *lc;
@@ -2051,7 +2575,7 @@ GetOptimalDpuForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
 	List	   *priv_list = (List *)baserel->fdw_private;
 
 	if (baseRelIsArrowFdw(baserel) &&
-		IsA(priv_list, List) && list_length(priv_list) == 2)
+		IsA(priv_list, List) && list_length(priv_list) == 3)
 	{
 		List	   *af_list = linitial(priv_list);
 		ListCell   *lc;
@@ -2072,31 +2596,30 @@ GetOptimalDpuForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
 }
 
 /*
- * arrowFdwExtractFilesList
+ * __arrowFdwExtractWritableFile
+ *
+ * It returns the pathname of the arrow file if 'writable' option is
+ * enabled, or NULL elsewhere.
  */
-static List *
-arrowFdwExtractFilesList(List *options_list,
-						 int *p_parallel_nworkers)
+static const char *
+__arrowFdwExtractWritableFile(List *options_list)
 {
-
 	ListCell   *lc;
-	List	   *filesList = NIL;
-	char	   *dir_path = NULL;
-	char	   *dir_suffix = NULL;
-	int			parallel_nworkers = -1;
+	char	   *filename = NULL;
+	bool		writable = false;
+	bool		has_dir = false;
+	int			nfiles = 0;
 
 	foreach (lc, options_list)
 	{
 		DefElem	   *defel = lfirst(lc);
 
-		Assert(IsA(defel->arg, String));
-		if (strcmp(defel->defname, "file") == 0)
+		if (strcmp(defel->defname, "writable") == 0)
+			writable = defGetBoolean(defel);
+		else if (strcmp(defel->defname, "file") == 0)
 		{
-			char   *temp = strVal(defel->arg);
-
-			if (access(temp, R_OK) != 0)
-				elog(ERROR, "arrow_fdw: unable to access '%s': %m", temp);
-			filesList = lappend(filesList, makeString(pstrdup(temp)));
+			filename = strVal(defel->arg);
+			nfiles++;
 		}
 		else if (strcmp(defel->defname, "files") == 0)
 		{
@@ -2104,26 +2627,151 @@ arrowFdwExtractFilesList(List *options_list,
 			char   *saveptr;
 			char   *tok;
 
-			while ((tok = strtok_r(temp, ",", &saveptr)) != NULL)
+			for (tok = strtok_r(temp, ",", &saveptr);
+				 tok != NULL;
+				 tok = strtok_r(NULL, ",", &saveptr))
 			{
-				tok = __trim(tok);
-
-				if (*tok != '/')
-					elog(ERROR, "arrow_fdw: file '%s' must be absolute path", tok);
-				if (access(tok, R_OK) != 0)
-					elog(ERROR, "arrow_fdw: unable to access '%s': %m", tok);
-				filesList = lappend(filesList, makeString(pstrdup(tok)));
+				filename = __trim(tok);
+				nfiles++;
 			}
-			pfree(temp);
 		}
 		else if (strcmp(defel->defname, "dir") == 0)
-		{
-			dir_path = strVal(defel->arg);
-			if (*dir_path != '/')
-				elog(ERROR, "arrow_fdw: dir '%s' must be absolute path", dir_path);
-		}
-		else if (strcmp(defel->defname, "suffix") == 0)
-		{
+			has_dir = true;
+	}
+	if (!writable)
+		return NULL;
+	if (nfiles != 1 || has_dir)
+		elog(ERROR, "arrow_fdw: writable foreign table accepts only one pathname by 'file' or 'files', and cannot use 'dir' option");
+	if (*filename != '/')
+		elog(ERROR, "arrow_fdw: file '%s' must be absolute path", filename);
+	return filename;
+}
+
+/*
+ * __arrowFdwWritableFileIsEmpty
+ *
+ * Writable foreign table may map an arrow file not created yet.
+ */
+static bool
+__arrowFdwWritableFileIsEmpty(const char *filename)
+{
+	struct stat	stat_buf;
+
+	if (stat(filename, &stat_buf) != 0)
+		return (errno == ENOENT);
+	return (stat_buf.st_size == 0);
+}
+
+/*
+ * arrowFdwExtractFilesList
+ */
+static List *
+__arrowFdwExtractDirFiles(List *filesList,
+						  const char *dir_path,
+						  const char *dir_suffix)
+{
+	struct dirent *dentry;
+	DIR	   *dir;
+	char   *temp;
+
+	dir = AllocateDir(dir_path);
+	while ((dentry = ReadDir(dir, dir_path)) != NULL)
+	{
+		struct stat	stat_buf;
+
+		/* also skips the undo files of the writable foreign table */
+		if (dentry->d_name[0] == '.')
+			continue;
+		temp = psprintf("%s/%s", dir_path, dentry->d_name);
+		/* walk down to the hive-style partition directory */
+		if (strchr(dentry->d_name, '=') != NULL &&
+			stat(temp, &stat_buf) == 0 &&
+			S_ISDIR(stat_buf.st_mode))
+		{
+			filesList = __arrowFdwExtractDirFiles(filesList, temp, dir_suffix);
+			pfree(temp);
+			continue;
+		}
+		if (dir_suffix)
+		{
+			char   *pos = strrchr(dentry->d_name, '.');
+
+			if (!pos || strcmp(pos+1, dir_suffix) != 0)
+			{
+				pfree(temp);
+				continue;
+			}
+		}
+		if (access(temp, R_OK) != 0)
+		{
+			elog(DEBUG1, "arrow_fdw: unable to read '%s', so skipped", temp);
+			pfree(temp);
+			continue;
+		}
+		filesList = lappend(filesList, makeString(temp));
+	}
+	FreeDir(dir);
+
+	return filesList;
+}
+
+static List *
+arrowFdwExtractFilesList(List *options_list,
+						 int *p_parallel_nworkers)
+{
+
+	ListCell   *lc;
+	List	   *filesList = NIL;
+	const char *writable_file = __arrowFdwExtractWritableFile(options_list);
+	char	   *dir_path = NULL;
+	char	   *dir_suffix = NULL;
+	int			parallel_nworkers = -1;
+
+	foreach (lc, options_list)
+	{
+		DefElem	   *defel = lfirst(lc);
+
+		Assert(IsA(defel->arg, String));
+		if (strcmp(defel->defname, "file") == 0)
+		{
+			char   *temp = strVal(defel->arg);
+
+			if (writable_file && __arrowFdwWritableFileIsEmpty(temp))
+				continue;
+			if (access(temp, R_OK) != 0)
+				elog(ERROR, "arrow_fdw: unable to access '%s': %m", temp);
+			filesList = lappend(filesList, makeString(pstrdup(temp)));
+		}
+		else if (strcmp(defel->defname, "files") == 0)
+		{
+			char   *temp = pstrdup(strVal(defel->arg));
+			char   *saveptr;
+			char   *tok;
+
+			for (tok = strtok_r(temp, ",", &saveptr);
+				 tok != NULL;
+				 tok = strtok_r(NULL, ",", &saveptr))
+			{
+				tok = __trim(tok);
+
+				if (*tok != '/')
+					elog(ERROR, "arrow_fdw: file '%s' must be absolute path", tok);
+				if (writable_file && __arrowFdwWritableFileIsEmpty(tok))
+					continue;
+				if (access(tok, R_OK) != 0)
+					elog(ERROR, "arrow_fdw: unable to access '%s': %m", tok);
+				filesList = lappend(filesList, makeString(pstrdup(tok)));
+			}
+			pfree(temp);
+		}
+		else if (strcmp(defel->defname, "dir") == 0)
+		{
+			dir_path = strVal(defel->arg);
+			if (*dir_path != '/')
+				elog(ERROR, "arrow_fdw: dir '%s' must be absolute path", dir_path);
+		}
+		else if (strcmp(defel->defname, "suffix") == 0)
+		{
 			dir_suffix = strVal(defel->arg);
 		}
 		else if (strcmp(defel->defname, "parallel_workers") == 0)
@@ -2132,6 +2780,10 @@ arrowFdwExtractFilesList(List *options_list,
 				elog(ERROR, "'parallel_workers' appeared twice");
 			parallel_nworkers = atoi(strVal(defel->arg));
 		}
+		else if (strcmp(defel->defname, "writable") == 0)
+		{
+			/* validated by __arrowFdwExtractWritableFile */
+		}
 		else
 			elog(ERROR, "arrow: unknown option (%s)", defel->defname);
 	}
@@ -2139,37 +2791,184 @@ arrowFdwExtractFilesList(List *options_list,
 		elog(ERROR, "arrow: cannot use 'suffix' option without 'dir'");
 
 	if (dir_path)
+		filesList = __arrowFdwExtractDirFiles(filesList, dir_path, dir_suffix);
+
+	if (p_parallel_nworkers)
+		*p_parallel_nworkers = parallel_nworkers;
+	return filesList;
+}
+
+/*
+ * arrowFdwPruneHivePartitions
+ *
+ * It removes the arrow files whose partition values (the 'key=value'
+ * components of the pathname) never satisfy the qualifiers, prior to
+ * read any footers of the files.
+ * Only qualifiers that reference nothing but the partition columns are
+ * used for pruning. If 'ps' is NULL (planning time), qualifiers that
+ * contain Params are not used because we cannot evaluate them.
+ */
+static bool
+__contain_unknown_params_walker(Node *node, void *context)
+{
+	if (!node)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param  *param = (Param *)node;
+
+		if (!context || param->paramkind != PARAM_EXTERN)
+			return true;
+	}
+	return expression_tree_walker(node, __contain_unknown_params_walker, context);
+}
+
+static List *
+arrowFdwPruneHivePartitions(Relation frel,
+							Index relid,
+							List *filesList,
+							List *quals,
+							PlanState *ps,
+							List **p_prune_quals,
+							int *p_nfiles_pruned)
+{
+	TupleDesc	tupdesc = RelationGetDescr(frel);
+	Bitmapset  *part_attrs = NULL;
+	List	   *part_keys = NIL;
+	List	   *prune_quals = NIL;
+	List	   *prune_attrs = NIL;
+	List	   *prune_states = NIL;
+	List	   *results = NIL;
+	EState	   *estate = NULL;
+	ExprContext *econtext;
+	TupleTableSlot *slot;
+	MemoryContext oldcxt;
+	ListCell   *lc1, *lc2, *lc3;
+	int			nfiles_pruned = 0;
+
+	/* pick up the partition keys in the pathname */
+	foreach (lc1, filesList)
 	{
-		struct dirent *dentry;
-		DIR	   *dir;
-		char   *temp;
+		char   *fname = pstrdup(strVal(lfirst(lc1)));
+		char   *base = strrchr(fname, '/');
+		char   *tok, *pos, *saveptr;
 
-		dir = AllocateDir(dir_path);
-		while ((dentry = ReadDir(dir, dir_path)) != NULL)
+		if (!base)
+			continue;
+		*base = '\0';
+		for (tok = strtok_r(fname, "/", &saveptr);
+			 tok != NULL;
+			 tok = strtok_r(NULL, "/", &saveptr))
 		{
-			if (strcmp(dentry->d_name, ".") == 0 ||
-				strcmp(dentry->d_name, "..") == 0)
+			pos = strchr(tok, '=');
+			if (!pos || pos == tok)
 				continue;
-			if (dir_suffix)
-			{
-				char   *pos = strrchr(dentry->d_name, '.');
+			*pos = '\0';
+			if (!list_member(part_keys, makeString(tok)))
+				part_keys = lappend(part_keys, makeString(pstrdup(tok)));
+		}
+		pfree(fname);
+	}
+	if (part_keys == NIL)
+		goto out;
+	for (int j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
 
-				if (!pos || strcmp(pos+1, dir_suffix) != 0)
-					continue;
-			}
-			temp = psprintf("%s/%s", dir_path, dentry->d_name);
-			if (access(temp, R_OK) != 0)
+		if (!attr->attisdropped &&
+			list_member(part_keys, makeString(NameStr(attr->attname))))
+			part_attrs = bms_add_member(part_attrs, attr->attnum -
+										FirstLowInvalidHeapAttributeNumber);
+	}
+	if (!part_attrs)
+		goto out;
+
+	/* qualifiers that are available for pruning */
+	foreach (lc1, quals)
+	{
+		Expr	   *qual = lfirst(lc1);
+		Bitmapset  *attrs = NULL;
+
+		pull_varattnos((Node *)qual, relid, &attrs);
+		if (!attrs || !bms_is_subset(attrs, part_attrs) ||
+			contain_volatile_functions((Node *)qual) ||
+			contain_subplans((Node *)qual) ||
+			__contain_unknown_params_walker((Node *)qual, ps))
+			continue;
+		prune_quals = lappend(prune_quals, qual);
+		prune_attrs = lappend(prune_attrs, attrs);
+	}
+	if (prune_quals == NIL)
+		goto out;
+
+	/* evaluate the qualifiers for each file */
+	if (ps)
+		econtext = ps->ps_ExprContext;
+	else
+	{
+		estate = CreateExecutorState();
+		econtext = GetPerTupleExprContext(estate);
+	}
+	foreach (lc1, prune_quals)
+	{
+		List	   *qlist = list_make1(lfirst(lc1));
+
+		if (ps)
+			prune_states = lappend(prune_states, ExecInitQual(qlist, ps));
+		else
+			prune_states = lappend(prune_states, ExecPrepareQual(qlist, estate));
+	}
+	slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+	econtext->ecxt_scantuple = slot;
+
+	foreach (lc1, filesList)
+	{
+		const char *fname = strVal(lfirst(lc1));
+		bool		pruned = false;
+
+		forboth (lc2, prune_states,
+				 lc3, prune_attrs)
+		{
+			ExprState  *qual_state = lfirst(lc2);
+			Bitmapset  *attrs = lfirst(lc3);
+			int			j, k;
+
+			ExecStoreAllNullTuple(slot);
+			oldcxt = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+			for (k = bms_next_member(attrs, -1);
+				 k >= 0;
+				 k = bms_next_member(attrs, k))
 			{
-				elog(DEBUG1, "arrow_fdw: unable to read '%s', so skipped", temp);
-				continue;
+				j = k + FirstLowInvalidHeapAttributeNumber;
+				if (!__fetchHivePartitionDatum(fname,
+											   TupleDescAttr(tupdesc, j-1),
+											   &slot->tts_values[j-1],
+											   &slot->tts_isnull[j-1]))
+					break;
 			}
-			filesList = lappend(filesList, makeString(temp));
+			MemoryContextSwitchTo(oldcxt);
+			/* unable to prune, if any partition key is not in the pathname */
+			if (k < 0 && !ExecQual(qual_state, econtext))
+				pruned = true;
+			ResetExprContext(econtext);
+			if (pruned)
+				break;
 		}
-		FreeDir(dir);
+		if (pruned)
+			nfiles_pruned++;
+		else
+			results = lappend(results, lfirst(lc1));
 	}
-
-	if (p_parallel_nworkers)
-		*p_parallel_nworkers = parallel_nworkers;
+	ExecDropSingleTupleTableSlot(slot);
+	econtext->ecxt_scantuple = NULL;
+	if (estate)
+		FreeExecutorState(estate);
+	filesList = results;
+out:
+	if (p_prune_quals)
+		*p_prune_quals = prune_quals;
+	if (p_nfiles_pruned)
+		*p_nfiles_pruned = nfiles_pruned;
 	return filesList;
 }
 
@@ -2346,7 +3145,7 @@ arrowFdwSetupIOvector(RecordBatchState *rb_state,
 
 	Assert(kds->format == KDS_FORMAT_ARROW &&
 		   kds->ncols <= kds->nr_colmeta &&
-		   kds->ncols == rb_state->nfields);
+		   kds->ncols >= rb_state->nfields);
 	con = alloca(offsetof(arrowFdwSetupIOContext,
 						  ioc[3 * kds->nr_colmeta]));
 	con->rb_offset = rb_state->rb_offset;
@@ -2361,7 +3160,9 @@ arrowFdwSetupIOvector(RecordBatchState *rb_state,
 		kern_colmeta *cmeta = &kds->colmeta[j];
 		int			attidx = j + 1 - FirstLowInvalidHeapAttributeNumber;
 
-		if (bms_is_member(attidx, referenced) ||
+		if (j >= rb_state->nfields)
+			cmeta->atttypkind = TYPE_KIND__NULL;	/* virtual column */
+		else if (bms_is_member(attidx, referenced) ||
 			bms_is_member(-FirstLowInvalidHeapAttributeNumber, referenced))
 			arrowFdwSetupIOvectorField(con, rb_field, kds, cmeta);
 		else
@@ -2470,8 +3271,8 @@ arrowFdwLoadRecordBatch(Relation relation,
 	setup_kern_data_store(kds, tupdesc, 0, KDS_FORMAT_ARROW);
 	kds->nitems = rb_state->rb_nitems;
 	kds->table_oid = RelationGetRelid(relation);
-	Assert(kds->ncols == rb_state->nfields);
-	for (int j=0; j < kds->ncols; j++)
+	Assert(kds->ncols >= rb_state->nfields);
+	for (int j=0; j < rb_state->nfields; j++)
 		__arrowKdsAssignAttrOptions(kds,
 									&kds->colmeta[j],
 									&rb_state->fields[j]);
@@ -2576,10 +3377,14 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 	Relation		frel = table_open(foreigntableid, NoLock);
 	List		   *filesList;
 	List		   *results = NIL;
+	List		   *quals = NIL;
+	List		   *prune_quals = NIL;
+	List		   *other_rinfos = NIL;
 	Bitmapset	   *referenced = NULL;
 	ListCell	   *lc1, *lc2;
 	size_t			totalLen = 0;
 	double			ntuples = 0.0;
+	bool			virtual_refs = false;
 	int				parallel_nworkers;
 
 	/* columns to be referenced */
@@ -2588,11 +3393,16 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 		RestrictInfo   *rinfo = lfirst(lc1);
 
 		pull_varattnos((Node *)rinfo->clause, baserel->relid, &referenced);
+		quals = lappend(quals, rinfo->clause);
 	}
 	referenced = pickup_outer_referenced(root, baserel, referenced);
 
 	/* read arrow-file metadta */
 	filesList = arrowFdwExtractFilesList(ft->options, &parallel_nworkers);
+	filesList = arrowFdwPruneHivePartitions(frel, baserel->relid,
+											filesList, quals, NULL,
+											&prune_quals, NULL);
+	arrowFdwPreloadMetadataCache(filesList);
 	foreach (lc1, filesList)
 	{
 		ArrowFileState *af_state;
@@ -2602,6 +3412,18 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 		if (!af_state)
 			continue;
 
+		/* does the scan reference virtual partition columns? */
+		if (af_state->nvirtuals > 0 && !virtual_refs)
+		{
+			int		nfields = (RelationGetDescr(frel)->natts -
+							   af_state->nvirtuals);
+
+			if (bms_is_member(-FirstLowInvalidHeapAttributeNumber, referenced) ||
+				bms_next_member(referenced, nfields -
+								FirstLowInvalidHeapAttributeNumber) >= 0)
+				virtual_refs = true;
+		}
+
 		/*
 		 * Size calculation based the record-batch metadata
 		 */
@@ -2634,14 +3456,27 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 	}
 	table_close(frel, NoLock);
 
-	/* setup baserel */
+	/*
+	 * setup baserel
+	 *
+	 * NOTE: the qualifiers used for partition pruning are already applied
+	 * on the number of tuples, so selectivity shall be estimated by others.
+	 */
+	foreach (lc1, baserel->baserestrictinfo)
+	{
+		RestrictInfo   *rinfo = lfirst(lc1);
+
+		if (!list_member_ptr(prune_quals, rinfo->clause))
+			other_rinfos = lappend(other_rinfos, rinfo);
+	}
 	baserel->rel_parallel_workers = parallel_nworkers;
-	baserel->fdw_private = list_make2(results, referenced);
+	baserel->fdw_private = list_make3(results, referenced,
+									  makeInteger(virtual_refs));
 	baserel->pages = totalLen / BLCKSZ;
 	baserel->tuples = ntuples;
 	baserel->rows = ntuples *
 		clauselist_selectivity(root,
-							   baserel->baserestrictinfo,
+							   other_rinfos,
 							   0,
 							   JOIN_INNER,
 							   NULL);
@@ -3381,7 +4216,7 @@ kds_arrow_fetch_tuple(TupleTableSlot *slot,
 		 k = bms_next_member(referenced, k))
 	{
 		j = k + FirstLowInvalidHeapAttributeNumber - 1;
-		if (j < 0)
+		if (j < 0 || kds->colmeta[j].atttypkind == TYPE_KIND__NULL)
 			continue;
 		pg_datum_arrow_ref(kds,
 						   &kds->colmeta[j],
@@ -3412,6 +4247,7 @@ __arrowFdwExecInit(ScanState *ss,
 	Relation		frel = ss->ss_currentRelation;
 	TupleDesc		tupdesc = RelationGetDescr(frel);
 	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
+	Index			scanrelid = ((Scan *)ss->ps.plan)->scanrelid;
 	Bitmapset	   *referenced = NULL;
 	Bitmapset	   *stat_attrs = NULL;
 	Bitmapset	   *optimal_gpus = NULL;
@@ -3421,6 +4257,7 @@ __arrowFdwExecInit(ScanState *ss,
 	List		   *af_states_list = NIL;
 	uint32_t		rb_nrooms = 0;
 	uint32_t		rb_nitems = 0;
+	int				nfiles_pruned = 0;
 	ArrowFdwState *arrow_state;
 	ListCell	   *lc1, *lc2;
 
@@ -3441,6 +4278,10 @@ __arrowFdwExecInit(ScanState *ss,
 
 	/* setup ArrowFileState */
 	filesList = arrowFdwExtractFilesList(ft->options, NULL);
+	filesList = arrowFdwPruneHivePartitions(frel, scanrelid,
+											filesList, outer_quals, &ss->ps,
+											NULL, &nfiles_pruned);
+	arrowFdwPreloadMetadataCache(filesList);
 	foreach (lc1, filesList)
 	{
 		char	   *fname = strVal(lfirst(lc1));
@@ -3489,6 +4330,7 @@ __arrowFdwExecInit(ScanState *ss,
 	arrow_state->curr_kds   = NULL;
 	arrow_state->curr_index = 0;
 	arrow_state->af_states_list = af_states_list;
+	arrow_state->nfiles_pruned = nfiles_pruned;
 	foreach (lc1, af_states_list)
 	{
 		ArrowFileState *af_state = lfirst(lc1);
@@ -3672,12 +4514,27 @@ ArrowIterateForeignScan(ForeignScanState *node)
 										arrow_state->referenced,
 										rb_state,
 										&arrow_state->chunk_buffer);
+		arrow_state->curr_af_state = rb_state->af_state;
 	}
 	Assert(kds && arrow_state->curr_index < kds->nitems);
 	if (kds_arrow_fetch_tuple(slot, kds,
 							  arrow_state->curr_index++,
 							  arrow_state->referenced))
+	{
+		ArrowFileState *af_state = arrow_state->curr_af_state;
+
+		/* fill up virtual partition columns, if any */
+		if (af_state->nvirtuals > 0)
+		{
+			int		base = slot->tts_tupleDescriptor->natts - af_state->nvirtuals;
+
+			memcpy(slot->tts_values + base, af_state->virt_values,
+				   sizeof(Datum) * af_state->nvirtuals);
+			memcpy(slot->tts_isnull + base, af_state->virt_isnull,
+				   sizeof(bool) * af_state->nvirtuals);
+		}
 		return slot;
+	}
 	return NULL;
 }
 
@@ -3873,6 +4730,11 @@ pgstromArrowFdwExplain(ArrowFdwState *arrow_state,
 		ExplainPropertyText("Stats-Hint", buf.data, es);
 	}
 
+	/* shows number of files pruned by the partition keys, if any */
+	if (arrow_state->nfiles_pruned > 0)
+		ExplainPropertyInteger("Pruned-Files", NULL,
+							   arrow_state->nfiles_pruned, es);
+
 	/* shows files on behalf of the foreign table */
 	chunk_sz = alloca(sizeof(size_t) * tupdesc->natts);
 	memset(chunk_sz, 0, sizeof(size_t) * tupdesc->natts);
@@ -3901,7 +4763,7 @@ pgstromArrowFdwExplain(ArrowFdwState *arrow_state,
 					 k = bms_next_member(arrow_state->referenced, k))
 				{
 					j = k + FirstLowInvalidHeapAttributeNumber - 1;
-					if (j < 0 || j >=  tupdesc->natts)
+					if (j < 0 || j >= rb_state->nfields)
 						continue;
 					sz = __recordBatchFieldLength(&rb_state->fields[j]);
 					read_sz += sz;
@@ -3976,147 +4838,2193 @@ ArrowExplainForeignScan(ForeignScanState *node, ExplainState *es)
 
 /*
  * ArrowAnalyzeForeignTable
+ *
+ * ANALYZE picks up only a few thousand rows from the record batches, so it
+ * does not load the entire record batch. Instead, the KDS is mapped on the
+ * anonymous memory; reserved but not populated, then only the pages of
+ * the column buffers that contain the sampled rows are read. Variable-
+ * length values and array elements are loaded in two steps; the offsets
+ * first, then the portion of the extra (or child) buffer pointed by them.
+ * Columns that are all NULL, or constant according to the min/max
+ * statistics, are never read.
  */
-static int
-RecordBatchAcquireSampleRows(Relation relation,
-							 RecordBatchState *rb_state,
-							 HeapTuple *rows,
-							 int nsamples)
+typedef struct
 {
-	TupleDesc		tupdesc = RelationGetDescr(relation);
-	kern_data_store *kds;
-	Bitmapset	   *referenced = NULL;
-	StringInfoData	buffer;
-	Datum		   *values;
-	bool		   *isnull;
-	int				count;
-	uint32_t		index;
+	uint64_t	lo;			/* first index (or byte) of the range */
+	uint64_t	hi;			/* last index (or byte) + 1 of the range */
+} arrowSampleRange;
 
-	/* ANALYZE needs to fetch all the attributes */
-	referenced = bms_make_singleton(-FirstLowInvalidHeapAttributeNumber);
-	initStringInfo(&buffer);
-	kds = arrowFdwFillupRecordBatch(relation,
-									referenced,
-									rb_state,
-									&buffer);
-	values = alloca(sizeof(Datum) * tupdesc->natts);
-	isnull = alloca(sizeof(bool)  * tupdesc->natts);
-	for (count = 0; count < nsamples; count++)
+typedef struct
+{
+	File		filp;
+	const char *filename;
+	kern_data_store *kds;	/* KDS on the anonymous memory */
+	off_t		rb_offset;	/* offset of the record batch body */
+	size_t		nbytes_read;
+} arrowSampleLoadContext;
+
+static void
+__arrowSampleReadPages(arrowSampleLoadContext *scxt,
+					   uint64_t cmeta_offset,
+					   off_t buf_offset,
+					   size_t buf_length,
+					   arrowSampleRange *ranges, int nranges)
+{
+	off_t		f_head = scxt->rb_offset + buf_offset;
+	off_t		f_tail = f_head + buf_length;
+	char	   *m_head = (char *)scxt->kds + __kds_unpack(cmeta_offset);
+	off_t		curr_pos = -1;
+	off_t		curr_end = -1;
+
+	Assert(cmeta_offset != 0);
+	for (int i=0; i <= nranges; i++)
 	{
-		/* fetch a row randomly */
-		index = (double)kds->nitems * drand48();
-		Assert(index < kds->nitems);
+		off_t		f_pos;
+		off_t		f_end;
 
-		for (int j=0; j < kds->ncols; j++)
+		if (i < nranges)
+		{
+			if (ranges[i].lo >= ranges[i].hi)
+				continue;
+			f_pos = Max(PAGE_ALIGN_DOWN(f_head + ranges[i].lo), f_head);
+			f_end = Min(PAGE_ALIGN(f_head + ranges[i].hi), f_tail);
+			if (f_pos >= f_end)
+				continue;
+			if (curr_pos >= 0 && f_pos <= curr_end)
+			{
+				/* merge the overlapped or continuous pages */
+				curr_end = Max(curr_end, f_end);
+				continue;
+			}
+		}
+		/* read the pages merged */
+		while (curr_pos >= 0 && curr_pos < curr_end)
 		{
-			kern_colmeta   *cmeta = &kds->colmeta[j];
+			ssize_t		sz;
 
-			pg_datum_arrow_ref(kds,
-							   cmeta,
-							   index,
-							   values + j,
-							   isnull + j);
+			CHECK_FOR_INTERRUPTS();
+			sz = FileRead(scxt->filp,
+						  m_head + (curr_pos - f_head),
+						  curr_end - curr_pos,
+						  curr_pos,
+						  WAIT_EVENT_DATA_FILE_READ);
+			if (sz > 0)
+			{
+				curr_pos += sz;
+				scxt->nbytes_read += sz;
+			}
+			else if (sz == 0)
+				elog(ERROR, "arrow_fdw: unexpected EOF at '%s' (pos=%lu)",
+					 scxt->filename, curr_pos);
+			else if (errno != EINTR)
+				elog(ERROR, "failed on FileRead('%s', pos=%lu, len=%lu): %m",
+					 scxt->filename, curr_pos, curr_end - curr_pos);
+		}
+		if (i < nranges)
+		{
+			curr_pos = f_pos;
+			curr_end = f_end;
 		}
-		rows[count] = heap_form_tuple(tupdesc, values, isnull);
 	}
-	pfree(buffer.data);
-
-	return count;
 }
 
-static int
-ArrowAcquireSampleRows(Relation relation,
-					   int elevel,
-					   HeapTuple *rows,
-					   int nrooms,
-					   double *p_totalrows,
-					   double *p_totaldeadrows)
+static void
+__arrowSampleLoadField(arrowSampleLoadContext *scxt,
+					   kern_colmeta *cmeta,
+					   RecordBatchFieldState *rb_field,
+					   arrowSampleRange *ranges, int nranges)
 {
-	ForeignTable   *ft = GetForeignTable(RelationGetRelid(relation));
-	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
-	List		   *rb_state_list = NIL;
-	ListCell	   *lc1, *lc2;
-	int64			total_nrows = 0;
-	int64			count_nrows = 0;
-	int				nsamples_min = nrooms / 100;
-	int				nitems = 0;
-
-	foreach (lc1, filesList)
+	kern_data_store *kds = scxt->kds;
+	arrowSampleRange *bytes;
+	int			unitsz = rb_field->attopts.unitsz;
+
+	if (nranges == 0)
+		return;
+	bytes = palloc(sizeof(arrowSampleRange) * nranges);
+	/* nullmap */
+	if (cmeta->nullmap_offset != 0)
 	{
-		ArrowFileState *af_state;
-		char	   *fname = strVal(lfirst(lc1));
-
-		af_state = BuildArrowFileState(relation, fname, NULL);
-		if (!af_state)
-			continue;
-		foreach (lc2, af_state->rb_list)
+		for (int i=0; i < nranges; i++)
 		{
-			RecordBatchState *rb_state = lfirst(lc2);
-
-			if (rb_state->rb_nitems == 0)
-				continue;	/* not reasonable to sample, skipped */
-			total_nrows += rb_state->rb_nitems;
-			rb_state_list = lappend(rb_state_list, rb_state);
+			bytes[i].lo = ranges[i].lo >> 3;
+			bytes[i].hi = (ranges[i].hi + 7) >> 3;
 		}
+		__arrowSampleReadPages(scxt, cmeta->nullmap_offset,
+							   rb_field->nullmap_offset,
+							   rb_field->nullmap_length,
+							   bytes, nranges);
 	}
-	nrooms = Min(nrooms, total_nrows);
+	if (cmeta->values_offset == 0)
+		goto children;
+
+	switch (rb_field->attopts.tag)
+	{
+		case ArrowType__Bool:
+			/* values is bitmap */
+			for (int i=0; i < nranges; i++)
+			{
+				bytes[i].lo = ranges[i].lo >> 3;
+				bytes[i].hi = (ranges[i].hi + 7) >> 3;
+			}
+			__arrowSampleReadPages(scxt, cmeta->values_offset,
+								   rb_field->values_offset,
+								   rb_field->values_length,
+								   bytes, nranges);
+			break;
+
+		case ArrowType__Utf8:
+		case ArrowType__Binary:
+		case ArrowType__LargeUtf8:
+		case ArrowType__LargeBinary:
+		case ArrowType__List:
+			{
+				char	   *base = (char *)kds + __kds_unpack(cmeta->values_offset);
+				size_t		nitems = rb_field->values_length / unitsz;
+
+				/* offsets buffer first */
+				for (int i=0; i < nranges; i++)
+				{
+					bytes[i].lo = ranges[i].lo * unitsz;
+					bytes[i].hi = (ranges[i].hi + 1) * unitsz;
+				}
+				__arrowSampleReadPages(scxt, cmeta->values_offset,
+									   rb_field->values_offset,
+									   rb_field->values_length,
+									   bytes, nranges);
+				/* then, range of the extra buffer or child items */
+				for (int i=0; i < nranges; i++)
+				{
+					if (ranges[i].hi >= nitems)
+						elog(ERROR, "arrow_fdw: offset buffer of '%s' is out of range",
+							 scxt->filename);
+					if (unitsz == sizeof(uint32_t))
+					{
+						bytes[i].lo = ((uint32_t *)base)[ranges[i].lo];
+						bytes[i].hi = ((uint32_t *)base)[ranges[i].hi];
+					}
+					else
+					{
+						bytes[i].lo = ((uint64_t *)base)[ranges[i].lo];
+						bytes[i].hi = ((uint64_t *)base)[ranges[i].hi];
+					}
+				}
+				if (rb_field->attopts.tag == ArrowType__List)
+				{
+					Assert(cmeta->num_subattrs == 1 &&
+						   rb_field->num_children == 1);
+					__arrowSampleLoadField(scxt,
+										   &kds->colmeta[cmeta->idx_subattrs],
+										   &rb_field->children[0],
+										   bytes, nranges);
+				}
+				else if (cmeta->extra_offset != 0)
+				{
+					__arrowSampleReadPages(scxt, cmeta->extra_offset,
+										   rb_field->extra_offset,
+										   rb_field->extra_length,
+										   bytes, nranges);
+				}
+			}
+			break;
+
+		default:
+			/* fixed-length values */
+			Assert(unitsz > 0);
+			for (int i=0; i < nranges; i++)
+			{
+				bytes[i].lo = ranges[i].lo * unitsz;
+				bytes[i].hi = ranges[i].hi * unitsz;
+			}
+			__arrowSampleReadPages(scxt, cmeta->values_offset,
+								   rb_field->values_offset,
+								   rb_field->values_length,
+								   bytes, nranges);
+			break;
+	}
+children:
+	if (rb_field->attopts.tag == ArrowType__Struct)
+	{
+		Assert(cmeta->num_subattrs == rb_field->num_children);
+		for (int j=0; j < cmeta->num_subattrs; j++)
+		{
+			__arrowSampleLoadField(scxt,
+								   &kds->colmeta[cmeta->idx_subattrs + j],
+								   &rb_field->children[j],
+								   ranges, nranges);
+		}
+	}
+	pfree(bytes);
+}
+
+/*
+ * __arrowSampleConstantDatum
+ *
+ * It returns true, if all the values of the field in the record batch are
+ * identical (or NULL) according to the null_count and min/max statistics.
+ */
+static bool
+__arrowSampleConstantDatum(RecordBatchFieldState *rb_field,
+						   Datum *p_datum, bool *p_isnull)
+{
+	MinMaxStatDatum *stat = &rb_field->stat_datum;
+
+	if (rb_field->null_count == rb_field->nitems)
+	{
+		*p_datum = 0;
+		*p_isnull = true;
+		return true;
+	}
+	if (rb_field->null_count > 0 || stat->isnull)
+		return false;
+	/*
+	 * Only the data types whose min/max statistics are kept in the same
+	 * representation with PostgreSQL's Datum.
+	 */
+	switch (rb_field->attopts.tag)
+	{
+		case ArrowType__Int:
+			if (!rb_field->attopts.integer.is_signed)
+				return false;
+			break;
+		case ArrowType__Decimal:
+			break;
+		case ArrowType__Date:
+			if (rb_field->attopts.date.unit != ArrowDateUnit__Day)
+				return false;
+			break;
+		default:
+			return false;
+	}
+	if (rb_field->attopts.tag == ArrowType__Decimal)
+	{
+		if (!DatumGetBool(DirectFunctionCall2(numeric_eq,
+											  PointerGetDatum(&stat->min.numeric),
+											  PointerGetDatum(&stat->max.numeric))))
+			return false;
+		*p_datum = PointerGetDatum(&stat->min.numeric);
+	}
+	else
+	{
+		if (stat->min.datum != stat->max.datum)
+			return false;
+		*p_datum = stat->min.datum;
+	}
+	*p_isnull = false;
+	return true;
+}
+
+static int
+__arrowSampleIndexComp(const void *__a, const void *__b)
+{
+	uint32_t	a = *((const uint32_t *)__a);
+	uint32_t	b = *((const uint32_t *)__b);
+
+	return (a < b ? -1 : (a > b ? 1 : 0));
+}
+
+static int
+RecordBatchAcquireSampleRows(Relation relation,
+							 RecordBatchState *rb_state,
+							 HeapTuple *rows,
+							 int nsamples)
+{
+	ArrowFileState *af_state = rb_state->af_state;
+	TupleDesc		tupdesc = RelationGetDescr(relation);
+	arrowSampleLoadContext scxt;
+	arrowSampleRange *ranges;
+	kern_data_store *kds;
+	strom_io_vector *iovec;
+	Bitmapset	   *referenced = NULL;
+	StringInfoData	buffer;
+	uint32_t	   *indexes;
+	Datum		   *values;
+	bool		   *isnull;
+	Datum		   *const_values;
+	bool		   *const_isnull;
+	bool		   *const_fields;
+	size_t			mmap_sz;
+	int				nranges = 0;
+	int				count;
+
+	/* setup KDS header, but not loaded yet */
+	referenced = bms_make_singleton(-FirstLowInvalidHeapAttributeNumber);
+	initStringInfo(&buffer);
+	iovec = arrowFdwLoadRecordBatch(relation,
+									referenced,
+									rb_state,
+									&buffer);
+	pfree(iovec);
+	kds = (kern_data_store *)buffer.data;
+	mmap_sz = PAGE_ALIGN(kds->length);
+	memset(&scxt, 0, sizeof(arrowSampleLoadContext));
+	scxt.filename = af_state->filename;
+	scxt.rb_offset = rb_state->rb_offset;
+	scxt.kds = mmap(NULL, mmap_sz,
+					PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+					-1, 0);
+	if (scxt.kds == MAP_FAILED)
+		elog(ERROR, "failed on mmap(anonymous, %zu): %m", mmap_sz);
+	PG_TRY();
+	{
+		memcpy(scxt.kds, kds, KDS_HEAD_LENGTH(kds));
+		kds = scxt.kds;
+
+		/* choose the rows to be sampled, in order of the index */
+		indexes = palloc(sizeof(uint32_t) * nsamples);
+		for (count = 0; count < nsamples; count++)
+		{
+			indexes[count] = (double)kds->nitems * drand48();
+			Assert(indexes[count] < kds->nitems);
+		}
+		qsort(indexes, nsamples, sizeof(uint32_t), __arrowSampleIndexComp);
+		ranges = palloc(sizeof(arrowSampleRange) * nsamples);
+		for (count = 0; count < nsamples; count++)
+		{
+			if (nranges > 0 && ranges[nranges-1].hi >= indexes[count])
+				ranges[nranges-1].hi = indexes[count] + 1;
+			else
+			{
+				ranges[nranges].lo = indexes[count];
+				ranges[nranges].hi = indexes[count] + 1;
+				nranges++;
+			}
+		}
+
+		/* load the pages that contain the sampled rows */
+		const_values = alloca(sizeof(Datum) * rb_state->nfields);
+		const_isnull = alloca(sizeof(bool)  * rb_state->nfields);
+		const_fields = alloca(sizeof(bool)  * rb_state->nfields);
+		scxt.filp = PathNameOpenFile(af_state->filename, O_RDONLY | PG_BINARY);
+		if (scxt.filp < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m",
+							af_state->filename)));
+		for (int j=0; j < rb_state->nfields; j++)
+		{
+			const_fields[j] = __arrowSampleConstantDatum(&rb_state->fields[j],
+														 &const_values[j],
+														 &const_isnull[j]);
+			if (!const_fields[j])
+				__arrowSampleLoadField(&scxt,
+									   &kds->colmeta[j],
+									   &rb_state->fields[j],
+									   ranges, nranges);
+		}
+		FileClose(scxt.filp);
+		elog(DEBUG2, "arrow_fdw: ANALYZE read %zu of %zu bytes of the record batch %d at '%s'",
+			 scxt.nbytes_read, rb_state->rb_length,
+			 rb_state->rb_index, af_state->filename);
+
+		/* fetch the sampled rows */
+		values = alloca(sizeof(Datum) * tupdesc->natts);
+		isnull = alloca(sizeof(bool)  * tupdesc->natts);
+		for (count = 0; count < nsamples; count++)
+		{
+			for (int j=0; j < rb_state->nfields; j++)
+			{
+				if (const_fields[j])
+				{
+					values[j] = const_values[j];
+					isnull[j] = const_isnull[j];
+				}
+				else
+				{
+					pg_datum_arrow_ref(kds,
+									   &kds->colmeta[j],
+									   indexes[count],
+									   values + j,
+									   isnull + j);
+				}
+			}
+			for (int k=0; k < af_state->nvirtuals; k++)
+			{
+				values[rb_state->nfields + k] = af_state->virt_values[k];
+				isnull[rb_state->nfields + k] = af_state->virt_isnull[k];
+			}
+			rows[count] = heap_form_tuple(tupdesc, values, isnull);
+		}
+		pfree(ranges);
+		pfree(indexes);
+	}
+	PG_FINALLY();
+	{
+		munmap(scxt.kds, mmap_sz);
+	}
+	PG_END_TRY();
+	pfree(buffer.data);
+
+	return count;
+}
+
+static int
+ArrowAcquireSampleRows(Relation relation,
+					   int elevel,
+					   HeapTuple *rows,
+					   int nrooms,
+					   double *p_totalrows,
+					   double *p_totaldeadrows)
+{
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(relation));
+	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
+	List		   *rb_state_list = NIL;
+	ListCell	   *lc1, *lc2;
+	int64			total_nrows = 0;
+	int64			count_nrows = 0;
+	int				nsamples_min = nrooms / 100;
+	int				nitems = 0;
+
+	arrowFdwPreloadMetadataCache(filesList);
+	foreach (lc1, filesList)
+	{
+		ArrowFileState *af_state;
+		char	   *fname = strVal(lfirst(lc1));
+
+		af_state = BuildArrowFileState(relation, fname, NULL);
+		if (!af_state)
+			continue;
+		foreach (lc2, af_state->rb_list)
+		{
+			RecordBatchState *rb_state = lfirst(lc2);
+
+			if (rb_state->rb_nitems == 0)
+				continue;	/* not reasonable to sample, skipped */
+			total_nrows += rb_state->rb_nitems;
+			rb_state_list = lappend(rb_state_list, rb_state);
+		}
+	}
+	nrooms = Min(nrooms, total_nrows);
 
 	/* fetch samples for each record-batch */
 	foreach (lc1, rb_state_list)
 	{
-		RecordBatchState *rb_state = lfirst(lc1);
-		int			nsamples;
+		RecordBatchState *rb_state = lfirst(lc1);
+		int			nsamples;
+
+		count_nrows += rb_state->rb_nitems;
+		nsamples = (double)nrooms * ((double)count_nrows /
+									 (double)total_nrows) - nitems;
+		if (nitems + nsamples > nrooms)
+			nsamples = nrooms - nitems;
+		if (nsamples > nsamples_min)
+			nitems += RecordBatchAcquireSampleRows(relation,
+												   rb_state,
+												   rows + nitems,
+												   nsamples);
+	}
+	*p_totalrows = total_nrows;
+	*p_totaldeadrows = 0.0;
+
+	return nitems;
+}
+
+/*
+ * ArrowAnalyzeForeignTable
+ */
+static bool
+ArrowAnalyzeForeignTable(Relation frel,
+						 AcquireSampleRowsFunc *p_sample_rows_func,
+						 BlockNumber *p_totalpages)
+{
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
+	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
+	ListCell	   *lc;
+	size_t			totalpages = 0;
+
+	foreach (lc, filesList)
+	{
+		const char	   *fname = strVal(lfirst(lc));
+		struct stat		stat_buf;
+
+		if (stat(fname, &stat_buf) != 0)
+		{
+			elog(NOTICE, "failed on stat('%s') on behalf of '%s', skipped",
+				 fname, get_rel_name(ft->relid));
+			continue;
+		}
+		totalpages += (stat_buf.st_size + BLCKSZ - 1) / BLCKSZ;
+	}
+	if (totalpages > MaxBlockNumber)
+		totalpages = MaxBlockNumber;
+
+	*p_sample_rows_func = ArrowAcquireSampleRows;
+	*p_totalpages = totalpages;
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Writable Arrow_Fdw
+ *
+ * INSERT and COPY FROM on the foreign table with 'writable' option
+ * append record batches to the arrow file. Rows are buffered on the
+ * SQLtable until arrow_fdw.write_batch_size, then written out as a
+ * record batch over the current footer, and the footer is rebuilt at
+ * the end of the statement.
+ * The original footer is saved as undo log for each (sub-)transaction,
+ * to revert the arrow file on abort. The footer at the transaction begin
+ * is also written to the undo file ('<dir>/.<filename>.undo'; hidden from
+ * the 'dir' option) and fsync'ed prior to any writes on the arrow file,
+ * then removed once the appended record batches become durable at commit.
+ * If the undo file is left, the writer crashed in the middle of the
+ * transaction, so the next writer reverts the arrow file by the undo file.
+ * Readers never modify the file; they raise an error on such a file until
+ * the next writer reverts it.
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	SubTransactionId subxid;	/* sub-transaction that saved the undo log */
+	off_t		footer_offset;	/* original offset of the footer */
+	size_t		footer_length;	/* original length of the footer + tail */
+	char		footer_backup[FLEXIBLE_ARRAY_MEMBER];
+} arrowWriteUndoLog;
+
+#define ARROW_UNDO_FILE_MAGIC	"ARROW_UNDO1"
+
+typedef struct
+{
+	char		magic[12];		/* ARROW_UNDO_FILE_MAGIC */
+	dev_t		st_dev;			/* identifier of the arrow file */
+	ino_t		st_ino;
+	bool		created;		/* arrow file is created by the transaction */
+	off_t		footer_offset;	/* original offset of the footer */
+	size_t		footer_length;	/* original length of the footer + tail */
+	/* followed by the footer image */
+} arrowWriteUndoFileHead;
+
+typedef struct
+{
+	dlist_node	chain;			/* link to arrow_write_files_list */
+	char	   *filename;
+	int			fdesc;
+	struct stat	stat_buf;		/* stat(2) at the first open */
+	bool		created;		/* file is created by this transaction */
+	bool		in_use;			/* a writer is in-progress */
+	bool		has_undo_file;	/* undo file is written */
+	int			pending_slot;	/* index of arrowPendingWrite, or -1 */
+	List	   *undo_logs;		/* stack of arrowWriteUndoLog */
+} arrowWriteFile;
+
+typedef struct
+{
+	arrowWriteFile *wfile;
+	MemoryContext memcxt;		/* memory context for the SQLtable */
+	MemoryContext tmpcxt;		/* per-row temporary memory */
+	int			nbatches_orig;	/* # of record batches at the begin */
+	SQLtable   *table;
+} arrowWriteState;
+
+static dlist_head	arrow_write_files_list;
+static dlist_head	arrow_export_files_list;	/* see Arrow export */
+static void	__arrowExportReleaseFiles(const char *tempname, bool remove_file);
+
+/*
+ * Management of the pending writes
+ */
+static int
+registerArrowPendingWrite(struct stat *stat_buf, int nbatches)
+{
+	TransactionId xid = GetTopTransactionId();	/* may assign a new xid */
+	int		slot = -1;
+
+	SpinLockAcquire(&arrow_metadata_cache->pending_lock);
+	for (int i=0; i < ARROW_PENDING_WRITES_NSLOTS; i++)
+	{
+		arrowPendingWrite *pw = &arrow_metadata_cache->pending[i];
+
+		if (!TransactionIdIsValid(pw->xid))
+		{
+			pw->xid = xid;
+			pw->nbatches = nbatches;
+			memcpy(&pw->stat_buf, stat_buf, sizeof(struct stat));
+			arrow_metadata_cache->num_pending++;
+			slot = i;
+			break;
+		}
+	}
+	SpinLockRelease(&arrow_metadata_cache->pending_lock);
+	if (slot < 0)
+		elog(ERROR, "arrow_fdw: too many concurrent writes on arrow files");
+	return slot;
+}
+
+static void
+unregisterArrowPendingWrite(int slot)
+{
+	arrowPendingWrite *pw = &arrow_metadata_cache->pending[slot];
+
+	SpinLockAcquire(&arrow_metadata_cache->pending_lock);
+	Assert(TransactionIdIsValid(pw->xid));
+	memset(pw, 0, sizeof(arrowPendingWrite));
+	arrow_metadata_cache->num_pending--;
+	SpinLockRelease(&arrow_metadata_cache->pending_lock);
+}
+
+/*
+ * __arrowFdwSetupPendingWrite
+ *
+ * It registers the committed state of the arrow file, and ensures its
+ * metadata cache prior to any writes, for the concurrent readers.
+ */
+static void
+__arrowFdwSetupPendingWrite(arrowWriteFile *wfile)
+{
+	arrowMetadataCache *mcache;
+	ArrowFileState *af_state = NULL;
+	int			nbatches = 0;
+
+	if (wfile->stat_buf.st_size > 0)
+	{
+		LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
+		mcache = lookupArrowMetadataCache(&wfile->stat_buf, false);
+		for (; mcache != NULL; mcache = mcache->next)
+			nbatches++;
+		LWLockRelease(&arrow_metadata_cache->mutex);
+		if (nbatches == 0)
+		{
+			af_state = __buildArrowFileStateByFile(wfile->filename, NULL);
+			if (af_state)
+			{
+				nbatches = list_length(af_state->rb_list);
+				LWLockAcquire(&arrow_metadata_cache->mutex, LW_EXCLUSIVE);
+				mcache = lookupArrowMetadataCache(&af_state->stat_buf, true);
+				if (!mcache)
+					__buildArrowMetadataCacheNoLock(af_state);
+				LWLockRelease(&arrow_metadata_cache->mutex);
+			}
+		}
+	}
+	wfile->pending_slot = registerArrowPendingWrite(&wfile->stat_buf, nbatches);
+}
+
+/*
+ * Management of the undo file
+ */
+static char *
+__arrowFdwUndoFileName(const char *filename)
+{
+	const char *base = strrchr(filename, '/');
+
+	base = (base ? base + 1 : filename);
+	return psprintf("%.*s.%s.undo",
+					(int)(base - filename), filename, base);
+}
+
+static bool
+__arrowFdwReadUndoFileHead(int undo_fdesc, int fdesc,
+						   arrowWriteUndoFileHead *head)
+{
+	struct stat	stat_buf;
+
+	if (fstat(fdesc, &stat_buf) != 0)
+		return false;
+	/* the undo file might be left for the file already replaced */
+	return (__readFile(undo_fdesc, head,
+					   sizeof(arrowWriteUndoFileHead)) == sizeof(arrowWriteUndoFileHead) &&
+			memcmp(head->magic, ARROW_UNDO_FILE_MAGIC,
+				   sizeof(ARROW_UNDO_FILE_MAGIC)) == 0 &&
+			head->st_dev == stat_buf.st_dev &&
+			head->st_ino == stat_buf.st_ino);
+}
+
+static void
+__arrowFdwWriteUndoFile(arrowWriteFile *wfile, arrowWriteUndoLog *undo)
+{
+	char	   *undo_name = __arrowFdwUndoFileName(wfile->filename);
+	char	   *temp_name = psprintf("%s.tmp", undo_name);
+	arrowWriteUndoFileHead head;
+	int			fdesc;
+
+	memset(&head, 0, sizeof(arrowWriteUndoFileHead));
+	memcpy(head.magic, ARROW_UNDO_FILE_MAGIC, sizeof(ARROW_UNDO_FILE_MAGIC));
+	head.st_dev = wfile->stat_buf.st_dev;
+	head.st_ino = wfile->stat_buf.st_ino;
+	head.created = wfile->created;
+	head.footer_offset = undo->footer_offset;
+	head.footer_length = undo->footer_length;
+
+	fdesc = open(temp_name, O_WRONLY | O_CREAT | O_TRUNC | PG_BINARY,
+				 pg_file_create_mode);
+	if (fdesc < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create file \"%s\": %m", temp_name)));
+	if (__writeFile(fdesc, &head, sizeof(arrowWriteUndoFileHead)) != sizeof(arrowWriteUndoFileHead) ||
+		__writeFile(fdesc, undo->footer_backup, undo->footer_length) != undo->footer_length)
+	{
+		int		errno_saved = errno;
+
+		close(fdesc);
+		unlink(temp_name);
+		errno = errno_saved;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m", temp_name)));
+	}
+	close(fdesc);
+	/* durable_rename() also flushes the temporary file */
+	durable_rename(temp_name, undo_name, ERROR);
+	wfile->has_undo_file = true;
+
+	pfree(temp_name);
+	pfree(undo_name);
+}
+
+static void
+__arrowFdwRemoveUndoFile(arrowWriteFile *wfile, int elevel)
+{
+	char	   *undo_name = __arrowFdwUndoFileName(wfile->filename);
+
+	if (durable_unlink(undo_name, elevel) == 0)
+		wfile->has_undo_file = false;
+	pfree(undo_name);
+}
+
+/*
+ * __arrowFdwReplayUndoFile
+ *
+ * It reverts the arrow file by the undo file left by the crashed writer.
+ * The caller must hold the exclusive flock on the 'fdesc', so nobody is
+ * writing the arrow file right now. It returns true if the arrow file is
+ * removed, because it was created by the crashed writer.
+ */
+static bool
+__arrowFdwReplayUndoFile(const char *filename, int fdesc)
+{
+	char	   *undo_name = __arrowFdwUndoFileName(filename);
+	arrowWriteUndoFileHead head;
+	int			undo_fdesc;
+	bool		removed = false;
+
+	undo_fdesc = open(undo_name, O_RDONLY | PG_BINARY);
+	if (undo_fdesc < 0)
+	{
+		if (errno != ENOENT)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m", undo_name)));
+		pfree(undo_name);
+		return false;	/* nothing to revert */
+	}
+	if (__arrowFdwReadUndoFileHead(undo_fdesc, fdesc, &head))
+	{
+		if (head.created)
+		{
+			if (unlink(filename) != 0 && errno != ENOENT)
+			{
+				close(undo_fdesc);
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not remove file \"%s\": %m", filename)));
+			}
+			removed = true;
+		}
+		else
+		{
+			char   *image = palloc(head.footer_length + 1);
+
+			if (__readFile(undo_fdesc, image,
+						   head.footer_length) != head.footer_length ||
+				__pwriteFile(fdesc, image, head.footer_length,
+							 head.footer_offset) != head.footer_length ||
+				ftruncate(fdesc, head.footer_offset + head.footer_length) != 0 ||
+				pg_fsync(fdesc) != 0)
+			{
+				close(undo_fdesc);
+				elog(ERROR, "arrow_fdw: failed on revert '%s' by '%s': %m",
+					 filename, undo_name);
+			}
+			pfree(image);
+		}
+		elog(LOG, "arrow_fdw: '%s' was reverted by '%s' of the crashed writer",
+			 filename, undo_name);
+	}
+	close(undo_fdesc);
+	durable_unlink(undo_name, ERROR);
+	pfree(undo_name);
+
+	return removed;
+}
+
+/*
+ * __arrowFdwCheckUndoFile
+ *
+ * It raises an error if the arrow file to be read was left by the crashed
+ * writer. The undo file of a concurrent writer in-progress is usual, and
+ * the writer holds the exclusive flock on the file.
+ */
+static void
+__arrowFdwCheckUndoFile(const char *filename, int fdesc)
+{
+	char	   *undo_name = __arrowFdwUndoFileName(filename);
+	arrowWriteUndoFileHead head;
+	struct stat	stat_buf;
+	int			undo_fdesc;
+	bool		crashed;
+
+	if (stat(undo_name, &stat_buf) != 0)
+	{
+		pfree(undo_name);
+		return;		/* usual case */
+	}
+	if (flock(fdesc, LOCK_SH | LOCK_NB) != 0)
+	{
+		pfree(undo_name);
+		return;		/* a writer is in-progress */
+	}
+	/* the writer might commit and release the file in the meantime */
+	undo_fdesc = open(undo_name, O_RDONLY | PG_BINARY);
+	if (undo_fdesc < 0)
+		crashed = false;
+	else
+	{
+		crashed = __arrowFdwReadUndoFileHead(undo_fdesc, fdesc, &head);
+		close(undo_fdesc);
+	}
+	flock(fdesc, LOCK_UN);
+
+	if (crashed)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("arrow_fdw: '%s' may contain record batches half-written by the crashed writer",
+						filename),
+				 errdetail("The undo file \"%s\" is left.", undo_name),
+				 errhint("The next INSERT or COPY FROM on the writable foreign table reverts the file.")));
+	pfree(undo_name);
+}
+
+/*
+ * __arrowFdwOpenWriteFile
+ */
+static arrowWriteFile *
+__arrowFdwOpenWriteFile(const char *filename)
+{
+	arrowWriteFile *wfile;
+	struct stat	stat_buf;
+	dlist_iter	iter;
+	int			fdesc;
+	bool		created;
+
+retry:
+	created = false;
+	fdesc = open(filename, O_RDWR | PG_BINARY);
+	if (fdesc < 0)
+	{
+		if (errno != ENOENT)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m", filename)));
+		fdesc = open(filename, O_RDWR | O_CREAT | O_EXCL | PG_BINARY,
+					 pg_file_create_mode);
+		if (fdesc < 0)
+		{
+			if (errno == EEXIST)
+				goto retry;		/* concurrent session created the file */
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not create file \"%s\": %m", filename)));
+		}
+		created = true;
+	}
+	if (fstat(fdesc, &stat_buf) != 0)
+	{
+		close(fdesc);
+		elog(ERROR, "failed on fstat('%s'): %m", filename);
+	}
+	/* is the file already opened by this transaction? */
+	dlist_foreach(iter, &arrow_write_files_list)
+	{
+		wfile = dlist_container(arrowWriteFile, chain, iter.cur);
+		if (wfile->stat_buf.st_dev == stat_buf.st_dev &&
+			wfile->stat_buf.st_ino == stat_buf.st_ino)
+		{
+			close(fdesc);
+			return wfile;
+		}
+	}
+	/* tracked by the transaction callback, even if lock wait is canceled */
+	wfile = MemoryContextAllocZero(TopMemoryContext, sizeof(arrowWriteFile));
+	wfile->filename = MemoryContextStrdup(TopMemoryContext, filename);
+	wfile->fdesc = fdesc;
+	wfile->created = created;
+	wfile->pending_slot = -1;
+	dlist_push_tail(&arrow_write_files_list, &wfile->chain);
+
+	/* concurrent writers on the same file are serialized */
+	while (flock(fdesc, LOCK_EX | LOCK_NB) != 0)
+	{
+		if (errno != EWOULDBLOCK && errno != EINTR)
+			elog(ERROR, "failed on flock('%s'): %m", filename);
+		CHECK_FOR_INTERRUPTS();
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 10L,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+	}
+	/* the file might be removed or replaced during the lock wait */
+	if (!created)
+	{
+		struct stat	temp;
+
+		if (stat(filename, &temp) != 0 ||
+			temp.st_dev != stat_buf.st_dev ||
+			temp.st_ino != stat_buf.st_ino ||
+			__arrowFdwReplayUndoFile(filename, fdesc))
+		{
+			dlist_delete(&wfile->chain);
+			close(wfile->fdesc);
+			pfree(wfile->filename);
+			pfree(wfile);
+			goto retry;
+		}
+	}
+	if (fstat(fdesc, &wfile->stat_buf) != 0)
+		elog(ERROR, "failed on fstat('%s'): %m", filename);
+	__arrowFdwSetupPendingWrite(wfile);
+
+	return wfile;
+}
+
+/*
+ * __arrowFdwSaveUndoLog
+ */
+static void
+__arrowFdwSaveUndoLog(arrowWriteFile *wfile, off_t footer_offset, size_t file_sz)
+{
+	SubTransactionId subxid = GetCurrentSubTransactionId();
+	arrowWriteUndoLog *undo;
+	MemoryContext oldcxt;
+	size_t		length;
+	ssize_t		nbytes;
+	off_t		offset = 0;
+
+	if (wfile->undo_logs != NIL)
+	{
+		undo = linitial(wfile->undo_logs);
+		if (undo->subxid == subxid)
+			return;		/* already saved */
+	}
+	Assert(file_sz >= footer_offset);
+	length = file_sz - footer_offset;
+	undo = MemoryContextAlloc(TopMemoryContext,
+							  offsetof(arrowWriteUndoLog,
+									   footer_backup[length]));
+	undo->subxid = subxid;
+	undo->footer_offset = footer_offset;
+	undo->footer_length = length;
+	while (offset < length)
+	{
+		nbytes = pread(wfile->fdesc,
+					   undo->footer_backup + offset,
+					   length - offset,
+					   footer_offset + offset);
+		if (nbytes > 0)
+			offset += nbytes;
+		else if (nbytes == 0)
+			elog(ERROR, "pread: unexpected EOF; arrow file '%s' corruption?",
+				 wfile->filename);
+		else if (errno != EINTR)
+			elog(ERROR, "failed on pread('%s'): %m", wfile->filename);
+	}
+	/*
+	 * The file is in the state at the transaction begin if no undo logs,
+	 * so it must be durable prior to any writes.
+	 */
+	if (!wfile->has_undo_file)
+	{
+		PG_TRY();
+		{
+			__arrowFdwWriteUndoFile(wfile, undo);
+		}
+		PG_CATCH();
+		{
+			pfree(undo);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+	}
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	wfile->undo_logs = lcons(undo, wfile->undo_logs);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * __arrowFdwApplyUndoLog
+ */
+static bool
+__arrowFdwApplyUndoLog(arrowWriteFile *wfile, arrowWriteUndoLog *undo)
+{
+	ssize_t		nbytes;
+	size_t		offset = 0;
+
+	while (offset < undo->footer_length)
+	{
+		nbytes = pwrite(wfile->fdesc,
+						undo->footer_backup + offset,
+						undo->footer_length - offset,
+						undo->footer_offset + offset);
+		if (nbytes > 0)
+			offset += nbytes;
+		else if (nbytes < 0 && errno == EINTR)
+			continue;
+		else
+			return false;
+	}
+	if (ftruncate(wfile->fdesc, undo->footer_offset +
+					  undo->footer_length) != 0)
+		return false;
+	/* the undo file shall revert the file again on crash, unless durable */
+	if (pg_fsync(wfile->fdesc) != 0)
+		return false;
+	return true;
+}
+
+/*
+ * __arrowFdwReleaseWriteFiles
+ */
+static void
+__arrowFdwReleaseWriteFiles(bool is_commit)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &arrow_write_files_list)
+	{
+		arrowWriteFile *wfile = dlist_container(arrowWriteFile,
+												chain, iter.cur);
+		if (!is_commit)
+		{
+			bool	reverted = true;
+
+			if (wfile->created)
+			{
+				if (unlink(wfile->filename) != 0)
+					elog(WARNING, "failed on unlink('%s'): %m",
+						 wfile->filename);
+			}
+			else if (wfile->undo_logs != NIL)
+			{
+				/* revert to the state at the transaction begin */
+				if (!__arrowFdwApplyUndoLog(wfile, llast(wfile->undo_logs)))
+				{
+					elog(WARNING, "arrow_fdw: failed on revert '%s' (%m), the undo file is kept for the next open",
+						 wfile->filename);
+					reverted = false;
+				}
+			}
+			if (reverted && wfile->has_undo_file)
+				__arrowFdwRemoveUndoFile(wfile, WARNING);
+		}
+		if (wfile->pending_slot >= 0)
+			unregisterArrowPendingWrite(wfile->pending_slot);
+		close(wfile->fdesc);	/* also releases flock */
+		dlist_delete(&wfile->chain);
+		list_free_deep(wfile->undo_logs);
+		pfree(wfile->filename);
+		pfree(wfile);
+	}
+}
+
+/*
+ * arrowFdwXactCallback
+ */
+static void
+arrowFdwXactCallback(XactEvent event, void *arg)
+{
+	dlist_iter	iter;
+
+	if (!dlist_is_empty(&arrow_export_files_list))
+	{
+		switch (event)
+		{
+			case XACT_EVENT_PARALLEL_COMMIT:
+				/* the leader shall rename the file */
+				__arrowExportReleaseFiles(NULL, false);
+				break;
+			case XACT_EVENT_COMMIT:
+			case XACT_EVENT_ABORT:
+			case XACT_EVENT_PREPARE:
+			case XACT_EVENT_PARALLEL_ABORT:
+				/* remove the temporary file not renamed */
+				__arrowExportReleaseFiles(NULL, true);
+				break;
+			default:
+				break;
+		}
+	}
+	if (dlist_is_empty(&arrow_write_files_list))
+		return;
+	switch (event)
+	{
+		case XACT_EVENT_PRE_COMMIT:
+			/* the appended record batches must be durable */
+			dlist_foreach(iter, &arrow_write_files_list)
+			{
+				arrowWriteFile *wfile = dlist_container(arrowWriteFile,
+														chain, iter.cur);
+				if (wfile->undo_logs != NIL &&
+					pg_fdatasync(wfile->fdesc) != 0)
+					ereport(ERROR,
+							(errcode_for_file_access(),
+							 errmsg("could not fdatasync file \"%s\": %m",
+									wfile->filename)));
+				/* no need to revert the file any more */
+				if (wfile->has_undo_file)
+					__arrowFdwRemoveUndoFile(wfile, ERROR);
+			}
+			break;
+		case XACT_EVENT_PRE_PREPARE:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("cannot PREPARE a transaction that has written arrow_fdw foreign tables")));
+			break;
+		case XACT_EVENT_COMMIT:
+			__arrowFdwReleaseWriteFiles(true);
+			break;
+		case XACT_EVENT_ABORT:
+			__arrowFdwReleaseWriteFiles(false);
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * arrowFdwSubXactCallback
+ */
+static void
+arrowFdwSubXactCallback(SubXactEvent event,
+						SubTransactionId mySubid,
+						SubTransactionId parentSubid, void *arg)
+{
+	dlist_iter	iter;
+
+	if (event != SUBXACT_EVENT_COMMIT_SUB &&
+		event != SUBXACT_EVENT_ABORT_SUB)
+		return;
+	dlist_foreach(iter, &arrow_write_files_list)
+	{
+		arrowWriteFile *wfile = dlist_container(arrowWriteFile,
+												chain, iter.cur);
+		arrowWriteUndoLog *undo;
+
+		if (event == SUBXACT_EVENT_ABORT_SUB)
+			wfile->in_use = false;
+		if (wfile->undo_logs == NIL)
+			continue;
+		undo = linitial(wfile->undo_logs);
+		if (undo->subxid != mySubid)
+			continue;
+		if (event == SUBXACT_EVENT_ABORT_SUB)
+		{
+			if (!__arrowFdwApplyUndoLog(wfile, undo))
+				elog(WARNING, "arrow_fdw: failed on revert '%s' (%m), file may be corrupted",
+					 wfile->filename);
+			wfile->undo_logs = list_delete_first(wfile->undo_logs);
+			pfree(undo);
+		}
+		else if (list_length(wfile->undo_logs) > 1 &&
+				 ((arrowWriteUndoLog *)
+				  lsecond(wfile->undo_logs))->subxid == parentSubid)
+		{
+			/* undo log of the parent shall revert this sub-transaction also */
+			wfile->undo_logs = list_delete_first(wfile->undo_logs);
+			pfree(undo);
+		}
+		else
+		{
+			undo->subxid = parentSubid;
+		}
+	}
+}
+
+/*
+ * __arrowFdwSetupWriteField
+ */
+static void
+__arrowFdwSetupWriteField(SQLfield *column,
+						  const char *attname,
+						  Oid atttypid,
+						  int atttypmod,
+						  ArrowField *field,
+						  int *p_numFieldNodes,
+						  int *p_numBuffers)
+{
+	HeapTuple	tup;
+	Form_pg_type typ;
+	const char *typname;
+	const char *nspname;
+	const char *tz_name = NULL;
+	Oid			typelemid = InvalidOid;
+
+	tup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(atttypid));
+	if (!HeapTupleIsValid(tup))
+		elog(ERROR, "cache lookup failed for type %u", atttypid);
+	typ = (Form_pg_type) GETSTRUCT(tup);
+	typname = pstrdup(NameStr(typ->typname));
+	nspname = get_namespace_name(typ->typnamespace);
+	if (!attname)
+		attname = typname;		/* element of array */
+	if (typ->typtype == TYPTYPE_ENUM ||
+		typ->typtype == TYPTYPE_DOMAIN)
+		elog(ERROR, "arrow_fdw: column '%s' of type '%s' is not supported to write arrow files",
+			 attname, format_type_be(atttypid));
+	if (IsTrueArrayType(typ))
+		typelemid = typ->typelem;
+	if (field && field->type.node.tag == ArrowNodeTag__Timestamp)
+		tz_name = field->type.Timestamp.timezone;
+	else if (atttypid == TIMESTAMPTZOID)
+		tz_name = pg_get_timezone_name(session_timezone);
+
+	*p_numFieldNodes += 1;
+	*p_numBuffers += assignArrowTypePgSQL(column,
+										  attname,
+										  atttypid,
+										  atttypmod,
+										  typname,
+										  nspname,
+										  typ->typlen,
+										  typ->typbyval,
+										  typ->typtype,
+										  typ->typalign,
+										  typ->typrelid,
+										  typelemid,
+										  tz_name,
+										  NULL,
+										  NULL,
+										  field);
+	if (OidIsValid(typ->typrelid))
+	{
+		TupleDesc	tupdesc = lookup_rowtype_tupdesc(atttypid, -1);
+
+		if (field && field->_num_children != tupdesc->natts)
+			elog(ERROR, "arrow_fdw: column '%s' is not compatible to the arrow field", attname);
+		column->nfields = tupdesc->natts;
+		column->subfields = palloc0(sizeof(SQLfield) * tupdesc->natts);
+		for (int j=0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+
+			if (attr->attisdropped)
+				elog(ERROR, "arrow_fdw: composite type '%s' with dropped columns is not supported",
+					 format_type_be(atttypid));
+			__arrowFdwSetupWriteField(&column->subfields[j],
+									  NameStr(attr->attname),
+									  attr->atttypid,
+									  attr->atttypmod,
+									  field ? &field->children[j] : NULL,
+									  p_numFieldNodes,
+									  p_numBuffers);
+		}
+		ReleaseTupleDesc(tupdesc);
+	}
+	else if (OidIsValid(typelemid))
+	{
+		if (field && field->_num_children != 1)
+			elog(ERROR, "arrow_fdw: column '%s' is not compatible to the arrow field", attname);
+		column->element = palloc0(sizeof(SQLfield));
+		__arrowFdwSetupWriteField(column->element,
+								  NULL,
+								  typelemid,
+								  atttypmod,
+								  field ? &field->children[0] : NULL,
+								  p_numFieldNodes,
+								  p_numBuffers);
+	}
+	ReleaseSysCache(tup);
+}
+
+/*
+ * __arrowFdwSetupWriteStats
+ *
+ * It enables min/max statistics of the column, and restores the statistics
+ * of the existing record batches from the custom-metadata of the field.
+ */
+static bool
+__arrowFdwSetupWriteStats(SQLfield *column, ArrowField *field, int nbatches)
+{
+	const char *min_tokens = NULL;
+	const char *max_tokens = NULL;
+	char	   *min_buffer;
+	char	   *max_buffer;
+	char	   *tok1, *pos1;
+	char	   *tok2, *pos2;
+	bool		is_half;
+	int			index;
+
+	if (!column->write_stat)
+		return false;
+	column->stat_enabled = true;
+	if (!field)
+		return true;
+
+	for (int k=0; k < field->_num_custom_metadata; k++)
+	{
+		ArrowKeyValue *kv = &field->custom_metadata[k];
+
+		if (strcmp(kv->key, "min_values") == 0)
+			min_tokens = kv->value;
+		else if (strcmp(kv->key, "max_values") == 0)
+			max_tokens = kv->value;
+	}
+	if (!min_tokens || !max_tokens)
+		return true;
+
+	/* float16 statistics are written as binary image of half_t */
+	is_half = (field->type.node.tag == ArrowNodeTag__FloatingPoint &&
+			   field->type.FloatingPoint.precision == ArrowPrecision__Half);
+	min_buffer = pstrdup(min_tokens);
+	max_buffer = pstrdup(max_tokens);
+	for (tok1 = strtok_r(min_buffer, ",", &pos1),
+		 tok2 = strtok_r(max_buffer, ",", &pos2), index = 0;
+		 tok1 != NULL && tok2 != NULL && index < nbatches;
+		 tok1 = strtok_r(NULL, ",", &pos1),
+		 tok2 = strtok_r(NULL, ",", &pos2), index++)
+	{
+		bool		__isnull = false;
+		int128_t	__min = __atoi128(__trim(tok1), &__isnull);
+		int128_t	__max = __atoi128(__trim(tok2), &__isnull);
+		SQLstat	   *item;
+
+		if (__isnull)
+			continue;
+		item = palloc0(sizeof(SQLstat));
+		item->rb_index = index;
+		item->is_valid = true;
+		if (is_half)
+		{
+			item->min.f32 = fp16_to_fp32((half_t)__min);
+			item->max.f32 = fp16_to_fp32((half_t)__max);
+		}
+		else
+		{
+			item->min.i128 = __min;
+			item->max.i128 = __max;
+		}
+		item->next = column->stat_list;
+		column->stat_list = item;
+	}
+	pfree(min_buffer);
+	pfree(max_buffer);
+
+	return true;
+}
+
+/*
+ * __arrowFdwSetupWriteTable
+ */
+static SQLtable *
+__arrowFdwSetupWriteTable(Relation frel, arrowWriteFile *wfile,
+						  int *p_nbatches_orig)
+{
+	TupleDesc	tupdesc = RelationGetDescr(frel);
+	SQLtable   *table;
+	ArrowFileInfo af_info;
+	ArrowSchema *schema = NULL;
+	struct stat	stat_buf;
+	off_t		footer_offset = 0;
+	int			nbatches = 0;
+
+	if (fstat(wfile->fdesc, &stat_buf) != 0)
+		elog(ERROR, "failed on fstat('%s'): %m", wfile->filename);
+	if (stat_buf.st_size > 0)
+	{
+		char		buffer[sizeof(int32_t) + 6];	/* + strlen("ARROW1") */
+
+		readArrowFileDesc(wfile->fdesc, &af_info);
+		if (af_info.footer._num_dictionaries > 0)
+			elog(ERROR, "arrow_fdw: DictionaryBatch is not supported on writable foreign tables ('%s')",
+				 wfile->filename);
+		schema = &af_info.footer.schema;
+		nbatches = af_info.footer._num_recordBatches;
+		if (schema->_num_fields != tupdesc->natts)
+			elog(ERROR, "arrow_fdw: foreign table '%s' is not compatible to '%s'",
+				 RelationGetRelationName(frel), wfile->filename);
+		/* the new record batches shall overwrite the current footer */
+		if (pread(wfile->fdesc, buffer, sizeof(buffer),
+				  stat_buf.st_size - sizeof(buffer)) != sizeof(buffer))
+			elog(ERROR, "failed on pread('%s'): %m", wfile->filename);
+		footer_offset = stat_buf.st_size - sizeof(buffer) - *((int32_t *)buffer);
+	}
+	__arrowFdwSaveUndoLog(wfile, footer_offset, stat_buf.st_size);
+
+	table = palloc0(offsetof(SQLtable, columns[tupdesc->natts]));
+	table->filename = wfile->filename;
+	table->fdesc = wfile->fdesc;
+	table->f_pos = footer_offset;
+	table->segment_sz = (size_t)arrow_write_batch_size_kb << 10;
+	table->nfields = tupdesc->natts;
+	for (int j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+		SQLfield   *column = &table->columns[j];
+		ArrowField *field = (schema ? &schema->fields[j] : NULL);
+
+		if (attr->attisdropped)
+			elog(ERROR, "arrow_fdw: writable foreign table '%s' has dropped columns",
+				 RelationGetRelationName(frel));
+		__arrowFdwSetupWriteField(column,
+								  NameStr(attr->attname),
+								  attr->atttypid,
+								  attr->atttypmod,
+								  field,
+								  &table->numFieldNodes,
+								  &table->numBuffers);
+		if (field)
+		{
+			/* inherit custom-metadata of the field, except for min/max stats */
+			column->customMetadata = palloc0(sizeof(ArrowKeyValue) *
+											 (field->_num_custom_metadata + 1));
+			column->numCustomMetadata = 0;
+			for (int k=0; k < field->_num_custom_metadata; k++)
+			{
+				ArrowKeyValue *kv = &field->custom_metadata[k];
+
+				if (strcmp(kv->key, "min_values") != 0 &&
+					strcmp(kv->key, "max_values") != 0)
+					column->customMetadata[column->numCustomMetadata++] = *kv;
+			}
+		}
+		if (__arrowFdwSetupWriteStats(column, field, nbatches))
+			table->has_statistics = true;
+	}
+	if (schema)
+	{
+		table->customMetadata = schema->custom_metadata;
+		table->numCustomMetadata = schema->_num_custom_metadata;
+		table->numRecordBatches = nbatches;
+		table->recordBatches = palloc0(sizeof(ArrowBlock) * (nbatches + 1));
+		memcpy(table->recordBatches,
+			   af_info.footer.recordBatches,
+			   sizeof(ArrowBlock) * nbatches);
+	}
+	*p_nbatches_orig = nbatches;
+
+	return table;
+}
+
+/*
+ * __arrowFdwBeginWrite
+ */
+static arrowWriteState *
+__arrowFdwBeginWrite(Relation frel)
+{
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
+	const char	   *filename = __arrowFdwExtractWritableFile(ft->options);
+	arrowWriteState *aw_state;
+	arrowWriteFile *wfile;
+	MemoryContext	oldcxt;
+
+	if (!filename)
+		elog(ERROR, "arrow_fdw: foreign table '%s' is not writable",
+			 RelationGetRelationName(frel));
+	/* only one transaction can write the foreign table concurrently */
+	LockRelationOid(RelationGetRelid(frel), ShareRowExclusiveLock);
+
+	wfile = __arrowFdwOpenWriteFile(filename);
+	if (wfile->in_use)
+		elog(ERROR, "arrow_fdw: '%s' is already being written in this query",
+			 filename);
+	aw_state = palloc0(sizeof(arrowWriteState));
+	aw_state->wfile = wfile;
+	aw_state->memcxt = AllocSetContextCreate(CurrentMemoryContext,
+											 "arrow_fdw write buffer",
+											 ALLOCSET_DEFAULT_SIZES);
+	aw_state->tmpcxt = AllocSetContextCreate(aw_state->memcxt,
+											 "arrow_fdw per-row memory",
+											 ALLOCSET_SMALL_SIZES);
+	oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
+	aw_state->table = __arrowFdwSetupWriteTable(frel, wfile,
+												&aw_state->nbatches_orig);
+	MemoryContextSwitchTo(oldcxt);
+	wfile->in_use = true;
+
+	return aw_state;
+}
+
+/*
+ * __arrowFdwWriteRecordBatch
+ */
+static void
+__arrowFdwWriteRecordBatch(arrowWriteState *aw_state)
+{
+	SQLtable   *table = aw_state->table;
+
+	if (table->f_pos == 0)
+	{
+		/* header and schema of the new arrow file */
+		arrowFileWrite(table, "ARROW1\0\0", 8);
+		writeArrowSchema(table);
+	}
+	writeArrowRecordBatch(table);
+	sql_table_clear(table);
+}
 
-		count_nrows += rb_state->rb_nitems;
-		nsamples = (double)nrooms * ((double)count_nrows /
-									 (double)total_nrows) - nitems;
-		if (nitems + nsamples > nrooms)
-			nsamples = nrooms - nitems;
-		if (nsamples > nsamples_min)
-			nitems += RecordBatchAcquireSampleRows(relation,
-												   rb_state,
-												   rows + nitems,
-												   nsamples);
+/*
+ * __arrowFdwPutValues
+ *
+ * It appends a row on the SQLtable; caller must switch the memory context
+ * of the table buffer, and tmpcxt is used to detoast the values.
+ */
+static void
+__arrowFdwPutValues(SQLtable *table, TupleDesc tupdesc,
+					Datum *values, bool *isnull, MemoryContext tmpcxt)
+{
+	MemoryContext memcxt = CurrentMemoryContext;
+	size_t		usage = 0;
+
+	for (int j=0; j < table->nfields; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+		SQLfield   *column = &table->columns[j];
+		Datum		datum = values[j];
+		Datum		temp;
+
+		if (isnull[j])
+			usage += sql_field_put_value(column, NULL, 0);
+		else if (attr->attbyval)
+		{
+			store_att_byval(&temp, datum, attr->attlen);
+			usage += sql_field_put_value(column, (char *)&temp, attr->attlen);
+		}
+		else if (attr->attlen == -1)
+		{
+			struct varlena *vl;
+
+			/* put_value of array/composite expects 4B-header */
+			MemoryContextSwitchTo(tmpcxt);
+			vl = pg_detoast_datum((struct varlena *)DatumGetPointer(datum));
+			MemoryContextSwitchTo(memcxt);
+			usage += sql_field_put_value(column, VARDATA(vl),
+										 VARSIZE(vl) - VARHDRSZ);
+		}
+		else if (attr->attlen > 0)
+		{
+			usage += sql_field_put_value(column, DatumGetPointer(datum),
+										 attr->attlen);
+		}
+		else
+			elog(ERROR, "arrow_fdw: unexpected type length (%d) of '%s'",
+				 attr->attlen, NameStr(attr->attname));
 	}
-	*p_totalrows = total_nrows;
-	*p_totaldeadrows = 0.0;
+	table->nitems++;
+	table->usage = usage;
+}
 
-	return nitems;
+/*
+ * __arrowFdwWriteTuple
+ */
+static void
+__arrowFdwWriteTuple(arrowWriteState *aw_state, TupleTableSlot *slot)
+{
+	SQLtable   *table = aw_state->table;
+	MemoryContext oldcxt;
+
+	slot_getallattrs(slot);
+	MemoryContextReset(aw_state->tmpcxt);
+	oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
+	__arrowFdwPutValues(table,
+						slot->tts_tupleDescriptor,
+						slot->tts_values,
+						slot->tts_isnull,
+						aw_state->tmpcxt);
+	if (table->usage >= table->segment_sz)
+		__arrowFdwWriteRecordBatch(aw_state);
+	MemoryContextSwitchTo(oldcxt);
 }
 
 /*
- * ArrowAnalyzeForeignTable
+ * __arrowFdwEndWrite
  */
-static bool
-ArrowAnalyzeForeignTable(Relation frel,
-						 AcquireSampleRowsFunc *p_sample_rows_func,
-						 BlockNumber *p_totalpages)
+static void
+__arrowFdwEndWrite(arrowWriteState *aw_state)
+{
+	SQLtable   *table = aw_state->table;
+	MemoryContext oldcxt;
+
+	oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
+	if (table->nitems > 0)
+		__arrowFdwWriteRecordBatch(aw_state);
+	if (table->numRecordBatches > aw_state->nbatches_orig)
+	{
+		writeArrowFooter(table);
+		if (ftruncate(table->fdesc, table->f_pos) != 0)
+			elog(ERROR, "failed on ftruncate('%s'): %m", table->filename);
+	}
+	MemoryContextSwitchTo(oldcxt);
+	aw_state->wfile->in_use = false;
+	MemoryContextDelete(aw_state->memcxt);
+}
+
+/*
+ * ArrowIsForeignRelUpdatable
+ */
+static int
+ArrowIsForeignRelUpdatable(Relation frel)
 {
 	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
-	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
-	ListCell	   *lc;
-	size_t			totalpages = 0;
 
-	foreach (lc, filesList)
+	if (__arrowFdwExtractWritableFile(ft->options) != NULL)
+		return (1 << CMD_INSERT);
+	return 0;
+}
+
+/*
+ * ArrowBeginForeignModify
+ */
+static void
+ArrowBeginForeignModify(ModifyTableState *mtstate,
+						ResultRelInfo *rrinfo,
+						List *fdw_private,
+						int subplan_index,
+						int eflags)
+{
+	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) != 0)
+		return;
+	rrinfo->ri_FdwState = __arrowFdwBeginWrite(rrinfo->ri_RelationDesc);
+}
+
+/*
+ * ArrowExecForeignInsert
+ */
+static TupleTableSlot *
+ArrowExecForeignInsert(EState *estate,
+					   ResultRelInfo *rrinfo,
+					   TupleTableSlot *slot,
+					   TupleTableSlot *planSlot)
+{
+	__arrowFdwWriteTuple(rrinfo->ri_FdwState, slot);
+	return slot;
+}
+
+/*
+ * ArrowEndForeignModify
+ */
+static void
+ArrowEndForeignModify(EState *estate,
+					  ResultRelInfo *rrinfo)
+{
+	arrowWriteState *aw_state = rrinfo->ri_FdwState;
+
+	if (aw_state)
+		__arrowFdwEndWrite(aw_state);
+}
+
+/*
+ * ArrowBeginForeignInsert
+ */
+static void
+ArrowBeginForeignInsert(ModifyTableState *mtstate,
+						ResultRelInfo *rrinfo)
+{
+	rrinfo->ri_FdwState = __arrowFdwBeginWrite(rrinfo->ri_RelationDesc);
+}
+
+/*
+ * ArrowEndForeignInsert
+ */
+static void
+ArrowEndForeignInsert(EState *estate,
+					  ResultRelInfo *rrinfo)
+{
+	arrowWriteState *aw_state = rrinfo->ri_FdwState;
+
+	if (aw_state)
+		__arrowFdwEndWrite(aw_state);
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Arrow export
+ *
+ * pgstrom.arrow_export(filename, row) is an aggregate function that writes
+ * the rows into a new arrow file on the server, without encode/decode of
+ * the client protocol. Each participant of the parallel aggregate builds
+ * its own record batches, and appends them to the temporary file under the
+ * flock(2). Then, the leader backend writes the footer that contains all
+ * the record batches, and renames the temporary file to the destination.
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	dlist_node	chain;			/* link to arrow_export_files_list */
+	char	   *tempname;		/* temporary file during the export */
+	int			fdesc;
+} arrowExportFile;
+
+typedef struct
+{
+	char	   *filename;		/* destination file */
+	Oid			typeid;			/* composite type of the rows */
+	int32		typmod;
+	int64		nitems;			/* total number of rows */
+	MemoryContext memcxt;		/* aggregate context */
+	TupleDesc	rowdesc;		/* tupdesc of the composite type */
+	TupleDesc	tupdesc;		/* rowdesc without dropped columns */
+	AttrNumber *attmap;			/* tupdesc -> rowdesc */
+	Datum	   *values;
+	bool	   *isnull;
+	arrowExportFile *efile;		/* NULL, if not opened yet */
+	SQLtable   *table;
+	bool		finished;
+} arrowExportState;
+
+/*
+ * __arrowExportCreateState
+ */
+static arrowExportState *
+__arrowExportCreateState(MemoryContext aggcxt,
+						 const char *filename,
+						 Oid typeid, int32 typmod)
+{
+	arrowExportState *es;
+	MemoryContext oldcxt;
+	TupleDesc	rowdesc;
+	TupleDesc	tupdesc;
+	SQLtable   *table;
+	int			natts = 0;
+
+	if (!has_privs_of_role(GetUserId(), ROLE_PG_WRITE_SERVER_FILES))
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("permission denied to export arrow file"),
+				 errhint("Only roles with privileges of the \"%s\" role may write files on the server.",
+						 "pg_write_server_files")));
+	if (!is_absolute_path(filename))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_NAME),
+				 errmsg("relative path not allowed for pgstrom.arrow_export")));
+
+	oldcxt = MemoryContextSwitchTo(aggcxt);
+	rowdesc = lookup_rowtype_tupdesc_copy(typeid, typmod);
+	tupdesc = CreateTemplateTupleDesc(rowdesc->natts);
+	es = palloc0(sizeof(arrowExportState));
+	es->filename = pstrdup(filename);
+	es->typeid = typeid;
+	es->typmod = typmod;
+	es->memcxt = aggcxt;
+	es->rowdesc = rowdesc;
+	es->attmap = palloc0(sizeof(AttrNumber) * rowdesc->natts);
+	es->values = palloc0(sizeof(Datum) * rowdesc->natts);
+	es->isnull = palloc0(sizeof(bool) * rowdesc->natts);
+	for (int j=0; j < rowdesc->natts; j++)
 	{
-		const char	   *fname = strVal(lfirst(lc));
-		struct stat		stat_buf;
+		if (TupleDescAttr(rowdesc, j)->attisdropped)
+			continue;
+		TupleDescCopyEntry(tupdesc, natts+1, rowdesc, j+1);
+		es->attmap[natts++] = j;
+	}
+	tupdesc->natts = natts;
+	es->tupdesc = tupdesc;
+
+	table = palloc0(offsetof(SQLtable, columns[natts]));
+	table->fdesc = -1;
+	table->segment_sz = (size_t)arrow_write_batch_size_kb << 10;
+	table->nfields = natts;
+	for (int j=0; j < natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
 
-		if (stat(fname, &stat_buf) != 0)
-		{
-			elog(NOTICE, "failed on stat('%s') on behalf of '%s', skipped",
-				 fname, get_rel_name(ft->relid));
+		__arrowFdwSetupWriteField(&table->columns[j],
+								  NameStr(attr->attname),
+								  attr->atttypid,
+								  attr->atttypmod,
+								  NULL,
+								  &table->numFieldNodes,
+								  &table->numBuffers);
+	}
+	es->table = table;
+	MemoryContextSwitchTo(oldcxt);
+
+	return es;
+}
+
+/*
+ * __arrowExportOpenFile
+ *
+ * All the participants of a query open the same temporary file; its name
+ * is built from the pid of the leader and the statement timestamp that are
+ * shared with the parallel workers.
+ */
+static void
+__arrowExportOpenFile(arrowExportState *es)
+{
+	arrowExportFile *efile;
+	char	   *tempname;
+	int			leader_pid;
+	int			fdesc;
+
+	if (es->efile)
+		return;
+	leader_pid = (IsParallelWorker() ? ParallelLeaderPid : MyProcPid);
+	tempname = psprintf("%s.%d.%ld.tmp",
+						es->filename, leader_pid,
+						(long)GetCurrentStatementStartTimestamp());
+	fdesc = open(tempname, O_RDWR | O_CREAT | PG_BINARY, pg_file_create_mode);
+	if (fdesc < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create file \"%s\": %m", tempname)));
+	efile = MemoryContextAllocZero(TopMemoryContext, sizeof(arrowExportFile));
+	efile->tempname = MemoryContextStrdup(TopMemoryContext, tempname);
+	efile->fdesc = fdesc;
+	dlist_push_tail(&arrow_export_files_list, &efile->chain);
+	pfree(tempname);
+
+	es->efile = efile;
+	es->table->filename = efile->tempname;
+	es->table->fdesc = efile->fdesc;
+}
+
+/*
+ * __arrowExportLockFile
+ *
+ * It acquires the flock on the temporary file, then moves the position of
+ * the SQLtable to the current end of the file.
+ */
+static void
+__arrowExportLockFile(arrowExportState *es)
+{
+	arrowExportFile *efile = es->efile;
+	struct stat	stat_buf;
+
+	while (flock(efile->fdesc, LOCK_EX | LOCK_NB) != 0)
+	{
+		if (errno != EWOULDBLOCK && errno != EINTR)
+			elog(ERROR, "failed on flock('%s'): %m", efile->tempname);
+		CHECK_FOR_INTERRUPTS();
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 1L,
+						 PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+	}
+	if (fstat(efile->fdesc, &stat_buf) != 0)
+		elog(ERROR, "failed on fstat('%s'): %m", efile->tempname);
+	es->table->f_pos = stat_buf.st_size;
+	if (es->table->f_pos == 0)
+	{
+		/* header and schema of the new arrow file */
+		arrowFileWrite(es->table, "ARROW1\0\0", 8);
+		writeArrowSchema(es->table);
+	}
+}
+
+/*
+ * __arrowExportUnlockFile
+ */
+static void
+__arrowExportUnlockFile(arrowExportState *es)
+{
+	if (flock(es->efile->fdesc, LOCK_UN) != 0)
+		elog(ERROR, "failed on flock('%s'): %m", es->efile->tempname);
+}
+
+/*
+ * __arrowExportWriteRecordBatch
+ */
+static void
+__arrowExportWriteRecordBatch(arrowExportState *es)
+{
+	MemoryContext oldcxt = MemoryContextSwitchTo(es->memcxt);
+
+	__arrowExportOpenFile(es);
+	__arrowExportLockFile(es);
+	writeArrowRecordBatch(es->table);
+	__arrowExportUnlockFile(es);
+	sql_table_clear(es->table);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * __arrowExportReleaseFiles
+ */
+static void
+__arrowExportReleaseFiles(const char *tempname, bool remove_file)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &arrow_export_files_list)
+	{
+		arrowExportFile *efile = dlist_container(arrowExportFile,
+												 chain, iter.cur);
+		if (tempname && strcmp(efile->tempname, tempname) != 0)
 			continue;
-		}
-		totalpages += (stat_buf.st_size + BLCKSZ - 1) / BLCKSZ;
+		if (remove_file &&
+			unlink(efile->tempname) != 0 && errno != ENOENT)
+			elog(WARNING, "failed on unlink('%s'): %m", efile->tempname);
+		close(efile->fdesc);
+		dlist_delete(&efile->chain);
+		pfree(efile->tempname);
+		pfree(efile);
 	}
-	if (totalpages > MaxBlockNumber)
-		totalpages = MaxBlockNumber;
+}
 
-	*p_sample_rows_func = ArrowAcquireSampleRows;
-	*p_totalpages = totalpages;
+/*
+ * pgstrom_arrow_export_trans
+ */
+PG_FUNCTION_INFO_V1(pgstrom_arrow_export_trans);
+PUBLIC_FUNCTION(Datum)
+pgstrom_arrow_export_trans(PG_FUNCTION_ARGS)
+{
+	arrowExportState *es = NULL;
+	MemoryContext aggcxt;
+	MemoryContext oldcxt;
+	HeapTupleHeader htup;
+	HeapTupleData tuple;
+	char	   *filename;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (!PG_ARGISNULL(0))
+		es = (arrowExportState *)PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("filename of pgstrom.arrow_export must not be NULL")));
+	if (PG_ARGISNULL(2))
+	{
+		/* NULL rows are ignored, like other aggregate functions */
+		if (!es)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(es);
+	}
+	filename = text_to_cstring(PG_GETARG_TEXT_PP(1));
+	if (!es)
+	{
+		if (!type_is_rowtype(get_fn_expr_argtype(fcinfo->flinfo, 2)))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("pgstrom.arrow_export needs a composite type argument")));
+		htup = PG_GETARG_HEAPTUPLEHEADER(2);
+		es = __arrowExportCreateState(aggcxt, filename,
+									  HeapTupleHeaderGetTypeId(htup),
+									  HeapTupleHeaderGetTypMod(htup));
+	}
+	else
+	{
+		if (strcmp(es->filename, filename) != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("pgstrom.arrow_export: filename must be identical in a group (\"%s\" and \"%s\")",
+							es->filename, filename)));
+		htup = PG_GETARG_HEAPTUPLEHEADER(2);
+	}
+	tuple.t_len = HeapTupleHeaderGetDatumLength(htup);
+	ItemPointerSetInvalid(&tuple.t_self);
+	tuple.t_tableOid = InvalidOid;
+	tuple.t_data = htup;
+	heap_deform_tuple(&tuple, es->rowdesc, es->values, es->isnull);
+	for (int j=0; j < es->tupdesc->natts; j++)
+	{
+		es->values[j] = es->values[es->attmap[j]];
+		es->isnull[j] = es->isnull[es->attmap[j]];
+	}
+	/* per-call memory context is used to detoast */
+	oldcxt = MemoryContextSwitchTo(es->memcxt);
+	__arrowFdwPutValues(es->table, es->tupdesc,
+						es->values, es->isnull,
+						oldcxt);
+	MemoryContextSwitchTo(oldcxt);
+	es->nitems++;
+	if (es->table->usage >= es->table->segment_sz)
+		__arrowExportWriteRecordBatch(es);
+
+	PG_RETURN_POINTER(es);
+}
 
-	return true;
+/*
+ * pgstrom_arrow_export_combine
+ */
+PG_FUNCTION_INFO_V1(pgstrom_arrow_export_combine);
+PUBLIC_FUNCTION(Datum)
+pgstrom_arrow_export_combine(PG_FUNCTION_ARGS)
+{
+	arrowExportState *es1;
+	arrowExportState *es2;
+	MemoryContext aggcxt;
+	MemoryContext oldcxt;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(1))
+	{
+		if (PG_ARGISNULL(0))
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(PG_GETARG_POINTER(0));
+	}
+	es2 = (arrowExportState *)PG_GETARG_POINTER(1);
+	/* deserialized state is already allocated on the aggregate context */
+	if (PG_ARGISNULL(0))
+		PG_RETURN_POINTER(es2);
+	es1 = (arrowExportState *)PG_GETARG_POINTER(0);
+
+	if (strcmp(es1->filename, es2->filename) != 0 ||
+		es1->typeid != es2->typeid ||
+		es1->typmod != es2->typmod)
+		elog(ERROR, "pgstrom.arrow_export: Bug? incompatible partial states");
+	Assert(es2->table->nitems == 0);
+	oldcxt = MemoryContextSwitchTo(es1->memcxt);
+	for (int i=0; i < es2->table->numRecordBatches; i++)
+		sql_table_append_record_batch(es1->table,
+									  &es2->table->recordBatches[i]);
+	MemoryContextSwitchTo(oldcxt);
+	es1->nitems += es2->nitems;
+
+	PG_RETURN_POINTER(es1);
+}
+
+/*
+ * pgstrom_arrow_export_serialize
+ *
+ * It writes out the rows in the buffer, then hands over the record batches
+ * written by this participant to the leader.
+ */
+PG_FUNCTION_INFO_V1(pgstrom_arrow_export_serialize);
+PUBLIC_FUNCTION(Datum)
+pgstrom_arrow_export_serialize(PG_FUNCTION_ARGS)
+{
+	arrowExportState *es = (arrowExportState *)PG_GETARG_POINTER(0);
+	SQLtable   *table = es->table;
+	StringInfoData buf;
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (table->nitems > 0)
+		__arrowExportWriteRecordBatch(es);
+
+	pq_begintypsend(&buf);
+	pq_sendstring(&buf, es->filename);
+	pq_sendint32(&buf, es->typeid);
+	pq_sendint32(&buf, es->typmod);
+	pq_sendint64(&buf, es->nitems);
+	pq_sendint32(&buf, table->numRecordBatches);
+	for (int i=0; i < table->numRecordBatches; i++)
+	{
+		ArrowBlock *block = &table->recordBatches[i];
+
+		pq_sendint64(&buf, block->offset);
+		pq_sendint32(&buf, block->metaDataLength);
+		pq_sendint64(&buf, block->bodyLength);
+	}
+	/* record batches are handed over */
+	table->numRecordBatches = 0;
+	es->nitems = 0;
+
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * pgstrom_arrow_export_deserialize
+ */
+PG_FUNCTION_INFO_V1(pgstrom_arrow_export_deserialize);
+PUBLIC_FUNCTION(Datum)
+pgstrom_arrow_export_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea	   *sstate = PG_GETARG_BYTEA_PP(0);
+	arrowExportState *es;
+	MemoryContext aggcxt;
+	MemoryContext oldcxt;
+	StringInfoData buf;
+	const char *filename;
+	Oid			typeid;
+	int32		typmod;
+	int64		nitems;
+	int			nbatches;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	initStringInfo(&buf);
+	appendBinaryStringInfo(&buf,
+						   VARDATA_ANY(sstate),
+						   VARSIZE_ANY_EXHDR(sstate));
+	filename = pq_getmsgstring(&buf);
+	typeid = pq_getmsgint(&buf, 4);
+	typmod = pq_getmsgint(&buf, 4);
+	nitems = pq_getmsgint64(&buf);
+	nbatches = pq_getmsgint(&buf, 4);
+
+	es = __arrowExportCreateState(aggcxt, filename, typeid, typmod);
+	es->nitems = nitems;
+	oldcxt = MemoryContextSwitchTo(aggcxt);
+	for (int i=0; i < nbatches; i++)
+	{
+		ArrowBlock	block;
+
+		initArrowNode(&block, Block);
+		block.offset = pq_getmsgint64(&buf);
+		block.metaDataLength = pq_getmsgint(&buf, 4);
+		block.bodyLength = pq_getmsgint64(&buf);
+		sql_table_append_record_batch(es->table, &block);
+	}
+	MemoryContextSwitchTo(oldcxt);
+	pq_getmsgend(&buf);
+	pfree(buf.data);
+
+	PG_RETURN_POINTER(es);
+}
+
+static int
+__arrowExportBlockComp(const void *__a, const void *__b)
+{
+	const ArrowBlock *a = __a;
+	const ArrowBlock *b = __b;
+
+	if (a->offset < b->offset)
+		return -1;
+	if (a->offset > b->offset)
+		return 1;
+	return 0;
+}
+
+/*
+ * pgstrom_arrow_export_final
+ *
+ * It writes the footer with all the record batches written by the
+ * participants, then renames the temporary file to the destination.
+ * It returns the number of rows written.
+ */
+PG_FUNCTION_INFO_V1(pgstrom_arrow_export_final);
+PUBLIC_FUNCTION(Datum)
+pgstrom_arrow_export_final(PG_FUNCTION_ARGS)
+{
+	arrowExportState *es;
+	SQLtable   *table;
+	MemoryContext oldcxt;
+	char	   *tempname;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	es = (arrowExportState *)PG_GETARG_POINTER(0);
+	table = es->table;
+	if (es->finished)
+		elog(ERROR, "pgstrom.arrow_export: '%s' is already written",
+			 es->filename);
+	if (table->nitems > 0)
+		__arrowExportWriteRecordBatch(es);
+
+	oldcxt = MemoryContextSwitchTo(es->memcxt);
+	__arrowExportOpenFile(es);
+	__arrowExportLockFile(es);
+	if (table->numRecordBatches > 1)
+		qsort(table->recordBatches,
+			  table->numRecordBatches,
+			  sizeof(ArrowBlock),
+			  __arrowExportBlockComp);
+	writeArrowFooter(table);
+	__arrowExportUnlockFile(es);
+	MemoryContextSwitchTo(oldcxt);
+	/* durable_rename() also flushes the temporary file */
+	tempname = pstrdup(es->efile->tempname);
+	durable_rename(tempname, es->filename, ERROR);
+	__arrowExportReleaseFiles(tempname, false);
+	es->efile = NULL;
+	es->finished = true;
+
+	PG_RETURN_INT64(es->nitems);
 }
 
 /*
@@ -4593,6 +7501,10 @@ pgstrom_startup_arrow_fdw(void)
 	dlist_init(&arrow_metadata_cache->free_fcaches);
 	for (i=0; i < ARROW_METADATA_HASH_NSLOTS; i++)
 		dlist_init(&arrow_metadata_cache->hash_slots[i]);
+	SpinLockInit(&arrow_metadata_cache->pending_lock);
+	arrow_metadata_cache->num_pending = 0;
+	memset(arrow_metadata_cache->pending, 0,
+		   sizeof(arrowPendingWrite) * ARROW_PENDING_WRITES_NSLOTS);
 
 	/* slab allocator */
 	sz = TYPEALIGN(ARROW_METADATA_BLOCKSZ,
@@ -4640,6 +7552,13 @@ pgstrom_init_arrow_fdw(void)
 	//r->ReInitializeDSMForeignScan	= ArrowReInitializeDSMForeignScan;
 	r->InitializeWorkerForeignScan	= ArrowInitializeWorkerForeignScan;
 	r->ShutdownForeignScan			= ArrowShutdownForeignScan;
+	/* INSERT/COPY FROM support */
+	r->IsForeignRelUpdatable		= ArrowIsForeignRelUpdatable;
+	r->BeginForeignModify			= ArrowBeginForeignModify;
+	r->ExecForeignInsert			= ArrowExecForeignInsert;
+	r->EndForeignModify				= ArrowEndForeignModify;
+	r->BeginForeignInsert			= ArrowBeginForeignInsert;
+	r->EndForeignInsert				= ArrowEndForeignInsert;
 	/* IMPORT FOREIGN SCHEMA support */
 	r->ImportForeignSchema			= ArrowImportForeignSchema;
 
@@ -4678,6 +7597,33 @@ pgstrom_init_arrow_fdw(void)
 							PGC_POSTMASTER,
 							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
 							NULL, NULL, NULL);
+	DefineCustomIntVariable("arrow_fdw.metadata_parallel_workers",
+							"max number of parallel workers to parse metadata of arrow files",
+							NULL,
+							&arrow_metadata_parallel_workers,
+							4,
+							0,
+							1024,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/*
+	 * Configurations for writable arrow_fdw
+	 */
+	DefineCustomIntVariable("arrow_fdw.write_batch_size",
+							"threshold of the buffer size to write out a record batch",
+							NULL,
+							&arrow_write_batch_size_kb,
+							256 * 1024,		/* 256MB */
+							1024,			/* 1MB */
+							1024 * 1024,	/* 1GB */
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	dlist_init(&arrow_write_files_list);
+	dlist_init(&arrow_export_files_list);
+	RegisterXactCallback(arrowFdwXactCallback, NULL);
+	RegisterSubXactCallback(arrowFdwSubXactCallback, NULL);
 	/* shared memory size */
 	shmem_request_next = shmem_request_hook;
 	shmem_request_hook = pgstrom_request_arrow_fdw;
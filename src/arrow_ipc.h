@@ -184,6 +184,11 @@ struct SQLtable
 	int			__iov_len;		/* for internal use of pwritev support */
 	int			__iov_cnt;
 	struct iovec *__iov;
+	ArrowBodyCompression *compression; /* body compression, if any */
+	int			compression_level; /* 0 means the default level */
+	int			__zbuf_len;		/* for internal use of body compression */
+	int			__zbuf_cnt;
+	struct iovec *__zbuf;
 
 	ArrowBlock *recordBatches;	/* recordBatches written in the past */
 	int			numRecordBatches;
@@ -232,9 +237,13 @@ extern void		arrowFileWriteIOV(SQLtable *table);
 extern void		writeArrowSchema(SQLtable *table);
 extern void		writeArrowDictionaryBatches(SQLtable *table);
 extern int		writeArrowRecordBatch(SQLtable *table);
+extern void		saveArrowRecordBatchStats(SQLtable *table, int rb_index);
 extern void		writeArrowFooter(SQLtable *table);
 
 extern size_t	setupArrowRecordBatchIOV(SQLtable *table);
+extern size_t	setupArrowRecordBatchMessageIOV(SQLtable *table,
+												ArrowRecordBatch *rbatch,
+												struct iovec *body, int nbody);
 
 /* arrow_nodes.c */
 extern void		__initArrowNode(ArrowNode *node, ArrowNodeTag tag);
@@ -243,6 +252,8 @@ extern void		__initArrowNode(ArrowNode *node, ArrowNodeTag tag);
 extern char	   *dumpArrowNode(ArrowNode *node);
 extern void		copyArrowNode(ArrowNode *dest, const ArrowNode *src);
 extern void		readArrowFileDesc(int fdesc, ArrowFileInfo *af_info);
+extern void		readArrowStreamDesc(int fdesc, size_t resume_offset,
+									ArrowFileInfo *af_info);
 extern bool		arrowFieldTypeIsEqual(ArrowField *a, ArrowField *b);
 extern const char *arrowNodeName(ArrowNode *node);
 
@@ -267,8 +278,18 @@ extern int		assignArrowTypePgSQL(SQLfield *column,
  * Error messages, and misc definitions for pg2arrow
  */
 #ifndef Elog
-#ifdef __PGSTROM_MODULE__
+#if defined(__PGSTROM_MODULE__)
 #define Elog(fmt, ...)			elog(ERROR,(fmt),##__VA_ARGS__)
+#elif defined(__ARROW_ELOG_CALLBACK__)
+/*
+ * The application provides its own error handler, e.g, the Ruby extension
+ * raises an exception, or reports the error of the background writer.
+ */
+extern void		__arrowElog(const char *filename, int lineno,
+							const char *fmt, ...)
+	__attribute__((format(printf, 3, 4), noreturn));
+#define Elog(fmt, ...)								\
+	__arrowElog(__FILE__,__LINE__,(fmt),##__VA_ARGS__)
 #else /* __PGSTROM_MODULE__ */
 #define Elog(fmt, ...)								\
 	do {											\
@@ -1949,16 +1949,178 @@ readArrowFooter(ArrowFooter *node, const char *pos)
 #define ARROW_FILE_TAIL_SIGNATURE_SZ	(sizeof(ARROW_FILE_TAIL_SIGNATURE) - 1)
 
 #ifndef __PGSTROM_MODULE__
+/*
+ * Elog() terminates the command-line tools, so PG_FINALLY() block is simply
+ * executed next to the PG_TRY() block.
+ */
 #define PG_TRY()								\
-	if (true) {									\
+	{											\
 		bool	__dummy__ __attribute__((unused))
 #define PG_FINALLY()							\
-	} else {									\
+	}											\
+	{											\
 		bool __dummy__ __attribute__((unused))
 #define PG_END_TRY()							\
 	}
 #endif
 
+/*
+ * readArrowStreamDesc - read the Arrow IPC stream
+ *
+ * It walks on the encapsulated messages of the IPC stream, up to the
+ * end-of-stream marker or the last complete message, thus, it can also
+ * read the Arrow file being written; that has no valid footer yet.
+ * If 'resume_offset' is not zero, it skips the messages prior to the
+ * offset (except for the Schema), then af_info->recordBatches contains
+ * only record batches appended after the offset.
+ */
+static const char *
+__fetchArrowStreamMessage(const char *mmap_head, size_t file_sz,
+						  size_t offset, bool legacy_format,
+						  ArrowMessage *message,
+						  ArrowBlock *block)
+{
+	const int32_t  *ival = (const int32_t *)(mmap_head + offset);
+	int32_t			prefix_sz = (legacy_format ? 4 : 8);
+	int32_t			meta_sz;
+
+	if (offset + prefix_sz > file_sz)
+		return NULL;	/* incomplete message */
+	if (!legacy_format)
+	{
+		if (ival[0] != (int32_t)0xffffffff)
+			return NULL;	/* not a message, or incomplete */
+		meta_sz = ival[1];
+	}
+	else
+		meta_sz = ival[0];
+	if (meta_sz <= 0 || offset + prefix_sz + meta_sz > file_sz)
+		return NULL;	/* end-of-stream, or incomplete message */
+	readArrowMessage(message, (const char *)ival + prefix_sz);
+	if (offset + prefix_sz + meta_sz + message->bodyLength > file_sz)
+		return NULL;	/* body is not written yet */
+
+	INIT_ARROW_NODE(block, Block);
+	block->offset = offset;
+	block->metaDataLength = prefix_sz + meta_sz;
+	block->bodyLength = message->bodyLength;
+
+	return mmap_head + offset + prefix_sz + meta_sz + message->bodyLength;
+}
+
+static inline void *
+__reallocArrowStreamArray(void *ptr, size_t sz)
+{
+	return (ptr ? repalloc(ptr, sz) : palloc(sz));
+}
+
+void
+readArrowStreamDesc(int fdesc, size_t resume_offset, ArrowFileInfo *af_info)
+{
+	static long		__PAGE_SIZE = 0;
+	size_t			file_sz;
+	size_t			mmap_sz;
+	char		   *mmap_head = NULL;
+	size_t			offset = 0;
+
+	memset(af_info, 0, sizeof(ArrowFileInfo));
+	if (fstat(fdesc, &af_info->stat_buf) != 0)
+		Elog("failed on fstat: %m");
+	file_sz = af_info->stat_buf.st_size;
+	if (file_sz < sizeof(int32_t))
+		Elog("Arrow IPC stream is too short");
+	if (__PAGE_SIZE == 0)
+		__PAGE_SIZE = sysconf(_SC_PAGESIZE);
+	mmap_sz = ((file_sz + __PAGE_SIZE - 1) & ~(__PAGE_SIZE - 1));
+	mmap_head = mmap(NULL, mmap_sz, PROT_READ, MAP_SHARED, fdesc, 0);
+	if (mmap_head == MAP_FAILED)
+		Elog("failed on mmap: %m");
+
+	PG_TRY();
+	{
+		ArrowFooter	   *footer = &af_info->footer;
+		ArrowMessage	message;
+		ArrowBlock		block;
+		const char	   *next;
+		bool			legacy_format;
+		int				nrooms_dict = 0;
+		int				nrooms_rb = 0;
+
+		/* Arrow file being written also begins with the signature */
+		if (file_sz >= ARROW_FILE_HEAD_SIGNATURE_SZ &&
+			memcmp(mmap_head,
+				   ARROW_FILE_HEAD_SIGNATURE,
+				   ARROW_FILE_HEAD_SIGNATURE_SZ) == 0)
+			offset = ARROW_FILE_HEAD_SIGNATURE_SZ;
+		/* Older format prior to Arrow v0.15 has no continuation token */
+		legacy_format = (*((int32_t *)(mmap_head + offset)) != (int32_t)0xffffffff);
+
+		/* the first message must be Schema */
+		next = __fetchArrowStreamMessage(mmap_head, file_sz, offset,
+										 legacy_format, &message, &block);
+		if (!next || message.body.node.tag != ArrowNodeTag__Schema)
+			Elog("Arrow IPC stream does not begin with Schema message");
+		INIT_ARROW_NODE(footer, Footer);
+		footer->version = message.version;
+		memcpy(&footer->schema, &message.body.schema, sizeof(ArrowSchema));
+		offset = next - mmap_head;
+		if (resume_offset > offset)
+			offset = resume_offset;
+
+		while ((next = __fetchArrowStreamMessage(mmap_head, file_sz, offset,
+												 legacy_format,
+												 &message, &block)) != NULL)
+		{
+			switch (message.body.node.tag)
+			{
+				case ArrowNodeTag__DictionaryBatch:
+					if (footer->_num_dictionaries == nrooms_dict)
+					{
+						nrooms_dict = 2 * nrooms_dict + 20;
+						footer->dictionaries =
+							__reallocArrowStreamArray(footer->dictionaries,
+													  sizeof(ArrowBlock) * nrooms_dict);
+						af_info->dictionaries =
+							__reallocArrowStreamArray(af_info->dictionaries,
+													  sizeof(ArrowMessage) * nrooms_dict);
+					}
+					footer->dictionaries[footer->_num_dictionaries] = block;
+					af_info->dictionaries[footer->_num_dictionaries] = message;
+					footer->_num_dictionaries++;
+					break;
+				case ArrowNodeTag__RecordBatch:
+					if (footer->_num_recordBatches == nrooms_rb)
+					{
+						nrooms_rb = 2 * nrooms_rb + 20;
+						footer->recordBatches =
+							__reallocArrowStreamArray(footer->recordBatches,
+													  sizeof(ArrowBlock) * nrooms_rb);
+						af_info->recordBatches =
+							__reallocArrowStreamArray(af_info->recordBatches,
+													  sizeof(ArrowMessage) * nrooms_rb);
+					}
+					footer->recordBatches[footer->_num_recordBatches] = block;
+					af_info->recordBatches[footer->_num_recordBatches] = message;
+					footer->_num_recordBatches++;
+					break;
+				default:
+					Elog("unexpected message (%s) in Arrow IPC stream",
+						 arrowNodeName(&message.body.node));
+			}
+			offset = next - mmap_head;
+		}
+		af_info->stream_tail = offset;
+	}
+	PG_FINALLY();
+	{
+		munmap(mmap_head, mmap_sz);
+	}
+	PG_END_TRY();
+}
+
+/*
+ * readArrowFileDesc - read the Arrow file (or IPC stream) by the descriptor
+ */
 void
 readArrowFileDesc(int fdesc, ArrowFileInfo *af_info)
 {
@@ -1970,11 +2132,24 @@ readArrowFileDesc(int fdesc, ArrowFileInfo *af_info)
 	const char	   *pos;
 	int32_t			offset;
 	int32_t			i, nitems;
+	char			tail[ARROW_FILE_TAIL_SIGNATURE_SZ];
 
 	memset(af_info, 0, sizeof(ArrowFileInfo));
 	if (fstat(fdesc, &af_info->stat_buf) != 0)
 		Elog("failed on fstat: %m");
 	file_sz = af_info->stat_buf.st_size;
+	/* IPC stream format, or Arrow file being written, has no valid footer */
+	if (file_sz < (ARROW_FILE_HEAD_SIGNATURE_SZ +
+				   sizeof(int32_t) +
+				   ARROW_FILE_TAIL_SIGNATURE_SZ) ||
+		pread(fdesc, tail, ARROW_FILE_TAIL_SIGNATURE_SZ,
+			  file_sz - ARROW_FILE_TAIL_SIGNATURE_SZ) != ARROW_FILE_TAIL_SIGNATURE_SZ ||
+		memcmp(tail, ARROW_FILE_TAIL_SIGNATURE,
+			   ARROW_FILE_TAIL_SIGNATURE_SZ) != 0)
+	{
+		readArrowStreamDesc(fdesc, 0, af_info);
+		return;
+	}
 	if (__PAGE_SIZE == 0)
 		__PAGE_SIZE = sysconf(_SC_PAGESIZE);
 	mmap_sz = ((file_sz + __PAGE_SIZE - 1) & ~(__PAGE_SIZE - 1));
@@ -2060,7 +2235,6 @@ readArrowFileDesc(int fdesc, ArrowFileInfo *af_info)
 				readArrowMessage(m, pos);
 			}
 		}
-		munmap(mmap_head, mmap_sz);
 	}
 	PG_FINALLY();
 	{
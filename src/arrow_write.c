@@ -14,6 +14,12 @@
 #endif
 #include <limits.h>
 #include "arrow_ipc.h"
+#ifdef HAVE_LIBLZ4
+#include <lz4frame.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
 
 /* alignment macros, if not */
 #ifndef SHORTALIGN
@@ -1219,11 +1225,14 @@ setupArrowField(ArrowField *field, SQLtable *table, SQLfield *column)
 	{
 		size_t		sz = sizeof(ArrowKeyValue) * (numCustomMetadata + 2);
 
-		if (!customMetadata)
-			customMetadata = palloc0(sz);
-		else
-			customMetadata = repalloc(customMetadata, sz);
-
+		/*
+		 * NOTE: column->customMetadata must be kept as is, because footer
+		 * may be written multiple times (e.g, writable arrow_fdw)
+		 */
+		customMetadata = palloc0(sz);
+		if (numCustomMetadata > 0)
+			memcpy(customMetadata, column->customMetadata,
+				   sizeof(ArrowKeyValue) * numCustomMetadata);
 		__setupArrowFieldStat(customMetadata + numCustomMetadata,
 							  column, table->numRecordBatches);
 		numCustomMetadata += 2;
@@ -1390,18 +1399,123 @@ setupArrowFieldNode(ArrowFieldNode *fnode, SQLfield *column)
 /*
  * setupArrowBuffer
  */
+/*
+ * __compress_arrow_buffer
+ *
+ * It compresses the buffer according to the BodyCompression of the table,
+ * then keeps the image to be written; that is 64bit uncompressed length
+ * followed by the compressed data. If compression does not reduce the size,
+ * the length is -1 and the data is kept as is, as Arrow format allows.
+ */
+static size_t
+__compress_arrow_buffer(SQLtable *table, SQLbuffer *buf, size_t length)
+{
+	int64_t		rawsz = length;
+	size_t		bound;
+	size_t		zlen;
+	char	   *zbuf;
+	struct iovec *iov;
+
+	switch (table->compression->codec)
+	{
+#ifdef HAVE_LIBLZ4
+		case ArrowCompressionType__LZ4_FRAME:
+			bound = LZ4F_compressFrameBound(length, NULL);
+			break;
+#endif
+#ifdef HAVE_LIBZSTD
+		case ArrowCompressionType__ZSTD:
+			bound = ZSTD_compressBound(length);
+			break;
+#endif
+		default:
+			Elog("Arrow BodyCompression codec (%d) is not supported in this build",
+				 (int)table->compression->codec);
+	}
+	if (bound < length)
+		bound = length;
+	zbuf = palloc(ARROWALIGN(sizeof(int64_t) + bound));
+
+	switch (table->compression->codec)
+	{
+#ifdef HAVE_LIBLZ4
+		case ArrowCompressionType__LZ4_FRAME:
+			{
+				LZ4F_preferences_t prefs;
+
+				memset(&prefs, 0, sizeof(LZ4F_preferences_t));
+				prefs.compressionLevel = table->compression_level;
+				zlen = LZ4F_compressFrame(zbuf + sizeof(int64_t), bound,
+										  buf->data, length, &prefs);
+				if (LZ4F_isError(zlen))
+					Elog("failed on LZ4F_compressFrame: %s",
+						 LZ4F_getErrorName(zlen));
+			}
+			break;
+#endif
+#ifdef HAVE_LIBZSTD
+		case ArrowCompressionType__ZSTD:
+			zlen = ZSTD_compress(zbuf + sizeof(int64_t), bound,
+								 buf->data, length,
+								 table->compression_level);
+			if (ZSTD_isError(zlen))
+				Elog("failed on ZSTD_compress: %s",
+					 ZSTD_getErrorName(zlen));
+			break;
+#endif
+		default:
+			Elog("Arrow BodyCompression codec (%d) is not supported in this build",
+				 (int)table->compression->codec);
+	}
+	if (zlen >= length)
+	{
+		/* uncompressed */
+		rawsz = -1;
+		memcpy(zbuf + sizeof(int64_t), buf->data, length);
+		zlen = length;
+	}
+	memcpy(zbuf, &rawsz, sizeof(int64_t));
+	zlen += sizeof(int64_t);
+	if (zlen < ARROWALIGN(zlen))
+		memset(zbuf + zlen, 0, ARROWALIGN(zlen) - zlen);
+
+	/* expand on demand */
+	if (table->__zbuf_cnt >= table->__zbuf_len)
+	{
+		table->__zbuf_len += 40;
+		if (!table->__zbuf)
+			table->__zbuf = palloc(sizeof(struct iovec) * table->__zbuf_len);
+		else
+			table->__zbuf = repalloc(table->__zbuf,
+									 sizeof(struct iovec) * table->__zbuf_len);
+	}
+	iov = &table->__zbuf[table->__zbuf_cnt++];
+	iov->iov_base = zbuf;
+	iov->iov_len  = ARROWALIGN(zlen);
+
+	return zlen;
+}
+
 static inline size_t
-__setup_arrow_buffer(ArrowBuffer *bnode, size_t offset, size_t length)
+__setup_arrow_buffer(SQLtable *table, ArrowBuffer *bnode, size_t offset,
+					 SQLbuffer *buf, size_t length)
 {
 	initArrowNode(bnode, Buffer);
 	bnode->offset = offset;
-	bnode->length = ARROWALIGN(length);
-
+	if (!table->compression || length == 0)
+		bnode->length = ARROWALIGN(length);
+	else
+	{
+		/* compressed length must be exact, but the next offset is aligned */
+		bnode->length = __compress_arrow_buffer(table, buf, length);
+		return ARROWALIGN(bnode->length);
+	}
 	return bnode->length;
 }
 
 static int
-setupArrowBuffer(ArrowBuffer *bnode, SQLfield *column, size_t *p_offset)
+setupArrowBuffer(SQLtable *table, ArrowBuffer *bnode, SQLfield *column,
+				 size_t *p_offset)
 {
 	size_t		offset = *p_offset;
 	int			j, retval = -1;
@@ -1412,12 +1526,14 @@ setupArrowBuffer(ArrowBuffer *bnode, SQLfield *column, size_t *p_offset)
 		assert(column->arrow_type.node.tag == ArrowNodeTag__Utf8);
 		/* nullmap */
 		if (column->nullcount == 0)
-			offset += __setup_arrow_buffer(bnode, offset, 0);
+			offset += __setup_arrow_buffer(table, bnode, offset, NULL, 0);
 		else
-			offset += __setup_arrow_buffer(bnode, offset,
+			offset += __setup_arrow_buffer(table, bnode, offset,
+										   &column->nullmap,
 										   column->nullmap.usage);
 		/* dictionary indexes (int32) */
-		offset += __setup_arrow_buffer(bnode+1, offset,
+		offset += __setup_arrow_buffer(table, bnode+1, offset,
+									   &column->values,
 									   column->values.usage);
 		retval = 2;
 	}
@@ -1429,14 +1545,16 @@ setupArrowBuffer(ArrowBuffer *bnode, SQLfield *column, size_t *p_offset)
 			   column->arrow_type.node.tag == ArrowNodeTag__LargeList);
 		/* nullmap */
 		if (column->nullcount == 0)
-			offset += __setup_arrow_buffer(bnode, offset, 0);
+			offset += __setup_arrow_buffer(table, bnode, offset, NULL, 0);
 		else
-			offset += __setup_arrow_buffer(bnode, offset,
+			offset += __setup_arrow_buffer(table, bnode, offset,
+										   &column->nullmap,
 										   column->nullmap.usage);
 		/* array index values */
-		offset += __setup_arrow_buffer(bnode+1, offset,
+		offset += __setup_arrow_buffer(table, bnode+1, offset,
+									   &column->values,
 									   column->values.usage);
-		retval += setupArrowBuffer(bnode+2, column->element, &offset);
+		retval += setupArrowBuffer(table, bnode+2, column->element, &offset);
 	}
 	else if (column->subfields)
 	{
@@ -1445,13 +1563,14 @@ setupArrowBuffer(ArrowBuffer *bnode, SQLfield *column, size_t *p_offset)
 		assert(column->arrow_type.node.tag == ArrowNodeTag__Struct);
 		/* nullmap */
 		if (column->nullcount == 0)
-			offset += __setup_arrow_buffer(bnode, offset, 0);
+			offset += __setup_arrow_buffer(table, bnode, offset, NULL, 0);
 		else
-			offset += __setup_arrow_buffer(bnode, offset,
+			offset += __setup_arrow_buffer(table, bnode, offset,
+										   &column->nullmap,
 										   column->nullmap.usage);
 		/* for each sub-fields */
 		for (j=0; j < column->nfields; j++)
-			retval += setupArrowBuffer(bnode + retval,
+			retval += setupArrowBuffer(table, bnode + retval,
 									   &column->subfields[j],
 									   &offset);
 	}
@@ -1472,12 +1591,14 @@ setupArrowBuffer(ArrowBuffer *bnode, SQLfield *column, size_t *p_offset)
 				retval = 2;
 				/* nullmap */
 				if (column->nullcount == 0)
-					offset += __setup_arrow_buffer(bnode, offset, 0);
+					offset += __setup_arrow_buffer(table, bnode, offset, NULL, 0);
 				else
-					offset += __setup_arrow_buffer(bnode, offset,
+					offset += __setup_arrow_buffer(table, bnode, offset,
+												   &column->nullmap,
 												   column->nullmap.usage);
 				/* inline values */
-				offset += __setup_arrow_buffer(bnode+1, offset,
+				offset += __setup_arrow_buffer(table, bnode+1, offset,
+											   &column->values,
 											   column->values.usage);
 				break;
 
@@ -1489,15 +1610,18 @@ setupArrowBuffer(ArrowBuffer *bnode, SQLfield *column, size_t *p_offset)
 				retval = 3;
 				/* nullmap */
 				if (column->nullcount == 0)
-					offset += __setup_arrow_buffer(bnode, offset, 0);
+					offset += __setup_arrow_buffer(table, bnode, offset, NULL, 0);
 				else
-					offset += __setup_arrow_buffer(bnode, offset,
+					offset += __setup_arrow_buffer(table, bnode, offset,
+												   &column->nullmap,
 												   column->nullmap.usage);
 				/* index values */
-				offset += __setup_arrow_buffer(bnode+1, offset,
+				offset += __setup_arrow_buffer(table, bnode+1, offset,
+											   &column->values,
 											   column->values.usage);
 				/* extra values */
-				offset += __setup_arrow_buffer(bnode+2, offset,
+				offset += __setup_arrow_buffer(table, bnode+2, offset,
+											   &column->extra,
 											   column->extra.usage);
 				break;
 
@@ -1597,7 +1721,11 @@ setupArrowRecordBatchIOV(SQLtable *table)
 
 	assert(table->nitems > 0);
 	assert(table->f_pos == LONGALIGN(table->f_pos));
-	
+
+	/* release the compressed buffers of the previous record batch */
+	while (table->__zbuf_cnt > 0)
+		pfree(table->__zbuf[--table->__zbuf_cnt].iov_base);
+
 	/* fill up [nodes] vector */
 	nodes = alloca(sizeof(ArrowFieldNode) * table->numFieldNodes);
 	for (i=0, j=0; i < table->nfields; i++)
@@ -1611,14 +1739,16 @@ setupArrowRecordBatchIOV(SQLtable *table)
 	buffers = alloca(sizeof(ArrowBuffer) * table->numBuffers);
 	for (i=0, j=0; i < table->nfields; i++)
 	{
-		j += setupArrowBuffer(&buffers[j], &table->columns[i],
+		j += setupArrowBuffer(table, &buffers[j], &table->columns[i],
 							  &bodyLength);
 	}
 	assert(j == table->numBuffers);
 
 	/* setup Message of Schema */
 	initArrowNode(&message, Message);
-	message.version = ArrowMetadataVersion__V4;
+	message.version = (table->compression
+					   ? ArrowMetadataVersion__V5
+					   : ArrowMetadataVersion__V4);
 	message.bodyLength = bodyLength;
 
 	rbatch = &message.body.recordBatch;
@@ -1628,13 +1758,65 @@ setupArrowRecordBatchIOV(SQLtable *table)
 	rbatch->_num_nodes = table->numFieldNodes;
 	rbatch->buffers = buffers;
 	rbatch->_num_buffers = table->numBuffers;
+	rbatch->compression = table->compression;
 	/* serialization */
 	consumed = setupFlatBufferMessageIOV(table, &message);
-	for (j=0; j < table->nfields; j++)
-		consumed += setupArrowBufferIOV(table, &table->columns[j]);
+	if (!table->compression)
+	{
+		for (j=0; j < table->nfields; j++)
+			consumed += setupArrowBufferIOV(table, &table->columns[j]);
+	}
+	else
+	{
+		/* buffers are already compressed in setupArrowBuffer() */
+		for (j=0; j < table->__zbuf_cnt; j++)
+		{
+			arrowFileAppendIOV(table,
+							   table->__zbuf[j].iov_base,
+							   table->__zbuf[j].iov_len);
+			consumed += table->__zbuf[j].iov_len;
+		}
+	}
 	return consumed;
 }
 
+/*
+ * setupArrowRecordBatchMessageIOV
+ *
+ * A variation of setupArrowRecordBatchIOV for the callers which build the
+ * body of record batch by themselves (like arrowmerge); [nodes] and [buffers]
+ * of the RecordBatch must be set up, and the body is given as iovec array
+ * that is already aligned.
+ */
+size_t
+setupArrowRecordBatchMessageIOV(SQLtable *table,
+								ArrowRecordBatch *rbatch,
+								struct iovec *body, int nbody)
+{
+	ArrowMessage	message;
+	size_t			bodyLength = 0;
+	size_t			consumed;
+	int				i;
+
+	assert(table->f_pos == LONGALIGN(table->f_pos));
+	for (i=0; i < nbody; i++)
+		bodyLength += body[i].iov_len;
+	assert(bodyLength == ARROWALIGN(bodyLength));
+
+	initArrowNode(&message, Message);
+	message.version = ArrowMetadataVersion__V4;
+	message.bodyLength = bodyLength;
+	memcpy(&message.body.recordBatch, rbatch, sizeof(ArrowRecordBatch));
+
+	consumed = setupFlatBufferMessageIOV(table, &message);
+	for (i=0; i < nbody; i++)
+	{
+		if (body[i].iov_len > 0)
+			arrowFileAppendIOV(table, body[i].iov_base, body[i].iov_len);
+	}
+	return consumed + bodyLength;
+}
+
 static void
 __saveArrowRecordBatchStats(int rb_index, SQLfield *field)
 {
@@ -1653,13 +1835,34 @@ __saveArrowRecordBatchStats(int rb_index, SQLfield *field)
 	}
 }
 
+/*
+ * saveArrowRecordBatchStats - saves min/max statistics of the record batch
+ * just written, then reset them for the next one.
+ */
+void
+saveArrowRecordBatchStats(SQLtable *table, int rb_index)
+{
+	int			j;
+
+	if (table->has_statistics)
+	{
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *field = &table->columns[j];
+
+			if (field->stat_enabled)
+				__saveArrowRecordBatchStats(rb_index, field);
+		}
+	}
+}
+
 int
 writeArrowRecordBatch(SQLtable *table)
 {
 	ArrowBlock	block;
 	size_t		length;
 	size_t		meta_sz;
-	int			j, rb_index;
+	int			rb_index;
 
 	table->__iov_cnt = 0;				/* reset iov */
 	length = setupArrowRecordBatchIOV(table);
@@ -1674,16 +1877,8 @@ writeArrowRecordBatch(SQLtable *table)
 
 	arrowFileWriteIOV(table);
 	rb_index = sql_table_append_record_batch(table, &block);
-	if (table->has_statistics)
-	{
-		for (j=0; j < table->nfields; j++)
-		{
-			SQLfield   *field = &table->columns[j];
+	saveArrowRecordBatchStats(table, rb_index);
 
-			if (field->stat_enabled)
-				__saveArrowRecordBatchStats(rb_index, field);
-		}
-	}
 	return rb_index;
 }
 
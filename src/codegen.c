@@ -1592,6 +1592,1105 @@ codegen_var_expression(codegen_context *context,
 	return 0;
 }
 
+/*
+ * __codegen_like_pattern
+ *
+ * LIKE/ILIKE operators with a constant pattern are pre-compiled to
+ * the LikeMatch expression, instead of the generic matcher that parses
+ * the pattern for each row. It sets up the header of LikeMatch and its
+ * payload, or returns false if not applicable.
+ */
+static bool
+__codegen_like_pattern(devfunc_info *dfunc, List *func_args,
+					   kern_expression *kexp, StringInfo payload)
+{
+	Const	   *con;
+	text	   *pattern;
+	const char *pat;
+	int			plen;
+	uint32_t	like_flags = 0;
+	uint16_t	like_kind;
+	kern_like_item *items;
+	int			nitems = 0;
+	StringInfoData lit;
+
+	switch (dfunc->func_code)
+	{
+		case FuncOpCode__like:
+		case FuncOpCode__textlike:
+		case FuncOpCode__bpcharlike:
+			break;
+		case FuncOpCode__notlike:
+		case FuncOpCode__textnlike:
+		case FuncOpCode__bpcharnlike:
+			like_flags |= KERN_LIKE_FLAG__NEGATIVE;
+			break;
+		case FuncOpCode__texticlike:
+		case FuncOpCode__bpchariclike:
+			like_flags |= KERN_LIKE_FLAG__ICASE;
+			break;
+		case FuncOpCode__texticnlike:
+		case FuncOpCode__bpcharicnlike:
+			like_flags |= (KERN_LIKE_FLAG__NEGATIVE | KERN_LIKE_FLAG__ICASE);
+			break;
+		default:
+			return false;
+	}
+	if (list_length(func_args) != 2)
+		return false;
+	con = lsecond(func_args);
+	if (!IsA(con, Const) || con->constisnull)
+		return false;
+	/*
+	 * Byte-wise search never matches in the middle of a character on UTF-8
+	 * and single-byte encodings. Others must advance character by character.
+	 */
+	if (GetDatabaseEncoding() == PG_UTF8 ||
+		pg_database_encoding_max_length() == 1)
+		like_flags |= KERN_LIKE_FLAG__BYTEWISE;
+
+	pattern = DatumGetTextPP(con->constvalue);
+	pat = VARDATA_ANY(pattern);
+	plen = VARSIZE_ANY_EXHDR(pattern);
+	items = palloc0(sizeof(kern_like_item) * (plen + 1));
+	initStringInfo(&lit);
+	for (int i=0; i < plen; i++)
+	{
+		kern_like_item *last = (nitems > 0 ? &items[nitems-1] : NULL);
+		char		c = pat[i];
+
+		if (c == '%')
+		{
+			/* a sequence of '%' is equivalent to a '%' */
+			if (!last || last->kind != KERN_LIKE_ITEM__PERCENT)
+				items[nitems++].kind = KERN_LIKE_ITEM__PERCENT;
+			continue;
+		}
+		if (c == '_')
+		{
+			if (last && last->kind == KERN_LIKE_ITEM__ANYCHARS)
+				last->nchars++;
+			else
+			{
+				items[nitems].kind = KERN_LIKE_ITEM__ANYCHARS;
+				items[nitems].nchars = 1;
+				nitems++;
+			}
+			continue;
+		}
+		if (c == '\\')
+		{
+			/* invalid escape shall be reported by the generic matcher */
+			if (++i >= plen)
+				return false;
+			c = pat[i];
+		}
+		/* see GetCharUpper in xpu_textlib.cu */
+		if ((like_flags & KERN_LIKE_FLAG__ICASE) != 0 && c >= 'a' && c <= 'z')
+			c += ('A' - 'a');
+		if (!last || last->kind != KERN_LIKE_ITEM__LITERAL)
+		{
+			last = &items[nitems++];
+			last->kind = KERN_LIKE_ITEM__LITERAL;
+			last->offset = lit.len;
+			last->length = 0;
+		}
+		appendStringInfoChar(&lit, c);
+		last->length++;
+	}
+
+	/* classification of the pattern */
+	if (nitems == 0 ||
+		(nitems == 1 && items[0].kind == KERN_LIKE_ITEM__LITERAL))
+		like_kind = KERN_LIKE_KIND__EXACT;
+	else if (nitems == 1 && items[0].kind == KERN_LIKE_ITEM__PERCENT)
+		like_kind = KERN_LIKE_KIND__PREFIX;
+	else if (nitems == 2 &&
+			 items[0].kind == KERN_LIKE_ITEM__LITERAL &&
+			 items[1].kind == KERN_LIKE_ITEM__PERCENT)
+		like_kind = KERN_LIKE_KIND__PREFIX;
+	else if (nitems == 2 &&
+			 items[0].kind == KERN_LIKE_ITEM__PERCENT &&
+			 items[1].kind == KERN_LIKE_ITEM__LITERAL)
+		like_kind = KERN_LIKE_KIND__SUFFIX;
+	else if (nitems == 3 &&
+			 items[0].kind == KERN_LIKE_ITEM__PERCENT &&
+			 items[1].kind == KERN_LIKE_ITEM__LITERAL &&
+			 items[2].kind == KERN_LIKE_ITEM__PERCENT)
+		like_kind = KERN_LIKE_KIND__SUBSTR;
+	else
+		like_kind = KERN_LIKE_KIND__GENERIC;
+
+	kexp->u.like.like_kind   = like_kind;
+	kexp->u.like.like_flags  = like_flags;
+	kexp->u.like.like_length = lit.len;
+	if (like_kind == KERN_LIKE_KIND__GENERIC)
+	{
+		/* items[] are followed by the literals */
+		for (int i=0; i < nitems; i++)
+		{
+			if (items[i].kind == KERN_LIKE_ITEM__LITERAL)
+				items[i].offset += sizeof(kern_like_item) * nitems;
+		}
+		kexp->u.like.like_nitems = nitems;
+		appendBinaryStringInfo(payload, (char *)items,
+							   sizeof(kern_like_item) * nitems);
+	}
+	appendBinaryStringInfo(payload, lit.data, lit.len);
+	pfree(items);
+	pfree(lit.data);
+
+	return true;
+}
+
+/*
+ * __codegen_precompiled_expression
+ *
+ * It writes out an expression that has a pre-compiled pattern in the payload
+ * and takes an argument, like LikeMatch, RegexMatch or ScalarArrayOpHash.
+ */
+static int
+__codegen_precompiled_expression(codegen_context *context,
+								 StringInfo buf,
+								 int curr_depth,
+								 kern_expression *kexp,
+								 int header_sz,
+								 StringInfo payload,
+								 Expr *arg)
+{
+	int		pos = -1;
+
+	kexp->exptype  = TypeOpCode__bool;
+	kexp->expflags = context->kexp_flags;
+	kexp->nr_args  = 1;
+	if (buf)
+	{
+		pos = __appendBinaryStringInfo(buf, kexp, header_sz);
+		appendBinaryStringInfo(buf, payload->data, payload->len);
+		((kern_expression *)(buf->data + pos))->args_offset
+			= __appendZeroStringInfo(buf, 0) - pos;
+	}
+	if (codegen_expression_walker(context, buf, curr_depth, arg) < 0)
+		return -1;
+	if (buf)
+		__appendKernExpMagicAndLength(buf, pos);
+	return 0;
+}
+
+/*
+ * codegen_like_expression
+ */
+static int
+codegen_like_expression(codegen_context *context,
+						StringInfo buf,
+						int curr_depth,
+						devfunc_info *dfunc,
+						List *func_args,
+						kern_expression *kexp,
+						StringInfo payload)
+{
+	/*
+	 * Specialized matchers are much cheaper than the generic one that
+	 * interprets the pattern for each row, except for the GENERIC kind.
+	 */
+	if (kexp->u.like.like_kind == KERN_LIKE_KIND__GENERIC)
+		context->device_cost += dfunc->func_cost;
+	else
+		context->device_cost += dfunc->func_cost / 8;
+
+	kexp->opcode = FuncOpCode__LikeMatch;
+	return __codegen_precompiled_expression(context, buf, curr_depth, kexp,
+											offsetof(kern_expression,
+													 u.like.data),
+											payload,
+											linitial(func_args));
+}
+
+/*
+ * Regular expression pre-compiler
+ *
+ * A constant pattern in the subset of the advanced regular expression (ARE)
+ * is compiled to the position automaton (Glushkov NFA) with up to 64
+ * positions, then the xPU device runs it as a bit-parallel NFA.
+ * The subset supports literals, '.', bracket expressions, class-shorthand
+ * escapes, grouping, alternation, quantifiers and '^' / '$' anchors of
+ * the whole pattern. The patterns out of the subset (back-references,
+ * lookahead constraints, embedded options, ...) are not pushed down.
+ */
+#define REGEX_NODE__EMPTY		0
+#define REGEX_NODE__LEAF		1
+#define REGEX_NODE__CONCAT		2
+#define REGEX_NODE__ALT			3
+#define REGEX_NODE__STAR		4
+#define REGEX_NODE__PLUS		5
+#define REGEX_NODE__QUEST		6
+
+#define REGEX_MAX_REPEAT		255		/* same as DUPMAX of PG */
+
+typedef struct
+{
+	uint64_t	ascii[2];		/* bitmap of ASCII characters */
+	bool		negated;
+	int			nranges;
+	int			nrooms;
+	kern_regex_range *ranges;	/* non-ASCII code-point ranges */
+} regex_class;
+
+typedef struct regex_node
+{
+	int			kind;			/* one of REGEX_NODE__* */
+	int			nleaves;		/* number of leaves in this sub-tree */
+	regex_class *cls;			/* LEAF */
+	struct regex_node *left;	/* CONCAT, ALT, or operand of the quantifier */
+	struct regex_node *right;	/* CONCAT, ALT */
+} regex_node;
+
+typedef struct
+{
+	const pg_wchar *pat;
+	int			len;
+	int			pos;
+	int			depth;			/* nest level of parentheses */
+	bool		icase;
+	bool		ctype_is_c;
+	bool		ctype_is_libc;	/* C or libc collation provider */
+	bool		toplevel_alt;	/* '|' appeared out of parentheses */
+	const char *errmsg;
+} regex_parser;
+
+typedef struct
+{
+	int			npos;
+	regex_class *classes[KERN_REGEX_MAX_NPOS];
+	uint64_t	follow[KERN_REGEX_MAX_NPOS];
+} regex_glushkov;
+
+static regex_node *__regex_parse_alt(regex_parser *rp);
+
+static regex_node *
+__regex_make_node(int kind, regex_node *left, regex_node *right)
+{
+	regex_node *node = palloc0(sizeof(regex_node));
+
+	node->kind = kind;
+	node->left = left;
+	node->right = right;
+	node->nleaves = ((left ? left->nleaves : 0) +
+					 (right ? right->nleaves : 0));
+	return node;
+}
+
+static regex_node *
+__regex_make_leaf(regex_parser *rp, regex_class *cls)
+{
+	regex_node *node = palloc0(sizeof(regex_node));
+
+	if (rp->icase)
+	{
+		/*
+		 * case folding of ASCII letters also depends on the locale;
+		 * e.g, 'i' is folded to U+0130 in the Turkish locale.
+		 */
+		if (!rp->ctype_is_c &&
+			((cls->ascii[1] & 0x07fffffe07fffffeUL) != 0))
+		{
+			rp->errmsg = "case-insensitive match on letters depends on the locale";
+			return NULL;
+		}
+		/* ASCII letters match both of upper and lower cases */
+		for (int c='A'; c <= 'Z'; c++)
+		{
+			int		l = c + ('a' - 'A');
+			uint64_t mask_c = (1UL << (c & 63));
+			uint64_t mask_l = (1UL << (l & 63));
+
+			if ((cls->ascii[c >> 6] & mask_c) != 0 ||
+				(cls->ascii[l >> 6] & mask_l) != 0)
+			{
+				cls->ascii[c >> 6] |= mask_c;
+				cls->ascii[l >> 6] |= mask_l;
+			}
+		}
+	}
+	node->kind = REGEX_NODE__LEAF;
+	node->nleaves = 1;
+	node->cls = cls;
+	return node;
+}
+
+static regex_node *
+__regex_make_concat(regex_node *left, regex_node *right)
+{
+	if (!left)
+		return right;
+	return __regex_make_node(REGEX_NODE__CONCAT, left, right);
+}
+
+static regex_node *
+__regex_copy_node(regex_node *node)
+{
+	regex_node *copy = palloc(sizeof(regex_node));
+
+	memcpy(copy, node, sizeof(regex_node));
+	if (node->left)
+		copy->left = __regex_copy_node(node->left);
+	if (node->right)
+		copy->right = __regex_copy_node(node->right);
+	return copy;
+}
+
+static bool
+__regex_class_add_range(regex_parser *rp, regex_class *cls,
+						pg_wchar lo, pg_wchar hi)
+{
+	if (lo > hi)
+	{
+		rp->errmsg = "invalid character range";
+		return false;
+	}
+	for (pg_wchar c = lo; c <= hi && c < 128; c++)
+		cls->ascii[c >> 6] |= (1UL << (c & 63));
+	if (hi >= 128)
+	{
+		/* case folding of non-ASCII characters depends on the locale */
+		if (rp->icase && !rp->ctype_is_c)
+		{
+			rp->errmsg = "case-insensitive match on non-ASCII characters";
+			return false;
+		}
+		if (cls->nranges == cls->nrooms)
+		{
+			cls->nrooms = 2 * cls->nrooms + 4;
+			if (!cls->ranges)
+				cls->ranges = palloc(sizeof(kern_regex_range) * cls->nrooms);
+			else
+				cls->ranges = repalloc(cls->ranges,
+									   sizeof(kern_regex_range) * cls->nrooms);
+		}
+		cls->ranges[cls->nranges].lo = Max(lo, 128);
+		cls->ranges[cls->nranges].hi = hi;
+		cls->nranges++;
+	}
+	return true;
+}
+
+static bool
+__regex_class_add_named(regex_parser *rp, regex_class *cls, const char *name)
+{
+	/*
+	 * locale_aware: 0 = never depends on the locale, 1 = ASCII only on
+	 * the C and libc collations (iswdigit/iswxdigit), but ICU may match
+	 * non-ASCII digits, 2 = depends on the locale except for C collation.
+	 */
+	static struct {
+		const char *name;
+		int			locale_aware;
+		const char *ranges;		/* pairs of lo/hi of ASCII chars */
+	} regex_named_classes[] = {
+		{"digit",  1, "09"},
+		{"xdigit", 1, "09AFaf"},
+		{"alpha",  2, "AZaz"},
+		{"alnum",  2, "09AZaz"},
+		{"upper",  2, "AZ"},
+		{"lower",  2, "az"},
+		{"space",  2, "  \t\r"},
+		{"blank",  2, "  \t\t"},
+		{"punct",  2, "!/:@[`{~"},
+		{"print",  2, " ~"},
+		{"graph",  2, "!~"},
+		{"cntrl",  2, "\x01\x1f\x7f\x7f"},
+		{"ascii",  0, "\x01\x7f"},
+		{NULL, 0, NULL},
+	};
+
+	for (int i=0; regex_named_classes[i].name; i++)
+	{
+		const char *ranges = regex_named_classes[i].ranges;
+
+		if (strcmp(name, regex_named_classes[i].name) != 0)
+			continue;
+		/* non-ASCII characters may belong to the class on the locale */
+		if ((regex_named_classes[i].locale_aware == 1 && !rp->ctype_is_libc) ||
+			(regex_named_classes[i].locale_aware == 2 && !rp->ctype_is_c))
+		{
+			rp->errmsg = "character class depends on the locale";
+			return false;
+		}
+		for (int j=0; ranges[j] != '\0'; j += 2)
+		{
+			if (!__regex_class_add_range(rp, cls, ranges[j], ranges[j+1]))
+				return false;
+		}
+		return true;
+	}
+	rp->errmsg = "invalid character class";
+	return false;
+}
+
+/*
+ * __regex_parse_escape - parses the escape sequence next to the backslash.
+ * It returns 1 with *p_char for a character-entry escape, 0 if it added
+ * class-shorthand escape to the 'cls', or -1 if not supported.
+ */
+static int
+__regex_parse_escape(regex_parser *rp, regex_class *cls, bool in_bracket,
+					 pg_wchar *p_char)
+{
+	pg_wchar	c;
+	bool		rv;
+
+	if (rp->pos >= rp->len)
+	{
+		rp->errmsg = "invalid escape \\ sequence";
+		return -1;
+	}
+	c = rp->pat[rp->pos++];
+	switch (c)
+	{
+		case 'a':	*p_char = '\007';	return 1;
+		case 'b':	*p_char = '\b';		return 1;
+		case 'e':	*p_char = '\033';	return 1;
+		case 'f':	*p_char = '\f';		return 1;
+		case 'n':	*p_char = '\n';		return 1;
+		case 'r':	*p_char = '\r';		return 1;
+		case 't':	*p_char = '\t';		return 1;
+		case 'v':	*p_char = '\v';		return 1;
+		case 'd':
+		case 's':
+		case 'w':
+		case 'D':
+		case 'S':
+		case 'W':
+			if (c == 'D' || c == 'S' || c == 'W')
+			{
+				/* the negated class is not valid in the bracket */
+				if (in_bracket)
+				{
+					rp->errmsg = "invalid escape \\ sequence";
+					return -1;
+				}
+				cls->negated = true;
+			}
+			if (c == 'd' || c == 'D')
+				rv = __regex_class_add_named(rp, cls, "digit");
+			else if (c == 's' || c == 'S')
+				rv = __regex_class_add_named(rp, cls, "space");
+			else
+				rv = (__regex_class_add_named(rp, cls, "alnum") &&
+					  __regex_class_add_range(rp, cls, '_', '_'));
+			return (rv ? 0 : -1);
+		default:
+			if ((c >= '0' && c <= '9') ||
+				(c >= 'A' && c <= 'Z') ||
+				(c >= 'a' && c <= 'z'))
+			{
+				/* back-references, constraint escapes, and so on */
+				rp->errmsg = "unsupported escape \\ sequence";
+				return -1;
+			}
+			*p_char = c;
+			return 1;
+	}
+}
+
+static regex_class *
+__regex_parse_bracket(regex_parser *rp)
+{
+	regex_class *cls = palloc0(sizeof(regex_class));
+	bool		is_first = true;
+
+	if (rp->pos < rp->len && rp->pat[rp->pos] == '^')
+	{
+		cls->negated = true;
+		rp->pos++;
+	}
+	for (;;)
+	{
+		pg_wchar	c, lo, hi;
+
+		if (rp->pos >= rp->len)
+		{
+			rp->errmsg = "brackets [] not balanced";
+			return NULL;
+		}
+		c = rp->pat[rp->pos];
+		if (c == ']' && !is_first)
+		{
+			rp->pos++;
+			break;
+		}
+		is_first = false;
+
+		if (c == '[' && rp->pos + 1 < rp->len &&
+			rp->pat[rp->pos + 1] == ':')
+		{
+			char		name[20];
+			int			k = 0;
+
+			rp->pos += 2;
+			while (rp->pos < rp->len &&
+				   rp->pat[rp->pos] != ':' &&
+				   k < sizeof(name) - 1)
+				name[k++] = (char)rp->pat[rp->pos++];
+			name[k] = '\0';
+			if (rp->pos + 1 >= rp->len ||
+				rp->pat[rp->pos] != ':' ||
+				rp->pat[rp->pos + 1] != ']')
+			{
+				rp->errmsg = "invalid character class";
+				return NULL;
+			}
+			rp->pos += 2;
+			if (!__regex_class_add_named(rp, cls, name))
+				return NULL;
+			continue;
+		}
+		if (c == '[' && rp->pos + 1 < rp->len &&
+			(rp->pat[rp->pos + 1] == '.' || rp->pat[rp->pos + 1] == '='))
+		{
+			rp->errmsg = "collating element is not supported";
+			return NULL;
+		}
+		rp->pos++;
+		if (c == '\\')
+		{
+			int		rv = __regex_parse_escape(rp, cls, true, &c);
+
+			if (rv < 0)
+				return NULL;
+			if (rv == 0)
+				continue;
+		}
+		lo = hi = c;
+		/* a range, unless '-' is the last character in the bracket */
+		if (rp->pos + 1 < rp->len &&
+			rp->pat[rp->pos] == '-' &&
+			rp->pat[rp->pos + 1] != ']')
+		{
+			rp->pos++;
+			c = rp->pat[rp->pos++];
+			if (c == '[' ||
+				(c == '\\' && __regex_parse_escape(rp, cls, true, &c) != 1))
+			{
+				if (!rp->errmsg)
+					rp->errmsg = "invalid character range";
+				return NULL;
+			}
+			hi = c;
+		}
+		if (!__regex_class_add_range(rp, cls, lo, hi))
+			return NULL;
+	}
+	return cls;
+}
+
+static regex_node *
+__regex_parse_atom(regex_parser *rp)
+{
+	regex_class *cls;
+	regex_node *node;
+	pg_wchar	c = rp->pat[rp->pos++];
+	int			rv;
+
+	switch (c)
+	{
+		case '(':
+			if (rp->pos < rp->len && rp->pat[rp->pos] == '?')
+			{
+				/* only non-capturing group is supported */
+				if (rp->pos + 1 >= rp->len || rp->pat[rp->pos + 1] != ':')
+				{
+					rp->errmsg = "lookahead constraint or embedded option";
+					return NULL;
+				}
+				rp->pos += 2;
+			}
+			rp->depth++;
+			node = __regex_parse_alt(rp);
+			if (!node)
+				return NULL;
+			if (rp->pos >= rp->len || rp->pat[rp->pos] != ')')
+			{
+				rp->errmsg = "parentheses () not balanced";
+				return NULL;
+			}
+			rp->pos++;
+			rp->depth--;
+			return node;
+		case '[':
+			cls = __regex_parse_bracket(rp);
+			if (!cls)
+				return NULL;
+			return __regex_make_leaf(rp, cls);
+		case '.':
+			cls = palloc0(sizeof(regex_class));
+			cls->negated = true;
+			return __regex_make_leaf(rp, cls);
+		case '\\':
+			cls = palloc0(sizeof(regex_class));
+			rv = __regex_parse_escape(rp, cls, false, &c);
+			if (rv < 0)
+				return NULL;
+			if (rv > 0 && !__regex_class_add_range(rp, cls, c, c))
+				return NULL;
+			return __regex_make_leaf(rp, cls);
+		case '^':
+		case '$':
+			rp->errmsg = "anchor in the middle of the pattern";
+			return NULL;
+		case '*':
+		case '+':
+		case '?':
+		case '{':
+			rp->errmsg = "quantifier operand invalid";
+			return NULL;
+		default:
+			cls = palloc0(sizeof(regex_class));
+			if (!__regex_class_add_range(rp, cls, c, c))
+				return NULL;
+			return __regex_make_leaf(rp, cls);
+	}
+}
+
+static bool
+__regex_parse_bound(regex_parser *rp, int *p_value)
+{
+	int		value = 0;
+	int		ndigits = 0;
+
+	while (rp->pos < rp->len &&
+		   rp->pat[rp->pos] >= '0' &&
+		   rp->pat[rp->pos] <= '9')
+	{
+		value = 10 * value + (rp->pat[rp->pos++] - '0');
+		if (value > REGEX_MAX_REPEAT)
+		{
+			rp->errmsg = "invalid repetition count(s)";
+			return false;
+		}
+		ndigits++;
+	}
+	*p_value = value;
+	return (ndigits > 0);
+}
+
+static regex_node *
+__regex_repeat(regex_parser *rp, regex_node *node, int min, int max)
+{
+	regex_node *result = NULL;
+
+	/* max < 0 means infinity */
+	if (max >= 0 && min > max)
+	{
+		rp->errmsg = "invalid repetition count(s)";
+		return NULL;
+	}
+	if (node->nleaves * (max < 0 ? min + 1 : max) > KERN_REGEX_MAX_NPOS)
+	{
+		rp->errmsg = "pattern is too complicated";
+		return NULL;
+	}
+	for (int i=0; i < min; i++)
+		result = __regex_make_concat(result, __regex_copy_node(node));
+	if (max < 0)
+		result = __regex_make_concat(result,
+									 __regex_make_node(REGEX_NODE__STAR,
+													   node, NULL));
+	else
+	{
+		for (int i=min; i < max; i++)
+			result = __regex_make_concat(result,
+										 __regex_make_node(REGEX_NODE__QUEST,
+														   __regex_copy_node(node),
+														   NULL));
+	}
+	if (!result)
+		result = __regex_make_node(REGEX_NODE__EMPTY, NULL, NULL);
+	return result;
+}
+
+static regex_node *
+__regex_parse_piece(regex_parser *rp)
+{
+	regex_node *node = __regex_parse_atom(rp);
+	int			min, max;
+
+	if (!node || rp->pos >= rp->len)
+		return node;
+	switch (rp->pat[rp->pos])
+	{
+		case '*':
+			rp->pos++;
+			node = __regex_make_node(REGEX_NODE__STAR, node, NULL);
+			break;
+		case '+':
+			rp->pos++;
+			node = __regex_make_node(REGEX_NODE__PLUS, node, NULL);
+			break;
+		case '?':
+			rp->pos++;
+			node = __regex_make_node(REGEX_NODE__QUEST, node, NULL);
+			break;
+		case '{':
+			rp->pos++;
+			if (!__regex_parse_bound(rp, &min))
+				goto bailout;
+			max = min;
+			if (rp->pos < rp->len && rp->pat[rp->pos] == ',')
+			{
+				rp->pos++;
+				if (rp->pos < rp->len && rp->pat[rp->pos] == '}')
+					max = -1;
+				else if (!__regex_parse_bound(rp, &max))
+					goto bailout;
+			}
+			if (rp->pos >= rp->len || rp->pat[rp->pos] != '}')
+				goto bailout;
+			rp->pos++;
+			node = __regex_repeat(rp, node, min, max);
+			if (!node)
+				return NULL;
+			break;
+		default:
+			return node;
+	}
+	/* non-greedy quantifier makes no difference for boolean match */
+	if (rp->pos < rp->len && rp->pat[rp->pos] == '?')
+		rp->pos++;
+	if (rp->pos < rp->len && (rp->pat[rp->pos] == '*' ||
+							  rp->pat[rp->pos] == '+' ||
+							  rp->pat[rp->pos] == '?' ||
+							  rp->pat[rp->pos] == '{'))
+	{
+		rp->errmsg = "quantifier operand invalid";
+		return NULL;
+	}
+	return node;
+
+bailout:
+	if (!rp->errmsg)
+		rp->errmsg = "invalid repetition count(s)";
+	return NULL;
+}
+
+static regex_node *
+__regex_parse_concat(regex_parser *rp)
+{
+	regex_node *result = NULL;
+
+	while (rp->pos < rp->len &&
+		   rp->pat[rp->pos] != '|' &&
+		   rp->pat[rp->pos] != ')')
+	{
+		regex_node *node = __regex_parse_piece(rp);
+
+		if (!node)
+			return NULL;
+		result = __regex_make_concat(result, node);
+		if (result->nleaves > KERN_REGEX_MAX_NPOS)
+		{
+			rp->errmsg = "pattern is too complicated";
+			return NULL;
+		}
+	}
+	if (!result)
+		result = __regex_make_node(REGEX_NODE__EMPTY, NULL, NULL);
+	return result;
+}
+
+static regex_node *
+__regex_parse_alt(regex_parser *rp)
+{
+	regex_node *result = __regex_parse_concat(rp);
+
+	while (result && rp->pos < rp->len && rp->pat[rp->pos] == '|')
+	{
+		regex_node *node;
+
+		rp->pos++;
+		if (rp->depth == 0)
+			rp->toplevel_alt = true;
+		node = __regex_parse_concat(rp);
+		if (!node)
+			return NULL;
+		result = __regex_make_node(REGEX_NODE__ALT, result, node);
+		if (result->nleaves > KERN_REGEX_MAX_NPOS)
+		{
+			rp->errmsg = "pattern is too complicated";
+			return NULL;
+		}
+	}
+	return result;
+}
+
+/*
+ * __regex_glushkov - assigns the positions for each leaf, and computes
+ * the first / last set of the sub-tree and the follow set of the positions.
+ * It returns whether the sub-tree matches an empty string.
+ */
+static bool
+__regex_glushkov(regex_glushkov *gk, regex_node *node,
+				 uint64_t *p_first, uint64_t *p_last)
+{
+	uint64_t	first_l, last_l, first_r, last_r, mask;
+	bool		nullable_l, nullable_r;
+
+	switch (node->kind)
+	{
+		case REGEX_NODE__EMPTY:
+			*p_first = *p_last = 0;
+			return true;
+		case REGEX_NODE__LEAF:
+			Assert(gk->npos < KERN_REGEX_MAX_NPOS);
+			gk->classes[gk->npos] = node->cls;
+			*p_first = *p_last = (1UL << gk->npos);
+			gk->npos++;
+			return false;
+		case REGEX_NODE__CONCAT:
+			nullable_l = __regex_glushkov(gk, node->left, &first_l, &last_l);
+			nullable_r = __regex_glushkov(gk, node->right, &first_r, &last_r);
+			for (int i=0; i < KERN_REGEX_MAX_NPOS; i++)
+			{
+				if ((last_l & (1UL << i)) != 0)
+					gk->follow[i] |= first_r;
+			}
+			*p_first = first_l | (nullable_l ? first_r : 0);
+			*p_last  = last_r  | (nullable_r ? last_l  : 0);
+			return (nullable_l && nullable_r);
+		case REGEX_NODE__ALT:
+			nullable_l = __regex_glushkov(gk, node->left, &first_l, &last_l);
+			nullable_r = __regex_glushkov(gk, node->right, &first_r, &last_r);
+			*p_first = first_l | first_r;
+			*p_last  = last_l  | last_r;
+			return (nullable_l || nullable_r);
+		case REGEX_NODE__STAR:
+		case REGEX_NODE__PLUS:
+			nullable_l = __regex_glushkov(gk, node->left, &first_l, &last_l);
+			for (int i=0; i < KERN_REGEX_MAX_NPOS; i++)
+			{
+				mask = (1UL << i);
+				if ((last_l & mask) != 0)
+					gk->follow[i] |= first_l;
+			}
+			*p_first = first_l;
+			*p_last  = last_l;
+			return (node->kind == REGEX_NODE__STAR || nullable_l);
+		case REGEX_NODE__QUEST:
+			__regex_glushkov(gk, node->left, p_first, p_last);
+			return true;
+		default:
+			elog(ERROR, "unknown regex node kind: %d", node->kind);
+	}
+	return false;
+}
+
+/*
+ * __codegen_regex_compile
+ *
+ * It compiles the regular expression to kern_regex_program, or returns
+ * the reason why the pattern is not supported.
+ */
+static const char *
+__codegen_regex_compile(const char *pattern, int pattern_len,
+						uint32_t *p_regex_flags,
+						Oid func_collid,
+						StringInfo payload)
+{
+	regex_parser rp;
+	regex_glushkov gk;
+	regex_node *root;
+	pg_wchar   *wpat;
+	int			wlen;
+	uint32_t	regex_flags = *p_regex_flags;
+	uint64_t	first, last;
+	kern_regex_program *prog;
+	int			nranges = 0;
+	size_t		sz;
+
+	if (GetDatabaseEncoding() == PG_UTF8)
+		regex_flags |= KERN_REGEX_FLAG__UTF8;
+	else if (pg_database_encoding_max_length() > 1)
+		return "multi-byte encoding other than UTF-8";
+
+	wpat = palloc(sizeof(pg_wchar) * (pattern_len + 1));
+	wlen = pg_mb2wchar_with_len(pattern, wpat, pattern_len);
+
+	memset(&rp, 0, sizeof(regex_parser));
+	rp.pat = wpat;
+	rp.len = wlen;
+	rp.icase = ((regex_flags & KERN_REGEX_FLAG__ICASE) != 0);
+	rp.ctype_is_c = (OidIsValid(func_collid) && lc_ctype_is_c(func_collid));
+	rp.ctype_is_libc = rp.ctype_is_c;
+	if (OidIsValid(func_collid) && !rp.ctype_is_c)
+	{
+		pg_locale_t	locale = pg_newlocale_from_collation(func_collid);
+
+		/* NULL means the default collation by libc */
+		rp.ctype_is_libc = (!locale || locale->provider == COLLPROVIDER_LIBC);
+	}
+	/* director prefix and embedded options at the head */
+	if ((wlen >= 3 && wpat[0] == '*' && wpat[1] == '*' && wpat[2] == '*') ||
+		(wlen >= 2 && wpat[0] == '(' && wpat[1] == '?' &&
+		 (wlen < 3 || wpat[2] != ':')))
+		return "director or embedded options";
+	/* anchors of the whole pattern */
+	if (rp.len > 0 && rp.pat[0] == '^')
+	{
+		regex_flags |= KERN_REGEX_FLAG__HEAD;
+		rp.pat++;
+		rp.len--;
+	}
+	if (rp.len > 0 && rp.pat[rp.len - 1] == '$')
+	{
+		int		nbackslashes = 0;
+
+		while (nbackslashes < rp.len - 1 &&
+			   rp.pat[rp.len - 2 - nbackslashes] == '\\')
+			nbackslashes++;
+		if (nbackslashes % 2 == 0)
+		{
+			regex_flags |= KERN_REGEX_FLAG__TAIL;
+			rp.len--;
+		}
+	}
+	root = __regex_parse_alt(&rp);
+	if (!root)
+		return rp.errmsg;
+	if (rp.pos < rp.len)
+		return "parentheses () not balanced";
+	/* '^a|b' means '(^a)|b', not '^(a|b)' */
+	if (rp.toplevel_alt &&
+		(regex_flags & (KERN_REGEX_FLAG__HEAD | KERN_REGEX_FLAG__TAIL)) != 0)
+		return "anchor in the alternation";
+	if (root->nleaves > KERN_REGEX_MAX_NPOS)
+		return "pattern is too complicated";
+
+	/* build the position automaton */
+	memset(&gk, 0, sizeof(regex_glushkov));
+	if (__regex_glushkov(&gk, root, &first, &last))
+		regex_flags |= KERN_REGEX_FLAG__NULLABLE;
+	for (int i=0; i < gk.npos; i++)
+		nranges += gk.classes[i]->nranges;
+	if (nranges > PG_UINT16_MAX)
+		return "pattern is too complicated";
+
+	sz = offsetof(kern_regex_program, ranges[nranges]);
+	prog = palloc0(sz);
+	prog->npos = gk.npos;
+	prog->nranges = 0;
+	prog->first = first;
+	prog->last = last;
+	for (int i=0; i < gk.npos; i++)
+	{
+		regex_class *cls = gk.classes[i];
+		uint64_t	mask = (1UL << i);
+
+		prog->follow[i] = gk.follow[i];
+		for (int c=0; c < 128; c++)
+		{
+			bool	member = ((cls->ascii[c >> 6] & (1UL << (c & 63))) != 0);
+
+			if (member != cls->negated)
+				prog->ascii[c] |= mask;
+		}
+		if (cls->nranges == 0)
+		{
+			if (cls->negated)
+				prog->mb_any |= mask;
+		}
+		else
+		{
+			prog->mb_check |= mask;
+			if (cls->negated)
+				prog->mb_negated |= mask;
+			prog->range_head[i] = prog->nranges;
+			prog->range_nums[i] = cls->nranges;
+			memcpy(prog->ranges + prog->nranges, cls->ranges,
+				   sizeof(kern_regex_range) * cls->nranges);
+			prog->nranges += cls->nranges;
+		}
+	}
+	appendBinaryStringInfo(payload, (char *)prog, sz);
+	*p_regex_flags = regex_flags;
+	pfree(prog);
+	pfree(wpat);
+
+	return NULL;
+}
+
+/*
+ * codegen_regex_expression
+ */
+static int
+codegen_regex_expression(codegen_context *context,
+						 StringInfo buf,
+						 int curr_depth,
+						 devfunc_info *dfunc,
+						 List *func_args,
+						 Oid func_collid)
+{
+	kern_expression kexp;
+	StringInfoData payload;
+	uint32_t	regex_flags = 0;
+	Const	   *con;
+	text	   *pattern;
+	const char *errmsg;
+
+	switch (dfunc->func_code)
+	{
+		case FuncOpCode__textregexeq:
+		case FuncOpCode__bpcharregexeq:
+		case FuncOpCode__regexp_like:
+			break;
+		case FuncOpCode__textregexne:
+		case FuncOpCode__bpcharregexne:
+			regex_flags |= KERN_REGEX_FLAG__NEGATIVE;
+			break;
+		case FuncOpCode__texticregexeq:
+		case FuncOpCode__bpcharicregexeq:
+			regex_flags |= KERN_REGEX_FLAG__ICASE;
+			break;
+		case FuncOpCode__texticregexne:
+		case FuncOpCode__bpcharicregexne:
+			regex_flags |= (KERN_REGEX_FLAG__NEGATIVE | KERN_REGEX_FLAG__ICASE);
+			break;
+		default:
+			__Elog("unexpected regular expression function: %s",
+				   dfunc->func_name);
+	}
+	if (list_length(func_args) != 2)
+		__Elog("regular expression function must take two arguments");
+	con = lsecond(func_args);
+	if (!IsA(con, Const) || con->constisnull)
+		__Elog("regular expression with non-constant pattern is not supported");
+	pattern = DatumGetTextPP(con->constvalue);
+
+	initStringInfo(&payload);
+	errmsg = __codegen_regex_compile(VARDATA_ANY(pattern),
+									 VARSIZE_ANY_EXHDR(pattern),
+									 &regex_flags,
+									 func_collid,
+									 &payload);
+	if (errmsg)
+		__Elog("regular expression '%s' is not supported: %s",
+			   TextDatumGetCString(con->constvalue), errmsg);
+	context->device_cost += dfunc->func_cost;
+
+	memset(&kexp, 0, sizeof(kexp));
+	kexp.opcode = FuncOpCode__RegexMatch;
+	kexp.u.regex.regex_flags = regex_flags;
+	kexp.u.regex.pattern_offset = payload.len;
+	kexp.u.regex.pattern_len = VARSIZE_ANY_EXHDR(pattern);
+	appendBinaryStringInfo(&payload,
+						   VARDATA_ANY(pattern),
+						   VARSIZE_ANY_EXHDR(pattern));
+	return __codegen_precompiled_expression(context, buf, curr_depth, &kexp,
+											offsetof(kern_expression,
+													 u.regex.data),
+											&payload,
+											linitial(func_args));
+}
+
 static int
 __codegen_func_expression(codegen_context *context,
 						  StringInfo buf,
@@ -1603,6 +2702,7 @@ __codegen_func_expression(codegen_context *context,
 	devfunc_info   *dfunc;
 	devtype_info   *dtype;
 	kern_expression	kexp;
+	StringInfoData	payload;
 	int				pos = -1;
 	ListCell	   *lc;
 
@@ -1611,6 +2711,33 @@ __codegen_func_expression(codegen_context *context,
 		(dfunc->func_flags & context->required_flags) != context->required_flags)
 		__Elog("function %s is not supported on the target device",
 			   format_procedure(func_oid));
+
+	/* LIKE/ILIKE with constant pattern */
+	memset(&kexp, 0, sizeof(kexp));
+	initStringInfo(&payload);
+	if (__codegen_like_pattern(dfunc, func_args, &kexp, &payload))
+		return codegen_like_expression(context, buf, curr_depth,
+									   dfunc, func_args, &kexp, &payload);
+	pfree(payload.data);
+
+	/* regular expressions */
+	switch (dfunc->func_code)
+	{
+		case FuncOpCode__textregexeq:
+		case FuncOpCode__textregexne:
+		case FuncOpCode__texticregexeq:
+		case FuncOpCode__texticregexne:
+		case FuncOpCode__bpcharregexeq:
+		case FuncOpCode__bpcharregexne:
+		case FuncOpCode__bpcharicregexeq:
+		case FuncOpCode__bpcharicregexne:
+		case FuncOpCode__regexp_like:
+			return codegen_regex_expression(context, buf, curr_depth,
+											dfunc, func_args, func_collid);
+		default:
+			break;
+	}
+
 	dtype = dfunc->func_rettype;
 	context->device_cost += dfunc->func_cost;
 
@@ -2177,19 +3304,215 @@ codegen_casewhen_expression(codegen_context *context,
 	/* ELSE <expression> */
 	if (caseexpr->defresult)
 	{
-		if (buf)
-			kexp.u.casewhen.case_else = (__appendZeroStringInfo(buf, 0) - pos);
-		if (codegen_expression_walker(context, buf,
-									  curr_depth,
-									  caseexpr->defresult) < 0)
-			return -1;
+		if (buf)
+			kexp.u.casewhen.case_else = (__appendZeroStringInfo(buf, 0) - pos);
+		if (codegen_expression_walker(context, buf,
+									  curr_depth,
+									  caseexpr->defresult) < 0)
+			return -1;
+	}
+	if (buf)
+	{
+		memcpy(buf->data + pos, &kexp, kexp.args_offset);
+		__appendKernExpMagicAndLength(buf, pos);
+	}
+	return 0;
+}
+
+/*
+ * codegen_scalar_array_op_hash
+ *
+ * 'SCALAR = ANY(ARRAY)' or 'SCALAR <> ALL(ARRAY)' with a large constant
+ * array, or a parameter array, of integer or date/time values is built to
+ * the hash table of the 64bit keys, then the xPU device probes it by the
+ * scalar value, instead of the linear scan on the array for each row.
+ * It returns 1 if the expression is not applicable, and the caller falls
+ * back to the generic ScalarArrayOp.
+ */
+static TypeOpCode
+__saop_hash_key_class(TypeOpCode type_code)
+{
+	switch (type_code)
+	{
+		case TypeOpCode__int1:
+		case TypeOpCode__int2:
+		case TypeOpCode__int4:
+		case TypeOpCode__int8:
+			/* integers are comparable to each other */
+			return TypeOpCode__int8;
+		case TypeOpCode__date:
+		case TypeOpCode__time:
+		case TypeOpCode__timestamp:
+		case TypeOpCode__timestamptz:
+		case TypeOpCode__money:
+			return type_code;
+		default:
+			return TypeOpCode__Invalid;
+	}
+}
+
+static uint64_t
+__saop_hash_datum_key(TypeOpCode type_code, Datum datum)
+{
+	switch (type_code)
+	{
+		case TypeOpCode__int1:
+			return (int64_t)((int8_t)DatumGetUInt8(datum));
+		case TypeOpCode__int2:
+			return (int64_t)DatumGetInt16(datum);
+		case TypeOpCode__int4:
+		case TypeOpCode__date:
+			return (int64_t)DatumGetInt32(datum);
+		default:
+			return (uint64_t)DatumGetInt64(datum);
+	}
+}
+
+/*
+ * pgstrom_build_saop_hash
+ *
+ * It builds kern_saop_hash of the array; on the planning time for the
+ * constant array, or on the session setup for the parameter array.
+ */
+kern_saop_hash *
+pgstrom_build_saop_hash(ArrayType *array, size_t *p_length)
+{
+	Oid				elemtype = ARR_ELEMTYPE(array);
+	devtype_info   *dtype = pgstrom_devtype_lookup(elemtype);
+	kern_saop_hash *hash;
+	uint32_t	   *used;
+	Datum		   *values;
+	bool		   *nulls;
+	int				nitems;
+	int16			typlen;
+	bool			typbyval;
+	char			typalign;
+	uint32_t		nslots = 2;
+	size_t			length;
+
+	get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+	if (!dtype || !typbyval ||
+		__saop_hash_key_class(dtype->type_code) == TypeOpCode__Invalid)
+		elog(ERROR, "Bug? type %s is not a supported key of ScalarArrayOpHash",
+			 format_type_be(elemtype));
+	deconstruct_array(array, elemtype,
+					  typlen, typbyval, typalign,
+					  &values, &nulls, &nitems);
+	while (nslots < 2 * nitems)
+		nslots *= 2;
+	length = KERN_SAOP_HASH_LENGTH(nslots);
+	hash = palloc0(length);
+	hash->nslots = nslots;
+	hash->nitems = nitems;
+	used = KERN_SAOP_HASH_USEDMAP(hash);
+	for (int i=0; i < nitems; i++)
+	{
+		uint64_t	key;
+		uint32_t	index;
+
+		if (nulls[i])
+		{
+			hash->has_nulls = true;
+			continue;
+		}
+		key = __saop_hash_datum_key(dtype->type_code, values[i]);
+		index = __saop_hash_key(key) & (nslots - 1);
+		while ((used[index >> 5] & (1U << (index & 31))) != 0)
+		{
+			if (hash->keys[index] == key)
+				break;
+			index = (index + 1) & (nslots - 1);
+		}
+		if ((used[index >> 5] & (1U << (index & 31))) == 0)
+		{
+			hash->keys[index] = key;
+			used[index >> 5] |= (1U << (index & 31));
+			hash->nkeys++;
+		}
+	}
+	pfree(values);
+	pfree(nulls);
+
+	*p_length = length;
+	return hash;
+}
+
+static int
+codegen_scalar_array_op_hash(codegen_context *context,
+							 StringInfo buf, int curr_depth,
+							 bool use_or, Oid op_oid,
+							 Expr *expr_a, Expr *expr_s,
+							 devtype_info *dtype_s,
+							 devtype_info *dtype_e)
+{
+	kern_expression	kexp;
+	StringInfoData	payload;
+	uint32_t		saop_flags = 0;
+	int				status;
+
+	if (!dtype_e->type_byval ||
+		__saop_hash_key_class(dtype_s->type_code) == TypeOpCode__Invalid ||
+		__saop_hash_key_class(dtype_s->type_code) !=
+		__saop_hash_key_class(dtype_e->type_code))
+		return 1;
+	/* only equality (ANY) or inequality (ALL) operator */
+	if (!use_or)
+	{
+		op_oid = get_negator(op_oid);
+		saop_flags |= KERN_SAOP_HASH_FLAG__NEGATIVE;
+	}
+	if (!OidIsValid(op_oid) ||
+		!(op_mergejoinable(op_oid, dtype_s->type_oid) ||
+		  op_hashjoinable(op_oid, dtype_s->type_oid)))
+		return 1;
+
+	memset(&kexp, 0, sizeof(kexp));
+	initStringInfo(&payload);
+	if (IsA(expr_a, Const))
+	{
+		Const		   *con = (Const *)expr_a;
+		ArrayType	   *array;
+		kern_saop_hash *hash;
+		size_t			length;
+
+		if (con->constisnull)
+			return 1;
+		array = DatumGetArrayTypeP(con->constvalue);
+		if (ARR_ELEMTYPE(array) != dtype_e->type_oid ||
+			ArrayGetNItems(ARR_NDIM(array),
+						   ARR_DIMS(array)) < KERN_SAOP_HASH_MIN_NITEMS)
+			return 1;
+		hash = pgstrom_build_saop_hash(array, &length);
+		appendBinaryStringInfo(&payload, (char *)hash, length);
+		pfree(hash);
 	}
-	if (buf)
+	else if (IsA(expr_a, Param) &&
+			 ((Param *)expr_a)->paramkind == PARAM_EXTERN)
 	{
-		memcpy(buf->data + pos, &kexp, kexp.args_offset);
-		__appendKernExpMagicAndLength(buf, pos);
+		Param	   *param = (Param *)expr_a;
+
+		/*
+		 * The parameter array is not known on the planning time, so its hash
+		 * table is built on the session setup, regardless of the number of
+		 * items; 'id = ANY($1)' usually takes a large IN-list.
+		 */
+		saop_flags |= KERN_SAOP_HASH_FLAG__PARAM;
+		kexp.u.saop_hash.param_id = param->paramid;
+		context->saop_hash_params = list_append_unique(context->saop_hash_params,
+													   param);
 	}
-	return 0;
+	else
+		return 1;
+
+	kexp.opcode = FuncOpCode__ScalarArrayOpHash;
+	kexp.u.saop_hash.saop_flags = saop_flags;
+	status = __codegen_precompiled_expression(context, buf, curr_depth, &kexp,
+											  offsetof(kern_expression,
+													   u.saop_hash.data),
+											  &payload,
+											  expr_s);
+	pfree(payload.data);
+	return status;
 }
 
 /*
@@ -2204,9 +3527,11 @@ codegen_scalar_array_op_expression(codegen_context *context,
 	devtype_info   *dtype_a, *dtype_s, *dtype_e;
 	devfunc_info   *dfunc;
 	Oid				type_oid;
+	Oid				op_oid;
 	Oid				func_oid;
 	Oid				argtypes[2];
 	int				pos = -1, __pos = -1;
+	int				status;
 	codegen_kvar_defitem *kvdef;
 	kern_expression	kexp;
 
@@ -2227,114 +3552,518 @@ codegen_scalar_array_op_expression(codegen_context *context,
 	if (!dtype_s)
 		__Elog("type %s is not device supported", format_type_be(type_oid));
 
-	if (dtype_s->type_element == NULL &&
-		dtype_a->type_element != NULL)
+	if (dtype_s->type_element == NULL &&
+		dtype_a->type_element != NULL)
+	{
+		op_oid = sa_op->opno;
+		func_oid = get_opcode(op_oid);
+	}
+	else if (dtype_s->type_element != NULL &&
+			 dtype_a->type_element == NULL)
+	{
+		/* swap arguments */
+		Expr		   *expr_temp  = expr_a;
+		devtype_info   *dtype_temp = dtype_a;
+
+		expr_a  = expr_s;
+		dtype_a = dtype_s;
+		expr_s  = expr_temp;
+		dtype_s = dtype_temp;
+		op_oid = get_commutator(sa_op->opno);
+		func_oid = get_opcode(op_oid);
+	}
+	else
+	{
+		__Elog("ScalarArrayOpExpr must be 'SCALAR = %s ARRAY' form",
+			   sa_op->useOr ? "ANY" : "ALL");
+	}
+	dtype_e = dtype_a->type_element;
+	argtypes[0] = dtype_s->type_oid;
+	argtypes[1] = dtype_e->type_oid;
+	dfunc = __pgstrom_devfunc_lookup(func_oid,
+									 2, argtypes,
+									 sa_op->inputcollid);
+	if (!dfunc)
+		__Elog("function %s is not device supported",
+			   format_procedure(func_oid));
+	if (dfunc->func_rettype->type_oid != BOOLOID ||
+		dfunc->func_nargs != 2)
+		__Elog("function %s is not a binary boolean function",
+			   format_procedure(func_oid));
+	/* hashed IN-list, if constant or parameter array */
+	status = codegen_scalar_array_op_hash(context, buf, curr_depth,
+										  sa_op->useOr, op_oid,
+										  expr_a, expr_s,
+										  dtype_s, dtype_e);
+	if (status <= 0)
+		return status;
+	/* allocation of kvar-slot for the temporary element variables */
+	kvdef = palloc0(sizeof(codegen_kvar_defitem));
+	kvdef->kv_slot_id = list_length(context->kvars_deflist);
+	kvdef->kv_depth = -1;
+	kvdef->kv_resno = InvalidAttrNumber;
+	kvdef->kv_maxref = curr_depth;
+	kvdef->kv_offset = -1;
+	kvdef->kv_type_oid = dtype_e->type_oid;
+	kvdef->kv_type_code = dtype_e->type_code;
+	kvdef->kv_typbyval = dtype_e->type_byval;
+	kvdef->kv_typalign = dtype_e->type_align;
+	kvdef->kv_typlen = dtype_e->type_length;
+	kvdef->kv_expr = (Expr *)makeNullConst(dtype_e->type_oid, -1, InvalidOid);
+	__assign_codegen_kvar_defitem_subfields(kvdef);
+	context->kvars_deflist = lappend(context->kvars_deflist, kvdef);
+
+	/* allocation of saop kep */
+	memset(&kexp, 0, sizeof(kexp));
+	if (buf)
+	{
+		memset(&kexp, 0, sizeof(kexp));
+		kexp.exptype     = TypeOpCode__bool;
+		kexp.expflags    = context->kexp_flags;
+		kexp.opcode      = (sa_op->useOr
+							? FuncOpCode__ScalarArrayOpAny
+							: FuncOpCode__ScalarArrayOpAll);
+		kexp.nr_args     = 2;
+		kexp.args_offset = offsetof(kern_expression, u.saop.data);
+		kexp.u.saop.elem_slot_id = kvdef->kv_slot_id;
+		pos = __appendBinaryStringInfo(buf, &kexp, kexp.args_offset);
+	}
+	/* 1st arg - array-expression to be walked on */
+	if (codegen_expression_walker(context, buf, curr_depth, expr_a) < 0)
+		return -1;
+	/* 2nd arg - comparator function */
+	if (buf)
+	{
+		memset(&kexp, 0, sizeof(kexp));
+		kexp.exptype = dfunc->func_rettype->type_code;
+		kexp.expflags = context->kexp_flags;
+		kexp.opcode = dfunc->func_code;
+		kexp.nr_args = 2;
+		kexp.args_offset = offsetof(kern_expression, u.data);
+		__pos = __appendBinaryStringInfo(buf, &kexp, kexp.args_offset);
+	}
+	/* 1st arg (scalar expression) of the comparator function */
+	if (codegen_expression_walker(context, buf, curr_depth, expr_s) < 0)
+		return -1;
+	/* 2nd arg (element reference) of the comparator function */
+	if (buf)
+	{
+		int		elem_pos;
+
+		memset(&kexp, 0, sizeof(kexp));
+		kexp.exptype  = dtype_e->type_code;
+		kexp.expflags = context->kexp_flags;
+		kexp.opcode   = FuncOpCode__VarExpr;
+		kexp.nr_args  = 0;
+		kexp.u.v.var_slot_id = kvdef->kv_slot_id;
+		kexp.u.v.var_offset = -1;
+		elem_pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExprVar);
+		__appendKernExpMagicAndLength(buf, elem_pos);
+	}
+	/* terminate the epression */
+	if (buf)
+	{
+		__appendKernExpMagicAndLength(buf, __pos);
+		__appendKernExpMagicAndLength(buf, pos);
+	}
+	return 0;
+}
+
+/*
+ * Common sub-expression elimination
+ *
+ * FuncExpr/OpExpr nodes that appear multiple times in the scan-quals and
+ * the final-depth expressions (projection or group-by keys/arguments) are
+ * evaluated only once; SaveExpr stores the result on a dedicated kvars-slot,
+ * then the later references load it by VarExpr. A sub-expression evaluated
+ * by the scan-quals can be referenced from the deeper depth through the
+ * kvec-buffer, like as a regular input column.
+ *
+ * Only the sub-expressions that are always evaluated whenever the root
+ * expression is evaluated (the root itself, and the first argument chain
+ * of the functions/operators) can produce the result, and it becomes
+ * available for the later root expressions only, because the device code
+ * may skip the other arguments (e.g, NULL input of strict functions).
+ */
+#define CODEGEN_CSE_PHASE__SCAN_QUALS		1
+#define CODEGEN_CSE_PHASE__FINAL_DEPTH		2
+
+typedef struct
+{
+	Expr	   *cse_expr;		/* the common sub-expression */
+	int			cse_nrefs;		/* number of the references */
+	int			cse_phase;		/* CODEGEN_CSE_PHASE__* that saved it */
+	bool		cse_ready;		/* true, if its kvars-slot is available */
+	codegen_kvar_defitem *cse_kvdef;
+} codegen_cse_item;
+
+static bool
+__codegen_collect_subexprs_walker(Node *node, void *__priv)
+{
+	List	  **p_cse_items = __priv;
+	ListCell   *lc;
+
+	if (!node)
+		return false;
+	if (IsA(node, FuncExpr) || IsA(node, OpExpr))
+	{
+		codegen_cse_item *cse;
+
+		foreach (lc, *p_cse_items)
+		{
+			cse = lfirst(lc);
+			if (codegen_expression_equals(node, cse->cse_expr))
+			{
+				/* sub-expressions in the duplicated one are never used */
+				cse->cse_nrefs++;
+				return false;
+			}
+		}
+		cse = palloc0(sizeof(codegen_cse_item));
+		cse->cse_expr = (Expr *)node;
+		cse->cse_nrefs = 1;
+		*p_cse_items = lappend(*p_cse_items, cse);
+	}
+	return expression_tree_walker(node, __codegen_collect_subexprs_walker, __priv);
+}
+
+static bool
+__codegen_subexpr_is_valid(codegen_context *context, Expr *expr)
+{
+	devfunc_info   *dfunc;
+	devtype_info   *dtype;
+
+	if (contain_volatile_functions((Node *)expr))
+		return false;
+	if (IsA(expr, FuncExpr))
+	{
+		FuncExpr   *func = (FuncExpr *)expr;
+
+		dfunc = pgstrom_devfunc_lookup(func->funcid,
+									   func->args,
+									   func->inputcollid);
+	}
+	else if (IsA(expr, OpExpr))
+	{
+		OpExpr	   *oper = (OpExpr *)expr;
+
+		dfunc = pgstrom_devfunc_lookup(get_opcode(oper->opno),
+									   oper->args,
+									   oper->inputcollid);
+	}
+	else
+		return false;
+	if (!dfunc ||
+		(dfunc->func_flags & context->required_flags) != context->required_flags)
+		return false;
+	/* SaveExpr requires the kvars-slot with identical device type */
+	dtype = pgstrom_devtype_lookup(exprType((Node *)expr));
+	if (!dtype || dtype->type_code != dfunc->func_rettype->type_code)
+		return false;
+	return true;
+}
+
+/*
+ * codegen_build_common_subexprs
+ *
+ * It collects the common sub-expressions in the scan-quals and the final-depth
+ * expressions. context->tlist_dev must be already built.
+ */
+void
+codegen_build_common_subexprs(codegen_context *context,
+							  pgstromPlanInfo *pp_info)
+{
+	List	   *cse_items = NIL;
+	ListCell   *lc1, *lc2;
+
+	context->cse_items = NIL;
+	foreach (lc1, pp_info->scan_quals)
+		__codegen_collect_subexprs_walker(lfirst(lc1), &cse_items);
+	if (pp_info->groupby_actions != NIL)
+	{
+		forboth (lc1, context->tlist_dev,
+				 lc2, pp_info->groupby_actions)
+		{
+			TargetEntry *tle = lfirst(lc1);
+			int			action = lfirst_int(lc2);
+
+			if (action == KAGG_ACTION__VREF ||
+				action == KAGG_ACTION__VREF_NOKEY)
+				__codegen_collect_subexprs_walker((Node *)tle->expr, &cse_items);
+			else if (IsA(tle->expr, FuncExpr))
+				__codegen_collect_subexprs_walker((Node *)((FuncExpr *)tle->expr)->args,
+												  &cse_items);
+		}
+	}
+	else
+	{
+		foreach (lc1, context->tlist_dev)
+		{
+			TargetEntry *tle = lfirst(lc1);
+
+			if (!tle->resjunk)
+				__codegen_collect_subexprs_walker((Node *)tle->expr, &cse_items);
+		}
+	}
+
+	foreach (lc1, cse_items)
+	{
+		codegen_cse_item *cse = lfirst(lc1);
+
+		if (cse->cse_nrefs > 1 &&
+			__codegen_subexpr_is_valid(context, cse->cse_expr))
+			context->cse_items = lappend(context->cse_items, cse);
+		else
+			pfree(cse);
+	}
+	list_free(cse_items);
+}
+
+/*
+ * __codegen_lookup_subexpr
+ */
+static codegen_cse_item *
+__codegen_lookup_subexpr(codegen_context *context, Expr *expr)
+{
+	ListCell   *lc;
+
+	foreach (lc, context->cse_items)
+	{
+		codegen_cse_item *cse = lfirst(lc);
+
+		if (codegen_expression_equals(expr, cse->cse_expr))
+			return cse;
+	}
+	return NULL;
+}
+
+/*
+ * __codegen_assign_subexpr_defitem
+ */
+static codegen_kvar_defitem *
+__codegen_assign_subexpr_defitem(codegen_context *context,
+								 codegen_cse_item *cse,
+								 int curr_depth)
+{
+	codegen_kvar_defitem *kvdef;
+	Oid			kv_type_oid = exprType((Node *)cse->cse_expr);
+
+	kvdef = palloc0(sizeof(codegen_kvar_defitem));
+	kvdef->kv_slot_id   = list_length(context->kvars_deflist);
+	kvdef->kv_depth     = curr_depth;
+	kvdef->kv_resno     = InvalidAttrNumber;	/* no source */
+	kvdef->kv_maxref    = curr_depth;
+	kvdef->kv_offset    = -1;					/* assigned on demand */
+	kvdef->kv_type_oid  = kv_type_oid;
+	if (!__assign_codegen_kvar_defitem_type_params(kv_type_oid,
+												   &kvdef->kv_type_code,
+												   &kvdef->kv_typbyval,
+												   &kvdef->kv_typalign,
+												   &kvdef->kv_typlen,
+												   (curr_depth == 0
+													? &kvdef->kv_kvec_sizeof
+													: NULL),
+												   false))
+	{
+		pfree(kvdef);
+		return NULL;
+	}
+	kvdef->kv_expr      = cse->cse_expr;
+	kvdef->kv_subexpr   = true;
+	__assign_codegen_kvar_defitem_subfields(kvdef);
+	context->kvars_deflist = lappend(context->kvars_deflist, kvdef);
+
+	cse->cse_phase = context->cse_phase;
+	cse->cse_kvdef = kvdef;
+
+	return kvdef;
+}
+
+/*
+ * codegen_common_subexpr
+ *
+ * It returns true, if 'expr' is a common sub-expression and the code to save
+ * or load the result was generated, with its status on *p_status.
+ */
+static bool
+codegen_common_subexpr(codegen_context *context,
+					   StringInfo buf, int curr_depth,
+					   Expr *expr, int *p_status)
+{
+	codegen_cse_item *cse;
+	codegen_kvar_defitem *kvdef;
+	kern_expression kexp;
+	int			pos;
+
+	cse = __codegen_lookup_subexpr(context, expr);
+	if (!cse)
+		return false;
+	kvdef = cse->cse_kvdef;
+	if (cse->cse_ready)
+	{
+		memset(&kexp, 0, sizeof(kexp));
+		kexp.exptype         = kvdef->kv_type_code;
+		kexp.expflags        = context->kexp_flags;
+		kexp.opcode          = FuncOpCode__VarExpr;
+		kexp.u.v.var_slot_id = kvdef->kv_slot_id;
+		if (cse->cse_phase == context->cse_phase &&
+			kvdef->kv_depth == curr_depth)
+		{
+			/* load from the kvars-slot at the same depth */
+			kexp.u.v.var_offset = -1;
+		}
+		else if (kvdef->kv_depth == 0 &&
+				 kvdef->kv_kvec_sizeof > 0 &&
+				 curr_depth > 0 &&
+				 curr_depth <= context->num_rels + 1)
+		{
+			/* load from the kvec-buffer, moved from the scan-quals */
+			if (kvdef->kv_offset < 0)
+			{
+				kvdef->kv_offset = context->kvecs_usage;
+				context->kvecs_usage += KVEC_ALIGN(kvdef->kv_kvec_sizeof);
+			}
+			kvdef->kv_maxref = Max(kvdef->kv_maxref, curr_depth);
+			kexp.u.v.var_offset = kvdef->kv_offset;
+		}
+		else
+			return false;
+		pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExprVar);
+		__appendKernExpMagicAndLength(buf, pos);
+		*p_status = 0;
+		return true;
+	}
+
+	/* elsewhere, try to save the result if always evaluated */
+	if (kvdef != NULL ||
+		!list_member_ptr(context->cse_must_evals, expr))
+		return false;
+	if (context->cse_phase == CODEGEN_CSE_PHASE__SCAN_QUALS)
 	{
-		func_oid = get_opcode(sa_op->opno);
+		if (curr_depth != 0)
+			return false;
 	}
-	else if (dtype_s->type_element != NULL &&
-			 dtype_a->type_element == NULL)
+	else if (context->cse_phase == CODEGEN_CSE_PHASE__FINAL_DEPTH)
 	{
-		/* swap arguments */
-		Expr		   *expr_temp  = expr_a;
-		devtype_info   *dtype_temp = dtype_a;
-		Oid				opcode;
-
-		expr_a  = expr_s;
-		dtype_a = dtype_s;
-		expr_s  = expr_temp;
-		dtype_s = dtype_temp;
-		opcode = get_commutator(sa_op->opno);
-		func_oid = get_opcode(opcode);
+		if (curr_depth != context->num_rels + 1)
+			return false;
 	}
 	else
-	{
-		__Elog("ScalarArrayOpExpr must be 'SCALAR = %s ARRAY' form",
-			   sa_op->useOr ? "ANY" : "ALL");
-	}
-	dtype_e = dtype_a->type_element;
-	argtypes[0] = dtype_s->type_oid;
-	argtypes[1] = dtype_e->type_oid;
-	dfunc = __pgstrom_devfunc_lookup(func_oid,
-									 2, argtypes,
-									 sa_op->inputcollid);
-	if (!dfunc)
-		__Elog("function %s is not device supported",
-			   format_procedure(func_oid));
-	if (dfunc->func_rettype->type_oid != BOOLOID ||
-		dfunc->func_nargs != 2)
-		__Elog("function %s is not a binary boolean function",
-			   format_procedure(func_oid));
-	/* allocation of kvar-slot for the temporary element variables */
-	kvdef = palloc0(sizeof(codegen_kvar_defitem));
-	kvdef->kv_slot_id = list_length(context->kvars_deflist);
-	kvdef->kv_depth = -1;
-	kvdef->kv_resno = InvalidAttrNumber;
-	kvdef->kv_maxref = curr_depth;
-	kvdef->kv_offset = -1;
-	kvdef->kv_type_oid = dtype_e->type_oid;
-	kvdef->kv_type_code = dtype_e->type_code;
-	kvdef->kv_typbyval = dtype_e->type_byval;
-	kvdef->kv_typalign = dtype_e->type_align;
-	kvdef->kv_typlen = dtype_e->type_length;
-	kvdef->kv_expr = (Expr *)makeNullConst(dtype_e->type_oid, -1, InvalidOid);
-	__assign_codegen_kvar_defitem_subfields(kvdef);
-	context->kvars_deflist = lappend(context->kvars_deflist, kvdef);
+		return false;
+	kvdef = __codegen_assign_subexpr_defitem(context, cse, curr_depth);
+	if (!kvdef)
+		return false;
 
-	/* allocation of saop kep */
 	memset(&kexp, 0, sizeof(kexp));
-	if (buf)
-	{
-		memset(&kexp, 0, sizeof(kexp));
-		kexp.exptype     = TypeOpCode__bool;
-		kexp.expflags    = context->kexp_flags;
-		kexp.opcode      = (sa_op->useOr
-							? FuncOpCode__ScalarArrayOpAny
-							: FuncOpCode__ScalarArrayOpAll);
-		kexp.nr_args     = 2;
-		kexp.args_offset = offsetof(kern_expression, u.saop.data);
-		kexp.u.saop.elem_slot_id = kvdef->kv_slot_id;
-		pos = __appendBinaryStringInfo(buf, &kexp, kexp.args_offset);
-	}
-	/* 1st arg - array-expression to be walked on */
-	if (codegen_expression_walker(context, buf, curr_depth, expr_a) < 0)
-		return -1;
-	/* 2nd arg - comparator function */
-	if (buf)
+	kexp.exptype  = kvdef->kv_type_code;
+	kexp.expflags = context->kexp_flags;
+	kexp.opcode   = FuncOpCode__SaveExpr;
+	kexp.nr_args  = 1;
+	kexp.args_offset = MAXALIGN(offsetof(kern_expression,
+										 u.save.data));
+	kexp.u.save.sv_slot_id = kvdef->kv_slot_id;
+	pos = __appendBinaryStringInfo(buf, &kexp, kexp.args_offset);
+	if (IsA(expr, FuncExpr))
+		*p_status = codegen_func_expression(context, buf, curr_depth,
+											(FuncExpr *)expr);
+	else
+		*p_status = codegen_oper_expression(context, buf, curr_depth,
+											(OpExpr *)expr);
+	if (*p_status == 0)
+		__appendKernExpMagicAndLength(buf, pos);
+	return true;
+}
+
+/*
+ * __codegen_bind_subexpr_defitem
+ *
+ * It binds a new final-depth kvars-slot, if the expression itself is a common
+ * sub-expression, to avoid duplicated SaveExpr.
+ */
+static void
+__codegen_bind_subexpr_defitem(codegen_context *context,
+							   codegen_kvar_defitem *kvdef)
+{
+	codegen_cse_item *cse;
+
+	if (context->cse_phase != CODEGEN_CSE_PHASE__FINAL_DEPTH)
+		return;
+	cse = __codegen_lookup_subexpr(context, kvdef->kv_expr);
+	if (cse && !cse->cse_kvdef)
 	{
-		memset(&kexp, 0, sizeof(kexp));
-		kexp.exptype = dfunc->func_rettype->type_code;
-		kexp.expflags = context->kexp_flags;
-		kexp.opcode = dfunc->func_code;
-		kexp.nr_args = 2;
-		kexp.args_offset = offsetof(kern_expression, u.data);
-		__pos = __appendBinaryStringInfo(buf, &kexp, kexp.args_offset);
+		cse->cse_phase = context->cse_phase;
+		cse->cse_kvdef = kvdef;
 	}
-	/* 1st arg (scalar expression) of the comparator function */
-	if (codegen_expression_walker(context, buf, curr_depth, expr_s) < 0)
-		return -1;
-	/* 2nd arg (element reference) of the comparator function */
-	if (buf)
+}
+
+/*
+ * codegen_expression_root_walker
+ *
+ * It walks on the root expression; that is always evaluated on the device
+ * side, and shall be a unit of common sub-expression production.
+ */
+static int
+codegen_expression_root_walker(codegen_context *context,
+							   StringInfo buf, int curr_depth,
+							   Expr *expr)
+{
+	List	   *must_evals = NIL;
+	Expr	   *curr = expr;
+	ListCell   *lc;
+	int			status;
+
+	if (context->cse_items == NIL)
+		return codegen_expression_walker(context, buf, curr_depth, expr);
+
+	/* nodes always evaluated, if the root expression is evaluated */
+	while (curr)
 	{
-		int		elem_pos;
+		List   *args = NIL;
 
-		memset(&kexp, 0, sizeof(kexp));
-		kexp.exptype  = dtype_e->type_code;
-		kexp.expflags = context->kexp_flags;
-		kexp.opcode   = FuncOpCode__VarExpr;
-		kexp.nr_args  = 0;
-		kexp.u.v.var_slot_id = kvdef->kv_slot_id;
-		kexp.u.v.var_offset = -1;
-		elem_pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExprVar);
-		__appendKernExpMagicAndLength(buf, elem_pos);
+		must_evals = lappend(must_evals, curr);
+		switch (nodeTag(curr))
+		{
+			case T_FuncExpr:
+				args = ((FuncExpr *)curr)->args;
+				curr = (args != NIL ? linitial(args) : NULL);
+				break;
+			case T_OpExpr:
+			case T_DistinctExpr:
+				args = ((OpExpr *)curr)->args;
+				curr = (args != NIL ? linitial(args) : NULL);
+				break;
+			case T_BoolExpr:
+				args = ((BoolExpr *)curr)->args;
+				curr = (args != NIL ? linitial(args) : NULL);
+				break;
+			case T_RelabelType:
+				curr = ((RelabelType *)curr)->arg;
+				break;
+			case T_NullTest:
+				curr = ((NullTest *)curr)->arg;
+				break;
+			case T_BooleanTest:
+				curr = ((BooleanTest *)curr)->arg;
+				break;
+			default:
+				curr = NULL;
+				break;
+		}
 	}
-	/* terminate the epression */
-	if (buf)
+	context->cse_must_evals = must_evals;
+	status = codegen_expression_walker(context, buf, curr_depth, expr);
+	context->cse_must_evals = NIL;
+	list_free(must_evals);
+
+	/* the saved results are available for the later root expressions */
+	foreach (lc, context->cse_items)
 	{
-		__appendKernExpMagicAndLength(buf, __pos);
-		__appendKernExpMagicAndLength(buf, pos);
+		codegen_cse_item *cse = lfirst(lc);
+
+		if (cse->cse_kvdef)
+			cse->cse_ready = true;
 	}
-	return 0;
+	return status;
 }
 
 static int
@@ -2342,8 +4071,14 @@ codegen_expression_walker(codegen_context *context,
 						  StringInfo buf, int curr_depth,
 						  Expr *expr)
 {
+	int			status;
+
 	if (!expr)
 		return 0;
+	if (buf && context->cse_items != NIL &&
+		(IsA(expr, FuncExpr) || IsA(expr, OpExpr)) &&
+		codegen_common_subexpr(context, buf, curr_depth, expr, &status))
+		return status;
 
 	switch (nodeTag(expr))
 	{
@@ -2722,7 +4457,7 @@ __codegen_build_loadvars_one(codegen_context *context, int depth)
 	{
 		codegen_kvar_defitem *kvdef = lfirst(lc);
 
-		if (kvdef->kv_depth == depth)
+		if (kvdef->kv_depth == depth && !kvdef->kv_subexpr)
 		{
 			kern_varload_desc  *vl_desc = &kexp->u.load.desc[nitems++];
 
@@ -2918,20 +4653,52 @@ codegen_build_scan_quals(codegen_context *context, List *dev_quals)
 {
 	StringInfoData buf;
 	bytea	   *xpucode = NULL;
-	Expr	   *expr;
 	int			saved_depth = context->curr_depth;
+	int			status = 0;
 
 	Assert(context->elevel >= ERROR);
 	if (dev_quals == NIL)
 		return NULL;
-	if (list_length(dev_quals) == 1)
-		expr = linitial(dev_quals);
-	else
-		expr = make_andclause(dev_quals);
 
 	initStringInfo(&buf);
 	context->curr_depth = 0;
-	if (codegen_expression_walker(context, &buf, 0, expr) == 0)
+	context->cse_phase = CODEGEN_CSE_PHASE__SCAN_QUALS;
+	if (list_length(dev_quals) == 1)
+		status = codegen_expression_root_walker(context, &buf, 0,
+												linitial(dev_quals));
+	else if (context->cse_items == NIL)
+		status = codegen_expression_walker(context, &buf, 0,
+										   make_andclause(dev_quals));
+	else
+	{
+		kern_expression	kexp;
+		int			pos;
+		ListCell   *lc;
+
+		/*
+		 * BoolExpr(AND) evaluates the arguments from the head, so each
+		 * qualifier can be a unit of common sub-expression production.
+		 */
+		memset(&kexp, 0, sizeof(kexp));
+		kexp.exptype = TypeOpCode__bool;
+		kexp.expflags = context->kexp_flags;
+		kexp.opcode = FuncOpCode__BoolExpr_And;
+		kexp.nr_args = list_length(dev_quals);
+		kexp.args_offset = SizeOfKernExpr(0);
+		pos = __appendBinaryStringInfo(&buf, &kexp, SizeOfKernExpr(0));
+		foreach (lc, dev_quals)
+		{
+			status = codegen_expression_root_walker(context, &buf, 0,
+													lfirst(lc));
+			if (status != 0)
+				break;
+		}
+		if (status == 0)
+			__appendKernExpMagicAndLength(&buf, pos);
+	}
+	context->cse_phase = 0;
+
+	if (status == 0)
 	{
 		xpucode = palloc(VARHDRSZ+buf.len);
 		memcpy(xpucode->vl_dat, buf.data, buf.len);
@@ -3004,6 +4771,7 @@ __try_inject_projection_expression(codegen_context *context,
 	kvdef->kv_expr      = expr;
 	__assign_codegen_kvar_defitem_subfields(kvdef);
 	context->kvars_deflist = lappend(context->kvars_deflist, kvdef);
+	__codegen_bind_subexpr_defitem(context, kvdef);
 
 	/*
 	 * Setup VarExpr / SaveExpr expression
@@ -3018,7 +4786,7 @@ found:
 										 u.save.data));
 	kexp.u.save.sv_slot_id   = kvdef->kv_slot_id;
 	pos = __appendBinaryStringInfo(buf, &kexp, kexp.args_offset);
-	codegen_expression_walker(context, buf, context->num_rels+1, expr);
+	codegen_expression_root_walker(context, buf, context->num_rels+1, expr);
 	__appendKernExpMagicAndLength(buf, pos);
 
 	return kvdef;
@@ -3085,6 +4853,7 @@ codegen_build_projection(codegen_context *context)
 
 	initStringInfo(&buf);
 	buf.len = sz;
+	context->cse_phase = CODEGEN_CSE_PHASE__FINAL_DEPTH;
 	foreach (lc, context->tlist_dev)
 	{
 		TargetEntry	*tle = lfirst(lc);
@@ -3098,6 +4867,7 @@ codegen_build_projection(codegen_context *context)
 												 tle->expr);
 		kexp->u.proj.slot_id[kexp->u.proj.nattrs++] = kvdef->kv_slot_id;
 	}
+	context->cse_phase = 0;
 	Assert(nattrs == kexp->u.proj.nattrs);
 	kexp->exptype = TypeOpCode__int4;
 	kexp->expflags = context->kexp_flags;
@@ -3524,6 +5294,49 @@ codegen_build_packed_gistevals(codegen_context *context,
 	pp_info->kexp_gist_evals_packed = result;
 }
 
+/*
+ * __try_reference_groupby_key
+ *
+ * The groupby-actions are evaluated prior to the keyhash on the device side,
+ * so the grouping-keys are already saved on the kvars-slot.
+ */
+static codegen_kvar_defitem *
+__try_reference_groupby_key(codegen_context *context,
+							StringInfo buf,
+							Expr *expr)
+{
+	codegen_kvar_defitem *kvdef;
+	kern_expression kexp;
+	ListCell   *lc;
+	int			pos;
+
+	kvdef = lookup_input_varnode_defitem(context, (Var *)expr,
+										 context->num_rels+1, true);
+	if (kvdef)
+		goto found;
+	foreach (lc, context->kvars_deflist)
+	{
+		kvdef = lfirst(lc);
+
+		if (codegen_expression_equals(expr, kvdef->kv_expr))
+			goto found;
+	}
+	/* not found, so evaluate the expression here */
+	return __try_inject_projection_expression(context, buf, expr);
+
+found:
+	memset(&kexp, 0, sizeof(kexp));
+	kexp.exptype         = kvdef->kv_type_code;
+	kexp.expflags        = context->kexp_flags;
+	kexp.opcode          = FuncOpCode__VarExpr;
+	kexp.u.v.var_slot_id = kvdef->kv_slot_id;
+	kexp.u.v.var_offset  = -1;
+	pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExprVar);
+	__appendKernExpMagicAndLength(buf, pos);
+
+	return kvdef;
+}
+
 /*
  * codegen_build_groupby_keyhash
  */
@@ -3560,7 +5373,7 @@ codegen_build_groupby_keyhash(codegen_context *context,
 		{
 			codegen_kvar_defitem *kvdef;
 
-			kvdef = __try_inject_projection_expression(context, &buf, tle->expr);
+			kvdef = __try_reference_groupby_key(context, &buf, tle->expr);
 			groupby_key_items = lappend(groupby_key_items, kvdef);
 			kexp.nr_args++;
 		}
@@ -3875,14 +5688,17 @@ codegen_build_groupby_actions(codegen_context *context,
 
 	Assert(pp_info->groupby_actions != NIL &&
 		   list_length(pp_info->groupby_actions) <= list_length(context->tlist_dev));
+	/* the groupby-actions shall be evaluated first, on the device side */
+	context->cse_phase = CODEGEN_CSE_PHASE__FINAL_DEPTH;
+	__codegen_build_groupby_actions(context, pp_info);
 	groupby_keys_input = codegen_build_groupby_keyhash(context, pp_info);
+	context->cse_phase = 0;
 	groupby_keys_final = codegen_build_groupby_keyload(context, pp_info);
 	if (groupby_keys_input != NIL &&
 		groupby_keys_final != NIL)
 		codegen_build_groupby_keycomp(context, pp_info,
 									  groupby_keys_input,
 									  groupby_keys_final);
-	__codegen_build_groupby_actions(context, pp_info);
 }
 
 /*
@@ -4157,6 +5973,149 @@ __xpucode_gisteval_cstring(StringInfo buf,
 	appendStringInfo(buf, "}");
 }
 
+static void
+__xpucode_like_literal_cstring(StringInfo buf, const char *lit, int len)
+{
+	for (int i=0; i < len; i++)
+	{
+		if (lit[i] == '%' || lit[i] == '_' || lit[i] == '\\')
+			appendStringInfoChar(buf, '\\');
+		else if (lit[i] == '\'')
+			appendStringInfoChar(buf, '\'');
+		appendStringInfoChar(buf, lit[i]);
+	}
+}
+
+static void
+__xpucode_likematch_cstring(StringInfo buf,
+							const kern_expression *kexp,
+							const CustomScanState *css,
+							ExplainState *es,
+							List *dcontext)
+{
+	const kern_expression *karg = KEXP_FIRST_ARG(kexp);
+	const char *lit = kexp->u.like.data;
+	uint32_t	like_flags = kexp->u.like.like_flags;
+	const char *label;
+
+	Assert(kexp->nr_args == 1);
+	switch (kexp->u.like.like_kind)
+	{
+		case KERN_LIKE_KIND__EXACT:
+			label = "exact";
+			break;
+		case KERN_LIKE_KIND__PREFIX:
+			label = "prefix";
+			break;
+		case KERN_LIKE_KIND__SUFFIX:
+			label = "suffix";
+			break;
+		case KERN_LIKE_KIND__SUBSTR:
+			label = "substr";
+			break;
+		default:
+			label = "generic";
+			break;
+	}
+	appendStringInfo(buf, "{%s%s::%s <pattern='",
+					 (like_flags & KERN_LIKE_FLAG__NEGATIVE) != 0 ? "Not" : "",
+					 (like_flags & KERN_LIKE_FLAG__ICASE) != 0 ? "ILike" : "Like",
+					 label);
+	if (kexp->u.like.like_kind == KERN_LIKE_KIND__GENERIC)
+	{
+		const kern_like_item *items = (const kern_like_item *)lit;
+
+		for (int i=0; i < kexp->u.like.like_nitems; i++)
+		{
+			switch (items[i].kind)
+			{
+				case KERN_LIKE_ITEM__LITERAL:
+					__xpucode_like_literal_cstring(buf, lit + items[i].offset,
+												   items[i].length);
+					break;
+				case KERN_LIKE_ITEM__ANYCHARS:
+					for (int j=0; j < items[i].nchars; j++)
+						appendStringInfoChar(buf, '_');
+					break;
+				default:
+					appendStringInfoChar(buf, '%');
+					break;
+			}
+		}
+	}
+	else
+	{
+		if (kexp->u.like.like_kind == KERN_LIKE_KIND__SUFFIX ||
+			kexp->u.like.like_kind == KERN_LIKE_KIND__SUBSTR)
+			appendStringInfoChar(buf, '%');
+		__xpucode_like_literal_cstring(buf, lit, kexp->u.like.like_length);
+		if (kexp->u.like.like_kind == KERN_LIKE_KIND__PREFIX ||
+			kexp->u.like.like_kind == KERN_LIKE_KIND__SUBSTR)
+			appendStringInfoChar(buf, '%');
+	}
+	appendStringInfo(buf, "'> arg=");
+	__xpucode_to_cstring(buf, karg, css, es, dcontext);
+	appendStringInfo(buf, "}");
+}
+
+static void
+__xpucode_regexmatch_cstring(StringInfo buf,
+							 const kern_expression *kexp,
+							 const CustomScanState *css,
+							 ExplainState *es,
+							 List *dcontext)
+{
+	const kern_expression *karg = KEXP_FIRST_ARG(kexp);
+	const kern_regex_program *prog = (const kern_regex_program *)
+		kexp->u.regex.data;
+	const char *pattern = kexp->u.regex.data + kexp->u.regex.pattern_offset;
+	uint32_t	regex_flags = kexp->u.regex.regex_flags;
+
+	Assert(kexp->nr_args == 1);
+	appendStringInfo(buf, "{%sRegex%s <pattern='",
+					 (regex_flags & KERN_REGEX_FLAG__NEGATIVE) != 0 ? "Not" : "",
+					 (regex_flags & KERN_REGEX_FLAG__ICASE) != 0 ? "::icase" : "");
+	for (int i=0; i < kexp->u.regex.pattern_len; i++)
+	{
+		if (pattern[i] == '\'')
+			appendStringInfoChar(buf, '\'');
+		appendStringInfoChar(buf, pattern[i]);
+	}
+	appendStringInfo(buf, "', npos=%u> arg=", prog->npos);
+	__xpucode_to_cstring(buf, karg, css, es, dcontext);
+	appendStringInfo(buf, "}");
+}
+
+static void
+__xpucode_saophash_cstring(StringInfo buf,
+						   const kern_expression *kexp,
+						   const CustomScanState *css,
+						   ExplainState *es,
+						   List *dcontext)
+{
+	const kern_expression *karg = KEXP_FIRST_ARG(kexp);
+	uint32_t	saop_flags = kexp->u.saop_hash.saop_flags;
+
+	Assert(kexp->nr_args == 1);
+	appendStringInfo(buf, "{ScalarArrayOpHash%s: ",
+					 (saop_flags & KERN_SAOP_HASH_FLAG__NEGATIVE) != 0 ? "All" : "Any");
+	if ((saop_flags & KERN_SAOP_HASH_FLAG__PARAM) != 0)
+		appendStringInfo(buf, "param=$%u", kexp->u.saop_hash.param_id);
+	else
+	{
+		const kern_saop_hash *hash = (const kern_saop_hash *)
+			kexp->u.saop_hash.data;
+
+		appendStringInfo(buf, "nkeys=%u, nslots=%u%s",
+						 hash->nkeys,
+						 hash->nslots,
+						 hash->has_nulls ? ", has_nulls" : "");
+	}
+	appendStringInfo(buf, ", arg=");
+	__xpucode_to_cstring(buf, karg, css, es, dcontext);
+	appendStringInfo(buf, "}");
+}
+
 static void
 __xpucode_aggfuncs_cstring(StringInfo buf,
 						   const kern_expression *kexp,
@@ -4323,6 +6282,15 @@ __xpucode_to_cstring(StringInfo buf,
 		case FuncOpCode__GiSTEval:
 			__xpucode_gisteval_cstring(buf, kexp, css, es, dcontext);
 			break;
+		case FuncOpCode__LikeMatch:
+			__xpucode_likematch_cstring(buf, kexp, css, es, dcontext);
+			return;
+		case FuncOpCode__RegexMatch:
+			__xpucode_regexmatch_cstring(buf, kexp, css, es, dcontext);
+			return;
+		case FuncOpCode__ScalarArrayOpHash:
+			__xpucode_saophash_cstring(buf, kexp, css, es, dcontext);
+			return;
 		case FuncOpCode__HashValue:
 			appendStringInfo(buf, "{HashValue");
 			break;
@@ -126,6 +126,7 @@ typedef struct {
 	uint32_t		nitems_raw;		/* nitems in the raw data chunk */
 	uint32_t		nitems_in;		/* nitems after the scan_quals */
 	uint32_t		nitems_out;		/* nitems of final results */
+	uint32_t		nitems_quals[KERN_SCAN_QUALS_NSTATS]; /* nitems after each scan_quals */
 	struct {
 		uint32_t	nitems_gist;	/* nitems picked up by GiST index */
 		uint32_t	nitems_out;		/* nitems after this depth */
@@ -872,6 +872,12 @@ kern_gpujoin_main(kern_session_info *session,
 	/* merge the group-by buffer to the kds_final, if any */
 	mergeGpuPreAggGroupByBuffer(kcxt, kds_dst);
 
+	/* update the statistics of scan-quals (per thread) */
+	for (int i=0; i < KERN_SCAN_QUALS_NSTATS; i++)
+	{
+		if (kcxt->scan_quals_nitems[i] > 0)
+			atomicAdd(&kgtask->nitems_quals[i], kcxt->scan_quals_nitems[i]);
+	}
 	/* update the statistics */
 	if (get_local_id() == 0)
 	{
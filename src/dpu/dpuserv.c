@@ -62,6 +62,7 @@ struct dpuTaskExecState
 	uint32_t		nitems_raw;		/* nitems in the raw data chunk */
 	uint32_t		nitems_in;		/* nitems after the scan_quals */
 	uint32_t		nitems_out;		/* nitems of final results */
+	uint32_t		nitems_quals[KERN_SCAN_QUALS_NSTATS]; /* nitems after each scan_quals */
 	uint32_t		num_rels;		/* >0, if JOIN */
 	struct {
 		uint32_t	nitems_gist;	/* nitems picked up by GiST index */
@@ -139,6 +140,8 @@ dpuClientWriteBack(dpuClient *dclient,
 	resp->u.results.nitems_raw = dtes->nitems_raw;
 	resp->u.results.nitems_in  = dtes->nitems_in;
 	resp->u.results.nitems_out = dtes->nitems_out;
+	memcpy(resp->u.results.nitems_quals,
+		   dtes->nitems_quals, sizeof(dtes->nitems_quals));
 	resp->u.results.num_rels   = dtes->num_rels;
 	for (int i=0; i < dtes->num_rels; i++)
 	{
@@ -2091,6 +2094,13 @@ __handleDpuTaskExecHashJoin(dpuClient *dclient,
 	return true;
 }
 
+static void
+__updateDpuScanQualsStats(dpuTaskExecState *dtes, kern_context *kcxt)
+{
+	for (int i=0; i < KERN_SCAN_QUALS_NSTATS; i++)
+		dtes->nitems_quals[i] += kcxt->scan_quals_nitems[i];
+}
+
 static bool
 __handleDpuScanExecBlock(dpuClient *dclient,
 						 dpuTaskExecState *dtes,
@@ -2162,6 +2172,7 @@ __handleDpuScanExecBlock(dpuClient *dclient,
 			}
 		}
 	}
+	__updateDpuScanQualsStats(dtes, kcxt);
 	return true;
 }
 
@@ -2223,6 +2234,7 @@ __handleDpuScanExecArrow(dpuClient *dclient,
 		}
 	}
 	dtes->nitems_raw += kds_src->nitems;
+	__updateDpuScanQualsStats(dtes, kcxt);
 	return true;
 }
 
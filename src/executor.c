@@ -288,6 +288,31 @@ xpuclientCleanupConnections(ResourceReleasePhase phase,
  *
  * ----------------------------------------------------------------
  */
+static Datum
+__fetch_session_param_extern(ParamListInfo param_info, Param *param,
+							 bool *p_isnull)
+{
+	/* See ExecEvalParamExtern */
+	ParamExternData *prm, prmData;
+
+	Assert(param->paramkind == PARAM_EXTERN);
+	if (param_info->paramFetch != NULL)
+		prm = param_info->paramFetch(param_info,
+									 param->paramid,
+									 false, &prmData);
+	else
+		prm = &param_info->params[param->paramid - 1];
+	if (!OidIsValid(prm->ptype))
+		elog(ERROR, "no value found for parameter %d", param->paramid);
+	if (prm->ptype != param->paramtype)
+		elog(ERROR, "type of parameter %d (%s) does not match that when preparing the plan (%s)",
+			 param->paramid,
+			 format_type_be(prm->ptype),
+			 format_type_be(param->paramtype));
+	*p_isnull = prm->isnull;
+	return prm->value;
+}
+
 static void
 __build_session_param_info(pgstromTaskState *pts,
 						   kern_session_info *session,
@@ -326,24 +351,8 @@ __build_session_param_info(pgstromTaskState *pts,
 		}
 		else if (param->paramkind == PARAM_EXTERN)
 		{
-			/* See ExecEvalParamExtern */
-			ParamExternData *prm, prmData;
-
-			if (param_info->paramFetch != NULL)
-				prm = param_info->paramFetch(param_info,
-											 param->paramid,
-											 false, &prmData);
-			else
-				prm = &param_info->params[param->paramid - 1];
-			if (!OidIsValid(prm->ptype))
-				elog(ERROR, "no value found for parameter %d", param->paramid);
-			if (prm->ptype != param->paramtype)
-				elog(ERROR, "type of parameter %d (%s) does not match that when preparing the plan (%s)",
-					 param->paramid,
-					 format_type_be(prm->ptype),
-					 format_type_be(param->paramtype));
-			param_isnull = prm->isnull;
-			param_value  = prm->value;
+			param_value = __fetch_session_param_extern(param_info, param,
+													   &param_isnull);
 		}
 		else
 		{
@@ -390,6 +399,51 @@ __build_session_param_info(pgstromTaskState *pts,
 	}
 }
 
+/*
+ * __build_session_saop_hash
+ *
+ * It builds the hash table of the parameter arrays referenced by
+ * the ScalarArrayOpHash, like 'id = ANY($1)', once per session.
+ */
+static void
+__build_session_saop_hash(pgstromTaskState *pts,
+						  kern_session_info *session,
+						  StringInfo buf)
+{
+	pgstromPlanInfo *pp_info = pts->pp_info;
+	ExprContext	   *econtext = pts->css.ss.ps.ps_ExprContext;
+	ParamListInfo	param_info = econtext->ecxt_param_list_info;
+	uint32_t	   *offsets;
+	size_t			sz = sizeof(uint32_t) * (param_info->numParams + 1);
+	ListCell	   *lc;
+
+	offsets = alloca(sz);
+	memset(offsets, 0, sz);
+	foreach (lc, pp_info->saop_hash_params)
+	{
+		Param	   *param = lfirst(lc);
+		Datum		param_value;
+		bool		param_isnull;
+
+		Assert(param->paramkind == PARAM_EXTERN &&
+			   param->paramid > 0 &&
+			   param->paramid <= param_info->numParams);
+		param_value = __fetch_session_param_extern(param_info, param,
+												   &param_isnull);
+		if (!param_isnull)
+		{
+			kern_saop_hash *hash;
+			size_t		length;
+
+			hash = pgstrom_build_saop_hash(DatumGetArrayTypeP(param_value),
+										   &length);
+			offsets[param->paramid] = __appendBinaryStringInfo(buf, hash, length);
+			pfree(hash);
+		}
+	}
+	session->session_saop_hash = __appendBinaryStringInfo(buf, offsets, sz);
+}
+
 /*
  * __build_session_kvars_defs
  */
@@ -548,6 +602,8 @@ pgstromBuildSessionInfo(pgstromTaskState *pts,
 	__appendZeroStringInfo(&buf, session_sz);
 	if (param_info)
 		__build_session_param_info(pts, session, &buf);
+	if (param_info && pp_info->saop_hash_params != NIL)
+		__build_session_saop_hash(pts, session, &buf);
 	if (pp_info->kvars_deflist != NIL)
 		__build_session_kvars_defs(pts, session, &buf);
 	if (pp_info->kexp_load_vars_packed)
@@ -796,6 +852,12 @@ __updateStatsXpuCommand(pgstromTaskState *pts, const XpuCommand *xcmd)
 								xcmd->u.results.nitems_raw);
 		pg_atomic_fetch_add_u64(&ps_state->source_ntuples_in,
 								xcmd->u.results.nitems_in);
+		for (int i=0; i < KERN_SCAN_QUALS_NSTATS; i++)
+		{
+			if (xcmd->u.results.nitems_quals[i] > 0)
+				pg_atomic_fetch_add_u64(&ps_state->source_ntuples_quals[i],
+										xcmd->u.results.nitems_quals[i]);
+		}
 		for (int i=0; i < n_rels; i++)
 		{
 			pg_atomic_fetch_add_u64(&ps_state->inners[i].stats_gist,
@@ -961,7 +1023,13 @@ __fetchNextXpuCommand(pgstromTaskState *pts)
 			xcmd = pts->cb_next_chunk(pts, xcmd_iov, &xcmd_iovcnt);
 			if (!xcmd)
 			{
-				Assert(pts->scan_done);
+				/*
+				 * The chunk might be processed by the host (e.g, the
+				 * host-resident GpuCache), so the caller shall consume
+				 * the fallback tuples, if not scan_done.
+				 */
+				if (!pts->scan_done)
+					return NULL;
 				break;
 			}
 			xpuClientSendCommandIOV(conn, xcmd_iov, xcmd_iovcnt);
@@ -1297,6 +1365,9 @@ __fixup_fallback_projection(Node *node, void *__data)
 	{
 		codegen_kvar_defitem *kvdef = lfirst(lc);
 
+		/* common sub-expressions are not filled on the fallback */
+		if (kvdef->kv_subexpr)
+			continue;
 		if (equal(kvdef->kv_expr, node))
 		{
 			return (Node *)makeVar(INDEX_VAR,
@@ -1647,7 +1718,12 @@ pgstromExecScanAccess(pgstromTaskState *pts)
 			xpuClientPutResponse(pts->curr_resp);
 		pts->curr_resp = __fetchNextXpuCommand(pts);
 		if (!pts->curr_resp)
-			return pgstromFetchFallbackTuple(pts);
+		{
+			slot = pgstromFetchFallbackTuple(pts);
+			if (slot || pts->scan_done)
+				return slot;
+			continue;
+		}
 		resp = pts->curr_resp;
 		switch (resp->tag)
 		{
@@ -1946,6 +2022,8 @@ pgstromExecResetTaskState(CustomScanState *node)
 	pgstromTaskStateResetScan(pts);
 	if (pts->br_state)
 		pgstromBrinIndexExecReset(pts);
+	if (pts->gcache_desc)
+		pgstromGpuCacheExecReset(pts);
 	if (pts->arrow_state)
 		pgstromArrowFdwExecReset(pts->arrow_state);
 }
@@ -2300,6 +2378,36 @@ pgstromExplainTaskState(CustomScanState *node,
 		}
 		snprintf(label, sizeof(label), "%s Scan Quals", xpu_label);
 		ExplainPropertyText(label, buf.data, es);
+
+		/* observed selectivity of the individual qualifiers */
+		if (es->analyze && ps_state && list_length(scan_quals) > 1)
+		{
+			uint64_t	prev_ntuples
+				= pg_atomic_read_u64(&ps_state->source_ntuples_raw);
+			int			nquals = Min(list_length(scan_quals),
+									 KERN_SCAN_QUALS_NSTATS);
+
+			resetStringInfo(&buf);
+			for (int i=0; i < nquals; i++)
+			{
+				uint64_t	curr_ntuples
+					= pg_atomic_read_u64(&ps_state->source_ntuples_quals[i]);
+
+				if (i > 0)
+					appendStringInfoString(&buf, ", ");
+				if (prev_ntuples > 0)
+					appendStringInfo(&buf, "%.2f%%",
+									 100.0 * (double)curr_ntuples /
+									 (double)prev_ntuples);
+				else
+					appendStringInfoString(&buf, "--");
+				prev_ntuples = curr_ntuples;
+			}
+			if (nquals < list_length(scan_quals))
+				appendStringInfoString(&buf, ", ...");
+			snprintf(label, sizeof(label), "%s Scan Quals Selectivity", xpu_label);
+			ExplainPropertyText(label, buf.data, es);
+		}
 	}
 
 	/* xPU JOIN */
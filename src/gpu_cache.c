@@ -11,6 +11,7 @@
  */
 #include "pg_strom.h"
 #include "cuda_common.h"
+#include "access/xlog.h"
 
 //#define GPUCACHE_DEBUG_MESSAGE		1
 /*
@@ -49,7 +50,7 @@ typedef struct
 	struct {
 		pthread_cond_t	cond;
 		dlist_head		queue;
-	} gpus[FLEXIBLE_ARRAY_MEMBER];		/* per GPU device */
+	} gpus[FLEXIBLE_ARRAY_MEMBER];		/* per GPU device, and host applier */
 } GpuCacheSharedHead;
 
 /*
@@ -64,6 +65,7 @@ typedef struct
 	int64		max_num_rows;
 	int64		rowid_hash_nslots;
 	size_t		redo_buffer_size;
+	bool		host_resident;
 } GpuCacheOptions;
 
 INLINE_FUNCTION(bool)
@@ -75,7 +77,8 @@ GpuCacheOptionsEqual(const GpuCacheOptions *a, const GpuCacheOptions *b)
 			a->gpu_sync_threshold == b->gpu_sync_threshold &&
 			a->max_num_rows       == b->max_num_rows &&
 			a->rowid_hash_nslots  == b->rowid_hash_nslots &&
-			a->redo_buffer_size   == b->redo_buffer_size);
+			a->redo_buffer_size   == b->redo_buffer_size &&
+			a->host_resident      == b->host_resident);
 }
 
 /*
@@ -107,20 +110,52 @@ typedef struct
 	pg_atomic_uint64 gcache_extra_usage;	/* used in extra buffer (incl dead space) */
 	pg_atomic_uint64 gcache_extra_dead;		/* dead space in extra buffer */
 
-	/* rowid-map propertoes */
+	/*
+	 * rowid-map properties
+	 *
+	 * the open-addressing hash table (ctid -> rowid) is lookup/updated
+	 * without locks; rowid_mutex protects only the list of free rowids.
+	 * rowid_generation is incremented when the free list is rebuilt, to
+	 * invalidate the free rowids cached by the backends.
+	 */
+	uint64_t		rowid_map_nslots;	/* power of 2 */
+	pg_atomic_uint32 rowid_num_used;
+	pg_atomic_uint32 rowid_generation;
 	pthread_mutex_t	rowid_mutex;
 	uint32_t		rowid_next_free;
 	uint32_t		rowid_num_free;
 
-	/* redo buffer properties */
+	/*
+	 * redo buffer properties
+	 *
+	 * writers reserve the range to write by CAS on redo_write_pos, then
+	 * advance redo_publish_pos in order of the reservation once the logs
+	 * are copied. GpuService reads the logs until redo_publish_pos.
+	 */
 	pthread_mutex_t	redo_mutex;
+	pthread_cond_t	redo_cond;	/* wakeup writers waiting for space or order */
 	uint64_t		redo_write_timestamp;
 	uint64_t		redo_write_nitems;
-	uint64_t		redo_write_pos;
+	pg_atomic_uint64 redo_write_pos;
+	uint64_t		redo_publish_pos;
 	uint64_t		redo_read_nitems;
-	uint64_t		redo_read_pos;
+	pg_atomic_uint64 redo_read_pos;
 	uint64_t		redo_sync_pos;
 
+	/*
+	 * host-resident columnar cache (only if host_resident)
+	 *
+	 * KDS_FORMAT_COLUMN image on the host shared memory, maintained by
+	 * the GpuCache Host Applier. Extra buffer has two regions, to switch
+	 * them on compaction. The fields below are modified under the
+	 * exclusive lock of host_rwlock.
+	 */
+	pthread_rwlock_t host_rwlock;
+	uint64_t		host_main_offset;
+	uint64_t		host_extra_offset;
+	uint64_t		host_extra_sz;		/* size of each region */
+	uint32_t		host_extra_curr;	/* current region (0 or 1) */
+
 	/* schema definitions (KDS_FORMAT_COLUMN) */
 	size_t			kds_extra_sz;
 	kern_data_store	kds_head;
@@ -133,6 +168,8 @@ typedef struct
 
 /*
  * GpuCacheRowIdItem
+ *
+ * ctid of the rowid, and the link of the free list if not used.
  */
 typedef struct
 {
@@ -141,28 +178,140 @@ typedef struct
 	uint16_t		__padding__;
 } GpuCacheRowIdItem;
 
+/*
+ * RowId-map - an open-addressing hash table (linear probing)
+ *
+ * Each slot has a 64bit key (packed ctid) and a rowid. A writer claims an
+ * empty or removed slot by CAS to ROWID_MAP_KEY__BUSY, then sets up the
+ * rowid and publishes the key. A removed slot never goes back to empty
+ * until the rowid-map is rebuilt, so it does not break the probe sequence
+ * of other keys. Because a particular ctid is inserted and removed by only
+ * one backend that modifies the row, no locks are needed.
+ */
+#define ROWID_MAP_KEY__EMPTY		0UL		/* ctid (0,0) is never valid */
+#define ROWID_MAP_KEY__BUSY			(~0UL - 1)
+#define ROWID_MAP_KEY__REMOVED		(~0UL)
+
+INLINE_FUNCTION(uint64_t)
+__gpuCacheRowIdMapNSlots(const GpuCacheOptions *gc_options)
+{
+	uint64_t	nrooms = Max(gc_options->rowid_hash_nslots,
+							 gc_options->max_num_rows +
+							 gc_options->max_num_rows / 2);
+	uint64_t	nslots = 1024;
+
+	while (nslots < nrooms)
+		nslots += nslots;
+	return nslots;
+}
+
+INLINE_FUNCTION(size_t)
+__gpuCacheRowIdMapLength(uint64_t rowid_map_nslots, uint64_t max_num_rows)
+{
+	return PAGE_ALIGN((sizeof(pg_atomic_uint64) +
+					   sizeof(uint32_t)) * rowid_map_nslots +
+					  sizeof(GpuCacheRowIdItem) * max_num_rows);
+}
+
 INLINE_FUNCTION(char *)
 gpuCacheRedoLogBuffer(GpuCacheSharedState *gc_sstate)
 {
 	return (char *)gc_sstate + gc_sstate->redo_buffer_offset;
 }
 
+INLINE_FUNCTION(pg_atomic_uint64 *)
+gpuCacheRowIdMapKeys(GpuCacheSharedState *gc_sstate)
+{
+	return (pg_atomic_uint64 *)((char *)gc_sstate + gc_sstate->rowid_map_offset);
+}
+
 INLINE_FUNCTION(uint32_t *)
-gpuCacheRowIdHashSlot(GpuCacheSharedState *gc_sstate)
+gpuCacheRowIdMapValues(GpuCacheSharedState *gc_sstate)
 {
-	return (uint32_t *)((char *)gc_sstate + gc_sstate->rowid_map_offset);
+	return (uint32_t *)(gpuCacheRowIdMapKeys(gc_sstate) +
+						gc_sstate->rowid_map_nslots);
 }
 
 INLINE_FUNCTION(GpuCacheRowIdItem *)
 gpuCacheRowIdItemArray(GpuCacheSharedState *gc_sstate)
 {
-	return (GpuCacheRowIdItem *)
-		(gpuCacheRowIdHashSlot(gc_sstate) + gc_sstate->gc_options.rowid_hash_nslots);
+	return (GpuCacheRowIdItem *)(gpuCacheRowIdMapValues(gc_sstate) +
+								 gc_sstate->rowid_map_nslots);
+}
+
+INLINE_FUNCTION(kern_data_store *)
+gpuCacheHostMainBuffer(GpuCacheSharedState *gc_sstate)
+{
+	Assert(gc_sstate->gc_options.host_resident);
+	return (kern_data_store *)((char *)gc_sstate + gc_sstate->host_main_offset);
+}
+
+INLINE_FUNCTION(kern_data_extra *)
+gpuCacheHostExtraBuffer(GpuCacheSharedState *gc_sstate, uint32_t region)
+{
+	Assert(gc_sstate->gc_options.host_resident && region < 2);
+	if (gc_sstate->host_extra_sz == 0)
+		return NULL;
+	return (kern_data_extra *)((char *)gc_sstate +
+							   gc_sstate->host_extra_offset +
+							   gc_sstate->host_extra_sz * region);
+}
+
+INLINE_FUNCTION(GpuCacheSysattr *)
+gpuCacheHostGetSysattr(kern_data_store *kds, uint32_t rowid)
+{
+	kern_colmeta   *cmeta = &kds->colmeta[kds->nr_colmeta - 1];
+
+	Assert(cmeta->attlen == sizeof(GpuCacheSysattr) &&
+		   rowid < kds->column_nrooms);
+	return (GpuCacheSysattr *)((char *)kds + __kds_unpack(cmeta->values_offset)) + rowid;
+}
+
+/*
+ * gpuCacheHostUpdateStatistics
+ *
+ * It must be called under the exclusive lock of host_rwlock
+ */
+INLINE_FUNCTION(void)
+gpuCacheHostUpdateStatistics(GpuCacheSharedState *gc_sstate,
+							 kern_data_store *kds)
+{
+	kern_data_extra *extra;
+
+	extra = gpuCacheHostExtraBuffer(gc_sstate, gc_sstate->host_extra_curr);
+	pg_atomic_write_u64(&gc_sstate->gcache_main_size, kds->length);
+	pg_atomic_write_u64(&gc_sstate->gcache_main_nitems, kds->nitems);
+	if (extra)
+	{
+		pg_atomic_write_u64(&gc_sstate->gcache_extra_size, extra->length);
+		pg_atomic_write_u64(&gc_sstate->gcache_extra_usage, extra->usage);
+		pg_atomic_write_u64(&gc_sstate->gcache_extra_dead, extra->deadspace);
+	}
+}
+
+/*
+ * Index of the command queue; the last one is consumed by the GpuCache
+ * Host Applier for the host-resident GpuCache.
+ */
+INLINE_FUNCTION(int)
+gpuCacheCommandQueueIndex(const GpuCacheOptions *gc_options)
+{
+	return (gc_options->host_resident
+			? numGpuDevAttrs
+			: gc_options->cuda_dindex);
 }
 
 /*
  * GpuCacheLocalMapping
+ *
+ * Backend caches a small number of free rowids, to avoid rowid_mutex for
+ * each row insertion/removal. Free rowids are cached only if the GpuCache
+ * has enough free rowids, not to exhaust them by the caches.
  */
+#define GPUCACHE_ROWID_CACHE_NBATCH		64
+#define GPUCACHE_ROWID_CACHE_NROOMS		(2 * GPUCACHE_ROWID_CACHE_NBATCH)
+#define GPUCACHE_ROWID_CACHE_MIN_FREE	65536
+
 typedef struct
 {
 	dlist_node		chain;
@@ -170,6 +319,10 @@ typedef struct
 	int				refcnt;
 	GpuCacheSharedState *gc_sstate;
 	size_t			mmap_sz;
+	/* free rowids cached by the backend */
+	uint32_t		rowid_cache_generation;
+	uint32_t		rowid_cache_nitems;
+	uint32_t		rowid_cache[GPUCACHE_ROWID_CACHE_NROOMS];
 	/* fields below are valid only GpuService context */
 	pthread_rwlock_t gcache_rwlock;
 	CUdeviceptr		gcache_main_devptr;
@@ -191,6 +344,10 @@ struct GpuCacheDesc
 	bool			drop_on_commit;
 	uint32_t		nitems;
 	StringInfoData	buf;	/* array of PendingCtidItem */
+	/* REDO logs not written to the shared buffer yet */
+	dlist_node		redo_chain;	/* link to gcache_pending_redo_list */
+	uint32_t		redo_nitems;
+	StringInfoData	redo;
 };
 
 typedef struct
@@ -203,19 +360,41 @@ typedef struct
 /* --- static variables --- */
 static char	   *pgstrom_gpucache_auto_preload;		/* GUC */
 static bool		pgstrom_enable_gpucache;			/* GUC */
+static int		pgstrom_gpucache_load_parallel_workers;	/* GUC */
 static GpuCacheSharedHead *gcache_shared_head = NULL;
 static HTAB	   *gcache_descriptors_htab = NULL;
 static HTAB	   *gcache_signatures_htab = NULL;
+static dlist_head	gcache_pending_redo_list;
 static shmem_request_hook_type shmem_request_next = NULL;
 static shmem_startup_hook_type shmem_startup_next = NULL;
 static object_access_hook_type object_access_next = NULL;
+static set_rel_pathlist_hook_type set_rel_pathlist_next = NULL;
+static CustomPathMethods	gcache_hscan_path_methods;
+static CustomScanMethods	gcache_hscan_plan_methods;
+static CustomExecMethods	gcache_hscan_exec_methods;
 
 /* --- function declarations --- */
 static bool		__gpuCacheAppendLog(GpuCacheDesc *gc_desc,
 									GCacheTxLogCommon *tx_log);
+static bool		__gpuCacheFlushLog(GpuCacheDesc *gc_desc, bool in_commit);
+static void		__gpuCacheFlushPendingLogs(const GpuCacheIdent *ident,
+										   bool in_commit);
 static void		gpuCacheInvokeDropUnload(const GpuCacheDesc *gc_desc,
 										 bool is_async);
+static int		__gpucacheHostApplyOneLog(GpuCacheSharedState *gc_sstate,
+										  kern_data_store *kds,
+										  const GCacheTxLogCommon *tx_log,
+										  char *errbuf, size_t errbuf_sz);
+static bool		__restoreGpuCacheSnapshot(GpuCacheDesc *gc_desc,
+										  Relation rel);
+static void		__unlinkGpuCacheSnapshots(Oid database_oid, Oid table_oid,
+										  uint64_t keep_signature);
+static void		__flushGpuCacheRowIdCache(GpuCacheLocalMapping *gc_lmap,
+										  uint32_t nkeeps);
+static void		__gpuCacheExplainDesc(GpuCacheDesc *gc_desc,
+									  ExplainState *es);
 void	gpuCacheStartupPreloader(Datum arg);
+void	gpuCacheHostApplier(Datum arg);
 
 /*
  * gpucache_sync_trigger_function_oid
@@ -264,6 +443,7 @@ __parseSyncTriggerOptions(const char *__config, GpuCacheOptions *gc_options)
 	int64		max_num_rows = (10UL << 20);	/* default: 10M rows */
 	int64		rowid_hash_nslots = -1;			/* default: auto */
 	ssize_t		redo_buffer_size = (160UL << 20);	/* default: 160MB */
+	bool		host_resident = false;
 	char	   *config;
 	char	   *key, *value;
 	char	   *saved;
@@ -391,6 +571,15 @@ __parseSyncTriggerOptions(const char *__config, GpuCacheOptions *gc_options)
 				return false;
 			}
 		}
+		else if (strcmp(key, "host_resident") == 0)
+		{
+			if (!parse_bool(value, &host_resident))
+			{
+				elog(WARNING, "gpucache: invalid option [%s]=[%s]",
+					 key, value);
+				return false;
+			}
+		}
 		else
 		{
 			elog(WARNING, "gpucache: unknown option [%s]=[%s]", key, value);
@@ -408,12 +597,18 @@ out:
 		}
 		if (rowid_hash_nslots < 0)
 			rowid_hash_nslots = (max_num_rows + max_num_rows / 5);
+		/* GpuCache must be host-resident on the host without GPUs */
+		if (numGpuDevAttrs == 0)
+			host_resident = true;
+		if (host_resident)
+			cuda_dindex = -1;
 		gc_options->cuda_dindex       = cuda_dindex;
 		gc_options->gpu_sync_interval = gpu_sync_interval;
 		gc_options->gpu_sync_threshold = gpu_sync_threshold;
 		gc_options->max_num_rows      = max_num_rows;
 		gc_options->rowid_hash_nslots = rowid_hash_nslots;
 		gc_options->redo_buffer_size  = redo_buffer_size;
+		gc_options->host_resident     = host_resident;
 	}
 	return true;
 }
@@ -929,14 +1124,37 @@ __openGpuCacheSharedState(Oid database_oid,
 				 "GpuCacheSharedState validation error");
 		goto bailout;
 	}
-	off += PAGE_ALIGN(sizeof(uint32_t) * gc_sstate->gc_options.rowid_hash_nslots +
-					  sizeof(GpuCacheRowIdItem) * gc_sstate->gc_options.max_num_rows);
+	if (gc_sstate->rowid_map_nslots != __gpuCacheRowIdMapNSlots(&gc_sstate->gc_options))
+	{
+		snprintf(errbuf, errbuf_sz,
+				 "GpuCacheSharedState validation error");
+		goto bailout;
+	}
+	off += __gpuCacheRowIdMapLength(gc_sstate->rowid_map_nslots,
+									gc_sstate->gc_options.max_num_rows);
 	if (off != gc_sstate->redo_buffer_offset)
 	{
 		snprintf(errbuf, errbuf_sz, "GpuCacheSharedState validation error");
 		goto bailout;
 	}
 	off += gc_sstate->gc_options.redo_buffer_size;
+	if (gc_sstate->gc_options.host_resident)
+	{
+		if (off != gc_sstate->host_main_offset)
+		{
+			snprintf(errbuf, errbuf_sz,
+					 "GpuCacheSharedState validation error");
+			goto bailout;
+		}
+		off += PAGE_ALIGN(gc_sstate->kds_head.length);
+		if (off != gc_sstate->host_extra_offset)
+		{
+			snprintf(errbuf, errbuf_sz,
+					 "GpuCacheSharedState validation error");
+			goto bailout;
+		}
+		off += 2 * gc_sstate->host_extra_sz;
+	}
 	if (off != stat_buf.st_size)
 	{
 		snprintf(errbuf, errbuf_sz,
@@ -985,32 +1203,61 @@ bailout:
 static void
 __resetGpuCacheSharedState(GpuCacheSharedState *gc_sstate)
 {
-	uint32_t   *rowid_hslot = gpuCacheRowIdHashSlot(gc_sstate);
+	pg_atomic_uint64 *rowid_keys = gpuCacheRowIdMapKeys(gc_sstate);
 	GpuCacheRowIdItem *rowid_items = gpuCacheRowIdItemArray(gc_sstate);
-	uint32_t	rowid_nslots = gc_sstate->gc_options.rowid_hash_nslots;
+	uint64_t	rowid_nslots = gc_sstate->rowid_map_nslots;
 	uint32_t	rowid_nrooms = gc_sstate->gc_options.max_num_rows;
 
 	/* reset rowid-map */
 	pthreadMutexLock(&gc_sstate->rowid_mutex);
-	for (uint32_t i=0; i < rowid_nslots; i++)
-		rowid_hslot[i] = UINT_MAX;
+	for (uint64_t i=0; i < rowid_nslots; i++)
+		pg_atomic_init_u64(&rowid_keys[i], ROWID_MAP_KEY__EMPTY);
 	for (uint32_t i=1; i < rowid_nrooms; i++)
+	{
 		rowid_items[i-1].next = i;
+		ItemPointerSetInvalid(&rowid_items[i-1].ctid);
+	}
 	rowid_items[rowid_nrooms-1].next = UINT_MAX;	/* terminator */
+	ItemPointerSetInvalid(&rowid_items[rowid_nrooms-1].ctid);
 	gc_sstate->rowid_next_free = 0;
 	gc_sstate->rowid_num_free = rowid_nrooms;
+	pg_atomic_write_u32(&gc_sstate->rowid_num_used, 0);
+	pg_atomic_fetch_add_u32(&gc_sstate->rowid_generation, 1);
 	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
 
 	/* reset redo-log-buffer */
 	pthreadMutexLock(&gc_sstate->redo_mutex);
 	gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
 	gc_sstate->redo_write_nitems = 0;
-    gc_sstate->redo_write_pos = 0;
-    gc_sstate->redo_read_nitems = 0;
-    gc_sstate->redo_read_pos = 0;
-    gc_sstate->redo_sync_pos = 0;
+	pg_atomic_init_u64(&gc_sstate->redo_write_pos, 0);
+	gc_sstate->redo_publish_pos = 0;
+	gc_sstate->redo_read_nitems = 0;
+	pg_atomic_init_u64(&gc_sstate->redo_read_pos, 0);
+	gc_sstate->redo_sync_pos = 0;
 	pthreadMutexUnlock(&gc_sstate->redo_mutex);
 
+	/* reset host-resident columnar cache */
+	if (gc_sstate->gc_options.host_resident)
+	{
+		kern_data_store *kds_host;
+		kern_data_extra *extra;
+
+		pthreadRWLockWriteLock(&gc_sstate->host_rwlock);
+		kds_host = gpuCacheHostMainBuffer(gc_sstate);
+		memcpy(kds_host, &gc_sstate->kds_head,
+			   KDS_HEAD_LENGTH(&gc_sstate->kds_head));
+		kds_host->nitems = 0;
+		gc_sstate->host_extra_curr = 0;
+		extra = gpuCacheHostExtraBuffer(gc_sstate, 0);
+		if (extra)
+		{
+			extra->length = gc_sstate->host_extra_sz;
+			extra->usage = offsetof(kern_data_extra, data);
+			extra->deadspace = 0;
+		}
+		pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+	}
+
 	/* make this GpuCache available again */
 	pg_atomic_init_u32(&gc_sstate->phase, GCACHE_PHASE__IS_EMPTY);
 }
@@ -1025,8 +1272,14 @@ __createGpuCacheSharedState(Relation rel,
 {
 	TupleDesc	tupdesc = RelationGetDescr(rel);
 	int			fdesc = -1;
+	kern_data_store *kds_head;
+	size_t		kds_extra_sz;
 	size_t		rowid_map_offset;
+	uint64_t	rowid_map_nslots = __gpuCacheRowIdMapNSlots(gc_options);
 	size_t		redo_buffer_offset;
+	size_t		host_main_offset = 0;
+	size_t		host_extra_offset = 0;
+	size_t		host_extra_sz = 0;
 	size_t		mmap_sz;
 	char		namebuf[MAXPGPATH];
 	dlist_head *hslot;
@@ -1038,13 +1291,32 @@ __createGpuCacheSharedState(Relation rel,
 							MyDatabaseId,
 							RelationGetRelid(rel),
 							signature);
+	kds_head = alloca(estimate_kern_data_store(tupdesc));
+	__setup_kern_data_store_column(kds_head,
+								   &kds_extra_sz,
+								   rel,
+								   gc_options->max_num_rows);
 	mmap_sz = PAGE_ALIGN(offsetof(GpuCacheSharedState, kds_head) +
-						 estimate_kern_data_store(tupdesc));
+						 KDS_HEAD_LENGTH(kds_head));
 	rowid_map_offset = mmap_sz;
-	mmap_sz += PAGE_ALIGN(sizeof(uint32_t) * gc_options->rowid_hash_nslots +
-						  sizeof(GpuCacheRowIdItem) * gc_options->max_num_rows);
+	mmap_sz += __gpuCacheRowIdMapLength(rowid_map_nslots,
+										gc_options->max_num_rows);
 	redo_buffer_offset = mmap_sz;
 	mmap_sz += PAGE_ALIGN(gc_options->redo_buffer_size);
+	if (gc_options->host_resident)
+	{
+		/*
+		 * Host-resident columnar cache: main KDS, and double-buffered
+		 * extra regions for varlena values. Pages of the extra regions
+		 * are not populated until they are used actually.
+		 */
+		host_main_offset = mmap_sz;
+		mmap_sz += PAGE_ALIGN(kds_head->length);
+		host_extra_offset = mmap_sz;
+		if (kds_extra_sz > 0)
+			host_extra_sz = PAGE_ALIGN(2 * kds_extra_sz);
+		mmap_sz += 2 * host_extra_sz;
+	}
 
 	fdesc = shm_open(namebuf, O_RDWR | O_CREAT | O_EXCL | O_TRUNC, 0600);
 	if (fdesc < 0)
@@ -1079,14 +1351,18 @@ __createGpuCacheSharedState(Relation rel,
 		gc_sstate->ident.signature    = signature;
 		strncpy(gc_sstate->table_name, RelationGetRelationName(rel), NAMEDATALEN);
 		gc_sstate->rowid_map_offset = rowid_map_offset;
+		gc_sstate->rowid_map_nslots = rowid_map_nslots;
 		gc_sstate->redo_buffer_offset = redo_buffer_offset;
+		gc_sstate->host_main_offset = host_main_offset;
+		gc_sstate->host_extra_offset = host_extra_offset;
+		gc_sstate->host_extra_sz = host_extra_sz;
 		memcpy(&gc_sstate->gc_options, gc_options, sizeof(GpuCacheOptions));
 		pthreadMutexInitShared(&gc_sstate->rowid_mutex);
 		pthreadMutexInitShared(&gc_sstate->redo_mutex);
-		__setup_kern_data_store_column(&gc_sstate->kds_head,
-									   &gc_sstate->kds_extra_sz,
-									   rel,
-									   gc_options->max_num_rows);
+		pthreadCondInitShared(&gc_sstate->redo_cond);
+		pthreadRWLockInitShared(&gc_sstate->host_rwlock);
+		memcpy(&gc_sstate->kds_head, kds_head, KDS_HEAD_LENGTH(kds_head));
+		gc_sstate->kds_extra_sz = kds_extra_sz;
 		__resetGpuCacheSharedState(gc_sstate);
 
 		/* build GpuCacheLocalMapping */
@@ -1207,6 +1483,7 @@ __removeGpuCacheLocalMapping(GpuCacheLocalMapping *gc_lmap)
 
 	Assert(gc_lmap->refcnt == 0);
 	dlist_delete(&gc_lmap->chain);
+	__flushGpuCacheRowIdCache(gc_lmap, 0);
 	munmap(gc_lmap->gc_sstate, gc_lmap->mmap_sz);
 	if (gc_lmap->gcache_main_devptr != 0UL)
 	{
@@ -1294,127 +1571,351 @@ getGpuCacheDescIdent(const GpuCacheDesc *gc_desc)
  *
  * ------------------------------------------------------------
  */
+INLINE_FUNCTION(uint64_t)
+__gpuCacheRowIdMapKey(const ItemPointerData *ctid)
+{
+	return (((uint64_t)ItemPointerGetBlockNumberNoCheck(ctid) << 16) |
+			((uint64_t)ItemPointerGetOffsetNumberNoCheck(ctid)));
+}
+
+/*
+ * __insertGpuCacheRowIdMap
+ */
+static bool
+__insertGpuCacheRowIdMap(GpuCacheSharedState *gc_sstate,
+						 const ItemPointerData *ctid, uint32_t rowid)
+{
+	pg_atomic_uint64 *map_keys = gpuCacheRowIdMapKeys(gc_sstate);
+	uint32_t   *map_values = gpuCacheRowIdMapValues(gc_sstate);
+	uint64_t	mask = gc_sstate->rowid_map_nslots - 1;
+	uint64_t	key = __gpuCacheRowIdMapKey(ctid);
+	uint64_t	index;
+
+	index = hash_bytes((unsigned char *)&key, sizeof(uint64_t)) & mask;
+	for (uint64_t count=0; count <= mask; count++, index = ((index+1) & mask))
+	{
+		uint64_t	curr = pg_atomic_read_u64(&map_keys[index]);
+
+		if ((curr == ROWID_MAP_KEY__EMPTY ||
+			 curr == ROWID_MAP_KEY__REMOVED) &&
+			pg_atomic_compare_exchange_u64(&map_keys[index], &curr,
+										   ROWID_MAP_KEY__BUSY))
+		{
+			map_values[index] = rowid;
+			pg_write_barrier();
+			pg_atomic_write_u64(&map_keys[index], key);
+			pg_atomic_fetch_add_u32(&gc_sstate->rowid_num_used, 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * __lookupGpuCacheRowIdMap
+ *
+ * It returns the rowid of the ctid, or UINT_MAX if not found. If 'remove',
+ * the slot is also marked as removed.
+ */
 static uint32_t
-__allocGpuCacheRowId(GpuCacheLocalMapping *gc_lmap, const ItemPointer ctid)
+__lookupGpuCacheRowIdMap(GpuCacheSharedState *gc_sstate,
+						 const ItemPointerData *ctid, bool remove)
+{
+	pg_atomic_uint64 *map_keys = gpuCacheRowIdMapKeys(gc_sstate);
+	uint32_t   *map_values = gpuCacheRowIdMapValues(gc_sstate);
+	uint64_t	mask = gc_sstate->rowid_map_nslots - 1;
+	uint64_t	key = __gpuCacheRowIdMapKey(ctid);
+	uint64_t	index;
+
+	index = hash_bytes((unsigned char *)&key, sizeof(uint64_t)) & mask;
+	for (uint64_t count=0; count <= mask; count++, index = ((index+1) & mask))
+	{
+		uint64_t	curr = pg_atomic_read_u64(&map_keys[index]);
+
+		if (curr == key)
+		{
+			uint32_t	rowid;
+
+			pg_read_barrier();
+			rowid = map_values[index];
+			if (remove)
+			{
+				/* full barrier; rowid must be read prior to the removal */
+				pg_atomic_exchange_u64(&map_keys[index],
+									   ROWID_MAP_KEY__REMOVED);
+				pg_atomic_fetch_sub_u32(&gc_sstate->rowid_num_used, 1);
+			}
+			return rowid;
+		}
+		if (curr == ROWID_MAP_KEY__EMPTY)
+			break;
+	}
+	return UINT_MAX;
+}
+
+/*
+ * __flushGpuCacheRowIdCache
+ *
+ * It returns the free rowids cached by the backend to the shared free list.
+ */
+static void
+__flushGpuCacheRowIdCache(GpuCacheLocalMapping *gc_lmap, uint32_t nkeeps)
 {
 	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
-	uint32_t   *hslot = gpuCacheRowIdHashSlot(gc_sstate);
 	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
-	uint32_t	hash, hindex;
-	uint32_t	rowid;
-
-	hash = hash_bytes((unsigned char *)ctid, sizeof(ItemPointerData));
-	hindex = (hash % gc_sstate->gc_options.rowid_hash_nslots);
 
+	if (gc_lmap->rowid_cache_nitems <= nkeeps)
+		return;
 	pthreadMutexLock(&gc_sstate->rowid_mutex);
-	rowid = gc_sstate->rowid_next_free;
-	if (rowid < gc_sstate->gc_options.max_num_rows)
+	/* cached rowids are already released, if GpuCache was reset */
+	if (gc_lmap->rowid_cache_generation ==
+		pg_atomic_read_u32(&gc_sstate->rowid_generation))
 	{
-		GpuCacheRowIdItem *ritem = &rowitems[rowid];
+		for (uint32_t i=nkeeps; i < gc_lmap->rowid_cache_nitems; i++)
+		{
+			uint32_t	rowid = gc_lmap->rowid_cache[i];
 
-		ItemPointerCopy(ctid, &ritem->ctid);
-		gc_sstate->rowid_next_free = ritem->next;
-		ritem->next = hslot[hindex];
-		hslot[hindex] = rowid;
-		Assert(gc_sstate->rowid_num_free > 0);
-		gc_sstate->rowid_num_free--;
+			rowitems[rowid].next = gc_sstate->rowid_next_free;
+			gc_sstate->rowid_next_free = rowid;
+			gc_sstate->rowid_num_free++;
+		}
 	}
-	else
+	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+	gc_lmap->rowid_cache_nitems = nkeeps;
+}
+
+/*
+ * __gpuCacheRowIdCacheOnExit
+ *
+ * It returns the free rowids cached by this backend on exit.
+ */
+static bool		gpucache_rowid_cache_on_exit = false;
+
+static void
+__gpuCacheRowIdCacheOnExit(int code, Datum arg)
+{
+	pthreadMutexLock(&gcache_shared_mapping_lock);
+	for (int i=0; i < GCACHE_SHARED_MAPPING_NSLOTS; i++)
 	{
-		uint32_t	phase;
+		dlist_iter	iter;
 
-		Assert(rowid == UINT_MAX);
-		phase = pg_atomic_exchange_u32(&gc_sstate->phase,
-									   GCACHE_PHASE__IS_CORRUPTED);
-		if (phase != GCACHE_PHASE__IS_CORRUPTED)
-			elog(WARNING, "gpucache: rowid exceeds max_num_rows (%lu), so it is now switched to 'corrupted' state",
-				 gc_sstate->gc_options.max_num_rows);
+		dlist_foreach(iter, &gcache_shared_mapping_slot[i])
+		{
+			GpuCacheLocalMapping *gc_lmap = dlist_container(GpuCacheLocalMapping,
+															 chain, iter.cur);
+			__flushGpuCacheRowIdCache(gc_lmap, 0);
+		}
 	}
-	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+	pthreadMutexUnlock(&gcache_shared_mapping_lock);
+}
 
-	return rowid;
+static void
+__registerGpuCacheRowIdCacheOnExit(void)
+{
+	if (!gpucache_rowid_cache_on_exit)
+	{
+		on_proc_exit(__gpuCacheRowIdCacheOnExit, 0);
+		gpucache_rowid_cache_on_exit = true;
+	}
 }
 
+/*
+ * __fetchGpuCacheRowIdCache
+ */
 static uint32_t
-__lookupGpuCacheRowId(GpuCacheLocalMapping *gc_lmap, const ItemPointer ctid)
+__fetchGpuCacheRowIdCache(GpuCacheLocalMapping *gc_lmap)
 {
 	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
-	uint32_t   *hslot = gpuCacheRowIdHashSlot(gc_sstate);
 	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
-	uint32_t	hash, rowid;
-	uint32_t	phase;
 
-	phase = pg_atomic_read_u32(&gc_sstate->phase);
-	if (phase == GCACHE_PHASE__IS_CORRUPTED)
-		return UINT_MAX;
-
-	/* Lookup the hash slot */
-	hash = hash_bytes((unsigned char *)ctid, sizeof(ItemPointerData));
-	pthreadMutexLock(&gc_sstate->rowid_mutex);
-	rowid = hslot[hash % gc_sstate->gc_options.rowid_hash_nslots];
-	while (rowid < gc_sstate->gc_options.max_num_rows)
+	if (gc_lmap->rowid_cache_generation !=
+		pg_atomic_read_u32(&gc_sstate->rowid_generation))
+		gc_lmap->rowid_cache_nitems = 0;
+	if (gc_lmap->rowid_cache_nitems == 0)
 	{
-		GpuCacheRowIdItem *ritem = &rowitems[rowid];
+		uint32_t	nbatch;
 
-		if (ItemPointerEquals(&ritem->ctid, ctid))
+		__registerGpuCacheRowIdCacheOnExit();
+		pthreadMutexLock(&gc_sstate->rowid_mutex);
+		gc_lmap->rowid_cache_generation =
+			pg_atomic_read_u32(&gc_sstate->rowid_generation);
+		nbatch = (gc_sstate->rowid_num_free >= GPUCACHE_ROWID_CACHE_MIN_FREE
+				  ? GPUCACHE_ROWID_CACHE_NBATCH : 1);
+		while (gc_lmap->rowid_cache_nitems < nbatch)
 		{
-			pthreadMutexUnlock(&gc_sstate->rowid_mutex);
-			return rowid;
+			uint32_t	rowid = gc_sstate->rowid_next_free;
+
+			if (rowid >= gc_sstate->gc_options.max_num_rows)
+				break;
+			gc_sstate->rowid_next_free = rowitems[rowid].next;
+			Assert(gc_sstate->rowid_num_free > 0);
+			gc_sstate->rowid_num_free--;
+			gc_lmap->rowid_cache[gc_lmap->rowid_cache_nitems++] = rowid;
 		}
-		rowid = ritem->next;
+		pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+
+		/* reverse the order, to assign rowids from the head of free list */
+		for (uint32_t i=0, j=gc_lmap->rowid_cache_nitems; i+1 < j; i++, j--)
+		{
+			uint32_t	temp = gc_lmap->rowid_cache[i];
+
+			gc_lmap->rowid_cache[i] = gc_lmap->rowid_cache[j-1];
+			gc_lmap->rowid_cache[j-1] = temp;
+		}
+
+		if (gc_lmap->rowid_cache_nitems == 0)
+			return UINT_MAX;	/* no free rowids */
 	}
-	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
-	/* not found */
+	return gc_lmap->rowid_cache[--gc_lmap->rowid_cache_nitems];
+}
+
+/*
+ * __releaseGpuCacheRowIdCache
+ */
+static void
+__releaseGpuCacheRowIdCache(GpuCacheLocalMapping *gc_lmap, uint32_t rowid)
+{
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+
+	if (gc_lmap->rowid_cache_generation !=
+		pg_atomic_read_u32(&gc_sstate->rowid_generation))
+	{
+		/* GpuCache was reset, so the rowid is already released */
+		gc_lmap->rowid_cache_nitems = 0;
+		return;
+	}
+	__registerGpuCacheRowIdCacheOnExit();
+	Assert(gc_lmap->rowid_cache_nitems < GPUCACHE_ROWID_CACHE_NROOMS);
+	gc_lmap->rowid_cache[gc_lmap->rowid_cache_nitems++] = rowid;
+	/* unlocked reference to rowid_num_free is just a hint */
+	if (gc_lmap->rowid_cache_nitems >= GPUCACHE_ROWID_CACHE_NROOMS)
+		__flushGpuCacheRowIdCache(gc_lmap, GPUCACHE_ROWID_CACHE_NBATCH);
+	else if (gc_sstate->rowid_num_free < GPUCACHE_ROWID_CACHE_MIN_FREE)
+		__flushGpuCacheRowIdCache(gc_lmap, 0);
+}
+
+/*
+ * __gpuCacheRowIdMapCorrupted
+ */
+static void
+__gpuCacheRowIdMapCorrupted(GpuCacheSharedState *gc_sstate,
+							const ItemPointerData *ctid)
+{
+	uint32_t	phase;
+
 	phase = pg_atomic_exchange_u32(&gc_sstate->phase,
 								   GCACHE_PHASE__IS_CORRUPTED);
-	if (phase != GCACHE_PHASE__IS_CORRUPTED)
+	if (phase == GCACHE_PHASE__IS_CORRUPTED)
+		return;
+	if (!ctid)
+		elog(WARNING, "gpucache: rowid exceeds max_num_rows (%lu), so it is now switched to 'corrupted' state",
+			 gc_sstate->gc_options.max_num_rows);
+	else
 		elog(WARNING, "gpucache: no rowid was assigned to ctid(%u,%u), so it is now switched to 'corrupted' state",
-			 (uint32_t)ctid->ip_blkid.bi_hi << 16 |
-			 (uint32_t)ctid->ip_blkid.bi_lo,
-			 (uint32_t)ctid->ip_posid);
-	return UINT_MAX;
+			 ItemPointerGetBlockNumberNoCheck(ctid),
+			 ItemPointerGetOffsetNumberNoCheck(ctid));
 }
 
-static void
-__removeGpuCacheRowId(GpuCacheLocalMapping *gc_lmap, const ItemPointer ctid)
+static uint32_t
+__allocGpuCacheRowId(GpuCacheLocalMapping *gc_lmap, const ItemPointer ctid)
 {
 	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
-	uint32_t   *hslot = gpuCacheRowIdHashSlot(gc_sstate);
 	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
-	uint32_t	hash, rowid;
-	uint32_t   *prev;
-	bool		found = false;
+	uint32_t	rowid;
+
+	rowid = __fetchGpuCacheRowIdCache(gc_lmap);
+	if (rowid < gc_sstate->gc_options.max_num_rows)
+	{
+		ItemPointerCopy(ctid, &rowitems[rowid].ctid);
+		if (__insertGpuCacheRowIdMap(gc_sstate, ctid, rowid))
+			return rowid;
+		ItemPointerSetInvalid(&rowitems[rowid].ctid);
+		__releaseGpuCacheRowIdCache(gc_lmap, rowid);
+	}
+	__gpuCacheRowIdMapCorrupted(gc_sstate, NULL);
+	return UINT_MAX;
+}
 
-	hash = hash_bytes((unsigned char *)ctid, sizeof(ItemPointerData));
+/*
+ * __allocGpuCacheRowIdBulk
+ *
+ * It assigns rowids to multiple ctids under a single acquisition of the
+ * rowid_mutex, for the initial loading. It returns the number of rowids
+ * actually assigned; if less than 'nitems', rowid exceeds max_num_rows
+ * and GpuCache is switched to 'corrupted' state.
+ */
+static uint32_t
+__allocGpuCacheRowIdBulk(GpuCacheLocalMapping *gc_lmap,
+						 const ItemPointerData *ctids,
+						 uint32_t nitems,
+						 uint32_t *rowids)
+{
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
+	uint32_t	i, nvalids;
 
 	pthreadMutexLock(&gc_sstate->rowid_mutex);
-	prev = &hslot[hash % gc_sstate->gc_options.rowid_hash_nslots];
-	for (rowid = *prev;
-		 rowid < gc_sstate->gc_options.max_num_rows;
-		 rowid = *prev)
+	for (i=0; i < nitems; i++)
 	{
-		GpuCacheRowIdItem *ritem = &rowitems[rowid];
+		uint32_t	rowid = gc_sstate->rowid_next_free;
 
-		if (ItemPointerEquals(&ritem->ctid, ctid))
-		{
-			*prev = ritem->next;
-
-			ritem->next = gc_sstate->rowid_next_free;
-			gc_sstate->rowid_next_free = rowid;
-			ItemPointerSetInvalid(&ritem->ctid);
-			gc_sstate->rowid_num_free++;
-			found = true;
+		if (rowid >= gc_sstate->gc_options.max_num_rows)
 			break;
-		}
-		prev = &ritem->next;
+		gc_sstate->rowid_next_free = rowitems[rowid].next;
+		rowids[i] = rowid;
 	}
+	Assert(gc_sstate->rowid_num_free >= i);
+	gc_sstate->rowid_num_free -= i;
 	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
 
-	if (!found)
+	/* rowid-map is updated without locks */
+	nvalids = i;
+	for (i=0; i < nvalids; i++)
+	{
+		ItemPointerCopy(&ctids[i], &rowitems[rowids[i]].ctid);
+		if (!__insertGpuCacheRowIdMap(gc_sstate, &ctids[i], rowids[i]))
+			elog(ERROR, "Bug? no room for the GpuCache rowid-map");
+	}
+	if (nvalids < nitems)
+		__gpuCacheRowIdMapCorrupted(gc_sstate, NULL);
+	return nvalids;
+}
+
+static uint32_t
+__lookupGpuCacheRowId(GpuCacheLocalMapping *gc_lmap, const ItemPointer ctid)
+{
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	uint32_t	rowid;
+
+	if (pg_atomic_read_u32(&gc_sstate->phase) == GCACHE_PHASE__IS_CORRUPTED)
+		return UINT_MAX;
+	rowid = __lookupGpuCacheRowIdMap(gc_sstate, ctid, false);
+	if (rowid >= gc_sstate->gc_options.max_num_rows)
+	{
+		/* not found */
+		__gpuCacheRowIdMapCorrupted(gc_sstate, ctid);
+		return UINT_MAX;
+	}
+	return rowid;
+}
+
+static void
+__removeGpuCacheRowId(GpuCacheLocalMapping *gc_lmap, const ItemPointer ctid)
+{
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
+	uint32_t	rowid;
+
+	rowid = __lookupGpuCacheRowIdMap(gc_sstate, ctid, true);
+	if (rowid >= gc_sstate->gc_options.max_num_rows)
+	{
 		elog(WARNING, "Bug? no rowid for ctid(%u,%u) is not assigned yet",
-			 (uint32_t)ctid->ip_blkid.bi_hi << 16 |
-			 (uint32_t)ctid->ip_blkid.bi_lo,
-			 (uint32_t)ctid->ip_posid);
+			 ItemPointerGetBlockNumberNoCheck(ctid),
+			 ItemPointerGetOffsetNumberNoCheck(ctid));
+		return;
+	}
+	ItemPointerSetInvalid(&rowitems[rowid].ctid);
+	__releaseGpuCacheRowIdCache(gc_lmap, rowid);
 }
 
 /* ------------------------------------------------------------
@@ -1467,6 +1968,8 @@ lookupGpuCacheDescNoLoad(Oid table_oid,
 			gc_desc->drop_on_commit = false;
 			gc_desc->nitems = 0;
 			memset(&gc_desc->buf, 0, sizeof(StringInfoData));
+			gc_desc->redo_nitems = 0;
+			memset(&gc_desc->redo, 0, sizeof(StringInfoData));
 		}
 		PG_CATCH();
 		{
@@ -1526,6 +2029,8 @@ lookupGpuCacheDesc(Relation rel)
 			gc_desc->drop_on_commit = false;
 			gc_desc->nitems = 0;
 			memset(&gc_desc->buf, 0, sizeof(StringInfoData));
+			gc_desc->redo_nitems = 0;
+			memset(&gc_desc->redo, 0, sizeof(StringInfoData));
 		}
 		PG_CATCH();
 		{
@@ -1547,6 +2052,10 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool normal_commit)
 	{
 		char	namebuf[MAXPGPATH];
 
+		/* REDO logs make no sense any more */
+		if (gc_desc->redo.len > 0)
+			dlist_delete(&gc_desc->redo_chain);
+
 		/* unload from the server */
 		gpuCacheInvokeDropUnload(gc_desc, true);
 		/* unlink the shared memory segment */
@@ -1569,48 +2078,48 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool normal_commit)
 			GCacheTxLogXact		tx_log;
 
 			if (pitem->tag == 'I')
-			{
-				if (normal_commit)
-				{
-					tx_log.type = GCACHE_TX_LOG__COMMIT_INS;
-				}
-				else
-				{
-					tx_log.type = GCACHE_TX_LOG__ABORT_INS;
-					__removeGpuCacheRowId(gc_desc->gc_lmap, &pitem->ctid);
-				}
-				tx_log.length = sizeof(GCacheTxLogXact);
-				tx_log.rowid = pitem->rowid;
-			}
-			else if (pitem->tag == 'D')
-			{
-				if (normal_commit)
-				{
-					tx_log.type = GCACHE_TX_LOG__COMMIT_DEL;
-					__removeGpuCacheRowId(gc_desc->gc_lmap, &pitem->ctid);
-				}
-				else
-				{
-					tx_log.type = GCACHE_TX_LOG__ABORT_DEL;
-				}
-				tx_log.length = sizeof(GCacheTxLogXact);
-				tx_log.rowid = pitem->rowid;
-			}
-			else
+				tx_log.type = (normal_commit
+							   ? GCACHE_TX_LOG__COMMIT_INS
+							   : GCACHE_TX_LOG__ABORT_INS);
+			else if (pitem->tag == 'D')
+				tx_log.type = (normal_commit
+							   ? GCACHE_TX_LOG__COMMIT_DEL
+							   : GCACHE_TX_LOG__ABORT_DEL);
+			else
 			{
 				elog(WARNING, "Bug? unexpected PendingCtidItem tag '%c'",
 					 pitem->tag);
+				pos += sizeof(PendingCtidItem);
 				continue;
 			}
+			tx_log.length = sizeof(GCacheTxLogXact);
+			tx_log.rowid = pitem->rowid;
 			if (!__gpuCacheAppendLog(gc_desc, (GCacheTxLogCommon *)&tx_log))
 				elog(WARNING, "Bug? unable to write out GpuCache Log");
 			pos += sizeof(PendingCtidItem);
 		}
+		/*
+		 * All the logs of this transaction are written at once, then rowids
+		 * are released; they must not be reused prior to the logs above.
+		 */
+		if (!__gpuCacheFlushLog(gc_desc, true))
+			elog(WARNING, "Bug? unable to write out GpuCache Log");
+		pos = gc_desc->buf.data;
+		for (uint32_t i=0; i < gc_desc->nitems; i++)
+		{
+			PendingCtidItem	   *pitem = (PendingCtidItem *)pos;
+
+			if (normal_commit ? pitem->tag == 'D' : pitem->tag == 'I')
+				__removeGpuCacheRowId(gc_desc->gc_lmap, &pitem->ctid);
+			pos += sizeof(PendingCtidItem);
+		}
 		putGpuCacheLocalMapping(gc_desc->gc_lmap);
 	}
 	/* cleanup itself */
 	if (gc_desc->buf.data)
 		pfree(gc_desc->buf.data);
+	if (gc_desc->redo.data)
+		pfree(gc_desc->redo.data);
 	hash_search(gcache_descriptors_htab,
 				gc_desc, HASH_REMOVE, NULL);
 }
@@ -1901,27 +2410,202 @@ __gpuCacheInitLoadTrackCtid(GpuCacheDesc *gc_desc,
 	gc_desc->nitems++;
 }
 
+/* ------------------------------------------------------------
+ *
+ * Initial loading
+ *
+ * The initial loading scans the table in chunks of blocks; if the table is
+ * large enough, parallel workers also pick up the chunks to be loaded.
+ * Rowids are assigned to a batch of tuples at once, and the host-resident
+ * GpuCache writes the columnar image directly, not via REDO log buffer.
+ * Tuples inserted / deleted by the current transaction must be tracked by
+ * the backend local GpuCacheDesc, so the parallel workers leave them to
+ * the leader process, then it scans the table again only for these tuples.
+ * ------------------------------------------------------------
+ */
+#define GPUCACHE_LOAD_PARALLEL_KEY			0x9c0ac4e1e0000001UL
+#define GPUCACHE_LOAD_CHUNK_NBLOCKS			1024	/* 8MB */
+#define GPUCACHE_LOAD_PARALLEL_MIN_CHUNKS	8		/* min # of chunks per worker */
+#define GPUCACHE_LOAD_BATCH_NITEMS			512
+#define GPUCACHE_LOAD_BATCH_BUFSZ			(1UL << 20)		/* 1MB */
+
+typedef struct
+{
+	GpuCacheIdent	ident;
+	BlockNumber		nblocks;
+	pg_atomic_uint64 next_block;	/* next chunk to be loaded */
+	pg_atomic_uint32 num_deferred;	/* # of tuples left to the leader */
+	pg_atomic_uint32 num_failed;	/* # of workers failed on loading */
+} gpuCacheLoadParallelState;
+
+typedef struct
+{
+	GpuCacheDesc   *gc_desc;	/* NULL on the parallel workers */
+	GpuCacheDesc   *redo_desc;	/* REDO log buffer, if GPU-resident */
+	GpuCacheLocalMapping *gc_lmap;
+	Relation		rel;
+	uint32_t		nitems;
+	uint32_t		rowids[GPUCACHE_LOAD_BATCH_NITEMS];
+	uint32_t		offsets[GPUCACHE_LOAD_BATCH_NITEMS];
+	ItemPointerData	ctids[GPUCACHE_LOAD_BATCH_NITEMS];
+	StringInfoData	buf;		/* array of GCacheTxLogInsert */
+} gpuCacheLoadBatch;
+
 /*
- * __initialLoadGpuCache - entrypoint of the initial loading
+ * __initialLoadGpuCacheAddTuple
  */
 static void
-__initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
+__initialLoadGpuCacheAddTuple(gpuCacheLoadBatch *batch,
+							  HeapTuple scantup,
+							  TransactionId gcache_xmin,
+							  TransactionId gcache_xmax)
+{
+	HeapTuple	tuple = __makeFlattenHeapTuple(batch->rel, scantup);
+	GCacheTxLogInsert *item;
+	size_t		sz;
+
+	Assert(batch->nitems < GPUCACHE_LOAD_BATCH_NITEMS);
+	sz = MAXALIGN(offsetof(GCacheTxLogInsert, htup) + tuple->t_len);
+	enlargeStringInfo(&batch->buf, sz);
+	item = (GCacheTxLogInsert *)(batch->buf.data + batch->buf.len);
+	memset(item, 0, sz);
+	item->type = GCACHE_TX_LOG__INSERT;
+	item->length = sz;
+	item->rowid = UINT_MAX;		/* assigned on the flush */
+	memcpy(&item->htup, tuple->t_data, tuple->t_len);
+	memcpy(&item->htup.t_ctid, &tuple->t_self, sizeof(ItemPointerData));
+	HeapTupleHeaderSetXmin(&item->htup, gcache_xmin);
+	HeapTupleHeaderSetXmax(&item->htup, gcache_xmax);
+	HeapTupleHeaderSetCmin(&item->htup, InvalidCommandId);
+
+	batch->offsets[batch->nitems] = batch->buf.len;
+	ItemPointerCopy(&tuple->t_self, &batch->ctids[batch->nitems]);
+	batch->buf.len += sz;
+	batch->nitems++;
+	pfree(tuple);
+}
+
+/*
+ * __initialLoadGpuCacheFlushBatch
+ *
+ * It assigns rowids to the buffered tuples at once, then writes them to
+ * the host-resident columnar image or REDO log buffer.
+ */
+static bool
+__initialLoadGpuCacheFlushBatch(gpuCacheLoadBatch *batch)
+{
+	GpuCacheSharedState *gc_sstate = batch->gc_lmap->gc_sstate;
+	uint32_t	nitems = batch->nitems;
+	uint32_t	nvalids;
+	bool		retval = true;
+
+	if (nitems == 0)
+		return true;
+	nvalids = __allocGpuCacheRowIdBulk(batch->gc_lmap,
+									   batch->ctids,
+									   nitems,
+									   batch->rowids);
+	if (nvalids < nitems)
+		retval = false;		/* GpuCache is already corrupted */
+	PG_TRY();
+	{
+		for (uint32_t i=0; i < nvalids; i++)
+		{
+			GCacheTxLogInsert *item = (GCacheTxLogInsert *)
+				(batch->buf.data + batch->offsets[i]);
+			TransactionId	xmin = HeapTupleHeaderGetRawXmin(&item->htup);
+			TransactionId	xmax = HeapTupleHeaderGetRawXmax(&item->htup);
+
+			item->rowid = batch->rowids[i];
+			if (!batch->gc_desc)
+				Assert(!TransactionIdIsNormal(xmin) &&
+					   !TransactionIdIsNormal(xmax));
+			else
+			{
+				if (TransactionIdIsNormal(xmin))
+					__gpuCacheInitLoadTrackCtid(batch->gc_desc, xmin, 'I',
+												item->rowid, &batch->ctids[i]);
+				if (TransactionIdIsNormal(xmax))
+					__gpuCacheInitLoadTrackCtid(batch->gc_desc, xmax, 'D',
+												item->rowid, &batch->ctids[i]);
+			}
+		}
+
+		if (gc_sstate->gc_options.host_resident)
+		{
+			kern_data_store *kds;
+			char		errbuf[GCACHE_CONTROL_CMD__ERRORBUF_SIZE];
+			int			status = 0;
+
+			pthreadRWLockWriteLock(&gc_sstate->host_rwlock);
+			kds = gpuCacheHostMainBuffer(gc_sstate);
+			for (uint32_t i=0; i < nvalids && status == 0; i++)
+			{
+				status = __gpucacheHostApplyOneLog(gc_sstate, kds,
+												   (GCacheTxLogCommon *)
+												   (batch->buf.data +
+													batch->offsets[i]),
+												   errbuf, sizeof(errbuf));
+			}
+			if (status == 0)
+				gpuCacheHostUpdateStatistics(gc_sstate, kds);
+			pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+			if (status != 0)
+				elog(ERROR, "%s", errbuf);
+		}
+		else
+		{
+			for (uint32_t i=0; i < nvalids; i++)
+			{
+				if (!__gpuCacheAppendLog(batch->redo_desc, (GCacheTxLogCommon *)
+										 (batch->buf.data + batch->offsets[i])))
+				{
+					elog(WARNING, "unable to write out GpuCache TxLogInsert");
+					retval = false;
+					break;
+				}
+			}
+		}
+	}
+	PG_CATCH();
+	{
+		for (uint32_t i=0; i < nvalids; i++)
+			__removeGpuCacheRowId(batch->gc_lmap, &batch->ctids[i]);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	batch->nitems = 0;
+	resetStringInfo(&batch->buf);
+
+	return retval;
+}
+
+/*
+ * __initialLoadGpuCacheBlocks
+ *
+ * It loads the tuples in the range of the blocks. If 'num_deferred' is
+ * given (parallel loading), the tuples to be tracked by the current
+ * transaction are counted and left to the rescan by the leader with
+ * 'deferred_only', that loads only these tuples.
+ */
+static bool
+__initialLoadGpuCacheBlocks(gpuCacheLoadBatch *batch,
+							BlockNumber start_block,
+							BlockNumber num_blocks,
+							bool deferred_only,
+							pg_atomic_uint32 *num_deferred)
 {
 	TableScanDesc	hscan;
 	HeapTuple		scantup;
-	HeapTuple		tuple;
-	size_t			item_sz = 2048;
-	GCacheTxLogInsert *item = alloca(item_sz);
-
-	Assert(gc_desc->gc_lmap != NULL);
+	bool			retval = true;
 
-	hscan = table_beginscan(rel, SnapshotAny, 0, NULL);
+	hscan = table_beginscan_strat(batch->rel, SnapshotAny, 0, NULL,
+								  true, false);
+	heap_setscanlimits(hscan, start_block, num_blocks);
 	while ((scantup = heap_getnext(hscan, ForwardScanDirection)) != NULL)
 	{
 		TransactionId	gcache_xmin;
 		TransactionId	gcache_xmax;
-		uint32_t		rowid;
-		size_t			sz;
 
 		CHECK_FOR_INTERRUPTS();
 
@@ -1929,45 +2613,220 @@ __initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 												  &gcache_xmin,
 												  &gcache_xmax))
 			continue;
+		if (TransactionIdIsNormal(gcache_xmin) ||
+			TransactionIdIsNormal(gcache_xmax))
+		{
+			/* must be tracked by the leader, after the parallel loading */
+			if (num_deferred)
+			{
+				pg_atomic_fetch_add_u32(num_deferred, 1);
+				continue;
+			}
+			Assert(batch->gc_desc != NULL);
+		}
+		else if (deferred_only)
+			continue;
 
-		tuple = __makeFlattenHeapTuple(rel, scantup);
-		sz = MAXALIGN(offsetof(GCacheTxLogInsert, htup) + tuple->t_len);
-		if (sz > item_sz)
+		__initialLoadGpuCacheAddTuple(batch, scantup,
+									  gcache_xmin,
+									  gcache_xmax);
+		if (batch->nitems >= GPUCACHE_LOAD_BATCH_NITEMS ||
+			batch->buf.len >= GPUCACHE_LOAD_BATCH_BUFSZ)
 		{
-			item_sz = 2 * sz + 1024;
-			item = alloca(item_sz);
+			if (!__initialLoadGpuCacheFlushBatch(batch))
+			{
+				retval = false;
+				break;
+			}
 		}
-		rowid = __allocGpuCacheRowId(gc_desc->gc_lmap, &tuple->t_self);
-		if (rowid == UINT_MAX)
+	}
+	table_endscan(hscan);
+
+	return retval;
+}
+
+/*
+ * __initialLoadGpuCacheParallelLoop
+ */
+static bool
+__initialLoadGpuCacheParallelLoop(gpuCacheLoadBatch *batch,
+								  gpuCacheLoadParallelState *ps)
+{
+	for (;;)
+	{
+		uint64_t	start_block;
+		BlockNumber	num_blocks;
+
+		start_block = pg_atomic_fetch_add_u64(&ps->next_block,
+											  GPUCACHE_LOAD_CHUNK_NBLOCKS);
+		if (start_block >= ps->nblocks)
 			break;
-		PG_TRY();
+		num_blocks = Min(ps->nblocks - start_block,
+						 GPUCACHE_LOAD_CHUNK_NBLOCKS);
+		if (!__initialLoadGpuCacheBlocks(batch,
+										 start_block,
+										 num_blocks,
+										 false,
+										 &ps->num_deferred))
+			return false;
+	}
+	return __initialLoadGpuCacheFlushBatch(batch);
+}
+
+/*
+ * gpuCacheInitialLoadWorkerMain - entrypoint of the parallel worker
+ */
+PUBLIC_FUNCTION(void)
+gpuCacheInitialLoadWorkerMain(dsm_segment *seg, shm_toc *toc)
+{
+	gpuCacheLoadParallelState *ps;
+	gpuCacheLoadBatch *batch;
+	GpuCacheDesc   *redo_desc;
+	GpuCacheLocalMapping *gc_lmap;
+	Relation		rel;
+
+	ps = shm_toc_lookup(toc, GPUCACHE_LOAD_PARALLEL_KEY, false);
+	rel = table_open(ps->ident.table_oid, AccessShareLock);
+	gc_lmap = getGpuCacheLocalMappingIfExist(ps->ident.database_oid,
+											 ps->ident.table_oid,
+											 ps->ident.signature);
+	if (!gc_lmap)
+		elog(ERROR, "GpuCache of '%s' is not found",
+			 RelationGetRelationName(rel));
+	/* REDO log buffer of this worker (not tied to any transactions) */
+	redo_desc = palloc0(sizeof(GpuCacheDesc));
+	memcpy(&redo_desc->ident, &ps->ident, sizeof(GpuCacheIdent));
+	redo_desc->xid = InvalidTransactionId;
+	memcpy(&redo_desc->gc_options, &gc_lmap->gc_sstate->gc_options,
+		   sizeof(GpuCacheOptions));
+	redo_desc->gc_lmap = gc_lmap;
+
+	batch = palloc0(sizeof(gpuCacheLoadBatch));
+	batch->gc_desc = NULL;
+	batch->redo_desc = redo_desc;
+	batch->gc_lmap = gc_lmap;
+	batch->rel = rel;
+	initStringInfo(&batch->buf);
+	PG_TRY();
+	{
+		if (!__initialLoadGpuCacheParallelLoop(batch, ps))
+			pg_atomic_fetch_add_u32(&ps->num_failed, 1);
+		else if (!__gpuCacheFlushLog(redo_desc, false))
 		{
-			if (TransactionIdIsNormal(gcache_xmin))
-				__gpuCacheInitLoadTrackCtid(gc_desc, gcache_xmin,
-											'I', rowid, &tuple->t_self);
-			if (TransactionIdIsNormal(gcache_xmax))
-				__gpuCacheInitLoadTrackCtid(gc_desc, gcache_xmax,
-											'D', rowid, &tuple->t_self);
-
-			item->type = GCACHE_TX_LOG__INSERT;
-			item->length = sz;
-			item->rowid = rowid;
-			memcpy(&item->htup, tuple->t_data, tuple->t_len);
-			memcpy(&item->htup.t_ctid, &tuple->t_self, sizeof(ItemPointerData));
-			HeapTupleHeaderSetXmin(&item->htup, gcache_xmin);
-			HeapTupleHeaderSetXmax(&item->htup, gcache_xmax);
-			HeapTupleHeaderSetCmin(&item->htup, InvalidCommandId);
-			if (!__gpuCacheAppendLog(gc_desc, (GCacheTxLogCommon *)item))
-				elog(WARNING, "unable to write out GpuCache TxLogInsert");
+			elog(WARNING, "unable to write out GpuCache TxLogInsert");
+			pg_atomic_fetch_add_u32(&ps->num_failed, 1);
 		}
-		PG_CATCH();
+	}
+	PG_CATCH();
+	{
+		/* see __gpuCacheAppendLog; it is linked if any pending logs */
+		if (redo_desc->redo.len > 0)
+			dlist_delete(&redo_desc->redo_chain);
+		putGpuCacheLocalMapping(gc_lmap);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	if (redo_desc->redo.len > 0)
+		dlist_delete(&redo_desc->redo_chain);
+	if (redo_desc->redo.data)
+		pfree(redo_desc->redo.data);
+	putGpuCacheLocalMapping(gc_lmap);
+	table_close(rel, AccessShareLock);
+}
+
+/*
+ * __initialLoadGpuCache - entrypoint of the initial loading
+ *
+ * It returns false if GpuCache could not load all the tuples.
+ */
+static bool
+__initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
+{
+	gpuCacheLoadBatch *batch;
+	BlockNumber		nblocks = RelationGetNumberOfBlocks(rel);
+	int				nworkers = 0;
+	bool			status;
+
+	Assert(gc_desc->gc_lmap != NULL);
+	batch = palloc0(sizeof(gpuCacheLoadBatch));
+	batch->gc_desc = gc_desc;
+	batch->redo_desc = gc_desc;
+	batch->gc_lmap = gc_desc->gc_lmap;
+	batch->rel = rel;
+	initStringInfo(&batch->buf);
+
+	if (pgstrom_gpucache_load_parallel_workers > 0 &&
+		!IsParallelWorker() &&
+		!IsInParallelMode() &&
+		IsUnderPostmaster &&
+		ActiveSnapshotSet())
+	{
+		nworkers = Min(nblocks / (GPUCACHE_LOAD_CHUNK_NBLOCKS *
+								  GPUCACHE_LOAD_PARALLEL_MIN_CHUNKS),
+					   pgstrom_gpucache_load_parallel_workers);
+	}
+
+	if (nworkers < 1)
+	{
+		status = (__initialLoadGpuCacheBlocks(batch, 0, nblocks, false, NULL) &&
+				  __initialLoadGpuCacheFlushBatch(batch));
+	}
+	else
+	{
+		ParallelContext *pcxt;
+		gpuCacheLoadParallelState *ps;
+		uint32_t	num_deferred;
+
+		EnterParallelMode();
+		pcxt = CreateParallelContext("pg_strom",
+									 "gpuCacheInitialLoadWorkerMain",
+									 nworkers);
+		shm_toc_estimate_chunk(&pcxt->estimator,
+							   sizeof(gpuCacheLoadParallelState));
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+		InitializeParallelDSM(pcxt);
+
+		ps = shm_toc_allocate(pcxt->toc, sizeof(gpuCacheLoadParallelState));
+		memcpy(&ps->ident, &gc_desc->ident, sizeof(GpuCacheIdent));
+		ps->nblocks = nblocks;
+		pg_atomic_init_u64(&ps->next_block, 0);
+		pg_atomic_init_u32(&ps->num_deferred, 0);
+		pg_atomic_init_u32(&ps->num_failed, 0);
+		shm_toc_insert(pcxt->toc, GPUCACHE_LOAD_PARALLEL_KEY, ps);
+
+		/* launch the workers; the leader also loads the chunks */
+		LaunchParallelWorkers(pcxt);
+		elog(DEBUG2, "gpucache: initial loading of '%s' (%u blocks) by %d parallel workers",
+			 RelationGetRelationName(rel), nblocks, pcxt->nworkers_launched);
+		status = __initialLoadGpuCacheParallelLoop(batch, ps);
+		WaitForParallelWorkersToFinish(pcxt);
+		num_deferred = pg_atomic_read_u32(&ps->num_deferred);
+		if (pg_atomic_read_u32(&ps->num_failed) > 0)
+			status = false;
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+
+		/*
+		 * tuples to be tracked by the current transaction; all the processes
+		 * (including the leader) skipped them in the parallel loading above.
+		 */
+		if (status && num_deferred > 0)
 		{
-			__removeGpuCacheRowId(gc_desc->gc_lmap, &tuple->t_self);
-			PG_RE_THROW();
+			elog(DEBUG2, "gpucache: %u tuples of '%s' are loaded by the leader",
+				 num_deferred, RelationGetRelationName(rel));
+			status = (__initialLoadGpuCacheBlocks(batch, 0, nblocks, true, NULL) &&
+					  __initialLoadGpuCacheFlushBatch(batch));
 		}
-		PG_END_TRY();
 	}
-	table_endscan(hscan);
+	pfree(batch->buf.data);
+	pfree(batch);
+	/* initial loading is not transactional */
+	if (!__gpuCacheFlushLog(gc_desc, false))
+	{
+		elog(WARNING, "unable to write out GpuCache TxLogInsert");
+		status = false;
+	}
+	return status;
 }
 
 static bool
@@ -1993,9 +2852,12 @@ initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 										   &phase,
 										   GCACHE_PHASE__IS_LOADING))
 		{
+			bool		status = true;
+
 			PG_TRY();
 			{
-				__initialLoadGpuCache(gc_desc, rel);
+				if (!__restoreGpuCacheSnapshot(gc_desc, rel))
+					status = __initialLoadGpuCache(gc_desc, rel);
 			}
 			PG_CATCH();
 			{
@@ -2005,6 +2867,14 @@ initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 			}
 			PG_END_TRY();
 
+			if (!status)
+			{
+				elog(WARNING, "gpucache: initial loading of '%s' was not completed",
+					 RelationGetRelationName(rel));
+				pg_atomic_write_u32(&gc_sstate->phase,
+									GCACHE_PHASE__IS_CORRUPTED);
+				return false;
+			}
 			phase = GCACHE_PHASE__IS_LOADING;
 			if (!pg_atomic_compare_exchange_u32(&gc_sstate->phase,
 												&phase,
@@ -2066,7 +2936,9 @@ baseRelHasGpuCache(PlannerInfo *root, RelOptInfo *baserel)
 				phase == GCACHE_PHASE__IS_LOADING ||
 				phase == GCACHE_PHASE__IS_READY)
 			{
-				cuda_dindex = gc_options.cuda_dindex;
+				cuda_dindex = (gc_options.host_resident
+							   ? GPUCACHE_HOST_DINDEX
+							   : gc_options.cuda_dindex);
 			}
 		}
 		table_close(rel, NoLock);
@@ -2097,7 +2969,7 @@ RelationHasGpuCache(Relation rel)
  */
 static void
 __gpuCacheInvokeBackgroundCommand(const GpuCacheIdent *ident,
-								  int cuda_dindex,
+								  int queue_index,
 								  bool is_async,
 								  int command,
 								  uint64 end_pos)
@@ -2105,7 +2977,7 @@ __gpuCacheInvokeBackgroundCommand(const GpuCacheIdent *ident,
 	GpuCacheControlCommand *cmd = NULL;
 	dlist_node	   *dnode;
 
-	Assert(cuda_dindex >= 0 && cuda_dindex < numGpuDevAttrs);
+	Assert(queue_index >= 0 && queue_index <= numGpuDevAttrs);
 	pthreadMutexLock(&gcache_shared_head->gcache_cmd_mutex);
 	while (dlist_is_empty(&gcache_shared_head->gcache_free_cmds))
 	{
@@ -2127,9 +2999,9 @@ __gpuCacheInvokeBackgroundCommand(const GpuCacheIdent *ident,
 	cmd->errcode = -1;
 
 	pthreadMutexLock(&gcache_shared_head->gcache_cmd_mutex);
-	dlist_push_tail(&gcache_shared_head->gpus[cuda_dindex].queue,
+	dlist_push_tail(&gcache_shared_head->gpus[queue_index].queue,
 					&cmd->chain);
-	pthreadCondSignal(&gcache_shared_head->gpus[cuda_dindex].cond);
+	pthreadCondSignal(&gcache_shared_head->gpus[queue_index].cond);
 	pthreadMutexUnlock(&gcache_shared_head->gcache_cmd_mutex);
 
 	if (!is_async)
@@ -2200,7 +3072,7 @@ gpuCacheInvokeApplyRedo(const GpuCacheDesc *gc_desc,
 						bool is_async)
 {
 	__gpuCacheInvokeBackgroundCommand(&gc_desc->ident,
-									  gc_desc->gc_options.cuda_dindex,
+									  gpuCacheCommandQueueIndex(&gc_desc->gc_options),
 									  is_async,
 									  GCACHE_CONTROL_CMD__APPLY_REDO,
 									  sync_pos);
@@ -2213,7 +3085,7 @@ static void
 gpuCacheInvokeCompaction(const GpuCacheDesc *gc_desc, bool is_async)
 {
 	__gpuCacheInvokeBackgroundCommand(&gc_desc->ident,
-									  gc_desc->gc_options.cuda_dindex,
+									  gpuCacheCommandQueueIndex(&gc_desc->gc_options),
 									  is_async,
 									  GCACHE_CONTROL_CMD__COMPACTION,
 									  0);
@@ -2226,7 +3098,7 @@ static void
 gpuCacheInvokeDropUnload(const GpuCacheDesc *gc_desc, bool is_async)
 {
 	__gpuCacheInvokeBackgroundCommand(&gc_desc->ident,
-									  gc_desc->gc_options.cuda_dindex,
+									  gpuCacheCommandQueueIndex(&gc_desc->gc_options),
 									  is_async,
 									  GCACHE_CONTROL_CMD__DROP_UNLOAD,
 									  0);
@@ -2234,82 +3106,201 @@ gpuCacheInvokeDropUnload(const GpuCacheDesc *gc_desc, bool is_async)
 
 /*
  * __gpuCacheAppendLog
+ *
+ * REDO logs are buffered per GpuCacheDesc, then written to the shared REDO
+ * log buffer at once on the end of statement / transaction, or when local
+ * buffer gets filled up.
  */
+#define GPUCACHE_LOCAL_REDO_BUFSZ		(1UL << 20)		/* 1MB */
+
 static bool
 __gpuCacheAppendLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
 {
 	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
-	char	   *redo_buffer = gpuCacheRedoLogBuffer(gc_sstate);
-	size_t		buffer_sz = gc_sstate->gc_options.redo_buffer_size;
-	bool		append_done = false;
+	bool		in_commit = !IsTransactionState();
+	size_t		local_bufsz;
 
 	Assert(tx_log->length == MAXALIGN(tx_log->length));
-	while (!append_done)
-	{
-		size_t		usage;
-		uint32_t	phase;
-		uint64_t	sync_pos;
+	/*
+	 * Once GPU buffer is marked to 'corrupted', any following REDO-logs
+	 * make no sense, until pgstrom.gpucache_recovery() is called.
+	 */
+	if (pg_atomic_read_u32(&gc_sstate->phase) == GCACHE_PHASE__IS_CORRUPTED)
+		return false;
 
+	if (gc_desc->redo.len == 0)
+	{
 		/*
-		 * Once GPU buffer is marked to 'corrupted', any following REDO-logs
-		 * make no sense, until pgstrom.gpucache_recovery() is called.
+		 * REDO logs buffered by other descriptors (sub-transactions) on
+		 * the same GpuCache must be written out first, to keep the order
+		 * of the logs.
 		 */
-		phase = pg_atomic_read_u32(&gc_sstate->phase);
-		if (phase == GCACHE_PHASE__IS_CORRUPTED)
-			return false;
-		Assert(phase == GCACHE_PHASE__IS_LOADING ||
-			   phase == GCACHE_PHASE__IS_READY);
+		__gpuCacheFlushPendingLogs(&gc_desc->ident, in_commit);
+		if (!gc_desc->redo.data)
+			initStringInfoCxt(CacheMemoryContext, &gc_desc->redo);
+		dlist_push_tail(&gcache_pending_redo_list, &gc_desc->redo_chain);
+	}
+	appendBinaryStringInfo(&gc_desc->redo, (char *)tx_log, tx_log->length);
+	gc_desc->redo_nitems++;
+
+	local_bufsz = Min(GPUCACHE_LOCAL_REDO_BUFSZ,
+					  gc_sstate->gc_options.redo_buffer_size / 4);
+	if (gc_desc->redo.len >= local_bufsz)
+		return __gpuCacheFlushLog(gc_desc, in_commit);
+	return true;
+}
 
-		pthreadMutexLock(&gc_sstate->redo_mutex);
-		Assert(gc_sstate->redo_write_pos >= gc_sstate->redo_read_pos &&
-			   gc_sstate->redo_write_pos <= gc_sstate->redo_read_pos + buffer_sz &&
-			   gc_sstate->redo_sync_pos <= gc_sstate->redo_write_pos);
-		usage = gc_sstate->redo_write_pos - gc_sstate->redo_read_pos;
+/*
+ * __gpuCacheFlushLog
+ *
+ * It writes out the locally buffered REDO logs to the shared buffer.
+ * A range of the buffer is reserved by CAS on redo_write_pos, then
+ * redo_publish_pos is advanced in order of the reservation; GpuService
+ * never reads the logs beyond the redo_publish_pos.
+ * If 'in_commit' is true, we cannot raise an error (including query
+ * cancel), so interrupts are not checked during the wait.
+ */
+static bool
+__gpuCacheFlushLog(GpuCacheDesc *gc_desc, bool in_commit)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	char	   *redo_buffer = gpuCacheRedoLogBuffer(gc_sstate);
+	size_t		buffer_sz = gc_sstate->gc_options.redo_buffer_size;
+	size_t		length = gc_desc->redo.len;
+	const char *pos = gc_desc->redo.data;
+	size_t		remain;
+	uint64_t	head_pos;
+	uint64_t	tail_pos;
+	uint64_t	sync_pos = ULONG_MAX;
+
+	if (length == 0)
+		return true;
+	if (length > buffer_sz)
+	{
+		/* should not happen, because local_bufsz <= buffer_sz / 4 */
+		elog(WARNING, "GpuCache: local REDO logs (%zu) exceeds the buffer size (%zu)",
+			 length, buffer_sz);
+		goto corrupted;
+	}
 
-		/* buffer has enough space? */
-		if (usage + tx_log->length <= buffer_sz)
-		{
-			const char *pos = (const char *)tx_log;
-			size_t		remain = tx_log->length;
-			size_t		offset;
-			size_t		nbytes;
+	/* reserve the range of the shared buffer */
+	head_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+	for (;;)
+	{
+		uint64_t	read_pos;
 
-			while (remain > 0)
-			{
-				offset = gc_sstate->redo_write_pos % buffer_sz;
-				if (offset + remain > buffer_sz)
-					nbytes = buffer_sz - offset;
-				else
-					nbytes = remain;
-				memcpy(redo_buffer + offset, pos, nbytes);
-				gc_sstate->redo_write_pos += nbytes;
-				pos += nbytes;
-				remain -= nbytes;
-			}
-			gc_sstate->redo_write_nitems++;
-			gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
-			append_done = true;
+		if (pg_atomic_read_u32(&gc_sstate->phase) == GCACHE_PHASE__IS_CORRUPTED)
+			goto corrupted;
+
+		read_pos = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
+		Assert(head_pos >= read_pos && head_pos <= read_pos + buffer_sz);
+		if (head_pos + length <= read_pos + buffer_sz)
+		{
+			if (pg_atomic_compare_exchange_u64(&gc_sstate->redo_write_pos,
+											   &head_pos,
+											   head_pos + length))
+				break;
+			continue;	/* head_pos is updated by CAS */
 		}
 		/*
-		 * check whether the REDO log buffer usage exceeds the threshold of
-		 * the synchronization.
+		 * Not enough space on the shared buffer, so kick GpuService to
+		 * apply the published logs and wait for the read_pos advanced.
 		 */
-		if (gc_sstate->redo_write_pos >= (gc_sstate->redo_sync_pos +
-										  gc_sstate->gc_options.gpu_sync_threshold))
-		{
-			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
-			pthreadMutexUnlock(&gc_sstate->redo_mutex);
-			gpuCacheInvokeApplyRedo(gc_desc, sync_pos, append_done);
-		}
-		else
+		sync_pos = ULONG_MAX;
+		pthreadMutexLock(&gc_sstate->redo_mutex);
+		if (gc_sstate->redo_sync_pos < gc_sstate->redo_publish_pos)
+			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_publish_pos;
+		pthreadMutexUnlock(&gc_sstate->redo_mutex);
+		if (sync_pos != ULONG_MAX)
+			gpuCacheInvokeApplyRedo(gc_desc, sync_pos, true);
+
+		pthreadMutexLock(&gc_sstate->redo_mutex);
+		if (pg_atomic_read_u64(&gc_sstate->redo_read_pos) == read_pos)
+			pthreadCondWaitTimeout(&gc_sstate->redo_cond,
+								   &gc_sstate->redo_mutex, 100);
+		pthreadMutexUnlock(&gc_sstate->redo_mutex);
+		if (!in_commit)
+			CHECK_FOR_INTERRUPTS();
+		head_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+	}
+	tail_pos = head_pos + length;
+
+	/*
+	 * copy the REDO logs to the reserved range
+	 * (no error is allowed until redo_publish_pos is advanced)
+	 */
+	remain = length;
+	while (remain > 0)
+	{
+		size_t	offset = (tail_pos - remain) % buffer_sz;
+		size_t	nbytes = Min(remain, buffer_sz - offset);
+
+		memcpy(redo_buffer + offset, pos, nbytes);
+		pos += nbytes;
+		remain -= nbytes;
+	}
+
+	/* publish the logs in order of the reservation */
+	sync_pos = ULONG_MAX;
+	pthreadMutexLock(&gc_sstate->redo_mutex);
+	while (gc_sstate->redo_publish_pos != head_pos)
+	{
+		Assert(gc_sstate->redo_publish_pos < head_pos);
+		pthreadCondWaitTimeout(&gc_sstate->redo_cond,
+							   &gc_sstate->redo_mutex, 100);
+	}
+	gc_sstate->redo_publish_pos = tail_pos;
+	gc_sstate->redo_write_nitems += gc_desc->redo_nitems;
+	gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
+	/*
+	 * check whether the REDO log buffer usage exceeds the threshold of
+	 * the synchronization.
+	 */
+	Assert(gc_sstate->redo_sync_pos <= gc_sstate->redo_publish_pos);
+	if (gc_sstate->redo_publish_pos >= (gc_sstate->redo_sync_pos +
+										gc_sstate->gc_options.gpu_sync_threshold))
+		sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_publish_pos;
+	pthreadCondBroadcast(&gc_sstate->redo_cond);
+	pthreadMutexUnlock(&gc_sstate->redo_mutex);
+
+	if (sync_pos != ULONG_MAX)
+		gpuCacheInvokeApplyRedo(gc_desc, sync_pos, true);
+
+	resetStringInfo(&gc_desc->redo);
+	gc_desc->redo_nitems = 0;
+	dlist_delete(&gc_desc->redo_chain);
+	return true;
+
+corrupted:
+	/* REDO logs make no sense on the corrupted GpuCache */
+	resetStringInfo(&gc_desc->redo);
+	gc_desc->redo_nitems = 0;
+	dlist_delete(&gc_desc->redo_chain);
+	return false;
+}
+
+/*
+ * __gpuCacheFlushPendingLogs
+ *
+ * It writes out the locally buffered REDO logs on the GpuCache specified
+ * by the 'ident', or all the GpuCache if NULL.
+ */
+static void
+__gpuCacheFlushPendingLogs(const GpuCacheIdent *ident, bool in_commit)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &gcache_pending_redo_list)
+	{
+		GpuCacheDesc   *gc_desc = dlist_container(GpuCacheDesc, redo_chain,
+												  iter.cur);
+		if (!ident || GpuCacheIdentEqual(&gc_desc->ident, ident))
 		{
-			pthreadMutexUnlock(&gc_sstate->redo_mutex);
+			if (!__gpuCacheFlushLog(gc_desc, in_commit))
+				elog(in_commit ? WARNING : NOTICE,
+					 "GpuCache is corrupted, so pending REDO logs are discarded");
 		}
-
-		if (!append_done)
-			pg_usleep(2000L);	/* 2ms */
 	}
-	return append_done;
 }
 
 /*
@@ -2507,8 +3498,9 @@ pgstrom_gpucache_apply_redo(PG_FUNCTION_ARGS)
 		GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
 		uint64_t	sync_pos;
 
+		__gpuCacheFlushPendingLogs(&gc_desc->ident, false);
 		pthreadMutexLock(&gc_sstate->redo_mutex);
-		sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
+		sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_publish_pos;
 		pthreadMutexUnlock(&gc_sstate->redo_mutex);
 
 		gpuCacheInvokeApplyRedo(gc_desc, sync_pos, false);
@@ -2592,52 +3584,326 @@ pgstrom_gpucache_recovery(PG_FUNCTION_ARGS)
  *
  * ------------------------------------------------------------
  */
-GpuCacheDesc *
-pgstromGpuCacheExecInit(pgstromTaskState *pts)
+static bool
+__gpuCacheExecCheckRelation(Relation rel, GpuCacheOptions *gc_options)
 {
-	Relation	rel = pts->css.ss.ss_currentRelation;
 	uint64_t	signature;
-	GpuCacheOptions gc_options;
 
 	if (!rel)
-		return NULL;
+		return false;
 	/* GpuCache is not workable on hot-standby server */
 	if (RecoveryInProgress())
 	{
 		elog(DEBUG2, "gpucache: not valid in hot-standby slave server");
-		return NULL;
+		return false;
 	}
 	/* only READ COMMITTED transaction can use GpuCache */
 	if (XactIsoLevel > XACT_READ_COMMITTED)
 	{
 		elog(DEBUG2, "gpucache: not valid in serializable/repeatable-read transaction");
-		return NULL;
+		return false;
 	}
 	/* check pg_strom.enable_gpucache */
 	if (!pgstrom_enable_gpucache)
-		return NULL;
+		return false;
 	/* table must be configured for GpuCache */
-	signature = gpuCacheTableSignature(rel, &gc_options);
+	signature = gpuCacheTableSignature(rel, gc_options);
 	if (signature == 0UL)
 	{
 		elog(DEBUG2, "gpucache: table '%s' is not configured - check row/statement triggers with pgstrom.gpucache_sync_trigger()",
 			 RelationGetRelationName(rel));
-		return NULL;
+		return false;
 	}
-	return lookupGpuCacheDesc(rel);
+	return true;
 }
 
-XpuCommand *
-pgstromScanChunkGpuCache(pgstromTaskState *pts,
-						 struct iovec *xcmd_iov,
-						 int *xcmd_iovcnt)
+static GpuCacheDesc *
+__gpuCacheExecLookupDesc(Relation rel)
 {
-	Relation	rel = pts->css.ss.ss_currentRelation;
-	GpuCacheDesc *gc_desc = pts->gcache_desc;
+	GpuCacheDesc *gc_desc = lookupGpuCacheDesc(rel);
+
+	/* makes own modification visible to the scan */
+	if (gc_desc)
+		__gpuCacheFlushPendingLogs(&gc_desc->ident, false);
+	return gc_desc;
+}
+
+GpuCacheDesc *
+pgstromGpuCacheExecInit(pgstromTaskState *pts)
+{
+	Relation	rel = pts->css.ss.ss_currentRelation;
+	GpuCacheOptions gc_options;
+
+	if (!__gpuCacheExecCheckRelation(rel, &gc_options))
+		return NULL;
+	/*
+	 * host-resident GpuCache is scanned by CPU, then the rows are processed
+	 * by the CPU-fallback routines; they don't support PreAgg and RIGHT/FULL
+	 * OUTER JOIN.
+	 */
+	if (gc_options.host_resident)
+	{
+		pgstromPlanInfo *pp_info = pts->pp_info;
+
+		if ((pts->xpu_task_flags & DEVTASK__PREAGG) != 0)
+		{
+			elog(DEBUG2, "gpucache: host-resident GpuCache is not valid for PreAgg");
+			return NULL;
+		}
+		for (int i=0; i < pp_info->num_rels; i++)
+		{
+			if (pp_info->inners[i].join_type == JOIN_RIGHT ||
+				pp_info->inners[i].join_type == JOIN_FULL)
+			{
+				elog(DEBUG2, "gpucache: host-resident GpuCache is not valid for RIGHT/FULL OUTER JOIN");
+				return NULL;
+			}
+		}
+	}
+	return __gpuCacheExecLookupDesc(rel);
+}
+
+/*
+ * __gpuCacheHostCheckVisibility
+ */
+static bool
+__gpuCacheHostCheckVisibility(const GpuCacheSysattr *sysattr)
+{
+	if (sysattr->xmin == InvalidTransactionId)
+		return false;
+	if (sysattr->xmin != FrozenTransactionId &&
+		!TransactionIdIsCurrentTransactionId(sysattr->xmin))
+		return false;	/* not committed yet */
+	if (sysattr->xmax == InvalidTransactionId)
+		return true;
+	if (sysattr->xmax == FrozenTransactionId)
+		return false;	/* already deleted */
+	return !TransactionIdIsCurrentTransactionId(sysattr->xmax);
+}
+
+/*
+ * GpuCacheHostScanDesc
+ *
+ * Host-resident GpuCache is scanned by CPU per GPUCACHE_HOST_SCAN_NROWS
+ * rows chunk. Chunks are distributed using the shared fetch counter, so it
+ * also works on the parallel scan. host_rwlock is held only during the scan
+ * on a chunk, not to block the Host Applier for a long time.
+ */
+#define GPUCACHE_HOST_SCAN_NROWS		65536
+
+struct GpuCacheHostScanDesc
+{
+	GpuCacheDesc   *gc_desc;
+	Relation		rel;
+	bool			redo_synced;	/* pending REDO logs are applied */
+	Datum		   *values;
+	bool		   *isnull;
+	MemoryContext	tuple_cxt;
+};
+
+/* host_rwlock being held by the host scan, if any */
+static GpuCacheSharedState *gcache_host_scan_locked = NULL;
+static bool		gcache_host_scan_on_exit = false;
+
+static void
+__gpuCacheHostScanOnExit(int code, Datum arg)
+{
+	/* host_rwlock is not released if FATAL during the scan */
+	if (gcache_host_scan_locked)
+	{
+		pthreadRWLockUnlock(&gcache_host_scan_locked->host_rwlock);
+		gcache_host_scan_locked = NULL;
+	}
+}
+
+static GpuCacheHostScanDesc *
+__gpuCacheHostScanBegin(GpuCacheDesc *gc_desc, Relation rel)
+{
+	GpuCacheHostScanDesc *hscan = palloc0(sizeof(GpuCacheHostScanDesc));
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+
+	hscan->gc_desc = gc_desc;
+	hscan->rel = rel;
+	hscan->values = palloc(sizeof(Datum) * tupdesc->natts);
+	hscan->isnull = palloc(sizeof(bool) * tupdesc->natts);
+	hscan->tuple_cxt = AllocSetContextCreate(CurrentMemoryContext,
+											 "GpuCache host scan",
+											 ALLOCSET_DEFAULT_SIZES);
+	if (!gcache_host_scan_on_exit)
+	{
+		before_shmem_exit(__gpuCacheHostScanOnExit, 0);
+		gcache_host_scan_on_exit = true;
+	}
+	return hscan;
+}
+
+static void
+__gpuCacheHostScanEnd(GpuCacheHostScanDesc *hscan)
+{
+	MemoryContextDelete(hscan->tuple_cxt);
+	pfree(hscan->values);
+	pfree(hscan->isnull);
+	pfree(hscan);
+}
+
+/*
+ * __gpuCacheHostScanChunk
+ *
+ * It scans the next chunk, and calls the 'callback' for each visible row.
+ * It returns false if no more chunks to be scanned.
+ */
+static bool
+__gpuCacheHostScanChunk(GpuCacheHostScanDesc *hscan,
+						pg_atomic_uint32 *fetch_count,
+						void (*callback)(void *arg, HeapTuple tuple),
+						void *callback_arg)
+{
+	GpuCacheDesc *gc_desc = hscan->gc_desc;
+	GpuCacheSharedState *gc_sstate;
+	Relation	rel = hscan->rel;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	Datum	   *values = hscan->values;
+	bool	   *isnull = hscan->isnull;
+	bool		has_chunk = false;
+
+	if (!initialLoadGpuCache(gc_desc, rel))
+		elog(ERROR, "GpuCache is now corrupted, try the query again");
+	gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	/* apply the pending REDO logs prior to the scan */
+	if (!hscan->redo_synced)
+	{
+		uint64_t	publish_pos;
+
+		pthreadMutexLock(&gc_sstate->redo_mutex);
+		publish_pos = gc_sstate->redo_publish_pos;
+		if (gc_sstate->redo_sync_pos < publish_pos)
+			gc_sstate->redo_sync_pos = publish_pos;
+		pthreadMutexUnlock(&gc_sstate->redo_mutex);
+		if (pg_atomic_read_u64(&gc_sstate->redo_read_pos) < publish_pos)
+			gpuCacheInvokeApplyRedo(gc_desc, publish_pos, false);
+		hscan->redo_synced = true;
+	}
+	if (pg_atomic_read_u32(&gc_sstate->phase) == GCACHE_PHASE__IS_CORRUPTED)
+		elog(ERROR, "GpuCache is now corrupted, try the query again");
+
+	CHECK_FOR_INTERRUPTS();
+	Assert(!gcache_host_scan_locked);
+	pthreadRWLockReadLock(&gc_sstate->host_rwlock);
+	gcache_host_scan_locked = gc_sstate;
+	PG_TRY();
+	{
+		kern_data_store *kds = gpuCacheHostMainBuffer(gc_sstate);
+		kern_data_extra *extra = gpuCacheHostExtraBuffer(gc_sstate,
+														 gc_sstate->host_extra_curr);
+		uint64_t	rowid, end;
+
+		rowid = (uint64_t)pg_atomic_fetch_add_u32(fetch_count, 1)
+			* GPUCACHE_HOST_SCAN_NROWS;
+		if (rowid < kds->nitems)
+		{
+			end = Min(rowid + GPUCACHE_HOST_SCAN_NROWS, kds->nitems);
+			while (rowid < end)
+			{
+				GpuCacheSysattr *sysattr = gpuCacheHostGetSysattr(kds, rowid);
+				MemoryContext oldcxt;
+				HeapTuple	tuple;
+
+				if (__gpuCacheHostCheckVisibility(sysattr))
+				{
+					oldcxt = MemoryContextSwitchTo(hscan->tuple_cxt);
+					for (int j=0; j < tupdesc->natts; j++)
+					{
+						Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+						kern_colmeta *cmeta = &kds->colmeta[j];
+						char	   *base;
+
+						if (attr->attisdropped ||
+							KDS_COLUMN_ITEM_ISNULL(kds, cmeta, rowid))
+						{
+							values[j] = 0;
+							isnull[j] = true;
+							continue;
+						}
+						base = (char *)kds + __kds_unpack(cmeta->values_offset);
+						if (cmeta->attlen > 0)
+						{
+							values[j] = fetch_att(base + cmeta->attlen * rowid,
+												  attr->attbyval,
+												  attr->attlen);
+						}
+						else
+						{
+							uint32_t	vl_off = ((uint32_t *)base)[rowid];
+
+							Assert(extra != NULL);
+							values[j] = PointerGetDatum((char *)extra +
+														__kds_unpack(vl_off));
+						}
+						isnull[j] = false;
+					}
+					tuple = heap_form_tuple(tupdesc, values, isnull);
+					ItemPointerCopy(&sysattr->ctid, &tuple->t_self);
+					tuple->t_tableOid = RelationGetRelid(rel);
+					callback(callback_arg, tuple);
+					MemoryContextSwitchTo(oldcxt);
+					MemoryContextReset(hscan->tuple_cxt);
+				}
+				rowid++;
+			}
+			has_chunk = true;
+		}
+	}
+	PG_FINALLY();
+	{
+		gcache_host_scan_locked = NULL;
+		pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+	}
+	PG_END_TRY();
+
+	return has_chunk;
+}
+
+static void
+__pgstromGpuCacheHostFallback(void *arg, HeapTuple tuple)
+{
+	pgstromTaskState *pts = arg;
+
+	pts->cb_cpu_fallback(pts, tuple);
+}
+
+/*
+ * __pgstromScanChunkGpuCacheHost
+ *
+ * It processes one chunk by the CPU-fallback routine for each call, then
+ * returns NULL without scan_done, to consume the fallback tuples.
+ */
+static XpuCommand *
+__pgstromScanChunkGpuCacheHost(pgstromTaskState *pts, GpuCacheDesc *gc_desc)
+{
+	Relation	rel = pts->css.ss.ss_currentRelation;
+
+	if (!pts->gcache_hscan)
+		pts->gcache_hscan = __gpuCacheHostScanBegin(gc_desc, rel);
+	if (!__gpuCacheHostScanChunk(pts->gcache_hscan,
+								 pts->gcache_fetch_count,
+								 __pgstromGpuCacheHostFallback, pts))
+		pts->scan_done = true;
+	return NULL;
+}
+
+XpuCommand *
+pgstromScanChunkGpuCache(pgstromTaskState *pts,
+						 struct iovec *xcmd_iov,
+						 int *xcmd_iovcnt)
+{
+	Relation	rel = pts->css.ss.ss_currentRelation;
+	GpuCacheDesc *gc_desc = pts->gcache_desc;
 	XpuCommand *xcmd = NULL;
 
 	if (!gc_desc)
 		elog(ERROR, "Bug? no GpuCacheDesc is assigned");
+	if (gc_desc->gc_options.host_resident)
+		return __pgstromScanChunkGpuCacheHost(pts, gc_desc);
 	if (!initialLoadGpuCache(gc_desc, rel))
 		elog(ERROR, "GpuCache is now corrupted, try the query again");
 	if (pg_atomic_fetch_add_u32(pts->gcache_fetch_count, 1) == 0)
@@ -2647,9 +3913,9 @@ pgstromScanChunkGpuCache(pgstromTaskState *pts,
 		uint64_t	sync_pos = ULONG_MAX;
 
 		pthreadMutexLock(&gc_sstate->redo_mutex);
-		write_pos = gc_sstate->redo_write_pos;
-		if (gc_sstate->redo_sync_pos < gc_sstate->redo_write_pos)
-			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
+		write_pos = gc_sstate->redo_publish_pos;
+		if (gc_sstate->redo_sync_pos < gc_sstate->redo_publish_pos)
+			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_publish_pos;
 		pthreadMutexUnlock(&gc_sstate->redo_mutex);
 
 		/* is the target table empty? */
@@ -2686,13 +3952,18 @@ pgstromScanChunkGpuCache(pgstromTaskState *pts,
 void
 pgstromGpuCacheExecEnd(pgstromTaskState *pts)
 {
-	/* nothing to do */
+	if (pts->gcache_hscan)
+		__gpuCacheHostScanEnd(pts->gcache_hscan);
+	pts->gcache_hscan = NULL;
 }
 
 void
 pgstromGpuCacheExecReset(pgstromTaskState *pts)
 {
-	pg_atomic_write_u32(pts->gcache_fetch_count, 0);
+	if (pts->gcache_fetch_count)
+		pg_atomic_write_u32(pts->gcache_fetch_count, 0);
+	if (pts->gcache_hscan)
+		pts->gcache_hscan->redo_synced = false;
 }
 
 void
@@ -2723,21 +3994,26 @@ pgstromGpuCacheExplain(pgstromTaskState *pts,
 					   ExplainState *es,
 					   List *dcontext)
 {
-	GpuCacheDesc *gc_desc = pts->gcache_desc;
+	if (pts->gcache_desc)
+		__gpuCacheExplainDesc(pts->gcache_desc, es);
+}
+
+static void
+__gpuCacheExplainDesc(GpuCacheDesc *gc_desc, ExplainState *es)
+{
 	GpuCacheLocalMapping *gc_lmap;
 	GpuCacheSharedState *gc_sstate;
 	GpuCacheOptions *gc_options;
 	char		temp[2048];
 
-	if (!gc_desc)
-		return;
 	gc_lmap = gc_desc->gc_lmap;
 	gc_sstate = gc_lmap->gc_sstate;
 	gc_options = &gc_desc->gc_options;
 
 	/* config options */
-	if (gc_options->cuda_dindex >= 0 &&
-		gc_options->cuda_dindex < numGpuDevAttrs)
+	if (gc_options->host_resident ||
+		(gc_options->cuda_dindex >= 0 &&
+		 gc_options->cuda_dindex < numGpuDevAttrs))
 	{
 		size_t	gpu_main_size;
 		size_t	gpu_extra_size;
@@ -2772,12 +4048,21 @@ pgstromGpuCacheExplain(pgstromTaskState *pts,
 
 			snprintf(temp, sizeof(temp),
 					 "%s [phase: %s, max_num_rows: %ld, main: %s, extra: %s]",
-					 gpuDevAttrs[gc_options->cuda_dindex].DEV_NAME,
+					 gc_options->host_resident
+					 ? "Host"
+					 : gpuDevAttrs[gc_options->cuda_dindex].DEV_NAME,
 					 phase,
 					 gc_options->max_num_rows,
 					 format_numeric(gpu_main_size),
 					 format_numeric(gpu_extra_size));
 		}
+		else if (gc_options->host_resident)
+		{
+			snprintf(temp, sizeof(temp),
+					 "Host [phase: %s, max_num_rows: %ld]",
+					 phase,
+					 gc_options->max_num_rows);
+		}
 		else
 		{
 			snprintf(temp, sizeof(temp),
@@ -2806,142 +4091,611 @@ pgstromGpuCacheExplain(pgstromTaskState *pts,
 				 "max_num_rows=%ld,"
 				 "redo_buffer_size=%zu,"
 				 "gpu_sync_interval=%d,"
-				 "gpu_sync_threshold=%zu",
+				 "gpu_sync_threshold=%zu,"
+				 "host_resident=%s",
 				 gpu_device_id,
 				 gc_options->max_num_rows,
 				 gc_options->redo_buffer_size,
 				 gc_options->gpu_sync_interval,
-				 gc_options->gpu_sync_threshold);
+				 gc_options->gpu_sync_threshold,
+				 gc_options->host_resident ? "on" : "off");
 		ExplainPropertyText("GPU Cache Options", temp, es);
 	}
 }
 
 /* ------------------------------------------------------------
  *
- * Routines to support DDL callbacks
+ * GpuCacheHostScan
+ *
+ * GpuScan/DpuScan scans the host-resident GpuCache using CPU, but they are
+ * not available if no GPU/DPU devices are installed. GpuCacheHostScan is
+ * a simple CustomScan that scans the host-resident GpuCache instead of
+ * the heap in this case.
  *
  * ------------------------------------------------------------
  */
+typedef struct
+{
+	pg_atomic_uint32 fetch_count;	/* shared fetch counter of the chunks */
+	bool		use_gcache;			/* false, if heap scan */
+	/* followed by ParallelTableScanDesc for heap scan */
+} GpuCacheHostScanShared;
+
+#define GpuCacheHostScanSharedPScan(__shared)					\
+	((ParallelTableScanDesc)((char *)(__shared) +				\
+							 MAXALIGN(sizeof(GpuCacheHostScanShared))))
+
+typedef struct
+{
+	CustomScanState	css;
+	GpuCacheDesc   *gc_desc;		/* NULL, if heap scan */
+	GpuCacheHostScanDesc *hscan;
+	GpuCacheHostScanShared *shared;	/* only if parallel scan */
+	pg_atomic_uint32 *fetch_count;
+	pg_atomic_uint32 __fetch_count_data;
+	TupleTableSlot *heap_slot;		/* for heap scan */
+	/* visible rows in the current chunk */
+	MemoryContext	chunk_cxt;
+	HeapTuple	   *chunk_tuples;
+	uint32_t		chunk_nitems;
+	uint32_t		chunk_index;
+	bool			scan_done;
+} GpuCacheHostScanState;
 
 /*
- * gpuCacheObjectAccess
- *
- * This callback marks drop_on_commit / drop_on_rollback for the pending
- * GpuCache entries on DDL commands.
+ * buildGpuCacheHostScanPath
+ */
+static CustomPath *
+buildGpuCacheHostScanPath(PlannerInfo *root,
+						  RelOptInfo *baserel,
+						  bool parallel_path)
+{
+	CustomPath	   *cpath;
+	ParamPathInfo  *param_info;
+	List		   *quals = baserel->baserestrictinfo;
+	QualCost		qcost;
+	int				parallel_nworkers = 0;
+	double			parallel_divisor = 1.0;
+	double			nrows;
+	Cost			startup_cost;
+	Cost			run_cost;
+
+	param_info = get_baserel_parampathinfo(root, baserel,
+										   baserel->lateral_relids);
+	if (param_info)
+		quals = list_concat_copy(quals, param_info->ppi_clauses);
+	nrows = (param_info ? param_info->ppi_rows : baserel->rows);
+	if (parallel_path)
+	{
+		double	leader_contribution;
+
+		if (!baserel->consider_parallel ||
+			!bms_is_empty(baserel->lateral_relids))
+			return NULL;
+		parallel_nworkers = compute_parallel_worker(baserel,
+													baserel->pages, -1,
+													max_parallel_workers_per_gather);
+		if (parallel_nworkers <= 0)
+			return NULL;
+		parallel_divisor = (double)parallel_nworkers;
+		if (parallel_leader_participation)
+		{
+			leader_contribution = 1.0 - (0.3 * (double)parallel_nworkers);
+			if (leader_contribution > 0.0)
+				parallel_divisor += leader_contribution;
+		}
+		nrows = clamp_row_est(nrows / parallel_divisor);
+	}
+	/* no disk i/o, because the columnar cache is on the host memory */
+	cost_qual_eval(&qcost, quals, root);
+	startup_cost = qcost.startup + baserel->reltarget->cost.startup;
+	run_cost = ((cpu_tuple_cost + qcost.per_tuple) * baserel->tuples / parallel_divisor +
+				baserel->reltarget->cost.per_tuple * nrows);
+
+	cpath = makeNode(CustomPath);
+	cpath->path.pathtype = T_CustomScan;
+	cpath->path.parent = baserel;
+	cpath->path.pathtarget = baserel->reltarget;
+	cpath->path.param_info = param_info;
+	cpath->path.parallel_aware = (parallel_nworkers > 0);
+	cpath->path.parallel_safe = baserel->consider_parallel;
+	cpath->path.parallel_workers = parallel_nworkers;
+	cpath->path.rows = nrows;
+	cpath->path.startup_cost = startup_cost;
+	cpath->path.total_cost = startup_cost + run_cost;
+	cpath->path.pathkeys = NIL;	/* unsorted results */
+	cpath->flags = CUSTOMPATH_SUPPORT_PROJECTION;
+	cpath->custom_paths = NIL;
+	cpath->custom_private = NIL;
+	cpath->methods = &gcache_hscan_path_methods;
+	return cpath;
+}
+
+/*
+ * GpuCacheHostScanAddScanPath
  */
 static void
-__gpuCacheCallbackOnAlterTable(Oid table_oid)
+GpuCacheHostScanAddScanPath(PlannerInfo *root,
+							RelOptInfo *baserel,
+							Index rtindex,
+							RangeTblEntry *rte)
 {
-	Datum		signature_old;
-	Datum		signature_new;
-	GpuCacheOptions options_old;
-	GpuCacheOptions options_new;
-	GpuCacheDesc *gc_desc;
+	/* call the secondary hook */
+	if (set_rel_pathlist_next)
+		set_rel_pathlist_next(root, baserel, rtindex, rte);
 
-	signature_old = gpuCacheTableSignatureSnapshot(table_oid, NULL,
-												   &options_old);
-	signature_new = gpuCacheTableSignatureSnapshot(table_oid, SnapshotSelf,
-												   &options_new);
-#ifdef GPUCACHE_DEBUG_MESSAGE
-	elog(LOG, "__gpuCacheCallbackOnAlterTable(table_oid=%u): signature %lx -> %lx",
-		 table_oid, signature_old, signature_new);
-#endif
-	if (signature_old != 0UL &&
-		signature_old != signature_new)
+	if (!pgstrom_enabled())
+		return;
+	/* We already proved the relation empty, so nothing more to do */
+	if (is_dummy_rel(baserel))
+		return;
+	/* It is the role of built-in Append node */
+	if (rte->inh)
+		return;
+	if (rte->rtekind != RTE_RELATION ||
+		rte->relkind != RELKIND_RELATION ||
+		baseRelHasGpuCache(root, baserel) != GPUCACHE_HOST_DINDEX)
+		return;
+	for (int try_parallel=0; try_parallel < 2; try_parallel++)
 	{
-		gc_desc = lookupGpuCacheDescNoLoad(table_oid,
-										   signature_old,
-										   InvalidTransactionId,
-										   &options_old);
-		if (gc_desc)
-			gc_desc->drop_on_commit = true;
+		CustomPath *cpath = buildGpuCacheHostScanPath(root, baserel,
+													  (try_parallel > 0));
+		if (cpath)
+		{
+			if (try_parallel == 0)
+				add_path(baserel, &cpath->path);
+			else
+				add_partial_path(baserel, &cpath->path);
+		}
 	}
+}
 
-	if (signature_new != 0UL &&
-		signature_new != signature_old)
-	{
-		gc_desc = lookupGpuCacheDescNoLoad(table_oid,
-										   signature_new,
-										   InvalidTransactionId,
-										   &options_new);
-		if (gc_desc)
-			gc_desc->drop_on_rollback = true;
-	}
+/*
+ * PlanGpuCacheHostScanPath
+ */
+static Plan *
+PlanGpuCacheHostScanPath(PlannerInfo *root,
+						 RelOptInfo *baserel,
+						 CustomPath *best_path,
+						 List *tlist,
+						 List *clauses,
+						 List *custom_children)
+{
+	CustomScan *cscan = makeNode(CustomScan);
+
+	/* sanity checks */
+	Assert(baserel->relid > 0 &&
+		   baserel->rtekind == RTE_RELATION &&
+		   custom_children == NIL);
+	cscan->scan.plan.targetlist = tlist;
+	cscan->scan.plan.qual = extract_actual_clauses(clauses, false);
+	cscan->scan.scanrelid = baserel->relid;
+	cscan->flags = best_path->flags;
+	cscan->methods = &gcache_hscan_plan_methods;
+	cscan->custom_plans = NIL;
+	cscan->custom_scan_tlist = NIL;
+
+	return &cscan->scan.plan;
 }
 
 /*
- * gpuCacheObjectAccess, and related...
+ * CreateGpuCacheHostScanState
  */
-static void
-__gpuCacheCallbackOnAlterTrigger(Oid trigger_oid)
+static Node *
+CreateGpuCacheHostScanState(CustomScan *cscan)
 {
-	Relation	srel;
-	ScanKeyData	skey;
-	SysScanDesc	sscan;
-	HeapTuple	tuple;
+	GpuCacheHostScanState *ghss = palloc0(sizeof(GpuCacheHostScanState));
 
-	srel = table_open(TriggerRelationId, AccessShareLock);
-	ScanKeyInit(&skey,
-				Anum_pg_trigger_oid,
-				BTEqualStrategyNumber, F_OIDEQ,
-				ObjectIdGetDatum(trigger_oid));
-	sscan = systable_beginscan(srel, TriggerOidIndexId, true,
-							   SnapshotSelf, 1, &skey);
-	while ((tuple = systable_getnext(sscan)) != NULL)
-	{
-		Oid		table_oid = ((Form_pg_trigger)GETSTRUCT(tuple))->tgrelid;
+	Assert(cscan->methods == &gcache_hscan_plan_methods);
+	NodeSetTag(ghss, T_CustomScanState);
+	ghss->css.flags = cscan->flags;
+	ghss->css.methods = &gcache_hscan_exec_methods;
+	ghss->css.slotOps = &TTSOpsHeapTuple;
 
-		__gpuCacheCallbackOnAlterTable(table_oid);
-	}
-	systable_endscan(sscan);
-	table_close(srel, AccessShareLock);
+	return (Node *)ghss;
 }
 
+/*
+ * ExecInitGpuCacheHostScan
+ */
 static void
-__gpuCacheOnDropRelation(Oid table_oid)
+__gpuCacheHostScanSwitchToHeap(GpuCacheHostScanState *ghss)
 {
-	Datum		signature;
+	EState	   *estate = ghss->css.ss.ps.state;
+	Relation	rel = ghss->css.ss.ss_currentRelation;
+
+	if (ghss->hscan)
+		__gpuCacheHostScanEnd(ghss->hscan);
+	ghss->hscan = NULL;
+	ghss->gc_desc = NULL;
+	if (!ghss->heap_slot)
+		ghss->heap_slot = table_slot_create(rel, &estate->es_tupleTable);
+}
+
+static void
+ExecInitGpuCacheHostScan(CustomScanState *node, EState *estate, int eflags)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)node;
+	Relation	rel = node->ss.ss_currentRelation;
 	GpuCacheOptions gc_options;
-	GpuCacheDesc *gc_desc;
 
-	signature = gpuCacheTableSignatureSnapshot(table_oid, NULL,
-											   &gc_options);
-	if (signature != 0UL)
+	ghss->fetch_count = &ghss->__fetch_count_data;
+	pg_atomic_init_u32(ghss->fetch_count, 0);
+	if (__gpuCacheExecCheckRelation(rel, &gc_options) &&
+		gc_options.host_resident)
+		ghss->gc_desc = __gpuCacheExecLookupDesc(rel);
+	if (!ghss->gc_desc)
 	{
-		gc_desc = lookupGpuCacheDescNoLoad(table_oid,
-										   signature,
-										   InvalidTransactionId,
-										   &gc_options);
-		if (gc_desc)
-			gc_desc->drop_on_commit = true;
+		/* GpuCache is not available, so scan the heap instead */
+		__gpuCacheHostScanSwitchToHeap(ghss);
+		return;
 	}
+	ghss->hscan = __gpuCacheHostScanBegin(ghss->gc_desc, rel);
+	ghss->chunk_cxt = AllocSetContextCreate(estate->es_query_cxt,
+											"GpuCacheHostScan chunk",
+											ALLOCSET_DEFAULT_SIZES);
+	ghss->chunk_tuples = MemoryContextAlloc(estate->es_query_cxt,
+											sizeof(HeapTuple) *
+											GPUCACHE_HOST_SCAN_NROWS);
 }
 
+/*
+ * ExecGpuCacheHostScan
+ */
 static void
-__gpuCacheOnDropTrigger(Oid trigger_oid)
+__gpuCacheHostScanSaveTuple(void *arg, HeapTuple tuple)
 {
-	Relation	srel;
-	ScanKeyData	skey;
-	SysScanDesc	sscan;
-	HeapTuple	tuple;
-
-	srel = table_open(TriggerRelationId, AccessShareLock);
-	ScanKeyInit(&skey, Anum_pg_trigger_oid,
-				BTEqualStrategyNumber, F_OIDEQ,
-				ObjectIdGetDatum(trigger_oid));
-	sscan = systable_beginscan(srel, TriggerOidIndexId,
-							   true, NULL, 1, &skey);
-	while ((tuple = systable_getnext(sscan)) != NULL)
-	{
-		Oid		table_oid = ((Form_pg_trigger) GETSTRUCT(tuple))->tgrelid;
-		Datum	signature;
-		GpuCacheOptions gc_options;
-		GpuCacheDesc *gc_desc;
+	GpuCacheHostScanState *ghss = arg;
+	MemoryContext	oldcxt;
 
-		signature = gpuCacheTableSignatureSnapshot(table_oid, NULL,
-												   &gc_options);
-		if (signature == 0UL)
-			continue;
+	Assert(ghss->chunk_nitems < GPUCACHE_HOST_SCAN_NROWS);
+	oldcxt = MemoryContextSwitchTo(ghss->chunk_cxt);
+	ghss->chunk_tuples[ghss->chunk_nitems++] = heap_copytuple(tuple);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+static TupleTableSlot *
+GpuCacheHostScanNext(ScanState *ss)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)ss;
+	TupleTableSlot *slot = ss->ss_ScanTupleSlot;
+
+	if (!ghss->gc_desc)
+	{
+		if (!ss->ss_currentScanDesc)
+			ss->ss_currentScanDesc = table_beginscan(ss->ss_currentRelation,
+													 ss->ps.state->es_snapshot,
+													 0, NULL);
+		if (table_scan_getnextslot(ss->ss_currentScanDesc,
+								   ForwardScanDirection,
+								   ghss->heap_slot))
+			return ExecCopySlot(slot, ghss->heap_slot);
+		return ExecClearTuple(slot);
+	}
+
+	while (ghss->chunk_index >= ghss->chunk_nitems)
+	{
+		if (ghss->scan_done)
+			return ExecClearTuple(slot);
+		ExecClearTuple(slot);
+		MemoryContextReset(ghss->chunk_cxt);
+		ghss->chunk_nitems = 0;
+		ghss->chunk_index = 0;
+		if (!__gpuCacheHostScanChunk(ghss->hscan,
+									 ghss->fetch_count,
+									 __gpuCacheHostScanSaveTuple, ghss))
+			ghss->scan_done = true;
+	}
+	return ExecStoreHeapTuple(ghss->chunk_tuples[ghss->chunk_index++],
+							  slot, false);
+}
+
+static bool
+GpuCacheHostScanReCheck(ScanState *ss, TupleTableSlot *slot)
+{
+	return true;
+}
+
+static TupleTableSlot *
+ExecGpuCacheHostScan(CustomScanState *node)
+{
+	return ExecScan(&node->ss,
+					(ExecScanAccessMtd) GpuCacheHostScanNext,
+					(ExecScanRecheckMtd) GpuCacheHostScanReCheck);
+}
+
+/*
+ * ExecEndGpuCacheHostScan
+ */
+static void
+ExecEndGpuCacheHostScan(CustomScanState *node)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)node;
+
+	if (node->ss.ss_currentScanDesc)
+		table_endscan(node->ss.ss_currentScanDesc);
+	if (ghss->hscan)
+		__gpuCacheHostScanEnd(ghss->hscan);
+}
+
+/*
+ * ExecReScanGpuCacheHostScan
+ */
+static void
+ExecReScanGpuCacheHostScan(CustomScanState *node)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)node;
+
+	if (node->ss.ss_currentScanDesc)
+		table_rescan(node->ss.ss_currentScanDesc, NULL);
+	/* shared fetch counter is reset by ReInitializeDSMCustomScan */
+	if (!ghss->shared)
+		pg_atomic_write_u32(ghss->fetch_count, 0);
+	if (ghss->hscan)
+	{
+		ghss->hscan->redo_synced = false;
+		MemoryContextReset(ghss->chunk_cxt);
+	}
+	ghss->chunk_nitems = 0;
+	ghss->chunk_index = 0;
+	ghss->scan_done = false;
+}
+
+/*
+ * Parallel scan support of GpuCacheHostScan
+ */
+static Size
+EstimateGpuCacheHostScanDSM(CustomScanState *node,
+							ParallelContext *pcxt)
+{
+	Relation	rel = node->ss.ss_currentRelation;
+	EState	   *estate = node->ss.ps.state;
+
+	return (MAXALIGN(sizeof(GpuCacheHostScanShared)) +
+			table_parallelscan_estimate(rel, estate->es_snapshot));
+}
+
+static void
+InitializeGpuCacheHostScanDSM(CustomScanState *node,
+							  ParallelContext *pcxt,
+							  void *coordinate)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)node;
+	GpuCacheHostScanShared *shared = coordinate;
+	Relation	rel = node->ss.ss_currentRelation;
+	EState	   *estate = node->ss.ps.state;
+
+	pg_atomic_init_u32(&shared->fetch_count, 0);
+	shared->use_gcache = (ghss->gc_desc != NULL);
+	if (!shared->use_gcache)
+	{
+		ParallelTableScanDesc pscan = GpuCacheHostScanSharedPScan(shared);
+
+		table_parallelscan_initialize(rel, pscan, estate->es_snapshot);
+		node->ss.ss_currentScanDesc = table_beginscan_parallel(rel, pscan);
+	}
+	ghss->shared = shared;
+	ghss->fetch_count = &shared->fetch_count;
+}
+
+static void
+ReInitializeGpuCacheHostScanDSM(CustomScanState *node,
+								ParallelContext *pcxt,
+								void *coordinate)
+{
+	GpuCacheHostScanShared *shared = coordinate;
+	Relation	rel = node->ss.ss_currentRelation;
+
+	pg_atomic_write_u32(&shared->fetch_count, 0);
+	if (!shared->use_gcache)
+		table_parallelscan_reinitialize(rel, GpuCacheHostScanSharedPScan(shared));
+}
+
+static void
+InitializeWorkerGpuCacheHostScan(CustomScanState *node,
+								 shm_toc *toc,
+								 void *coordinate)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)node;
+	GpuCacheHostScanShared *shared = coordinate;
+	Relation	rel = node->ss.ss_currentRelation;
+
+	/* all the participants must scan the same storage */
+	if (shared->use_gcache)
+	{
+		if (!ghss->gc_desc)
+			elog(ERROR, "GpuCache of '%s' is not available in the parallel worker",
+				 RelationGetRelationName(rel));
+	}
+	else
+	{
+		__gpuCacheHostScanSwitchToHeap(ghss);
+		node->ss.ss_currentScanDesc =
+			table_beginscan_parallel(rel, GpuCacheHostScanSharedPScan(shared));
+	}
+	ghss->shared = shared;
+	ghss->fetch_count = &shared->fetch_count;
+}
+
+/*
+ * ExplainGpuCacheHostScan
+ */
+static void
+ExplainGpuCacheHostScan(CustomScanState *node,
+						List *ancestors,
+						ExplainState *es)
+{
+	GpuCacheHostScanState *ghss = (GpuCacheHostScanState *)node;
+
+	if (ghss->gc_desc)
+		__gpuCacheExplainDesc(ghss->gc_desc, es);
+	else
+		ExplainPropertyText("GPU Cache", "not available (heap scan)", es);
+}
+
+/*
+ * pgstrom_init_gpu_cache_host_scan
+ */
+void
+pgstrom_init_gpu_cache_host_scan(void)
+{
+	/* setup path methods */
+	memset(&gcache_hscan_path_methods, 0, sizeof(CustomPathMethods));
+	gcache_hscan_path_methods.CustomName		= "GpuCacheHostScan";
+	gcache_hscan_path_methods.PlanCustomPath	= PlanGpuCacheHostScanPath;
+
+	/* setup plan methods */
+	memset(&gcache_hscan_plan_methods, 0, sizeof(CustomScanMethods));
+	gcache_hscan_plan_methods.CustomName		= "GpuCacheHostScan";
+	gcache_hscan_plan_methods.CreateCustomScanState = CreateGpuCacheHostScanState;
+	RegisterCustomScanMethods(&gcache_hscan_plan_methods);
+
+	/* setup exec methods */
+	memset(&gcache_hscan_exec_methods, 0, sizeof(CustomExecMethods));
+	gcache_hscan_exec_methods.CustomName		= "GpuCacheHostScan";
+	gcache_hscan_exec_methods.BeginCustomScan	= ExecInitGpuCacheHostScan;
+	gcache_hscan_exec_methods.ExecCustomScan	= ExecGpuCacheHostScan;
+	gcache_hscan_exec_methods.EndCustomScan		= ExecEndGpuCacheHostScan;
+	gcache_hscan_exec_methods.ReScanCustomScan	= ExecReScanGpuCacheHostScan;
+	gcache_hscan_exec_methods.EstimateDSMCustomScan = EstimateGpuCacheHostScanDSM;
+	gcache_hscan_exec_methods.InitializeDSMCustomScan = InitializeGpuCacheHostScanDSM;
+	gcache_hscan_exec_methods.ReInitializeDSMCustomScan = ReInitializeGpuCacheHostScanDSM;
+	gcache_hscan_exec_methods.InitializeWorkerCustomScan = InitializeWorkerGpuCacheHostScan;
+	gcache_hscan_exec_methods.ExplainCustomScan	= ExplainGpuCacheHostScan;
+
+	/* hook registration */
+	set_rel_pathlist_next = set_rel_pathlist_hook;
+	set_rel_pathlist_hook = GpuCacheHostScanAddScanPath;
+}
+
+/* ------------------------------------------------------------
+ *
+ * Routines to support DDL callbacks
+ *
+ * ------------------------------------------------------------
+ */
+
+/*
+ * gpuCacheObjectAccess
+ *
+ * This callback marks drop_on_commit / drop_on_rollback for the pending
+ * GpuCache entries on DDL commands.
+ */
+static void
+__gpuCacheCallbackOnAlterTable(Oid table_oid)
+{
+	Datum		signature_old;
+	Datum		signature_new;
+	GpuCacheOptions options_old;
+	GpuCacheOptions options_new;
+	GpuCacheDesc *gc_desc;
+
+	signature_old = gpuCacheTableSignatureSnapshot(table_oid, NULL,
+												   &options_old);
+	signature_new = gpuCacheTableSignatureSnapshot(table_oid, SnapshotSelf,
+												   &options_new);
+#ifdef GPUCACHE_DEBUG_MESSAGE
+	elog(LOG, "__gpuCacheCallbackOnAlterTable(table_oid=%u): signature %lx -> %lx",
+		 table_oid, signature_old, signature_new);
+#endif
+	if (signature_old != 0UL &&
+		signature_old != signature_new)
+	{
+		gc_desc = lookupGpuCacheDescNoLoad(table_oid,
+										   signature_old,
+										   InvalidTransactionId,
+										   &options_old);
+		if (gc_desc)
+			gc_desc->drop_on_commit = true;
+	}
+
+	if (signature_new != 0UL &&
+		signature_new != signature_old)
+	{
+		gc_desc = lookupGpuCacheDescNoLoad(table_oid,
+										   signature_new,
+										   InvalidTransactionId,
+										   &options_new);
+		if (gc_desc)
+			gc_desc->drop_on_rollback = true;
+	}
+}
+
+/*
+ * gpuCacheObjectAccess, and related...
+ */
+static void
+__gpuCacheCallbackOnAlterTrigger(Oid trigger_oid)
+{
+	Relation	srel;
+	ScanKeyData	skey;
+	SysScanDesc	sscan;
+	HeapTuple	tuple;
+
+	srel = table_open(TriggerRelationId, AccessShareLock);
+	ScanKeyInit(&skey,
+				Anum_pg_trigger_oid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(trigger_oid));
+	sscan = systable_beginscan(srel, TriggerOidIndexId, true,
+							   SnapshotSelf, 1, &skey);
+	while ((tuple = systable_getnext(sscan)) != NULL)
+	{
+		Oid		table_oid = ((Form_pg_trigger)GETSTRUCT(tuple))->tgrelid;
+
+		__gpuCacheCallbackOnAlterTable(table_oid);
+	}
+	systable_endscan(sscan);
+	table_close(srel, AccessShareLock);
+}
+
+static void
+__gpuCacheOnDropRelation(Oid table_oid)
+{
+	Datum		signature;
+	GpuCacheOptions gc_options;
+	GpuCacheDesc *gc_desc;
+
+	signature = gpuCacheTableSignatureSnapshot(table_oid, NULL,
+											   &gc_options);
+	if (signature != 0UL)
+	{
+		gc_desc = lookupGpuCacheDescNoLoad(table_oid,
+										   signature,
+										   InvalidTransactionId,
+										   &gc_options);
+		if (gc_desc)
+			gc_desc->drop_on_commit = true;
+	}
+	/* snapshots make no sense any more */
+	__unlinkGpuCacheSnapshots(MyDatabaseId, table_oid, 0);
+}
+
+static void
+__gpuCacheOnDropTrigger(Oid trigger_oid)
+{
+	Relation	srel;
+	ScanKeyData	skey;
+	SysScanDesc	sscan;
+	HeapTuple	tuple;
+
+	srel = table_open(TriggerRelationId, AccessShareLock);
+	ScanKeyInit(&skey, Anum_pg_trigger_oid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(trigger_oid));
+	sscan = systable_beginscan(srel, TriggerOidIndexId,
+							   true, NULL, 1, &skey);
+	while ((tuple = systable_getnext(sscan)) != NULL)
+	{
+		Oid		table_oid = ((Form_pg_trigger) GETSTRUCT(tuple))->tgrelid;
+		Datum	signature;
+		GpuCacheOptions gc_options;
+		GpuCacheDesc *gc_desc;
+
+		signature = gpuCacheTableSignatureSnapshot(table_oid, NULL,
+												   &gc_options);
+		if (signature == 0UL)
+			continue;
 
 		/* force to assign a valid transaction-id */
 		(void)GetCurrentTransactionId();
@@ -3074,6 +4828,11 @@ gpuCacheXactCallback(XactEvent event, void *arg)
 		 GetCurrentTransactionIdIfAny(),
 		 GetTopTransactionIdIfAny());
 #endif
+	/* write out the pending REDO logs prior to the commit */
+	if (event == XACT_EVENT_PRE_COMMIT ||
+		event == XACT_EVENT_PARALLEL_PRE_COMMIT)
+		__gpuCacheFlushPendingLogs(NULL, false);
+
 	if (hash_get_num_entries(gcache_descriptors_htab) > 0 &&
 		(event == XACT_EVENT_COMMIT || event == XACT_EVENT_ABORT))
 	{
@@ -3089,6 +4848,11 @@ gpuCacheXactCallback(XactEvent event, void *arg)
 				releaseGpuCacheDesc(gc_desc, normal_commit);
 		}
 	}
+	if (event == XACT_EVENT_COMMIT ||
+		event == XACT_EVENT_PARALLEL_COMMIT ||
+		event == XACT_EVENT_ABORT ||
+		event == XACT_EVENT_PARALLEL_ABORT)
+		__gpuCacheFlushPendingLogs(NULL, true);
 }
 
 /*
@@ -3378,11 +5142,11 @@ __gpucacheExecApplyRedoKernel(GpuCacheControlCommand *cmd,
 	int			status = EIO;
 
 	pthreadMutexLock(&gc_sstate->redo_mutex);
-	Assert(gc_sstate->redo_write_pos    >= gc_sstate->redo_read_pos &&
-		   gc_sstate->redo_write_nitems >= gc_sstate->redo_read_nitems);
-	head_pos = gc_sstate->redo_read_pos;
-	tail_pos = gc_sstate->redo_write_pos;
+	head_pos = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
+	tail_pos = gc_sstate->redo_publish_pos;
 	nitems  = (gc_sstate->redo_write_nitems - gc_sstate->redo_read_nitems);
+	Assert(tail_pos >= head_pos &&
+		   gc_sstate->redo_write_nitems >= gc_sstate->redo_read_nitems);
 	pthreadMutexUnlock(&gc_sstate->redo_mutex);
 
 	/* alloc kern_gpucache_redolog */
@@ -3422,12 +5186,13 @@ __gpucacheExecApplyRedoKernel(GpuCacheControlCommand *cmd,
 	}
 	end = pos + length;
 
-	/* make advance the read position */
+	/* make advance the read position, and wake up writers */
 	pthreadMutexLock(&gc_sstate->redo_mutex);
-	gc_sstate->redo_read_pos    += length;
+	pg_atomic_write_u64(&gc_sstate->redo_read_pos, head_pos + length);
 	gc_sstate->redo_read_nitems += nitems;
-	Assert(gc_sstate->redo_write_pos    >= gc_sstate->redo_read_pos &&
+	Assert(gc_sstate->redo_publish_pos  >= head_pos + length &&
 		   gc_sstate->redo_write_nitems >= gc_sstate->redo_read_nitems);
+	pthreadCondBroadcast(&gc_sstate->redo_cond);
 	pthreadMutexUnlock(&gc_sstate->redo_mutex);
 
 	/* setup kern_gpucache_redolog index */
@@ -3559,221 +5324,1375 @@ __gpucacheExecApplyRedo(GpuCacheControlCommand *cmd,
 		return EEXIST;
 	}
 
-	pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
-	if (gc_lmap->gcache_main_devptr == 0UL)
+	pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
+	if (gc_lmap->gcache_main_devptr == 0UL)
+	{
+		status = __gpucacheAllocDeviceMemory(gc_lmap,
+											 cmd->errbuf,
+											 sizeof(cmd->errbuf));
+		if (status)
+			goto bailout;
+	}
+	status = __gpucacheExecApplyRedoKernel(cmd, gc_lmap,
+										   f_gcache_apply_redo,
+										   f_gcache_compaction);
+bailout:
+	if (status)
+		__gpucacheMarkAsCorrupted(gc_lmap);
+	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+	putGpuCacheLocalMapping(gc_lmap);
+	return status;
+}
+
+/*
+ * GCACHE_CONTROL_CMD__DROP_UNLOAD
+ */
+static int
+__gpucacheExecDropUnload(GpuCacheControlCommand *cmd)
+{
+	GpuCacheLocalMapping *gc_lmap;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
+											 cmd->ident.table_oid,
+											 cmd->ident.signature);
+	if (!gc_lmap)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "shared memory segment (dat=%u,rel=%u,sig=%09lx) not found",
+				 cmd->ident.database_oid,
+				 cmd->ident.table_oid,
+				 cmd->ident.signature);
+		return EEXIST;
+	}
+	pthreadMutexLock(&gcache_shared_mapping_lock);
+	gc_lmap->refcnt &= 0xfffffffeU;
+	__putGpuCacheLocalMappingNoLock(gc_lmap);
+	pthreadMutexUnlock(&gcache_shared_mapping_lock);
+	return 0;
+}
+
+/*
+ * gpucacheManagerEventLoop
+ */
+void
+gpucacheManagerEventLoop(int cuda_dindex,
+						 CUcontext cuda_context,
+						 CUmodule cuda_module)
+{
+	pthread_mutex_t *cmd_mutex = &gcache_shared_head->gcache_cmd_mutex;
+	pthread_cond_t *cmd_cond = &gcache_shared_head->gpus[cuda_dindex].cond;
+	dlist_head	   *cmd_queue = &gcache_shared_head->gpus[cuda_dindex].queue;
+	CUfunction		f_gcache_apply_redo;
+	CUfunction		f_gcache_compaction;
+	CUresult		rc;
+	GpuCacheControlCommand *cmd;
+
+	rc = cuModuleGetFunction(&f_gcache_apply_redo,
+							 cuda_module,
+							 "kern_gpucache_apply_redo");
+	if (rc != CUDA_SUCCESS)
+	{
+		fprintf(stderr, "gpucache: unable to lookup gpucache_apply_redo\n");
+		return;
+	}
+	rc = cuModuleGetFunction(&f_gcache_compaction,
+							 cuda_module,
+							 "kern_gpucache_compaction");
+	if (rc != CUDA_SUCCESS)
+	{
+		fprintf(stderr, "gpucache: unable to lookup gpucache_compaction\n");
+		return;
+	}
+	
+	pthreadMutexLock(cmd_mutex);
+	while (!gpuServiceGoingTerminate())
+	{
+		int		status;
+
+		if (dlist_is_empty(cmd_queue))
+		{
+			if (!pthreadCondWaitTimeout(cmd_cond, cmd_mutex, 5000L))
+			{
+				/* timeout -> add some maintenance work here*/
+			}
+			continue;
+		}
+		/* fetch a command */
+		cmd = dlist_container(GpuCacheControlCommand, chain,
+							  dlist_pop_head_node(cmd_queue));
+		dlist_delete(&cmd->chain);
+		memset(&cmd->chain, 0, sizeof(dlist_node));
+		pthreadMutexUnlock(cmd_mutex);
+
+		switch (cmd->command)
+		{
+			case GCACHE_CONTROL_CMD__APPLY_REDO:
+				status = __gpucacheExecApplyRedo(cmd,
+												 f_gcache_apply_redo,
+												 f_gcache_compaction);
+				break;
+			case GCACHE_CONTROL_CMD__COMPACTION:
+				status = __gpucacheExecCompaction(cmd, f_gcache_compaction);
+				break;
+			case GCACHE_CONTROL_CMD__DROP_UNLOAD:
+				status = __gpucacheExecDropUnload(cmd);
+				break;
+			default:
+				status = EINVAL;
+				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+						 "gpucache: unknown command ('%c')",
+						 cmd->command);
+				break;
+		}
+		pthreadMutexLock(cmd_mutex);
+		cmd->errcode = status;
+		if (cmd->backend)
+			SetLatch(cmd->backend);
+		else
+			dlist_push_head(&gcache_shared_head->gcache_free_cmds, &cmd->chain);
+	}
+	/* returns the pending commands immediately */
+	while (!dlist_is_empty(cmd_queue))
+	{
+		cmd = dlist_container(GpuCacheControlCommand, chain,
+							  dlist_pop_head_node(cmd_queue));
+		dlist_delete(&cmd->chain);
+		memset(&cmd->chain, 0, sizeof(dlist_node));
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "GpuService is now shutting down...");
+		cmd->errcode = EBUSY;
+		if (cmd->backend)
+			SetLatch(cmd->backend);
+		else
+			dlist_push_head(&gcache_shared_head->gcache_free_cmds, &cmd->chain);
+	}
+	pthreadMutexUnlock(cmd_mutex);
+}
+
+/*
+ * gpucacheManagerWakeUp
+ */
+void
+gpucacheManagerWakeUp(int cuda_dindex)
+{
+	if (cuda_dindex >= 0 && cuda_dindex < numGpuDevAttrs)
+	{
+		pthreadCondBroadcast(&gcache_shared_head->gpus[cuda_dindex].cond);
+	}
+	else
+	{
+		/* wakeup all */
+		for (int i=0; i < cuda_dindex; i++)
+			pthreadCondBroadcast(&gcache_shared_head->gpus[i].cond);
+	}
+}
+
+/*
+ * gpuCacheGetDeviceBuffer
+ */
+void *
+gpuCacheGetDeviceBuffer(const GpuCacheIdent *ident,
+						CUdeviceptr *p_gcache_main_devptr,
+						CUdeviceptr *p_gcache_extra_devptr,
+						char *errbuf, size_t errbuf_sz)
+{
+	GpuCacheLocalMapping *gc_lmap;
+	bool		has_exclusive = false;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(ident->database_oid,
+											 ident->table_oid,
+											 ident->signature);
+	if (!gc_lmap)
+		return NULL;
+	pthreadRWLockReadLock(&gc_lmap->gcache_rwlock);
+retry:
+	if (gc_lmap->gcache_main_devptr == 0UL)
+	{
+		if (!has_exclusive)
+		{
+			pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+			has_exclusive = true;
+			pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
+			goto retry;
+		}
+		if (__gpucacheAllocDeviceMemory(gc_lmap,
+										errbuf, errbuf_sz) != 0)
+		{
+			pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+			putGpuCacheLocalMapping(gc_lmap);
+			return NULL;
+		}
+	}
+	/* ok, valid result */
+	*p_gcache_main_devptr  = gc_lmap->gcache_main_devptr;
+	*p_gcache_extra_devptr = gc_lmap->gcache_extra_devptr;
+	return gc_lmap;
+}
+
+/*
+ * gpuCachePutDeviceBuffer
+ */
+void
+gpuCachePutDeviceBuffer(void *__gc_lmap)
+{
+	GpuCacheLocalMapping *gc_lmap = (GpuCacheLocalMapping *)__gc_lmap;
+
+	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+	putGpuCacheLocalMapping(gc_lmap);
+}
+
+/* ------------------------------------------------------------
+ *
+ * GpuCache Host Applier
+ *
+ * It applies REDO logs on the host-resident GpuCache, instead of the
+ * GpuCache Manager on the GPU service.
+ *
+ * ------------------------------------------------------------
+ */
+static volatile sig_atomic_t gcache_host_applier_got_sigterm = false;
+
+static void
+gpuCacheHostApplierSigTerm(SIGNAL_ARGS)
+{
+	int		saved_errno = errno;
+
+	gcache_host_applier_got_sigterm = true;
+
+	pg_memory_barrier();
+
+	SetLatch(MyLatch);
+
+	errno = saved_errno;
+}
+
+/*
+ * __gpucacheHostSetNull
+ */
+static inline void
+__gpucacheHostSetNull(kern_data_store *kds,
+					  const kern_colmeta *cmeta,
+					  uint32_t rowid, bool isnull)
+{
+	uint8_t	   *nullmap = (uint8_t *)kds + __kds_unpack(cmeta->nullmap_offset);
+
+	Assert(cmeta->nullmap_offset != 0);
+	if (isnull)
+		nullmap[rowid >> 3] &= ~(1U << (rowid & 7));
+	else
+		nullmap[rowid >> 3] |=  (1U << (rowid & 7));
+}
+
+/*
+ * __gpucacheHostCountDeadSpace
+ */
+static uint64_t
+__gpucacheHostCountDeadSpace(kern_data_store *kds,
+							 kern_data_extra *extra,
+							 uint32_t rowid)
+{
+	uint64_t	retval = 0;
+
+	if (!kds->has_varlena || !extra)
+		return 0;
+	for (int j=0; j < kds->ncols; j++)
+	{
+		const kern_colmeta *cmeta = &kds->colmeta[j];
+		uint32_t   *values;
+
+		if (cmeta->attlen > 0 || KDS_COLUMN_ITEM_ISNULL(kds, cmeta, rowid))
+			continue;
+		values = (uint32_t *)((char *)kds + __kds_unpack(cmeta->values_offset));
+		retval += MAXALIGN(VARSIZE_ANY((char *)extra +
+									   __kds_unpack(values[rowid])));
+	}
+	return retval;
+}
+
+/*
+ * __gpucacheHostCompaction
+ *
+ * It copies varlena values of the live rows to the other extra region,
+ * then releases the physical pages of the older one.
+ *
+ * NOTE: must be called under the exclusive lock of host_rwlock
+ */
+static int
+__gpucacheHostCompaction(GpuCacheSharedState *gc_sstate,
+						 char *errbuf, size_t errbuf_sz)
+{
+	kern_data_store *kds = gpuCacheHostMainBuffer(gc_sstate);
+	uint32_t	curr = gc_sstate->host_extra_curr;
+	kern_data_extra *extra_src = gpuCacheHostExtraBuffer(gc_sstate, curr);
+	kern_data_extra *extra_dst = gpuCacheHostExtraBuffer(gc_sstate, 1 - curr);
+
+	if (!extra_src)
+		return 0;	/* no varlena columns */
+	extra_dst->length = gc_sstate->host_extra_sz;
+	extra_dst->usage = offsetof(kern_data_extra, data);
+	extra_dst->deadspace = 0;
+	for (uint32_t rowid=0; rowid < kds->nitems; rowid++)
+	{
+		GpuCacheSysattr *sysattr = gpuCacheHostGetSysattr(kds, rowid);
+
+		/*
+		 * dead rows are never referenced until the rowid is reused
+		 * by the INSERT log, so we don't need to carry their values.
+		 */
+		if (sysattr->xmin == InvalidTransactionId ||
+			sysattr->xmax == FrozenTransactionId)
+			continue;
+		for (int j=0; j < kds->ncols; j++)
+		{
+			const kern_colmeta *cmeta = &kds->colmeta[j];
+			uint32_t   *values;
+			char	   *vl_src;
+			uint32_t	vl_len;
+
+			if (cmeta->attlen > 0 || KDS_COLUMN_ITEM_ISNULL(kds, cmeta, rowid))
+				continue;
+			values = (uint32_t *)((char *)kds + __kds_unpack(cmeta->values_offset));
+			vl_src = (char *)extra_src + __kds_unpack(values[rowid]);
+			vl_len = VARSIZE_ANY(vl_src);
+			if (extra_dst->usage + vl_len > extra_dst->length)
+			{
+				snprintf(errbuf, errbuf_sz,
+						 "gpucache: extra buffer has no space");
+				return ENOSPC;
+			}
+			memcpy((char *)extra_dst + extra_dst->usage, vl_src, vl_len);
+			values[rowid] = __kds_packed(extra_dst->usage);
+			extra_dst->usage += MAXALIGN(vl_len);
+		}
+	}
+	gc_sstate->host_extra_curr = 1 - curr;
+	/* release physical pages of the older region */
+	if (madvise(extra_src, gc_sstate->host_extra_sz, MADV_REMOVE) != 0)
+		fprintf(stderr, "gpucache: failed on madvise(MADV_REMOVE): %m\n");
+	pg_atomic_write_u64(&gc_sstate->gcache_extra_usage, extra_dst->usage);
+	pg_atomic_write_u64(&gc_sstate->gcache_extra_dead, 0);
+	return 0;
+}
+
+/*
+ * __gpucacheHostApplyInsertLog
+ */
+static int
+__gpucacheHostApplyInsertLog(GpuCacheSharedState *gc_sstate,
+							 kern_data_store *kds,
+							 const GCacheTxLogInsert *i_log,
+							 char *errbuf, size_t errbuf_sz)
+{
+	const HeapTupleHeaderData *htup = &i_log->htup;
+	kern_data_extra *extra;
+	GpuCacheSysattr *sysattr;
+	uint32_t	rowid = i_log->rowid;
+	bool		heap_hasnull = ((htup->t_infomask & HEAP_HASNULL) != 0);
+	int			natts = (htup->t_infomask2 & HEAP_NATTS_MASK);
+	uint32_t	offset = htup->t_hoff;
+
+	/*
+	 * Total length of the varlena values never exceeds the log length,
+	 * so make sufficient space on the extra buffer prior to the update.
+	 */
+	extra = gpuCacheHostExtraBuffer(gc_sstate, gc_sstate->host_extra_curr);
+	if (extra)
+	{
+		size_t	required = i_log->length + MAXIMUM_ALIGNOF * kds->ncols;
+
+		if (extra->usage + required > extra->length)
+		{
+			int		status = __gpucacheHostCompaction(gc_sstate,
+													  errbuf, errbuf_sz);
+			if (status)
+				return status;
+			extra = gpuCacheHostExtraBuffer(gc_sstate, gc_sstate->host_extra_curr);
+			if (extra->usage + required > extra->length)
+			{
+				snprintf(errbuf, errbuf_sz,
+						 "gpucache: extra buffer has no space");
+				return ENOSPC;
+			}
+		}
+	}
+
+	for (int j=0; j < kds->ncols; j++)
+	{
+		const kern_colmeta *cmeta = &kds->colmeta[j];
+		char	   *base;
+
+		if (j >= natts || (heap_hasnull && att_isnull(j, htup->t_bits)))
+		{
+			if (cmeta->nullmap_offset == 0)
+			{
+				snprintf(errbuf, errbuf_sz,
+						 "gpucache: NULL appeared at not-null column");
+				return EINVAL;
+			}
+			__gpucacheHostSetNull(kds, cmeta, rowid, true);
+			continue;
+		}
+		if (cmeta->nullmap_offset != 0)
+			__gpucacheHostSetNull(kds, cmeta, rowid, false);
+
+		base = (char *)kds + __kds_unpack(cmeta->values_offset);
+		if (cmeta->attlen > 0)
+		{
+			offset = TYPEALIGN(cmeta->attalign, offset);
+			memcpy(base + cmeta->attlen * rowid,
+				   (char *)htup + offset,
+				   cmeta->attlen);
+			offset += cmeta->attlen;
+		}
+		else
+		{
+			char	   *vl_pos;
+			uint32_t	vl_len;
+
+			Assert(cmeta->attlen == -1 && extra != NULL);
+			if (!VARATT_NOT_PAD_BYTE((char *)htup + offset))
+				offset = TYPEALIGN(cmeta->attalign, offset);
+			vl_pos = (char *)htup + offset;
+			vl_len = VARSIZE_ANY(vl_pos);
+			memcpy((char *)extra + extra->usage, vl_pos, vl_len);
+			((uint32_t *)base)[rowid] = __kds_packed(extra->usage);
+			extra->usage += MAXALIGN(vl_len);
+			offset += vl_len;
+		}
+	}
+	sysattr = gpuCacheHostGetSysattr(kds, rowid);
+	sysattr->xmin = htup->t_choice.t_heap.t_xmin;
+	sysattr->xmax = htup->t_choice.t_heap.t_xmax;
+	sysattr->owner = 0;
+	memcpy(&sysattr->ctid, &htup->t_ctid, sizeof(ItemPointerData));
+
+	return 0;
+}
+
+/*
+ * __gpucacheHostApplyOneLog
+ *
+ * Unlike the GPU kernel, REDO logs are applied one by one in order, so we
+ * don't need to elect the owner of the row.
+ */
+static int
+__gpucacheHostApplyOneLog(GpuCacheSharedState *gc_sstate,
+						  kern_data_store *kds,
+						  const GCacheTxLogCommon *tx_log,
+						  char *errbuf, size_t errbuf_sz)
+{
+	kern_data_extra *extra;
+	GpuCacheSysattr *sysattr;
+	uint32_t	rowid;
+	int			status;
+
+	switch (tx_log->type)
+	{
+		case GCACHE_TX_LOG__INSERT:
+			rowid = ((const GCacheTxLogInsert *)tx_log)->rowid;
+			break;
+		case GCACHE_TX_LOG__DELETE:
+			rowid = ((const GCacheTxLogDelete *)tx_log)->rowid;
+			break;
+		case GCACHE_TX_LOG__COMMIT_INS:
+		case GCACHE_TX_LOG__COMMIT_DEL:
+		case GCACHE_TX_LOG__ABORT_INS:
+		case GCACHE_TX_LOG__ABORT_DEL:
+			rowid = ((const GCacheTxLogXact *)tx_log)->rowid;
+			break;
+		default:
+			snprintf(errbuf, errbuf_sz,
+					 "gpucache: unknown GCacheTxLog type (%08x)", tx_log->type);
+			return EINVAL;
+	}
+	if (rowid >= kds->column_nrooms)
+	{
+		snprintf(errbuf, errbuf_sz,
+				 "gpucache: rowid (%u) is out of range", rowid);
+		return EINVAL;
+	}
+	sysattr = gpuCacheHostGetSysattr(kds, rowid);
+	extra = gpuCacheHostExtraBuffer(gc_sstate, gc_sstate->host_extra_curr);
+	switch (tx_log->type)
+	{
+		case GCACHE_TX_LOG__INSERT:
+			status = __gpucacheHostApplyInsertLog(gc_sstate, kds,
+												  (const GCacheTxLogInsert *)tx_log,
+												  errbuf, errbuf_sz);
+			if (status)
+				return status;
+			break;
+		case GCACHE_TX_LOG__DELETE:
+			sysattr->xmax = ((const GCacheTxLogDelete *)tx_log)->xid;
+			break;
+		case GCACHE_TX_LOG__COMMIT_INS:
+			sysattr->xmin = FrozenTransactionId;
+			break;
+		case GCACHE_TX_LOG__COMMIT_DEL:
+			sysattr->xmax = FrozenTransactionId;
+			if (extra)
+				extra->deadspace += __gpucacheHostCountDeadSpace(kds, extra, rowid);
+			break;
+		case GCACHE_TX_LOG__ABORT_INS:
+			sysattr->xmin = InvalidTransactionId;
+			if (extra)
+				extra->deadspace += __gpucacheHostCountDeadSpace(kds, extra, rowid);
+			break;
+		case GCACHE_TX_LOG__ABORT_DEL:
+			sysattr->xmax = InvalidTransactionId;
+			break;
+	}
+	if (kds->nitems < rowid + 1)
+		kds->nitems = rowid + 1;
+	return 0;
+}
+
+/*
+ * __gpucacheExecHostApplyRedo
+ */
+static int
+__gpucacheExecHostApplyRedo(GpuCacheControlCommand *cmd)
+{
+	GpuCacheLocalMapping *gc_lmap;
+	GpuCacheSharedState *gc_sstate;
+	kern_data_store *kds;
+	char	   *redo_buf;
+	size_t		redo_bufsz;
+	char	   *temp_buf = NULL;
+	size_t		temp_bufsz = 0;
+	uint64_t	head_pos, tail_pos, pos;
+	uint64_t	nitems;
+	int			status = 0;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
+											 cmd->ident.table_oid,
+											 cmd->ident.signature);
+	if (!gc_lmap)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "shared memory segment (dat=%u,rel=%u,sig=%09lx) not found",
+				 cmd->ident.database_oid,
+				 cmd->ident.table_oid,
+				 cmd->ident.signature);
+		return EEXIST;
+	}
+	gc_sstate = gc_lmap->gc_sstate;
+	redo_buf = gpuCacheRedoLogBuffer(gc_sstate);
+	redo_bufsz = gc_sstate->gc_options.redo_buffer_size;
+	if (!gc_sstate->gc_options.host_resident)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "GpuCache is not host-resident");
+		putGpuCacheLocalMapping(gc_lmap);
+		return EINVAL;
+	}
+
+	pthreadMutexLock(&gc_sstate->redo_mutex);
+	head_pos = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
+	tail_pos = gc_sstate->redo_publish_pos;
+	nitems  = (gc_sstate->redo_write_nitems - gc_sstate->redo_read_nitems);
+	Assert(tail_pos >= head_pos &&
+		   gc_sstate->redo_write_nitems >= gc_sstate->redo_read_nitems);
+	pthreadMutexUnlock(&gc_sstate->redo_mutex);
+
+	pthreadRWLockWriteLock(&gc_sstate->host_rwlock);
+	kds = gpuCacheHostMainBuffer(gc_sstate);
+	for (pos = head_pos; pos < tail_pos; )
+	{
+		GCacheTxLogCommon *tx_log;
+		size_t		offset = (pos % redo_bufsz);
+
+		tx_log = (GCacheTxLogCommon *)(redo_buf + offset);
+		if (tx_log->length < offsetof(GCacheTxLogCommon, data) ||
+			pos + tx_log->length > tail_pos)
+		{
+			snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+					 "gpucache: REDO log is corrupted at %lu", pos);
+			status = EINVAL;
+			break;
+		}
+		/* REDO log across the tail of the ring buffer */
+		if (offset + tx_log->length > redo_bufsz)
+		{
+			size_t	sz = redo_bufsz - offset;
+
+			if (tx_log->length > temp_bufsz)
+			{
+				temp_bufsz = tx_log->length + BLCKSZ;
+				temp_buf = realloc(temp_buf, temp_bufsz);
+				if (!temp_buf)
+				{
+					snprintf(cmd->errbuf, sizeof(cmd->errbuf), "out of memory");
+					status = ENOMEM;
+					break;
+				}
+			}
+			memcpy(temp_buf, redo_buf + offset, sz);
+			memcpy(temp_buf + sz, redo_buf, tx_log->length - sz);
+			tx_log = (GCacheTxLogCommon *)temp_buf;
+		}
+		status = __gpucacheHostApplyOneLog(gc_sstate, kds, tx_log,
+										   cmd->errbuf, sizeof(cmd->errbuf));
+		if (status)
+			break;
+		pos += tx_log->length;
+	}
+	if (status == 0)
+		gpuCacheHostUpdateStatistics(gc_sstate, kds);
+	pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+	if (temp_buf)
+		free(temp_buf);
+
+	/* make advance the read position, and wake up writers */
+	pthreadMutexLock(&gc_sstate->redo_mutex);
+	pg_atomic_write_u64(&gc_sstate->redo_read_pos, tail_pos);
+	gc_sstate->redo_read_nitems += nitems;
+	pthreadCondBroadcast(&gc_sstate->redo_cond);
+	pthreadMutexUnlock(&gc_sstate->redo_mutex);
+
+	if (status)
+		__gpucacheMarkAsCorrupted(gc_lmap);
+	putGpuCacheLocalMapping(gc_lmap);
+	return status;
+}
+
+/*
+ * __gpucacheExecHostCompaction
+ */
+static int
+__gpucacheExecHostCompaction(GpuCacheControlCommand *cmd)
+{
+	GpuCacheLocalMapping *gc_lmap;
+	GpuCacheSharedState *gc_sstate;
+	int		status = 0;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
+											 cmd->ident.table_oid,
+											 cmd->ident.signature);
+	if (!gc_lmap)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "shared memory segment (dat=%u,rel=%u,sig=%09lx) not found",
+				 cmd->ident.database_oid,
+				 cmd->ident.table_oid,
+				 cmd->ident.signature);
+		return EEXIST;
+	}
+	gc_sstate = gc_lmap->gc_sstate;
+	if (gc_sstate->gc_options.host_resident)
+	{
+		pthreadRWLockWriteLock(&gc_sstate->host_rwlock);
+		status = __gpucacheHostCompaction(gc_sstate,
+										  cmd->errbuf,
+										  sizeof(cmd->errbuf));
+		pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+	}
+	putGpuCacheLocalMapping(gc_lmap);
+	return status;
+}
+
+/*
+ * gpuCacheHostApplier
+ */
+void
+gpuCacheHostApplier(Datum arg)
+{
+	pthread_mutex_t *cmd_mutex = &gcache_shared_head->gcache_cmd_mutex;
+	pthread_cond_t *cmd_cond = &gcache_shared_head->gpus[numGpuDevAttrs].cond;
+	dlist_head	   *cmd_queue = &gcache_shared_head->gpus[numGpuDevAttrs].queue;
+	GpuCacheControlCommand *cmd;
+
+	pqsignal(SIGTERM, gpuCacheHostApplierSigTerm);
+	BackgroundWorkerUnblockSignals();
+
+	pthreadMutexLock(cmd_mutex);
+	while (!gcache_host_applier_got_sigterm)
+	{
+		int		status;
+
+		if (dlist_is_empty(cmd_queue))
+		{
+			if (!pthreadCondWaitTimeout(cmd_cond, cmd_mutex, 1000L))
+			{
+				if (!PostmasterIsAlive())
+					break;
+			}
+			continue;
+		}
+		/* fetch a command */
+		cmd = dlist_container(GpuCacheControlCommand, chain,
+							  dlist_pop_head_node(cmd_queue));
+		memset(&cmd->chain, 0, sizeof(dlist_node));
+		pthreadMutexUnlock(cmd_mutex);
+
+		switch (cmd->command)
+		{
+			case GCACHE_CONTROL_CMD__APPLY_REDO:
+				status = __gpucacheExecHostApplyRedo(cmd);
+				break;
+			case GCACHE_CONTROL_CMD__COMPACTION:
+				status = __gpucacheExecHostCompaction(cmd);
+				break;
+			case GCACHE_CONTROL_CMD__DROP_UNLOAD:
+				status = __gpucacheExecDropUnload(cmd);
+				break;
+			default:
+				status = EINVAL;
+				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+						 "gpucache: unknown command ('%c')",
+						 cmd->command);
+				break;
+		}
+		pthreadMutexLock(cmd_mutex);
+		cmd->errcode = status;
+		if (cmd->backend)
+			SetLatch(cmd->backend);
+		else
+			dlist_push_head(&gcache_shared_head->gcache_free_cmds, &cmd->chain);
+	}
+	/* returns the pending commands immediately */
+	while (!dlist_is_empty(cmd_queue))
+	{
+		cmd = dlist_container(GpuCacheControlCommand, chain,
+							  dlist_pop_head_node(cmd_queue));
+		memset(&cmd->chain, 0, sizeof(dlist_node));
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "GpuCache Host Applier is now shutting down...");
+		cmd->errcode = EBUSY;
+		if (cmd->backend)
+			SetLatch(cmd->backend);
+		else
+			dlist_push_head(&gcache_shared_head->gcache_free_cmds, &cmd->chain);
+	}
+	pthreadMutexUnlock(cmd_mutex);
+
+	proc_exit(1);
+}
+
+/* ------------------------------------------------------------
+ *
+ * GpuCache Snapshot
+ *
+ * pgstrom.gpucache_snapshot() writes out the image of host-resident
+ * GpuCache (rowid-map, columnar data and varlena buffer) to the file under
+ * the data directory, tagged with the table signature and the WAL / xid
+ * horizon. The initial loading after restart mmaps the snapshot and copies
+ * it onto the shared memory segment, then reloads only the heap blocks
+ * whose LSN is newer than the horizon.
+ * The snapshot is taken under ShareLock on the table, after all the REDO
+ * logs are applied; so, any updates of the table after the snapshot are
+ * always visible as page-LSN beyond the horizon.
+ *
+ * ------------------------------------------------------------
+ */
+#define GPUCACHE_SNAPSHOT_DIR		"pg_strom_gpucache"
+#define GpuCacheSnapshotName(nameBuf,nameLen,datOid,relOid,signature)	\
+	snprintf((nameBuf), (nameLen),										\
+			 GPUCACHE_SNAPSHOT_DIR "/gpucache_d%u_r%u.%09lx.snap",		\
+			 (datOid), (relOid), (signature))
+
+typedef struct
+{
+	char			magic[8];			/* = "GCacheSS" */
+	uint64_t		system_identifier;
+	GpuCacheIdent	ident;
+	GpuCacheOptions	gc_options;
+	XLogRecPtr		horizon_lsn;		/* WAL insert position */
+	uint64_t		horizon_xid;		/* next FullTransactionId */
+	TimestampTz		timestamp;
+	BlockNumber		nblocks;			/* # of blocks on the snapshot */
+	uint32_t		nitems;				/* # of rowids in use */
+	uint64_t		main_sz;			/* total length of the main chunks */
+	uint64_t		extra_sz;			/* usage of the extra buffer */
+} GpuCacheSnapshotHead;
+
+/*
+ * __gpuCacheSnapshotMainChunk
+ *
+ * It returns the index-th range of the host main buffer to be saved;
+ * header, then nullmap / values of the columns for the rows in use.
+ */
+static bool
+__gpuCacheSnapshotMainChunk(const kern_data_store *kds, uint32_t index,
+							size_t *p_offset, size_t *p_length)
+{
+	const kern_colmeta *cmeta;
+	size_t		offset;
+	size_t		length;
+	size_t		unitsz;
+
+	if (index == 0)
+	{
+		*p_offset = 0;
+		*p_length = KDS_HEAD_LENGTH(kds);
+		return true;
+	}
+	index--;
+	if (index >= 2 * kds->nr_colmeta)
+		return false;
+	cmeta = &kds->colmeta[index / 2];
+	if ((index & 1) == 0)
+	{
+		offset = __kds_unpack(cmeta->nullmap_offset);
+		length = __kds_unpack(cmeta->nullmap_length);
+	}
+	else
+	{
+		offset = __kds_unpack(cmeta->values_offset);
+		length = __kds_unpack(cmeta->values_length);
+	}
+	if (offset == 0 || kds->column_nrooms == 0)
+		length = 0;
+	else
+	{
+		/* only the range for the rows in use */
+		unitsz = (length + kds->column_nrooms - 1) / kds->column_nrooms;
+		length = Min(length, unitsz * kds->nitems);
+	}
+	*p_offset = offset;
+	*p_length = length;
+	return true;
+}
+
+/*
+ * __writeGpuCacheSnapshotChunk
+ */
+static void
+__writeGpuCacheSnapshotChunk(int fdesc, const char *fname,
+							 const void *buffer, size_t length)
+{
+	const char *pos = buffer;
+
+	while (length > 0)
+	{
+		ssize_t	nbytes = write(fdesc, pos, length);
+
+		if (nbytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			elog(ERROR, "failed on write('%s'): %m", fname);
+		}
+		pos += nbytes;
+		length -= nbytes;
+	}
+}
+
+/*
+ * __unlinkGpuCacheSnapshots
+ *
+ * It removes the snapshot files of the table, except for 'keep_signature'.
+ */
+static void
+__unlinkGpuCacheSnapshots(Oid database_oid, Oid table_oid,
+						  uint64_t keep_signature)
+{
+	DIR		   *dir;
+	struct dirent *dentry;
+	char		path[MAXPGPATH];
+
+	dir = AllocateDir(GPUCACHE_SNAPSHOT_DIR);
+	if (!dir)
+		return;
+	while ((dentry = ReadDirExtended(dir, GPUCACHE_SNAPSHOT_DIR, LOG)) != NULL)
+	{
+		uint32_t	__database_oid;
+		uint32_t	__table_oid;
+		uint64_t	__signature;
+
+		if (sscanf(dentry->d_name,
+				   "gpucache_d%u_r%u.%09lx.snap",
+				   &__database_oid,
+				   &__table_oid,
+				   &__signature) == 3 &&
+			__database_oid == database_oid &&
+			__table_oid == table_oid &&
+			__signature != keep_signature)
+		{
+			snprintf(path, sizeof(path), "%s/%s",
+					 GPUCACHE_SNAPSHOT_DIR, dentry->d_name);
+			if (unlink(path) != 0 && errno != ENOENT)
+				elog(LOG, "failed on unlink('%s'): %m", path);
+		}
+	}
+	FreeDir(dir);
+}
+
+/*
+ * __writeGpuCacheSnapshot
+ *
+ * NOTE: caller must hold ShareLock on the table, and all the REDO logs must
+ * be already applied.
+ */
+static bool
+__writeGpuCacheSnapshot(GpuCacheDesc *gc_desc, Relation rel)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
+	GpuCacheSnapshotHead head;
+	kern_data_store *kds;
+	kern_data_extra *extra;
+	ItemPointerData	ctids[2048];
+	char		path[MAXPGPATH];
+	char		temp[MAXPGPATH];
+	volatile int fdesc = -1;
+	bool		retval = false;
+
+	if (MakePGDirectory(GPUCACHE_SNAPSHOT_DIR) != 0 && errno != EEXIST)
+		elog(ERROR, "could not create directory \"%s\": %m",
+			 GPUCACHE_SNAPSHOT_DIR);
+	GpuCacheSnapshotName(path, sizeof(path),
+						 gc_desc->ident.database_oid,
+						 gc_desc->ident.table_oid,
+						 gc_desc->ident.signature);
+	snprintf(temp, sizeof(temp), "%s.%d.tmp", path, MyProcPid);
+
+	memset(&head, 0, sizeof(GpuCacheSnapshotHead));
+	memcpy(head.magic, "GCacheSS", 8);
+	head.system_identifier = GetSystemIdentifier();
+	memcpy(&head.ident, &gc_desc->ident, sizeof(GpuCacheIdent));
+	memcpy(&head.gc_options, &gc_sstate->gc_options, sizeof(GpuCacheOptions));
+	head.horizon_lsn = GetXLogInsertRecPtr();
+	/* the state of the snapshot must not be lost on crash */
+	XLogFlush(head.horizon_lsn);
+	head.horizon_xid = U64FromFullTransactionId(ReadNextFullTransactionId());
+	head.timestamp = GetCurrentTimestamp();
+	head.nblocks = RelationGetNumberOfBlocks(rel);
+
+	pthreadRWLockReadLock(&gc_sstate->host_rwlock);
+	PG_TRY();
+	{
+		uint32_t	rowid;
+		uint32_t	index;
+		size_t		offset;
+		size_t		length;
+
+		kds = gpuCacheHostMainBuffer(gc_sstate);
+		extra = gpuCacheHostExtraBuffer(gc_sstate, gc_sstate->host_extra_curr);
+		/* rows not committed yet cannot be saved */
+		for (rowid=0; rowid < kds->nitems; rowid++)
+		{
+			GpuCacheSysattr *sysattr = gpuCacheHostGetSysattr(kds, rowid);
+
+			if (ItemPointerIsValid(&rowitems[rowid].ctid) &&
+				(sysattr->xmin != FrozenTransactionId ||
+				 (sysattr->xmax != InvalidTransactionId &&
+				  sysattr->xmax != FrozenTransactionId)))
+				break;
+		}
+		if (rowid < kds->nitems)
+		{
+			elog(NOTICE, "GpuCache of '%s' has uncommitted rows, so snapshot is not written",
+				 RelationGetRelationName(rel));
+		}
+		else
+		{
+			head.nitems = kds->nitems;
+			for (index=0; __gpuCacheSnapshotMainChunk(kds, index,
+													  &offset,
+													  &length); index++)
+				head.main_sz += length;
+			head.extra_sz = (extra ? extra->usage : 0);
+
+			fdesc = OpenTransientFile(temp, O_WRONLY | O_CREAT | O_TRUNC | PG_BINARY);
+			if (fdesc < 0)
+				elog(ERROR, "could not create file \"%s\": %m", temp);
+			__writeGpuCacheSnapshotChunk(fdesc, temp, &head,
+										 MAXALIGN(sizeof(GpuCacheSnapshotHead)));
+			/* rowid-map (ctids of the rows in use) */
+			for (rowid=0; rowid < head.nitems; rowid += lengthof(ctids))
+			{
+				uint32_t	count = Min(head.nitems - rowid, lengthof(ctids));
+
+				for (uint32_t i=0; i < count; i++)
+					ItemPointerCopy(&rowitems[rowid+i].ctid, &ctids[i]);
+				__writeGpuCacheSnapshotChunk(fdesc, temp, ctids,
+											 sizeof(ItemPointerData) * count);
+			}
+			length = sizeof(ItemPointerData) * head.nitems;
+			if (length != MAXALIGN(length))
+				__writeGpuCacheSnapshotChunk(fdesc, temp, ctids,
+											 MAXALIGN(length) - length);
+			/* main buffer */
+			for (index=0; __gpuCacheSnapshotMainChunk(kds, index,
+													  &offset,
+													  &length); index++)
+				__writeGpuCacheSnapshotChunk(fdesc, temp,
+											 (char *)kds + offset, length);
+			/* extra buffer */
+			if (extra)
+				__writeGpuCacheSnapshotChunk(fdesc, temp, extra, head.extra_sz);
+			if (CloseTransientFile(fdesc) != 0)
+				elog(ERROR, "could not close file \"%s\": %m", temp);
+			fdesc = -1;
+			retval = true;
+		}
+	}
+	PG_CATCH();
+	{
+		pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+		if (fdesc >= 0)
+			CloseTransientFile(fdesc);
+		unlink(temp);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+
+	if (retval)
 	{
-		status = __gpucacheAllocDeviceMemory(gc_lmap,
-											 cmd->errbuf,
-											 sizeof(cmd->errbuf));
-		if (status)
-			goto bailout;
+		/* durable_rename() also flushes the temporary file */
+		durable_rename(temp, path, ERROR);
+		__unlinkGpuCacheSnapshots(gc_desc->ident.database_oid,
+								  gc_desc->ident.table_oid,
+								  gc_desc->ident.signature);
+		elog(LOG, "gpucache: snapshot of '%s' was written (nitems=%u, lsn=%X/%X)",
+			 RelationGetRelationName(rel), head.nitems,
+			 LSN_FORMAT_ARGS(head.horizon_lsn));
 	}
-	status = __gpucacheExecApplyRedoKernel(cmd, gc_lmap,
-										   f_gcache_apply_redo,
-										   f_gcache_compaction);
-bailout:
-	if (status)
-		__gpucacheMarkAsCorrupted(gc_lmap);
-	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
-	putGpuCacheLocalMapping(gc_lmap);
-	return status;
+	return retval;
 }
 
 /*
- * GCACHE_CONTROL_CMD__DROP_UNLOAD
+ * __blockNumberComp
  */
 static int
-__gpucacheExecDropUnload(GpuCacheControlCommand *cmd)
+__blockNumberComp(const void *__a, const void *__b)
 {
-	GpuCacheLocalMapping *gc_lmap;
+	BlockNumber	a = *((const BlockNumber *)__a);
+	BlockNumber	b = *((const BlockNumber *)__b);
 
-	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
-											 cmd->ident.table_oid,
-											 cmd->ident.signature);
-	if (!gc_lmap)
-	{
-		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
-				 "shared memory segment (dat=%u,rel=%u,sig=%09lx) not found",
-				 cmd->ident.database_oid,
-				 cmd->ident.table_oid,
-				 cmd->ident.signature);
-		return EEXIST;
-	}
-	pthreadMutexLock(&gcache_shared_mapping_lock);
-	gc_lmap->refcnt &= 0xfffffffeU;
-	__putGpuCacheLocalMappingNoLock(gc_lmap);
-	pthreadMutexUnlock(&gcache_shared_mapping_lock);
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
 	return 0;
 }
 
 /*
- * gpucacheManagerEventLoop
+ * __reconcileGpuCacheSnapshot
+ *
+ * It removes the rows on the heap blocks modified since the snapshot, then
+ * reloads these blocks. The rowid-map is rebuilt from the ctids.
  */
-void
-gpucacheManagerEventLoop(int cuda_dindex,
-						 CUcontext cuda_context,
-						 CUmodule cuda_module)
+static void
+__reconcileGpuCacheSnapshot(GpuCacheDesc *gc_desc, Relation rel,
+							XLogRecPtr horizon_lsn,
+							BlockNumber snap_nblocks)
 {
-	pthread_mutex_t *cmd_mutex = &gcache_shared_head->gcache_cmd_mutex;
-	pthread_cond_t *cmd_cond = &gcache_shared_head->gpus[cuda_dindex].cond;
-	dlist_head	   *cmd_queue = &gcache_shared_head->gpus[cuda_dindex].queue;
-	CUfunction		f_gcache_apply_redo;
-	CUfunction		f_gcache_compaction;
-	CUresult		rc;
-	GpuCacheControlCommand *cmd;
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	pg_atomic_uint64 *rowid_keys = gpuCacheRowIdMapKeys(gc_sstate);
+	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
+	uint64_t	rowid_nslots = gc_sstate->rowid_map_nslots;
+	uint32_t	rowid_nrooms = gc_sstate->gc_options.max_num_rows;
+	BufferAccessStrategy bstrategy = GetAccessStrategy(BAS_BULKREAD);
+	BlockNumber	nblocks = RelationGetNumberOfBlocks(rel);
+	BlockNumber	blkno;
+	BlockNumber *blocks;
+	uint32_t	nrooms = 1024;
+	uint32_t	nitems = 0;
+	uint32_t	nremoved = 0;
+	gpuCacheLoadBatch *batch;
+	kern_data_store *kds;
+	kern_data_extra *extra;
+
+	/* pick up the heap blocks modified since the snapshot */
+	blocks = palloc(sizeof(BlockNumber) * nrooms);
+	for (blkno=0; blkno < Max(nblocks, snap_nblocks); blkno++)
+	{
+		bool	modified = true;
 
-	rc = cuModuleGetFunction(&f_gcache_apply_redo,
-							 cuda_module,
-							 "kern_gpucache_apply_redo");
-	if (rc != CUDA_SUCCESS)
-	{
-		fprintf(stderr, "gpucache: unable to lookup gpucache_apply_redo\n");
-		return;
-	}
-	rc = cuModuleGetFunction(&f_gcache_compaction,
-							 cuda_module,
-							 "kern_gpucache_compaction");
-	if (rc != CUDA_SUCCESS)
-	{
-		fprintf(stderr, "gpucache: unable to lookup gpucache_compaction\n");
-		return;
+		CHECK_FOR_INTERRUPTS();
+		if (blkno < nblocks)
+		{
+			Buffer	buffer;
+			Page	page;
+
+			buffer = ReadBufferExtended(rel, MAIN_FORKNUM, blkno,
+										RBM_NORMAL, bstrategy);
+			LockBuffer(buffer, BUFFER_LOCK_SHARE);
+			page = BufferGetPage(buffer);
+			if (!PageIsNew(page) &&
+				BufferGetLSNAtomic(buffer) <= horizon_lsn)
+				modified = false;
+			UnlockReleaseBuffer(buffer);
+		}
+		if (modified)
+		{
+			if (nitems >= nrooms)
+			{
+				nrooms += nrooms;
+				blocks = repalloc_huge(blocks, sizeof(BlockNumber) * nrooms);
+			}
+			blocks[nitems++] = blkno;
+		}
 	}
-	
-	pthreadMutexLock(cmd_mutex);
-	while (!gpuServiceGoingTerminate())
-	{
-		int		status;
+	FreeAccessStrategy(bstrategy);
 
-		if (dlist_is_empty(cmd_queue))
+	/* rebuild the rowid-map, and remove the rows on the modified blocks */
+	pthreadRWLockWriteLock(&gc_sstate->host_rwlock);
+	pthreadMutexLock(&gc_sstate->rowid_mutex);
+	kds = gpuCacheHostMainBuffer(gc_sstate);
+	extra = gpuCacheHostExtraBuffer(gc_sstate, gc_sstate->host_extra_curr);
+	for (uint64_t i=0; i < rowid_nslots; i++)
+		pg_atomic_init_u64(&rowid_keys[i], ROWID_MAP_KEY__EMPTY);
+	pg_atomic_write_u32(&gc_sstate->rowid_num_used, 0);
+	pg_atomic_fetch_add_u32(&gc_sstate->rowid_generation, 1);
+	gc_sstate->rowid_next_free = UINT_MAX;
+	gc_sstate->rowid_num_free = 0;
+	for (uint32_t rowid = rowid_nrooms; rowid > 0; rowid--)
+	{
+		GpuCacheRowIdItem *ritem = &rowitems[rowid-1];
+
+		if (ItemPointerIsValid(&ritem->ctid))
 		{
-			if (!pthreadCondWaitTimeout(cmd_cond, cmd_mutex, 5000L))
+			blkno = ItemPointerGetBlockNumberNoCheck(&ritem->ctid);
+			if (!bsearch(&blkno, blocks, nitems,
+						 sizeof(BlockNumber),
+						 __blockNumberComp))
 			{
-				/* timeout -> add some maintenance work here*/
+				if (!__insertGpuCacheRowIdMap(gc_sstate, &ritem->ctid, rowid-1))
+					elog(ERROR, "Bug? no room for the GpuCache rowid-map");
+				continue;
 			}
-			continue;
+			/* this row is no longer valid */
+			Assert(rowid-1 < kds->nitems);
+			gpuCacheHostGetSysattr(kds, rowid-1)->xmin = InvalidTransactionId;
+			if (extra)
+				extra->deadspace += __gpucacheHostCountDeadSpace(kds, extra, rowid-1);
+			ItemPointerSetInvalid(&ritem->ctid);
+			nremoved++;
 		}
-		/* fetch a command */
-		cmd = dlist_container(GpuCacheControlCommand, chain,
-							  dlist_pop_head_node(cmd_queue));
-		dlist_delete(&cmd->chain);
-		memset(&cmd->chain, 0, sizeof(dlist_node));
-		pthreadMutexUnlock(cmd_mutex);
-
-		switch (cmd->command)
+		ritem->next = gc_sstate->rowid_next_free;
+		gc_sstate->rowid_next_free = rowid-1;
+		gc_sstate->rowid_num_free++;
+	}
+	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+	gpuCacheHostUpdateStatistics(gc_sstate, kds);
+	pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+
+	/* reload the modified blocks */
+	batch = palloc0(sizeof(gpuCacheLoadBatch));
+	batch->gc_desc = gc_desc;
+	batch->redo_desc = gc_desc;
+	batch->gc_lmap = gc_desc->gc_lmap;
+	batch->rel = rel;
+	initStringInfo(&batch->buf);
+	for (uint32_t i=0, j; i < nitems; i = j)
+	{
+		for (j=i+1; j < nitems; j++)
 		{
-			case GCACHE_CONTROL_CMD__APPLY_REDO:
-				status = __gpucacheExecApplyRedo(cmd,
-												 f_gcache_apply_redo,
-												 f_gcache_compaction);
-				break;
-			case GCACHE_CONTROL_CMD__COMPACTION:
-				status = __gpucacheExecCompaction(cmd, f_gcache_compaction);
-				break;
-			case GCACHE_CONTROL_CMD__DROP_UNLOAD:
-				status = __gpucacheExecDropUnload(cmd);
-				break;
-			default:
-				status = EINVAL;
-				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
-						 "gpucache: unknown command ('%c')",
-						 cmd->command);
+			if (blocks[j] != blocks[j-1] + 1 || blocks[j] >= nblocks)
 				break;
 		}
-		pthreadMutexLock(cmd_mutex);
-		cmd->errcode = status;
-		if (cmd->backend)
-			SetLatch(cmd->backend);
-		else
-			dlist_push_head(&gcache_shared_head->gcache_free_cmds, &cmd->chain);
-	}
-	/* returns the pending commands immediately */
-	while (!dlist_is_empty(cmd_queue))
-	{
-		cmd = dlist_container(GpuCacheControlCommand, chain,
-							  dlist_pop_head_node(cmd_queue));
-		dlist_delete(&cmd->chain);
-		memset(&cmd->chain, 0, sizeof(dlist_node));
-		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
-				 "GpuService is now shutting down...");
-		cmd->errcode = EBUSY;
-		if (cmd->backend)
-			SetLatch(cmd->backend);
-		else
-			dlist_push_head(&gcache_shared_head->gcache_free_cmds, &cmd->chain);
+		if (blocks[i] >= nblocks)
+			break;
+		if (!__initialLoadGpuCacheBlocks(batch, blocks[i],
+										 blocks[j-1] - blocks[i] + 1,
+										 false, NULL))
+			break;
 	}
-	pthreadMutexUnlock(cmd_mutex);
+	__initialLoadGpuCacheFlushBatch(batch);
+	pfree(batch->buf.data);
+	pfree(batch);
+	pfree(blocks);
+
+	elog(LOG, "gpucache: '%s' is restored from the snapshot (%u of %u blocks reloaded, %u rows removed)",
+		 RelationGetRelationName(rel), nitems, nblocks, nremoved);
 }
 
 /*
- * gpucacheManagerWakeUp
+ * __restoreGpuCacheSnapshot
+ *
+ * It tries to restore the host-resident GpuCache from the snapshot.
+ * If no valid snapshot, it returns false, then caller loads the table
+ * from the scratch.
  */
-void
-gpucacheManagerWakeUp(int cuda_dindex)
+static bool
+__restoreGpuCacheSnapshot(GpuCacheDesc *gc_desc, Relation rel)
 {
-	if (cuda_dindex >= 0 && cuda_dindex < numGpuDevAttrs)
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	GpuCacheRowIdItem *rowitems = gpuCacheRowIdItemArray(gc_sstate);
+	const GpuCacheSnapshotHead *head;
+	const kern_data_store *kds_snap;
+	const char *reason = NULL;
+	char	   *mmap_addr = MAP_FAILED;
+	char		path[MAXPGPATH];
+	struct stat	stat_buf;
+	int			fdesc;
+	XLogRecPtr	horizon_lsn = InvalidXLogRecPtr;
+	BlockNumber	snap_nblocks = 0;
+
+	if (!gc_sstate->gc_options.host_resident || !RelationNeedsWAL(rel))
+		return false;
+	GpuCacheSnapshotName(path, sizeof(path),
+						 gc_desc->ident.database_oid,
+						 gc_desc->ident.table_oid,
+						 gc_desc->ident.signature);
+	fdesc = OpenTransientFile(path, O_RDONLY | PG_BINARY);
+	if (fdesc < 0)
 	{
-		pthreadCondBroadcast(&gcache_shared_head->gpus[cuda_dindex].cond);
+		if (errno != ENOENT)
+			elog(LOG, "could not open file \"%s\": %m", path);
+		return false;
 	}
-	else
+
+	if (fstat(fdesc, &stat_buf) != 0 ||
+		stat_buf.st_size < MAXALIGN(sizeof(GpuCacheSnapshotHead)) ||
+		(mmap_addr = mmap(NULL, stat_buf.st_size,
+						  PROT_READ,
+						  MAP_SHARED,
+						  fdesc, 0)) == MAP_FAILED)
 	{
-		/* wakeup all */
-		for (int i=0; i < cuda_dindex; i++)
-			pthreadCondBroadcast(&gcache_shared_head->gpus[i].cond);
+		elog(LOG, "gpucache: snapshot '%s' is not available", path);
+		CloseTransientFile(fdesc);
+		return false;
 	}
-}
-
-/*
- * gpuCacheGetDeviceBuffer
- */
-void *
-gpuCacheGetDeviceBuffer(const GpuCacheIdent *ident,
-						CUdeviceptr *p_gcache_main_devptr,
-						CUdeviceptr *p_gcache_extra_devptr,
-						char *errbuf, size_t errbuf_sz)
-{
-	GpuCacheLocalMapping *gc_lmap;
-	bool		has_exclusive = false;
 
-	gc_lmap = getGpuCacheLocalMappingIfExist(ident->database_oid,
-											 ident->table_oid,
-											 ident->signature);
-	if (!gc_lmap)
-		return NULL;
-	pthreadRWLockReadLock(&gc_lmap->gcache_rwlock);
-retry:
-	if (gc_lmap->gcache_main_devptr == 0UL)
+	PG_TRY();
 	{
-		if (!has_exclusive)
+		size_t		ctids_sz;
+		size_t		offset;
+		size_t		length;
+		const char *pos;
+
+		head = (const GpuCacheSnapshotHead *)mmap_addr;
+		ctids_sz = MAXALIGN(sizeof(ItemPointerData) * head->nitems);
+		kds_snap = (const kern_data_store *)
+			(mmap_addr + MAXALIGN(sizeof(GpuCacheSnapshotHead)) + ctids_sz);
+
+		/* validation checks */
+		if (memcmp(head->magic, "GCacheSS", 8) != 0)
+			reason = "magic mismatch";
+		else if (head->system_identifier != GetSystemIdentifier())
+			reason = "system identifier mismatch";
+		else if (!GpuCacheIdentEqual(&head->ident, &gc_desc->ident) ||
+				 !GpuCacheOptionsEqual(&head->gc_options, &gc_sstate->gc_options))
+			reason = "table signature mismatch";
+		else if (stat_buf.st_size != (MAXALIGN(sizeof(GpuCacheSnapshotHead)) +
+									  ctids_sz +
+									  head->main_sz +
+									  head->extra_sz))
+			reason = "file size mismatch";
+		else if (head->nitems > gc_sstate->gc_options.max_num_rows ||
+				 head->extra_sz > gc_sstate->host_extra_sz)
+			reason = "corrupted header";
+		else if (head->horizon_lsn > GetXLogInsertRecPtr())
+			reason = "WAL position is older than the snapshot";
+		else if (head->horizon_xid > U64FromFullTransactionId(ReadNextFullTransactionId()))
+			reason = "transaction id is older than the snapshot";
+		else if (head->main_sz < KDS_HEAD_LENGTH(&gc_sstate->kds_head) ||
+				 kds_snap->length != gc_sstate->kds_head.length ||
+				 kds_snap->column_nrooms != gc_sstate->kds_head.column_nrooms ||
+				 kds_snap->nr_colmeta != gc_sstate->kds_head.nr_colmeta ||
+				 kds_snap->nitems != head->nitems ||
+				 memcmp(kds_snap->colmeta, gc_sstate->kds_head.colmeta,
+						sizeof(kern_colmeta) * kds_snap->nr_colmeta) != 0)
+			reason = "columnar format mismatch";
+		if (reason)
+			goto skip;
+		horizon_lsn = head->horizon_lsn;
+		snap_nblocks = head->nblocks;
+
+		/* rowid-map; hash table and free-list are rebuilt later */
+		pos = mmap_addr + MAXALIGN(sizeof(GpuCacheSnapshotHead));
+		pthreadMutexLock(&gc_sstate->rowid_mutex);
+		for (uint32_t rowid=0; rowid < gc_sstate->gc_options.max_num_rows; rowid++)
 		{
-			pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
-			has_exclusive = true;
-			pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
-			goto retry;
+			if (rowid < head->nitems)
+				ItemPointerCopy((const ItemPointerData *)pos + rowid,
+								&rowitems[rowid].ctid);
+			else
+				ItemPointerSetInvalid(&rowitems[rowid].ctid);
 		}
-		if (__gpucacheAllocDeviceMemory(gc_lmap,
-										errbuf, errbuf_sz) != 0)
+		pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+		pos += ctids_sz;
+
+		/* columnar image */
+		pthreadRWLockWriteLock(&gc_sstate->host_rwlock);
 		{
-			pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
-			putGpuCacheLocalMapping(gc_lmap);
-			return NULL;
+			kern_data_store *kds = gpuCacheHostMainBuffer(gc_sstate);
+			kern_data_extra *extra;
+			uint32_t	index;
+
+			for (index=0; __gpuCacheSnapshotMainChunk(index == 0 ? kds_snap : kds,
+													  index,
+													  &offset,
+													  &length); index++)
+			{
+				memcpy((char *)kds + offset, pos, length);
+				pos += length;
+			}
+			gc_sstate->host_extra_curr = 0;
+			extra = gpuCacheHostExtraBuffer(gc_sstate, 0);
+			if (extra)
+			{
+				memcpy(extra, pos, head->extra_sz);
+				extra->length = gc_sstate->host_extra_sz;
+			}
 		}
+		pthreadRWLockUnlock(&gc_sstate->host_rwlock);
+	skip:
+		;
 	}
-	/* ok, valid result */
-	*p_gcache_main_devptr  = gc_lmap->gcache_main_devptr;
-	*p_gcache_extra_devptr = gc_lmap->gcache_extra_devptr;
-	return gc_lmap;
+	PG_CATCH();
+	{
+		munmap(mmap_addr, stat_buf.st_size);
+		CloseTransientFile(fdesc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	munmap(mmap_addr, stat_buf.st_size);
+	CloseTransientFile(fdesc);
+
+	if (reason)
+	{
+		elog(LOG, "gpucache: snapshot '%s' is not available (%s)", path, reason);
+		return false;
+	}
+	__reconcileGpuCacheSnapshot(gc_desc, rel, horizon_lsn, snap_nblocks);
+	return true;
 }
 
 /*
- * gpuCachePutDeviceBuffer
+ * pgstrom_gpucache_snapshot
  */
-void
-gpuCachePutDeviceBuffer(void *__gc_lmap)
+PG_FUNCTION_INFO_V1(pgstrom_gpucache_snapshot);
+PUBLIC_FUNCTION(Datum)
+pgstrom_gpucache_snapshot(PG_FUNCTION_ARGS)
 {
-	GpuCacheLocalMapping *gc_lmap = (GpuCacheLocalMapping *)__gc_lmap;
+	Oid			table_oid = PG_GETARG_OID(0);
+	Relation	rel;
+	GpuCacheDesc *gc_desc;
+	bool		retval = false;
 
-	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
-	putGpuCacheLocalMapping(gc_lmap);
+	/* ShareLock waits for completion of the concurrent writers */
+	rel = table_open(table_oid, ShareLock);
+	gc_desc = lookupGpuCacheDesc(rel);
+	if (!gc_desc)
+		elog(NOTICE, "table '%s' has no GpuCache",
+			 RelationGetRelationName(rel));
+	else if (!gc_desc->gc_options.host_resident)
+		elog(NOTICE, "GpuCache snapshot is supported only for host-resident GpuCache");
+	else if (!RelationNeedsWAL(rel))
+		elog(NOTICE, "GpuCache snapshot is not supported on unlogged or temporary tables");
+	else if (initialLoadGpuCache(gc_desc, rel))
+	{
+		GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+		uint64_t	sync_pos;
+
+		__gpuCacheFlushPendingLogs(&gc_desc->ident, false);
+		pthreadMutexLock(&gc_sstate->redo_mutex);
+		sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_publish_pos;
+		pthreadMutexUnlock(&gc_sstate->redo_mutex);
+		gpuCacheInvokeApplyRedo(gc_desc, sync_pos, false);
+
+		if (pg_atomic_read_u32(&gc_sstate->phase) == GCACHE_PHASE__IS_READY)
+			retval = __writeGpuCacheSnapshot(gc_desc, rel);
+	}
+	table_close(rel, ShareLock);
+
+	PG_RETURN_BOOL(retval);
 }
 
 /* ------------------------------------------------------------
@@ -4249,9 +7168,9 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 	else
 		str = psprintf("unknown-%u", phase);
 	values[5] = CStringGetTextDatum(str);
-	values[6] = Int64GetDatum(gc_sstate->gc_options.max_num_rows -
-							  gc_sstate->rowid_num_free);
-	values[7] = Int64GetDatum(gc_sstate->rowid_num_free);
+	values[6] = Int64GetDatum(pg_atomic_read_u32(&gc_sstate->rowid_num_used));
+	values[7] = Int64GetDatum(gc_sstate->gc_options.max_num_rows -
+							  pg_atomic_read_u32(&gc_sstate->rowid_num_used));
 	values[8] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_main_size));
 	values[9] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_main_nitems));
 	values[10] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_extra_size));
@@ -4259,9 +7178,9 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 	values[12] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_extra_dead));
 	values[13] = TimestampGetDatum(gc_sstate->redo_write_timestamp);
 	values[14] = Int64GetDatum(gc_sstate->redo_write_nitems);
-	values[15] = Int64GetDatum(gc_sstate->redo_write_pos);
+	values[15] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->redo_write_pos));
 	values[16] = Int64GetDatum(gc_sstate->redo_read_nitems);
-	values[17] = Int64GetDatum(gc_sstate->redo_read_pos);
+	values[17] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->redo_read_pos));
 	values[18] = Int64GetDatum(gc_sstate->redo_sync_pos);
 	if (gc_sstate->gc_options.cuda_dindex >= 0 &&
 		gc_sstate->gc_options.cuda_dindex < numGpuDevAttrs)
@@ -4278,6 +7197,19 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 					   gc_sstate->gc_options.gpu_sync_threshold);
 		values[19] = CStringGetTextDatum(str);
 	}
+	else if (gc_sstate->gc_options.host_resident)
+	{
+		str = psprintf("host_resident=on,"
+					   "max_num_rows=%ld,"
+					   "redo_buffer_size=%zu,"
+					   "gpu_sync_interval=%d,"
+					   "gpu_sync_threshold=%zu",
+					   gc_sstate->gc_options.max_num_rows,
+					   gc_sstate->gc_options.redo_buffer_size,
+					   gc_sstate->gc_options.gpu_sync_interval,
+					   gc_sstate->gc_options.gpu_sync_threshold);
+		values[19] = CStringGetTextDatum(str);
+	}
 	else
 	{
 		isnull[19] = true;
@@ -4331,7 +7263,7 @@ pgstrom_request_gpu_cache(void)
 
 	if (shmem_request_next)
 		shmem_request_next();
-	sz = offsetof(GpuCacheSharedHead, gpus[numGpuDevAttrs]);
+	sz = offsetof(GpuCacheSharedHead, gpus[numGpuDevAttrs + 1]);
 	RequestAddinShmemSpace(MAXALIGN(sz));
 }
 
@@ -4347,7 +7279,7 @@ pgstrom_startup_gpu_cache(void)
 	if (shmem_startup_next)
 		(*shmem_startup_next)();
 
-	sz = offsetof(GpuCacheSharedHead, gpus[numGpuDevAttrs]);
+	sz = offsetof(GpuCacheSharedHead, gpus[numGpuDevAttrs + 1]);
 	gcache_shared_head = ShmemInitStruct("GpuCache Shared Head", sz, &found);
 	if (found)
 		elog(ERROR, "Bug? GpuCacheSharedHead already exists");
@@ -4362,7 +7294,7 @@ pgstrom_startup_gpu_cache(void)
 		dlist_push_tail(&gcache_shared_head->gcache_free_cmds,
 						&cmd->chain);
 	}
-	for (int i=0; i < numGpuDevAttrs; i++)
+	for (int i=0; i <= numGpuDevAttrs; i++)
 	{
 		pthreadCondInitShared(&gcache_shared_head->gpus[i].cond);
 		dlist_init(&gcache_shared_head->gpus[i].queue);
@@ -4396,6 +7328,17 @@ pgstrom_init_gpu_cache(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* GUC: pg_strom.gpucache_load_parallel_workers */
+	DefineCustomIntVariable("pg_strom.gpucache_load_parallel_workers",
+							"max number of parallel workers for the initial loading of GpuCache",
+							NULL,
+							&pgstrom_gpucache_load_parallel_workers,
+							4,
+							0,
+							1024,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
 	/* setup local hash tables */
 	memset(&hctl, 0, sizeof(HASHCTL));
 	hctl.keysize = offsetof(GpuCacheDesc, xid) + sizeof(TransactionId);
@@ -4403,6 +7346,7 @@ pgstrom_init_gpu_cache(void)
 	hctl.hcxt = CacheMemoryContext;
 	gcache_descriptors_htab = hash_create("GpuCache Descriptors", 48, &hctl,
 										  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	dlist_init(&gcache_pending_redo_list);
 
 	memset(&hctl, 0, sizeof(HASHCTL));
     hctl.keysize = sizeof(Oid);
@@ -4439,6 +7383,26 @@ pgstrom_init_gpu_cache(void)
 		RegisterBackgroundWorker(&worker);
 	}
 
+	/*
+	 * Background worker to apply REDO logs on the host-resident GpuCache
+	 */
+	{
+		BackgroundWorker worker;
+
+		memset(&worker, 0, sizeof(BackgroundWorker));
+		snprintf(worker.bgw_name, sizeof(worker.bgw_name),
+				 "GPUCache Host Applier");
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+		worker.bgw_restart_time = 5;
+		snprintf(worker.bgw_library_name, BGW_MAXLEN,
+				 "$libdir/pg_strom");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN,
+				 "gpuCacheHostApplier");
+		worker.bgw_main_arg = 0;
+		RegisterBackgroundWorker(&worker);
+	}
+
 	/* request for the static shared memory */
 	shmem_request_next = shmem_request_hook;
 	shmem_request_hook = pgstrom_request_gpu_cache;
@@ -729,6 +729,9 @@ __build_fallback_exprs_join_walker(Node *node, void *data)
 	{
 		codegen_kvar_defitem *kvar = lfirst(lc);
 
+		/* common sub-expressions are not filled on the fallback */
+		if (kvar->kv_subexpr)
+			continue;
 		if (codegen_expression_equals(node, kvar->kv_expr))
 		{
 			return (Node *)makeVar(INDEX_VAR,
@@ -764,6 +767,8 @@ __build_fallback_exprs_inner_walker(Node *node, void *data)
 	{
 		codegen_kvar_defitem *kvdef = lfirst(lc);
 
+		if (kvdef->kv_subexpr)
+			continue;
 		if (codegen_expression_equals(node, kvdef->kv_expr))
 		{
 			return (Node *)makeVar(INNER_VAR,
@@ -1083,6 +1088,16 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 	Assert(pp_info->num_rels == list_length(custom_plans));
 	context = create_codegen_context(root, cpath, pp_info);
 
+	/*
+	 * final depth shall be device projection (Scan/Join) or partial
+	 * aggregation (GroupBy).
+	 */
+	if ((pp_info->xpu_task_flags & DEVTASK__MASK) == DEVTASK__PREAGG)
+		pgstrom_build_groupby_tlist_dev(context, root, tlist);
+	else
+		pgstrom_build_join_tlist_dev(context, root, joinrel, tlist);
+	codegen_build_common_subexprs(context, pp_info);
+
 	/* codegen for outer scan, if any */
 	if (pp_info->scan_quals)
 	{
@@ -1137,21 +1152,11 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 					   &outer_refs);
 	}
 
-	/*
-	 * final depth shall be device projection (Scan/Join) or partial
-	 * aggregation (GroupBy).
-	 */
+	/* codegen for the final depth */
 	if ((pp_info->xpu_task_flags & DEVTASK__MASK) == DEVTASK__PREAGG)
-	{
-		pgstrom_build_groupby_tlist_dev(context, root, tlist);
 		codegen_build_groupby_actions(context, pp_info);
-	}
 	else
-	{
-		/* build device projection */
-		pgstrom_build_join_tlist_dev(context, root, joinrel, tlist);
 		pp_info->kexp_projection = codegen_build_projection(context);
-	}
 	pull_varattnos((Node *)context->tlist_dev,
 				   pp_info->scan_relid,
 				   &outer_refs);
@@ -1175,6 +1180,7 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 	pp_info->extra_flags = context->extra_flags;
 	pp_info->extra_bufsz = context->extra_bufsz;
 	pp_info->used_params = context->used_params;
+	pp_info->saop_hash_params = context->saop_hash_params;
 	pp_info->outer_refs  = outer_refs;
 	/*
 	 * fixup fallback expressions
@@ -24,50 +24,49 @@ static bool					enable_dpuscan = false;		/* GUC */
 
 /*
  * sort_device_qualifiers
+ *
+ * It sorts the device qualifiers (RestrictInfo) by the rank; the estimated
+ * cost per rows rejected (cost / (1 - selectivity)), thus the qualifiers
+ * that are cheap and filter out many rows shall be evaluated first.
  */
 void
-sort_device_qualifiers(List *dev_quals_list, List *dev_costs_list)
+sort_device_qualifiers(PlannerInfo *root,
+					   List *dev_quals_list,
+					   List *dev_costs_list)
 {
 	int			nitems = list_length(dev_quals_list);
-	ListCell  **dev_quals = alloca(sizeof(ListCell *) * nitems);
-	int		   *dev_costs = alloca(sizeof(int) * nitems);
-	int			i, j, k;
+	void	  **dev_quals = alloca(sizeof(void *) * nitems);
+	double	   *dev_ranks = alloca(sizeof(double) * nitems);
+	int			i, j;
 	ListCell   *lc1, *lc2;
 
 	i = 0;
 	forboth (lc1, dev_quals_list,
 			 lc2, dev_costs_list)
 	{
-		dev_quals[i] = lc1;
-		dev_costs[i] = lfirst_int(lc2);
+		Node	   *dqual = lfirst(lc1);
+		Selectivity	dsel;
+		double		drank;
+
+		dsel = clauselist_selectivity(root, list_make1(dqual),
+									  0, JOIN_INNER, NULL);
+		CLAMP_PROBABILITY(dsel);
+		drank = (double)lfirst_int(lc2) / Max(1.0 - dsel, 0.0001);
+		/* insertion sort; keeps the original order if same rank */
+		for (j=i; j > 0 && dev_ranks[j-1] > drank; j--)
+		{
+			dev_quals[j] = dev_quals[j-1];
+			dev_ranks[j] = dev_ranks[j-1];
+		}
+		dev_quals[j] = dqual;
+		dev_ranks[j] = drank;
 		i++;
 	}
 	Assert(i == nitems);
 
-	for (i=0; i < nitems; i++)
-	{
-		int		dcost = dev_costs[i];
-		void   *dqual = dev_quals[i]->ptr_value;
-
-		k = i;
-		for (j=i+1; j < nitems; j++)
-		{
-			if (dcost > dev_costs[j])
-			{
-				dcost = dev_costs[j];
-				dqual = dev_quals[j]->ptr_value;
-				k = j;
-			}
-		}
-
-		if (i != k)
-		{
-			dev_costs[k] = dev_costs[i];
-			dev_costs[i] = dcost;
-			dev_quals[k]->ptr_value = dev_quals[i]->ptr_value;
-			dev_quals[i]->ptr_value = dqual;
-		}
-	}
+	i = 0;
+	foreach (lc1, dev_quals_list)
+		lfirst(lc1) = dev_quals[i++];
 }
 
 /*
@@ -166,8 +165,15 @@ __buildOuterScanPlanInfo(PlannerInfo *root,
 			ds_entry = GetOptimalDpuForBaseRel(root, baserel);
 		if (!ds_entry)
 			return NULL;
-		avg_seq_page_cost = (spc_seq_page_cost * (1.0 - baserel->allvisfrac) +
-							 pgstrom_dpu_seq_page_cost * baserel->allvisfrac);
+		/* Is host-resident GpuCache available? */
+		if (rte->relkind != RELKIND_FOREIGN_TABLE &&
+			baseRelHasGpuCache(root, baserel) == GPUCACHE_HOST_DINDEX)
+			gpu_cache_dindex = GPUCACHE_HOST_DINDEX;
+		if (gpu_cache_dindex >= 0)
+			avg_seq_page_cost = 0;
+		else
+			avg_seq_page_cost = (spc_seq_page_cost * (1.0 - baserel->allvisfrac) +
+								 pgstrom_dpu_seq_page_cost * baserel->allvisfrac);
 	}
 	else
 	{
@@ -310,7 +316,9 @@ buildOuterScanPlanInfo(PlannerInfo *root,
 				return NULL;
 			break;
 		case RELKIND_FOREIGN_TABLE:
-			if (baseRelIsArrowFdw(baserel))
+			/* virtual partition columns are not supported by xPU */
+			if (baseRelIsArrowFdw(baserel) &&
+				!baseRelHasArrowVirtualRefs(baserel))
 				break;
 			return NULL;
 		default:
@@ -377,7 +385,7 @@ buildOuterScanPlanInfo(PlannerInfo *root,
 	*p_param_info = param_info;
 	if (!allow_no_device_quals && dev_quals == NIL)
 		return NULL;
-	sort_device_qualifiers(dev_quals, dev_costs);
+	sort_device_qualifiers(root, dev_quals, dev_costs);
 	return __buildOuterScanPlanInfo(root,
 									baserel,
 									xpu_task_flags,
@@ -685,10 +693,11 @@ PlanXpuScanPathCommon(PlannerInfo *root,
 	CustomScan	   *cscan;
 
 	context = create_codegen_context(root, best_path, pp_info);
+	context->tlist_dev = gpuscan_build_projection(baserel, pp_info, tlist);
+	codegen_build_common_subexprs(context, pp_info);
 	/* code generation for WHERE-clause */
 	pp_info->kexp_scan_quals = codegen_build_scan_quals(context, pp_info->scan_quals);
 	/* code generation for the Projection */
-	context->tlist_dev = gpuscan_build_projection(baserel, pp_info, tlist);
 	pp_info->kexp_projection = codegen_build_projection(context);
 	codegen_build_packed_kvars_load(context, pp_info);
 	codegen_build_packed_kvars_move(context, pp_info);
@@ -696,6 +705,7 @@ PlanXpuScanPathCommon(PlannerInfo *root,
 	pp_info->extra_flags = context->extra_flags;
 	pp_info->extra_bufsz = context->extra_bufsz;
 	pp_info->used_params = context->used_params;
+	pp_info->saop_hash_params = context->saop_hash_params;
 	__build_explain_tlist_junks(root, baserel, context);
 
 	/* assign kvec buffer size for this scan */
@@ -2039,6 +2039,8 @@ resume_kernel:
 		resp->u.results.nitems_raw = kgtask->nitems_raw;
 		resp->u.results.nitems_in  = kgtask->nitems_in;
 		resp->u.results.nitems_out = kgtask->nitems_out;
+		memcpy(resp->u.results.nitems_quals,
+			   kgtask->nitems_quals, sizeof(kgtask->nitems_quals));
 		resp->u.results.num_rels = num_inner_rels;
 		for (int i=0; i < num_inner_rels; i++)
 		{
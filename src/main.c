@@ -370,6 +370,8 @@ pgstrom_sigpoll_handler(SIGNAL_ARGS)
 void
 _PG_init(void)
 {
+	bool		has_xpu_devices = false;
+
 	/*
 	 * PG-Strom must be loaded using shared_preload_libraries
 	 */
@@ -404,7 +406,7 @@ _PG_init(void)
 		pgstrom_init_gpu_scan();
 		pgstrom_init_gpu_join();
 		pgstrom_init_gpu_preagg();
-		pgstrom_init_gpu_cache();
+		has_xpu_devices = true;
 	}
 	/* init DPU related stuff */
 	if (pgstrom_init_dpu_device())
@@ -412,7 +414,12 @@ _PG_init(void)
 		pgstrom_init_dpu_scan();
 		pgstrom_init_dpu_join();
 		pgstrom_init_dpu_preagg();
+		has_xpu_devices = true;
 	}
+	/* init GpuCache (host-resident mode works without GPUs) */
+	pgstrom_init_gpu_cache();
+	if (!has_xpu_devices)
+		pgstrom_init_gpu_cache_host_scan();
 	pgstrom_init_pcie();
 	/* callback for the extension checker */
 	CacheRegisterSyscacheCallback(NAMESPACEOID, pgstrom_extension_checker_callback, 0);
@@ -37,6 +37,7 @@ __form_codegen_kvar_defitem(codegen_kvar_defitem *kvdef)
 	result = lappend(result, makeInteger(kvdef->kv_typalign));
 	result = lappend(result, makeInteger(kvdef->kv_typlen));
 	result = lappend(result, makeInteger(kvdef->kv_kvec_sizeof));
+	result = lappend(result, makeBoolean(kvdef->kv_subexpr));
 	result = lappend(result, kvdef->kv_expr);
 	foreach (lc, kvdef->kv_subfields)
 	{
@@ -68,6 +69,7 @@ __deform_codegen_kvar_defitem(List *sublist)
 	kvdef->kv_typalign = intVal(list_nth(sublist, kvindex++));
 	kvdef->kv_typlen   = intVal(list_nth(sublist, kvindex++));
 	kvdef->kv_kvec_sizeof = intVal(list_nth(sublist, kvindex++));
+	kvdef->kv_subexpr  = boolVal(list_nth(sublist, kvindex++));
 	kvdef->kv_expr     = list_nth(sublist, kvindex++);
 	subfields          = list_nth(sublist, kvindex++);
 	foreach (lc, subfields)
@@ -97,6 +99,7 @@ form_pgstrom_plan_info(CustomScan *cscan, pgstromPlanInfo *pp_info)
 	/* plan information */
 	privs = lappend(privs, bms_to_pglist(pp_info->outer_refs));
 	exprs = lappend(exprs, pp_info->used_params);
+	exprs = lappend(exprs, pp_info->saop_hash_params);
 	privs = lappend(privs, pp_info->host_quals);
 	privs = lappend(privs, makeInteger(pp_info->scan_relid));
 	privs = lappend(privs, pp_info->scan_quals);
@@ -200,6 +203,7 @@ deform_pgstrom_plan_info(CustomScan *cscan)
 	/* plan information */
 	pp_data.outer_refs = bms_from_pglist(list_nth(privs, pindex++));
 	pp_data.used_params = list_nth(exprs, eindex++);
+	pp_data.saop_hash_params = list_nth(exprs, eindex++);
 	pp_data.host_quals = list_nth(privs, pindex++);
 	pp_data.scan_relid = intVal(list_nth(privs, pindex++));
 	pp_data.scan_quals = list_nth(privs, pindex++);
@@ -293,6 +297,7 @@ copy_pgstrom_plan_info(const pgstromPlanInfo *pp_orig)
 	memcpy(pp_dest, pp_orig, offsetof(pgstromPlanInfo,
 									  inners[pp_orig->num_rels]));
 	pp_dest->used_params      = list_copy(pp_dest->used_params);
+	pp_dest->saop_hash_params = list_copy(pp_dest->saop_hash_params);
 	pp_dest->host_quals       = copyObject(pp_dest->host_quals);
 	pp_dest->scan_quals       = copyObject(pp_dest->scan_quals);
 	pp_dest->brin_index_conds = copyObject(pp_dest->brin_index_conds);
@@ -38,7 +38,9 @@
 #include "catalog/pg_aggregate.h"
 #include "catalog/pg_am.h"
 #include "catalog/pg_amop.h"
+#include "catalog/pg_authid.h"
 #include "catalog/pg_cast.h"
+#include "catalog/pg_collation.h"
 #include "catalog/pg_database.h"
 #include "catalog/pg_depend.h"
 #include "catalog/pg_foreign_table.h"
@@ -60,6 +62,7 @@
 #include "commands/tablespace.h"
 #include "commands/trigger.h"
 #include "commands/typecmds.h"
+#include "common/file_perm.h"
 #include "common/hashfn.h"
 #include "common/int.h"
 #include "executor/nodeSubplan.h"
@@ -92,10 +95,12 @@
 #include "storage/ipc.h"
 #include "storage/fd.h"
 #include "storage/latch.h"
+#include "storage/lmgr.h"
 #include "storage/pmsignal.h"
 #include "storage/procarray.h"
 #include "storage/shmem.h"
 #include "storage/smgr.h"
+#include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/cash.h"
 #include "utils/catcache.h"
@@ -135,6 +140,7 @@
 #include <pthread.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/file.h>
 #include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
@@ -236,6 +242,7 @@ typedef struct devfunc_info
 
 typedef struct XpuConnection	XpuConnection;
 typedef struct GpuCacheDesc		GpuCacheDesc;
+typedef struct GpuCacheHostScanDesc	GpuCacheHostScanDesc;
 typedef struct DpuStorageEntry	DpuStorageEntry;
 typedef struct ArrowFdwState	ArrowFdwState;
 typedef struct BrinIndexState	BrinIndexState;
@@ -278,6 +285,7 @@ typedef struct
 	/* Plan information */
 	const Bitmapset *outer_refs;	/* referenced columns */
 	List	   *used_params;		/* param list in use */
+	List	   *saop_hash_params;	/* param arrays of ScalarArrayOpHash */
 	List	   *host_quals;			/* host qualifiers to scan the outer */
 	Index		scan_relid;			/* relid of the outer relation to scan */
 	List	   *scan_quals;			/* device qualifiers to scan the outer */
@@ -358,6 +366,8 @@ typedef struct
 	pg_atomic_uint64	npages_buffer_read;	/* read from PG buffer */
 	pg_atomic_uint64	source_ntuples_raw;	/* # of raw tuples in the base relation */
 	pg_atomic_uint64	source_ntuples_in;	/* # of tuples survived from WHERE-quals */
+	pg_atomic_uint64	source_ntuples_quals[KERN_SCAN_QUALS_NSTATS];
+											/* ... from the first N WHERE-quals */
 	pg_atomic_uint64	result_ntuples;		/* # of tuples returned from xPU */
 	/* for parallel-scan */
 	uint32_t			parallel_scan_desc_offset;
@@ -430,6 +440,7 @@ struct pgstromTaskState
 	ArrowFdwState	   *arrow_state;
 	BrinIndexState	   *br_state;
 	GpuCacheDesc	   *gcache_desc;
+	GpuCacheHostScanDesc *gcache_hscan;	/* host-resident GpuCache scan */
 	pg_atomic_uint32   *gcache_fetch_count;
 	kern_multirels	   *h_kmrels;		/* host inner buffer (if JOIN) */
 	const char		   *kds_pathname;	/* pathname to be used for KDS setup */
@@ -549,6 +560,7 @@ typedef struct
 	int8_t		kv_typalign;	/* typalign from the catalog */
 	int16_t		kv_typlen;		/* typlen from the catalog */
 	int			kv_kvec_sizeof;	/* =sizeof(kvec_XXXX_t) */
+	bool		kv_subexpr;		/* true, if common sub-expression */
 	Expr	   *kv_expr;		/* original expression */
 	List	   *kv_subfields;	/* subfields definition, if array or composite */
 } codegen_kvar_defitem;
@@ -560,6 +572,7 @@ typedef struct
 	Expr	   *top_expr;
 	PlannerInfo *root;
 	List	   *used_params;
+	List	   *saop_hash_params;
 	uint32_t	required_flags;
 	uint32_t	extra_flags;
 	uint32_t	extra_bufsz;
@@ -571,6 +584,9 @@ typedef struct
 	uint32_t	kvecs_usage;
 	Index		scan_relid;		/* depth==0 */
 	int			num_rels;
+	List	   *cse_items;		/* common sub-expressions */
+	List	   *cse_must_evals;	/* nodes always evaluated in the current root */
+	int			cse_phase;		/* current phase of common sub-expressions */
 	struct {
 		PathTarget *inner_target;
 	} pd[1];
@@ -591,6 +607,8 @@ extern codegen_context *create_codegen_context(PlannerInfo *root,
 											   CustomPath *cpath,
 											   pgstromPlanInfo *pp_info);
 extern bool		codegen_expression_equals(const void *__a, const void *__b);
+extern void		codegen_build_common_subexprs(codegen_context *context,
+											  pgstromPlanInfo *pp_info);
 extern bytea   *codegen_build_scan_quals(codegen_context *context,
 										 List *dev_quals);
 extern bytea   *codegen_build_packed_joinquals(codegen_context *context,
@@ -617,6 +635,8 @@ extern void		codegen_build_packed_xpucode(bytea **p_xpucode,
 											 uint32_t *p_extra_bufsz,
 											 uint32_t *p_kvars_nslots,
 											 List **p_used_params);
+extern kern_saop_hash *pgstrom_build_saop_hash(ArrayType *array,
+											   size_t *p_length);
 extern bool		pgstrom_xpu_expression(Expr *expr,
 									   uint32_t required_xpu_flags,
 									   Index scan_relid,
@@ -778,7 +798,9 @@ extern void		pgstrom_init_gpu_service(void);
 /*
  * gpu_cache.c
  */
+#define GPUCACHE_HOST_DINDEX	INT_MAX		/* host-resident GpuCache */
 extern void		pgstrom_init_gpu_cache(void);
+extern void		pgstrom_init_gpu_cache_host_scan(void);
 extern int		baseRelHasGpuCache(PlannerInfo *root,
 								   RelOptInfo *baserel);
 extern bool		RelationHasGpuCache(Relation rel);
@@ -797,6 +819,8 @@ extern void		pgstromGpuCacheShutdown(pgstromTaskState *pts);
 extern void		pgstromGpuCacheExplain(pgstromTaskState *pts,
 									   ExplainState *es,
 									   List *dcontext);
+extern void		gpuCacheInitialLoadWorkerMain(dsm_segment *seg,
+											  shm_toc *toc);
 extern void		gpucacheManagerEventLoop(int cuda_dindex,
 										 CUcontext cuda_context,
 										 CUmodule cuda_module);
@@ -811,7 +835,8 @@ extern void		gpuCachePutDeviceBuffer(void *gc_lmap);
 /*
  * gpu_scan.c
  */
-extern void		sort_device_qualifiers(List *dev_quals_list,
+extern void		sort_device_qualifiers(PlannerInfo *root,
+									   List *dev_quals_list,
 									   List *dev_costs_list);
 extern pgstromPlanInfo *try_fetch_xpuscan_planinfo(const Path *path);
 extern pgstromPlanInfo *buildOuterScanPlanInfo(PlannerInfo *root,
@@ -873,6 +898,7 @@ extern void		pgstrom_init_dpu_preagg(void);
  */
 extern bool		baseRelIsArrowFdw(RelOptInfo *baserel);
 extern bool 	RelationIsArrowFdw(Relation frel);
+extern bool		baseRelHasArrowVirtualRefs(RelOptInfo *baserel);
 extern const Bitmapset *GetOptimalGpusForArrowFdw(PlannerInfo *root,
 												  RelOptInfo *baserel);
 extern const DpuStorageEntry *GetOptimalDpuForArrowFdw(PlannerInfo *root,
@@ -898,6 +924,8 @@ extern bool		kds_arrow_fetch_tuple(TupleTableSlot *slot,
 									  kern_data_store *kds,
 									  size_t index,
 									  const Bitmapset *referenced);
+extern void		pgstromArrowFdwMetadataWorkerMain(dsm_segment *seg,
+												  shm_toc *toc);
 extern void pgstrom_init_arrow_fdw(void);
 
 /*
@@ -76,6 +76,42 @@ CREATE FUNCTION pgstrom.arrow_fdw_import_file(text,	    -- relname
   AS 'MODULE_PATHNAME','pgstrom_arrow_fdw_import_file'
   LANGUAGE C;
 
+CREATE FUNCTION pgstrom.arrow_export_trans(internal, text, anyelement)
+  RETURNS internal
+  AS 'MODULE_PATHNAME','pgstrom_arrow_export_trans'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.arrow_export_combine(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME','pgstrom_arrow_export_combine'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.arrow_export_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_arrow_export_serialize'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.arrow_export_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME','pgstrom_arrow_export_deserialize'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.arrow_export_final(internal)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_arrow_export_final'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE AGGREGATE pgstrom.arrow_export(text, anyelement) (
+  sfunc = pgstrom.arrow_export_trans,
+  stype = internal,
+  finalfunc = pgstrom.arrow_export_final,
+  finalfunc_modify = read_write,
+  combinefunc = pgstrom.arrow_export_combine,
+  serialfunc = pgstrom.arrow_export_serialize,
+  deserialfunc = pgstrom.arrow_export_deserialize,
+  parallel = safe
+);
+
 -- ================================================================
 --
 -- GPU Cache Functions
@@ -102,6 +138,11 @@ CREATE FUNCTION pgstrom.gpucache_recovery(regclass)
   AS 'MODULE_PATHNAME','pgstrom_gpucache_recovery'
   LANGUAGE C STRICT;
 
+CREATE FUNCTION pgstrom.gpucache_snapshot(regclass)
+  RETURNS bool
+  AS 'MODULE_PATHNAME','pgstrom_gpucache_snapshot'
+  LANGUAGE C STRICT;
+
 CREATE TYPE pgstrom.__pgstrom_gpucache_info_t AS (
     database_oid        oid,
     database_name       text,
@@ -957,6 +957,101 @@ pgfn_ScalarArrayOp(XPU_PGFUNCTION_ARGS)
 	return true;
 }
 
+STATIC_FUNCTION(bool)
+pgfn_ScalarArrayOpHash(XPU_PGFUNCTION_ARGS)
+{
+	xpu_bool_t	   *result = (xpu_bool_t *)__result;
+	const kern_expression *karg = KEXP_FIRST_ARG(kexp);
+	const kern_saop_hash *hash;
+	const uint32_t *used;
+	uint32_t		saop_flags = kexp->u.saop_hash.saop_flags;
+	bool			negative = ((saop_flags & KERN_SAOP_HASH_FLAG__NEGATIVE) != 0);
+	uint32_t		mask;
+	uint32_t		index;
+	uint64_t		key;
+	union {
+		xpu_datum_t		dt;
+		xpu_int1_t		i1;
+		xpu_int2_t		i2;
+		xpu_int4_t		i4;
+		xpu_int8_t		i8;
+		xpu_date_t		date;
+		xpu_time_t		time;
+		xpu_timestamp_t	ts;
+		xpu_timestamptz_t tstz;
+		xpu_money_t		cash;
+	} sval;
+
+	assert(kexp->exptype == TypeOpCode__bool &&
+		   kexp->nr_args == 1);
+	if ((saop_flags & KERN_SAOP_HASH_FLAG__PARAM) == 0)
+		hash = (const kern_saop_hash *)kexp->u.saop_hash.data;
+	else
+	{
+		/* built on the session setup; NULL if the array is NULL */
+		hash = SESSION_SAOP_HASH(kcxt->session, kexp->u.saop_hash.param_id);
+		if (!hash)
+		{
+			result->expr_ops = NULL;
+			return true;
+		}
+	}
+	mask = hash->nslots - 1;
+	used = KERN_SAOP_HASH_USEDMAP(hash);
+	assert(hash->nslots > 0 && (hash->nslots & mask) == 0);
+
+	if (!EXEC_KERN_EXPRESSION(kcxt, karg, &sval))
+		return false;
+	if (XPU_DATUM_ISNULL(&sval.dt))
+	{
+		/* strict comparator never returns true/false on NULL, if any items */
+		if (hash->nitems > 0)
+			result->expr_ops = NULL;
+		else
+		{
+			result->expr_ops = &xpu_bool_ops;
+			result->value = negative;
+		}
+		return true;
+	}
+	switch (karg->exptype)
+	{
+		case TypeOpCode__int1:        key = (int64_t)sval.i1.value;   break;
+		case TypeOpCode__int2:        key = (int64_t)sval.i2.value;   break;
+		case TypeOpCode__int4:        key = (int64_t)sval.i4.value;   break;
+		case TypeOpCode__int8:        key = (int64_t)sval.i8.value;   break;
+		case TypeOpCode__date:        key = (int64_t)sval.date.value; break;
+		case TypeOpCode__time:        key = (int64_t)sval.time.value; break;
+		case TypeOpCode__timestamp:   key = (int64_t)sval.ts.value;   break;
+		case TypeOpCode__timestamptz: key = (int64_t)sval.tstz.value; break;
+		case TypeOpCode__money:       key = (int64_t)sval.cash.value; break;
+		default:
+			STROM_ELOG(kcxt, "unexpected key type of ScalarArrayOpHash");
+			return false;
+	}
+	/* probe the hash table; it always has an empty slot at least */
+	index = __saop_hash_key(key) & mask;
+	while ((used[index >> 5] & (1U << (index & 31))) != 0)
+	{
+		if (hash->keys[index] == key)
+		{
+			result->expr_ops = &xpu_bool_ops;
+			result->value = !negative;
+			return true;
+		}
+		index = (index + 1) & mask;
+	}
+	/* not found, but NULL may be equal to the scalar value */
+	if (hash->has_nulls)
+		result->expr_ops = NULL;
+	else
+	{
+		result->expr_ops = &xpu_bool_ops;
+		result->value = negative;
+	}
+	return true;
+}
+
 /* ----------------------------------------------------------------
  *
  * Routines to support Projection
@@ -1386,6 +1481,54 @@ ExecLoadVarsHeapTuple(kern_context *kcxt,
 	return true;
 }
 
+/*
+ * ExecScanQuals
+ *
+ * It evaluates the scan-quals, and counts number of rows that passed
+ * through the individual qualifiers of the top-level AND.
+ */
+STATIC_FUNCTION(bool)
+ExecScanQuals(kern_context *kcxt,
+			  const kern_expression *kexp_scan_quals)
+{
+	const kern_expression *karg;
+	xpu_bool_t	retval;
+	int			i;
+
+	if (kexp_scan_quals->opcode != FuncOpCode__BoolExpr_And)
+	{
+		if (!EXEC_KERN_EXPRESSION(kcxt, kexp_scan_quals, &retval))
+		{
+			assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
+			return false;
+		}
+		if (XPU_DATUM_ISNULL(&retval) || !retval.value)
+			return false;
+		kcxt->scan_quals_nitems[0]++;
+		return true;
+	}
+	/*
+	 * Unlike BoolExpr(AND), it stops on the first NULL also, because
+	 * the scan-quals don't distinguish NULL and false.
+	 */
+	for (i=0, karg = KEXP_FIRST_ARG(kexp_scan_quals);
+		 i < kexp_scan_quals->nr_args;
+		 i++, karg = KEXP_NEXT_ARG(karg))
+	{
+		assert(karg->exptype == TypeOpCode__bool);
+		if (!EXEC_KERN_EXPRESSION(kcxt, karg, &retval))
+		{
+			assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
+			return false;
+		}
+		if (XPU_DATUM_ISNULL(&retval) || !retval.value)
+			return false;
+		if (i < KERN_SCAN_QUALS_NSTATS)
+			kcxt->scan_quals_nitems[i]++;
+	}
+	return true;
+}
+
 PUBLIC_FUNCTION(bool)
 ExecLoadVarsOuterRow(kern_context *kcxt,
 					 const kern_expression *kexp_load_vars,
@@ -1397,20 +1540,7 @@ ExecLoadVarsOuterRow(kern_context *kcxt,
 	ExecLoadVarsHeapTuple(kcxt, kexp_load_vars, 0, kds, htup);
 	/* check scan quals if given */
 	if (kexp_scan_quals)
-	{
-		xpu_bool_t	retval;
-
-		if (EXEC_KERN_EXPRESSION(kcxt, kexp_scan_quals, &retval))
-		{
-			if (!XPU_DATUM_ISNULL(&retval) && retval.value)
-				return true;
-		}
-		else
-		{
-			assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
-		}
-		return false;
-	}
+		return ExecScanQuals(kcxt, kexp_scan_quals);
 	return true;
 }
 
@@ -1436,20 +1566,7 @@ ExecLoadVarsOuterArrow(kern_context *kcxt,
 	}
 	/* check scan quals if given */
 	if (kexp_scan_quals)
-	{
-		xpu_bool_t	retval;
-
-		if (EXEC_KERN_EXPRESSION(kcxt, kexp_scan_quals, &retval))
-		{
-			if (!XPU_DATUM_ISNULL(&retval) && retval.value)
-				return true;
-		}
-		else
-		{
-			assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
-		}
-		return false;
-	}
+		return ExecScanQuals(kcxt, kexp_scan_quals);
 	return true;
 }
 
@@ -1477,20 +1594,7 @@ ExecLoadVarsOuterColumn(kern_context *kcxt,
 	}
 	/* check scan quals if given */
 	if (kexp_scan_quals)
-	{
-		xpu_bool_t	retval;
-
-		if (EXEC_KERN_EXPRESSION(kcxt, kexp_scan_quals, &retval))
-		{
-			if (!XPU_DATUM_ISNULL(&retval) && retval.value)
-				return true;
-		}
-		else
-		{
-			assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
-		}
-		return false;
-	}
+		return ExecScanQuals(kcxt, kexp_scan_quals);
 	return true;
 }
 
@@ -2479,6 +2583,9 @@ PUBLIC_DATA xpu_function_catalog_entry builtin_xpu_functions_catalog[] = {
 	{FuncOpCode__CaseWhenExpr,				pgfn_CaseWhenExpr},
 	{FuncOpCode__ScalarArrayOpAny,			pgfn_ScalarArrayOp},
 	{FuncOpCode__ScalarArrayOpAll,			pgfn_ScalarArrayOp},
+	{FuncOpCode__ScalarArrayOpHash,			pgfn_ScalarArrayOpHash},
+	{FuncOpCode__LikeMatch,					pgfn_LikeMatch},
+	{FuncOpCode__RegexMatch,				pgfn_RegexMatch},
 #include "xpu_opcodes.h"
 	{FuncOpCode__Projection,                pgfn_Projection},
 	{FuncOpCode__LoadVars,                  pgfn_LoadVars},
@@ -338,6 +338,9 @@ typedef enum {
 	FuncOpCode__CaseWhenExpr,
 	FuncOpCode__ScalarArrayOpAny,
 	FuncOpCode__ScalarArrayOpAll,
+	FuncOpCode__ScalarArrayOpHash,
+	FuncOpCode__LikeMatch,
+	FuncOpCode__RegexMatch,
 #include "xpu_opcodes.h"
 	FuncOpCode__LoadVars = 9999,
 	FuncOpCode__MoveVars,
@@ -404,6 +407,8 @@ typedef union
 /*
  * kern_context - a set of run-time information
  */
+#define KERN_SCAN_QUALS_NSTATS		8	/* max # of per-qual statistics */
+
 typedef struct
 {
 	uint32_t		errcode;
@@ -437,6 +442,11 @@ typedef struct
 	 */
 	bool			kmode_compare_nulls;
 
+	/*
+	 * number of rows that passed through the Nth scan-quals (top-level AND)
+	 */
+	uint32_t		scan_quals_nitems[KERN_SCAN_QUALS_NSTATS];
+
 	/* variable length buffer */
 	char		   *vlpos;
 	char		   *vlend;
@@ -2145,6 +2155,113 @@ struct kern_varslot_desc
 
 #define KERN_EXPRESSION_MAGIC			(0x4b657870)	/* 'K' 'e' 'x' 'p' */
 
+/*
+ * kern_like_item - an element of LIKE/ILIKE pattern pre-compiled by the host
+ */
+#define KERN_LIKE_KIND__EXACT			1	/* 'abc' */
+#define KERN_LIKE_KIND__PREFIX			2	/* 'abc%' */
+#define KERN_LIKE_KIND__SUFFIX			3	/* '%abc' */
+#define KERN_LIKE_KIND__SUBSTR			4	/* '%abc%' */
+#define KERN_LIKE_KIND__GENERIC			5	/* any other patterns */
+
+#define KERN_LIKE_FLAG__NEGATIVE		0x0001U	/* NOT LIKE */
+#define KERN_LIKE_FLAG__ICASE			0x0002U	/* ILIKE; pattern is upper-cased */
+#define KERN_LIKE_FLAG__BYTEWISE		0x0004U	/* encoding allows byte-wise search */
+
+#define KERN_LIKE_ITEM__LITERAL			1	/* literal bytes */
+#define KERN_LIKE_ITEM__ANYCHARS		2	/* run of '_' */
+#define KERN_LIKE_ITEM__PERCENT			3	/* '%' */
+
+typedef struct
+{
+	uint16_t		kind;		/* one of KERN_LIKE_ITEM__* */
+	uint16_t		nchars;		/* number of '_', if ANYCHARS */
+	uint32_t		offset;		/* offset of the literal from u.like.data */
+	uint32_t		length;		/* length of the literal */
+} kern_like_item;
+
+/*
+ * kern_regex_program - regular expression pre-compiled by the host
+ *
+ * It is a position automaton (Glushkov NFA) of the pattern, and each bit of
+ * the uint64_t masks below represents a position (a character class) of
+ * the pattern, so the xPU device runs it as a bit-parallel NFA.
+ */
+#define KERN_REGEX_MAX_NPOS				64
+
+#define KERN_REGEX_FLAG__NEGATIVE		0x0001U	/* !~ */
+#define KERN_REGEX_FLAG__ICASE			0x0002U	/* ~* */
+#define KERN_REGEX_FLAG__UTF8			0x0004U	/* text is UTF-8 encoded */
+#define KERN_REGEX_FLAG__HEAD			0x0008U	/* anchored by '^' */
+#define KERN_REGEX_FLAG__TAIL			0x0010U	/* anchored by '$' */
+#define KERN_REGEX_FLAG__NULLABLE		0x0020U	/* matches an empty string */
+
+typedef struct
+{
+	uint32_t		lo;
+	uint32_t		hi;
+} kern_regex_range;
+
+typedef struct
+{
+	uint32_t		npos;			/* number of the positions */
+	uint32_t		nranges;		/* number of ranges[] */
+	uint64_t		first;			/* positions that may begin the match */
+	uint64_t		last;			/* positions that may end the match */
+	uint64_t		mb_any;			/* positions that match any non-ASCII chars */
+	uint64_t		mb_check;		/* positions that check ranges[] for
+									 * non-ASCII chars */
+	uint64_t		mb_negated;		/* mb_check positions, but negated */
+	uint64_t		ascii[128];		/* positions that match the ASCII char */
+	uint64_t		follow[KERN_REGEX_MAX_NPOS];	/* positions that may follow */
+	uint16_t		range_head[KERN_REGEX_MAX_NPOS];
+	uint16_t		range_nums[KERN_REGEX_MAX_NPOS];
+	kern_regex_range ranges[1];		/* non-ASCII code-point ranges */
+} kern_regex_program;
+
+/*
+ * kern_saop_hash - hashed IN-list of ScalarArrayOpHash
+ *
+ * 'SCALAR = ANY(ARRAY)' or 'SCALAR <> ALL(ARRAY)' with constant or
+ * parameter array of integer or date/time values is built to the open-
+ * addressing hash table of the 64bit keys by the host, then the xPU device
+ * probes it instead of the linear scan of the array.
+ * The hash table of the constant array is built on the planning time, and
+ * that of the parameter array is built on the session setup.
+ * 'keys[nslots]' is followed by the bitmap of the used slots, and at most
+ * half of the slots are used.
+ */
+#define KERN_SAOP_HASH_MIN_NITEMS		9		/* same as MIN_ARRAY_SIZE_FOR_HASHED_SAOP */
+
+#define KERN_SAOP_HASH_FLAG__NEGATIVE	0x0001U	/* <> ALL(ARRAY) */
+#define KERN_SAOP_HASH_FLAG__PARAM		0x0002U	/* array is a parameter */
+
+typedef struct
+{
+	uint32_t		nslots;			/* number of hash slots (2^N) */
+	uint32_t		nkeys;			/* number of distinct non-NULL keys */
+	uint32_t		nitems;			/* number of the array items */
+	bool			has_nulls;		/* array contains NULLs */
+	uint64_t		keys[1];
+} kern_saop_hash;
+
+#define KERN_SAOP_HASH_USEDMAP(__hash)					\
+	((uint32_t *)((__hash)->keys + (__hash)->nslots))
+#define KERN_SAOP_HASH_LENGTH(__nslots)					\
+	(offsetof(kern_saop_hash, keys[(__nslots)]) +		\
+	 sizeof(uint32_t) * (((__nslots) + 31) / 32))
+
+INLINE_FUNCTION(uint32_t)
+__saop_hash_key(uint64_t key)
+{
+	key ^= (key >> 33);
+	key *= 0xff51afd7ed558ccdUL;
+	key ^= (key >> 33);
+	key *= 0xc4ceb9fe1a85ec53UL;
+	key ^= (key >> 33);
+	return (uint32_t)key;
+}
+
 #define KEXP_FLAG__IS_PUSHED_DOWN		0x0001U
 
 #define SPECIAL_DEPTH__PREAGG_FINAL		(-2)
@@ -2190,6 +2307,26 @@ struct kern_expression
 			uint16_t	elem_slot_id;	/* slot-id of temporary array element */
 			char		data[1]			__MAXALIGNED__;
 		} saop;		/* ScalarArrayOp */
+		struct {
+			uint32_t	saop_flags;		/* mask of KERN_SAOP_HASH_FLAG__* */
+			uint32_t	param_id;		/* array parameter, if FLAG__PARAM */
+			char		data[1]			__MAXALIGNED__;	/* kern_saop_hash,
+														 * if constant */
+		} saop_hash;	/* ScalarArrayOpHash */
+		struct {
+			uint16_t	like_kind;		/* one of KERN_LIKE_KIND__* */
+			uint16_t	like_flags;		/* mask of KERN_LIKE_FLAG__* */
+			uint32_t	like_nitems;	/* number of kern_like_item (GENERIC) */
+			uint32_t	like_length;	/* length of the literal bytes */
+			char		data[1]			__MAXALIGNED__;
+		} like;		/* LikeMatch */
+		struct {
+			uint32_t	regex_flags;	/* mask of KERN_REGEX_FLAG__* */
+			uint32_t	pattern_offset;	/* offset of the original pattern
+										 * from u.regex.data (for EXPLAIN) */
+			uint32_t	pattern_len;	/* length of the original pattern */
+			char		data[1]			__MAXALIGNED__;	/* kern_regex_program */
+		} regex;	/* RegexMatch */
 		struct {
 			int			depth;
 			int			nitems;
@@ -2353,6 +2490,8 @@ typedef struct kern_session_info
 	uint32_t	groupby_prepfn_bufsz; /* buffer size for preagg functions */
 	float4_t	groupby_ngroups_estimation; /* planne's estimation of ngroups */
 	/* executor parameter buffer */
+	uint32_t	session_saop_hash;	/* offset to uint32_t[nparams+1] array of
+									 * kern_saop_hash offset, if any */
 	uint32_t	nparams;	/* number of parameters */
 	uint32_t	poffset[1];	/* offset of params */
 } kern_session_info;
@@ -2385,6 +2524,8 @@ typedef struct {
 	uint32_t	nitems_raw;		/* # of visible rows kept in the relation */
 	uint32_t	nitems_in;		/* # of result rows in depth-0 after WHERE-clause */
 	uint32_t	nitems_out;		/* # of result rows in final depth before host quals */
+	uint32_t	nitems_quals[KERN_SCAN_QUALS_NSTATS];	/* # of result rows
+														 * by each scan-quals */
 	uint32_t	num_rels;
 	struct {
 		uint32_t	nitems_gist;/* # of results rows by GiST index (if any) */
@@ -2668,6 +2809,19 @@ SESSION_ENCODE(kern_session_info *session)
 	return (struct xpu_encode_info *)((char *)session + session->session_encode);
 }
 
+INLINE_FUNCTION(const kern_saop_hash *)
+SESSION_SAOP_HASH(kern_session_info *session, uint32_t param_id)
+{
+	const uint32_t *offsets;
+
+	if (session->session_saop_hash == 0 || param_id > session->nparams)
+		return NULL;
+	offsets = (const uint32_t *)((char *)session + session->session_saop_hash);
+	if (offsets[param_id] == 0)
+		return NULL;	/* NULL array */
+	return (const kern_saop_hash *)((char *)session + offsets[param_id]);
+}
+
 /* ----------------------------------------------------------------
  *
  * Template for xPU connection commands receive
@@ -2882,6 +3036,9 @@ ExecKernProjection(kern_context *kcxt,
 #define DEVONLY_FUNC_OPCODE(a,NAME,b,c,d)	\
 	EXTERN_DATA bool pgfn_##NAME(XPU_PGFUNCTION_ARGS);
 #include "xpu_opcodes.h"
+/* LIKE/ILIKE and regular expression with pre-compiled pattern (xpu_textlib.cu) */
+EXTERN_DATA bool pgfn_LikeMatch(XPU_PGFUNCTION_ARGS);
+EXTERN_DATA bool pgfn_RegexMatch(XPU_PGFUNCTION_ARGS);
 
 /* ----------------------------------------------------------------
  *
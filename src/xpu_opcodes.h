@@ -696,6 +696,17 @@ __FUNC_OPCODE(bpchariclike, bpchar/text, 800, NULL)
 __FUNC_OPCODE(texticnlike, text/text, 800, NULL)
 __FUNC_OPCODE(bpcharicnlike, bpchar/text, 800, NULL)
 
+/* Regular expression operators (pre-compiled to RegexMatch by codegen) */
+__FUNC_OPCODE(textregexeq, text/text, 800, NULL)
+__FUNC_OPCODE(textregexne, text/text, 800, NULL)
+__FUNC_OPCODE(texticregexeq, text/text, 800, NULL)
+__FUNC_OPCODE(texticregexne, text/text, 800, NULL)
+__FUNC_OPCODE(bpcharregexeq, bpchar/text, 800, NULL)
+__FUNC_OPCODE(bpcharregexne, bpchar/text, 800, NULL)
+__FUNC_OPCODE(bpcharicregexeq, bpchar/text, 800, NULL)
+__FUNC_OPCODE(bpcharicregexne, bpchar/text, 800, NULL)
+__FUNC_OPCODE(regexp_like, text/text, 800, NULL)
+
 /* String operations */
 FUNC_OPCODE(substr,    text/int4/int4, DEVKIND__ANY, substr,    20, NULL)
 FUNC_OPCODE(substring, text/int4/int4, DEVKIND__ANY, substring, 20, NULL)
@@ -1151,6 +1151,438 @@ PG_BPCHARLIKE_TEMPLATE(bpcharnlike, GenericMatchText, !=)
 PG_BPCHARLIKE_TEMPLATE(bpchariclike, GenericCaseMatchText, ==)
 PG_BPCHARLIKE_TEMPLATE(bpcharicnlike, GenericCaseMatchText, !=)
 
+/*
+ * LIKE/ILIKE with pre-compiled pattern
+ *
+ * Constant patterns are classified by the host code into exact, prefix,
+ * suffix or sub-string match, and others are compiled into a sequence of
+ * literals and wildcards (kern_like_item). It neither re-parses the pattern
+ * for each row nor recurses, unlike GenericMatchText above.
+ */
+INLINE_FUNCTION(char)
+__like_getchar(char c, bool icase)
+{
+	return (icase && c >= 'a' && c <= 'z' ? c + ('A' - 'a') : c);
+}
+
+INLINE_FUNCTION(bool)
+__like_match_bytes(const char *t, const char *p, int len, bool icase)
+{
+	if (!icase)
+		return (__memcmp(t, p, len) == 0);
+	for (int i=0; i < len; i++)
+	{
+		if (__like_getchar(t[i], true) != p[i])
+			return false;
+	}
+	return true;
+}
+
+STATIC_FUNCTION(bool)
+__like_match_suffix(const xpu_encode_info *encode,
+					const char *t, int tlen,
+					const char *p, int plen,
+					uint32_t like_flags)
+{
+	if (tlen < plen)
+		return false;
+	if ((like_flags & KERN_LIKE_FLAG__BYTEWISE) == 0)
+	{
+		/* the suffix must begin at the character boundary */
+		int		pos = 0;
+
+		while (pos < tlen - plen)
+			pos += encode->enc_mblen(t + pos);
+		if (pos != tlen - plen)
+			return false;
+	}
+	return __like_match_bytes(t + tlen - plen, p, plen,
+							  (like_flags & KERN_LIKE_FLAG__ICASE) != 0);
+}
+
+STATIC_FUNCTION(bool)
+__like_match_substr(const xpu_encode_info *encode,
+					const char *t, int tlen,
+					const char *p, int plen,
+					uint32_t like_flags)
+{
+	bool	icase = ((like_flags & KERN_LIKE_FLAG__ICASE) != 0);
+	bool	bytewise = ((like_flags & KERN_LIKE_FLAG__BYTEWISE) != 0);
+	char	c_head, c_tail;
+	int		pos = 0;
+
+	if (plen == 0)
+		return true;
+	/*
+	 * Compare the first and the last byte of the literal at first, then
+	 * run the full comparison only on the candidate positions.
+	 */
+	c_head = p[0];
+	c_tail = p[plen-1];
+	while (pos + plen <= tlen)
+	{
+		const char *s = t + pos;
+
+		if (__like_getchar(s[0], icase) == c_head &&
+			__like_getchar(s[plen-1], icase) == c_tail &&
+			__like_match_bytes(s, p, plen, icase))
+			return true;
+		pos += (bytewise ? 1 : encode->enc_mblen(s));
+	}
+	return false;
+}
+
+/*
+ * __like_match_segment - returns the length of text that matched to
+ * the segment (items without '%'), or -1 if not matched.
+ */
+STATIC_FUNCTION(int)
+__like_match_segment(const xpu_encode_info *encode,
+					 const char *t, int tlen,
+					 const kern_like_item *items, int nitems,
+					 const char *base, bool icase)
+{
+	int		pos = 0;
+
+	for (int i=0; i < nitems; i++)
+	{
+		const kern_like_item *item = &items[i];
+
+		if (item->kind == KERN_LIKE_ITEM__LITERAL)
+		{
+			if (tlen - pos < item->length ||
+				!__like_match_bytes(t + pos, base + item->offset,
+									item->length, icase))
+				return -1;
+			pos += item->length;
+		}
+		else
+		{
+			assert(item->kind == KERN_LIKE_ITEM__ANYCHARS);
+			for (int j=0; j < item->nchars; j++)
+			{
+				if (pos >= tlen)
+					return -1;
+				pos += encode->enc_mblen(t + pos);
+			}
+			if (pos > tlen)
+				return -1;
+		}
+	}
+	return pos;
+}
+
+STATIC_FUNCTION(bool)
+__like_match_generic(const xpu_encode_info *encode,
+					 const char *t, int tlen,
+					 const kern_expression *kexp)
+{
+	const kern_like_item *items = (const kern_like_item *)kexp->u.like.data;
+	const char *base = kexp->u.like.data;
+	int		nitems = kexp->u.like.like_nitems;
+	bool	icase = ((kexp->u.like.like_flags & KERN_LIKE_FLAG__ICASE) != 0);
+	int		pos = 0;
+	int		i, j, sz;
+
+	/* the head segment must match at the beginning */
+	for (j=0; j < nitems && items[j].kind != KERN_LIKE_ITEM__PERCENT; j++);
+	if (j > 0)
+	{
+		sz = __like_match_segment(encode, t, tlen, items, j, base, icase);
+		if (sz < 0)
+			return false;
+		pos = sz;
+	}
+	if (j >= nitems)
+		return (pos == tlen);
+	/*
+	 * Any other segments follow '%'. It is sufficient to take the leftmost
+	 * match for the middle segments, because it leaves the longest text for
+	 * the remaining segments. Only the tail segment must end with the text.
+	 */
+	for (i=j+1; i < nitems; i=j+1)
+	{
+		for (j=i; j < nitems && items[j].kind != KERN_LIKE_ITEM__PERCENT; j++);
+		for (;;)
+		{
+			sz = __like_match_segment(encode, t + pos, tlen - pos,
+									  items + i, j - i, base, icase);
+			if (sz >= 0 && (j < nitems || pos + sz == tlen))
+				break;
+			if (pos >= tlen)
+				return false;
+			pos += encode->enc_mblen(t + pos);
+		}
+		pos += sz;
+	}
+	return true;
+}
+
+/*
+ * __exec_textlike_argument - fetch the text or bpchar argument of
+ * LikeMatch and RegexMatch
+ */
+STATIC_FUNCTION(bool)
+__exec_textlike_argument(kern_context *kcxt,
+						 const kern_expression *kexp,
+						 const char **p_str, int *p_len)
+{
+	const kern_expression *karg = KEXP_FIRST_ARG(kexp);
+
+	assert(kexp->exptype == TypeOpCode__bool &&
+		   kexp->nr_args == 1);
+	if (karg->exptype == TypeOpCode__bpchar)
+	{
+		xpu_bpchar_t	datum;
+
+		assert(KEXP_IS_VALID(karg, bpchar));
+		if (!EXEC_KERN_EXPRESSION(kcxt, karg, &datum))
+			return false;
+		if (XPU_DATUM_ISNULL(&datum))
+			*p_str = NULL;
+		else if (!xpu_bpchar_is_valid(kcxt, &datum))
+			return false;
+		else
+		{
+			*p_str = datum.value;
+			*p_len = datum.length;
+		}
+	}
+	else
+	{
+		xpu_text_t		datum;
+
+		assert(KEXP_IS_VALID(karg, text));
+		if (!EXEC_KERN_EXPRESSION(kcxt, karg, &datum))
+			return false;
+		if (XPU_DATUM_ISNULL(&datum))
+			*p_str = NULL;
+		else if (!xpu_text_is_valid(kcxt, &datum))
+			return false;
+		else
+		{
+			*p_str = datum.value;
+			*p_len = datum.length;
+		}
+	}
+	return true;
+}
+
+PUBLIC_FUNCTION(bool)
+pgfn_LikeMatch(XPU_PGFUNCTION_ARGS)
+{
+	xpu_bool_t *result = (xpu_bool_t *)__result;
+	const xpu_encode_info *encode = SESSION_ENCODE(kcxt->session);
+	const char *lit = kexp->u.like.data;
+	int			lit_len = kexp->u.like.like_length;
+	uint32_t	like_flags = kexp->u.like.like_flags;
+	bool		icase = ((like_flags & KERN_LIKE_FLAG__ICASE) != 0);
+	const char *str;
+	int			len;
+	bool		matched;
+
+	if (!__exec_textlike_argument(kcxt, kexp, &str, &len))
+		return false;
+	if (!str)
+	{
+		result->expr_ops = NULL;
+		return true;
+	}
+
+	switch (kexp->u.like.like_kind)
+	{
+		case KERN_LIKE_KIND__EXACT:
+			matched = (len == lit_len &&
+					   __like_match_bytes(str, lit, lit_len, icase));
+			break;
+		case KERN_LIKE_KIND__PREFIX:
+			matched = (len >= lit_len &&
+					   __like_match_bytes(str, lit, lit_len, icase));
+			break;
+		case KERN_LIKE_KIND__SUFFIX:
+			matched = __like_match_suffix(encode, str, len,
+										  lit, lit_len, like_flags);
+			break;
+		case KERN_LIKE_KIND__SUBSTR:
+			matched = __like_match_substr(encode, str, len,
+										  lit, lit_len, like_flags);
+			break;
+		case KERN_LIKE_KIND__GENERIC:
+			matched = __like_match_generic(encode, str, len, kexp);
+			break;
+		default:
+			STROM_ELOG(kcxt, "unknown LIKE pattern kind");
+			return false;
+	}
+	result->expr_ops = &xpu_bool_ops;
+	result->value = (matched != ((like_flags & KERN_LIKE_FLAG__NEGATIVE) != 0));
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Routines to support regular expression
+ *
+ * The host code compiles constant patterns to kern_regex_program, that is
+ * a position automaton (Glushkov NFA) with up to 64 positions. It runs as
+ * a bit-parallel NFA; the set of active positions is a uint64_t mask.
+ * ---------------------------------------------------------------- */
+INLINE_FUNCTION(int)
+__regex_ffs64(uint64_t mask)
+{
+#ifdef __CUDACC__
+	return __ffsll((long long)mask);
+#else
+	return __builtin_ffsll((long long)mask);
+#endif
+}
+
+INLINE_FUNCTION(uint32_t)
+__regex_next_char(const char *str, int len, int *p_pos, bool utf8)
+{
+	const unsigned char *s = (const unsigned char *)str + *p_pos;
+	int			remain = len - *p_pos;
+	uint32_t	c = s[0];
+
+	if (c < 0x80 || !utf8)
+	{
+		*p_pos += 1;
+		return c;
+	}
+	if ((c & 0xe0) == 0xc0 && remain >= 2)
+	{
+		*p_pos += 2;
+		return (((c & 0x1f) << 6) |
+				((uint32_t)(s[1] & 0x3f)));
+	}
+	if ((c & 0xf0) == 0xe0 && remain >= 3)
+	{
+		*p_pos += 3;
+		return (((c & 0x0f) << 12) |
+				((uint32_t)(s[1] & 0x3f) << 6) |
+				((uint32_t)(s[2] & 0x3f)));
+	}
+	if ((c & 0xf8) == 0xf0 && remain >= 4)
+	{
+		*p_pos += 4;
+		return (((c & 0x07) << 18) |
+				((uint32_t)(s[1] & 0x3f) << 12) |
+				((uint32_t)(s[2] & 0x3f) << 6) |
+				((uint32_t)(s[3] & 0x3f)));
+	}
+	/* broken sequence; consumes a byte as a non-ASCII character */
+	*p_pos += 1;
+	return c;
+}
+
+/*
+ * __regex_char_mask - positions that match the character
+ */
+INLINE_FUNCTION(uint64_t)
+__regex_char_mask(const kern_regex_program *prog, uint32_t code)
+{
+	uint64_t	mask;
+	uint64_t	checks;
+
+	if (code < 128)
+		return prog->ascii[code];
+	mask = prog->mb_any;
+	for (checks = prog->mb_check; checks != 0; checks &= (checks - 1))
+	{
+		int		i = __regex_ffs64(checks) - 1;
+		const kern_regex_range *r = prog->ranges + prog->range_head[i];
+		bool	found = false;
+
+		for (int k=0; k < prog->range_nums[i]; k++)
+		{
+			if (code >= r[k].lo && code <= r[k].hi)
+			{
+				found = true;
+				break;
+			}
+		}
+		if (found != (((prog->mb_negated >> i) & 1) != 0))
+			mask |= (1UL << i);
+	}
+	return mask;
+}
+
+STATIC_FUNCTION(bool)
+__regex_match(const kern_regex_program *prog, uint32_t regex_flags,
+			  const char *str, int len)
+{
+	bool		utf8 = ((regex_flags & KERN_REGEX_FLAG__UTF8) != 0);
+	bool		head = ((regex_flags & KERN_REGEX_FLAG__HEAD) != 0);
+	bool		tail = ((regex_flags & KERN_REGEX_FLAG__TAIL) != 0);
+	uint64_t	state = 0;
+	int			pos = 0;
+
+	if ((regex_flags & KERN_REGEX_FLAG__NULLABLE) != 0 &&
+		(!head || !tail || len == 0))
+		return true;
+	while (pos < len)
+	{
+		uint64_t	next = ((head && pos > 0) ? 0 : prog->first);
+		uint32_t	code;
+
+		/* follow-set of the active positions */
+		for (; state != 0; state &= (state - 1))
+			next |= prog->follow[__regex_ffs64(state) - 1];
+		code = __regex_next_char(str, len, &pos, utf8);
+		state = (next & __regex_char_mask(prog, code));
+		if (!tail && (state & prog->last) != 0)
+			return true;
+		if (head && state == 0)
+			return false;
+	}
+	return (tail && (state & prog->last) != 0);
+}
+
+PUBLIC_FUNCTION(bool)
+pgfn_RegexMatch(XPU_PGFUNCTION_ARGS)
+{
+	xpu_bool_t *result = (xpu_bool_t *)__result;
+	const kern_regex_program *prog = (const kern_regex_program *)
+		kexp->u.regex.data;
+	uint32_t	regex_flags = kexp->u.regex.regex_flags;
+	const char *str;
+	int			len;
+	bool		matched;
+
+	if (!__exec_textlike_argument(kcxt, kexp, &str, &len))
+		return false;
+	if (!str)
+	{
+		result->expr_ops = NULL;
+		return true;
+	}
+	matched = __regex_match(prog, regex_flags, str, len);
+	result->expr_ops = &xpu_bool_ops;
+	result->value = (matched != ((regex_flags & KERN_REGEX_FLAG__NEGATIVE) != 0));
+	return true;
+}
+
+/*
+ * Regular expression operators are always replaced by RegexMatch with
+ * the pattern pre-compiled by the host code, or not pushed down.
+ */
+#define PG_REGEX_NOT_COMPILED_TEMPLATE(FN_NAME)							\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##FN_NAME(XPU_PGFUNCTION_ARGS)									\
+	{																	\
+		STROM_ELOG(kcxt, "regular expression is not pre-compiled");		\
+		return false;													\
+	}
+PG_REGEX_NOT_COMPILED_TEMPLATE(textregexeq)
+PG_REGEX_NOT_COMPILED_TEMPLATE(textregexne)
+PG_REGEX_NOT_COMPILED_TEMPLATE(texticregexeq)
+PG_REGEX_NOT_COMPILED_TEMPLATE(texticregexne)
+PG_REGEX_NOT_COMPILED_TEMPLATE(bpcharregexeq)
+PG_REGEX_NOT_COMPILED_TEMPLATE(bpcharregexne)
+PG_REGEX_NOT_COMPILED_TEMPLATE(bpcharicregexeq)
+PG_REGEX_NOT_COMPILED_TEMPLATE(bpcharicregexne)
+PG_REGEX_NOT_COMPILED_TEMPLATE(regexp_like)
+
 /*
  * Sub-string
  */
@@ -85,6 +85,111 @@ SELECT id,z INTO test03p FROM regtest_data
 (SELECT * FROM test03g EXCEPT SELECT * FROM test03p);
 (SELECT * FROM test03p EXCEPT SELECT * FROM test03g);
 
+-- hash-based ScalarArrayOp for the arrays with many items
+CREATE TABLE rt_saop (
+  id    int,
+  a     int,
+  b     numeric(9,2),
+  c     text
+);
+INSERT INTO rt_saop (
+  SELECT x, CASE WHEN x % 97 = 0 THEN NULL ELSE x % 1000 END,
+            CASE WHEN x % 89 = 0 THEN NULL ELSE (x % 500)::numeric / 4.0 END,
+            CASE WHEN x % 83 = 0 THEN NULL ELSE 'k' || (x % 300)::text END
+    FROM generate_series(1,5000) x
+);
+VACUUM ANALYZE rt_saop;
+-- int4 array; below and above the threshold of hashing, with NULLs
+SET pg_strom.enabled = on;
+SELECT id, a = ANY('{1,2,3,5,8,13,21,34}'::int[]) v1,
+           a = ANY('{1,2,3,5,8,13,21,34,55}'::int[]) v2,
+           a = ANY('{1,2,3,5,8,13,21,34,55,NULL}'::int[]) v3,
+           a <> ALL('{1,2,3,5,8,13,21,34}'::int[]) v4,
+           a <> ALL('{1,2,3,5,8,13,21,34,55}'::int[]) v5,
+           a <> ALL('{1,2,3,5,8,13,21,34,55,NULL}'::int[]) v6,
+           a IN (2,4,6,8,10,12,14,16,18,20) v7,
+           a NOT IN (2,4,6,8,10,12,14,16,18,NULL) v8
+  INTO test10g
+  FROM rt_saop
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, a = ANY('{1,2,3,5,8,13,21,34}'::int[]) v1,
+           a = ANY('{1,2,3,5,8,13,21,34,55}'::int[]) v2,
+           a = ANY('{1,2,3,5,8,13,21,34,55,NULL}'::int[]) v3,
+           a <> ALL('{1,2,3,5,8,13,21,34}'::int[]) v4,
+           a <> ALL('{1,2,3,5,8,13,21,34,55}'::int[]) v5,
+           a <> ALL('{1,2,3,5,8,13,21,34,55,NULL}'::int[]) v6,
+           a IN (2,4,6,8,10,12,14,16,18,20) v7,
+           a NOT IN (2,4,6,8,10,12,14,16,18,NULL) v8
+  INTO test10p
+  FROM rt_saop
+ WHERE id > 0;
+(SELECT * FROM test10g EXCEPT SELECT * FROM test10p) ORDER BY id;
+(SELECT * FROM test10p EXCEPT SELECT * FROM test10g) ORDER BY id;
+-- numeric and text array
+SET pg_strom.enabled = on;
+SELECT id, b = ANY('{0.25,1.50,2.75,10.00,33.25,50.50,NULL,99.75,100.00,124.75}'::numeric[]) v1,
+           b <> ALL('{0.25,1.50,2.75,10.00,33.25,50.50,NULL,99.75,100.00,124.75}'::numeric[]) v2,
+           c = ANY('{k1,k10,k100,k2,k20,k200,k3,k30}'::text[]) v3,
+           c = ANY('{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]) v4,
+           c <> ALL('{k1,k10,k100,k2,k20,k200,k3,k30}'::text[]) v5,
+           c <> ALL('{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]) v6
+  INTO test11g
+  FROM rt_saop
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, b = ANY('{0.25,1.50,2.75,10.00,33.25,50.50,NULL,99.75,100.00,124.75}'::numeric[]) v1,
+           b <> ALL('{0.25,1.50,2.75,10.00,33.25,50.50,NULL,99.75,100.00,124.75}'::numeric[]) v2,
+           c = ANY('{k1,k10,k100,k2,k20,k200,k3,k30}'::text[]) v3,
+           c = ANY('{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]) v4,
+           c <> ALL('{k1,k10,k100,k2,k20,k200,k3,k30}'::text[]) v5,
+           c <> ALL('{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]) v6
+  INTO test11p
+  FROM rt_saop
+ WHERE id > 0;
+(SELECT * FROM test11g EXCEPT SELECT * FROM test11p) ORDER BY id;
+(SELECT * FROM test11p EXCEPT SELECT * FROM test11g) ORDER BY id;
+-- in the scan qualifiers
+SET pg_strom.enabled = on;
+SELECT * INTO test12g FROM rt_saop
+ WHERE a = ANY('{1,2,3,5,8,13,21,34,55,NULL}'::int[]) OR c = ANY('{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]);
+SET pg_strom.enabled = off;
+SELECT * INTO test12p FROM rt_saop
+ WHERE a = ANY('{1,2,3,5,8,13,21,34,55,NULL}'::int[]) OR c = ANY('{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]);
+(SELECT * FROM test12g EXCEPT SELECT * FROM test12p) ORDER BY id;
+(SELECT * FROM test12p EXCEPT SELECT * FROM test12g) ORDER BY id;
+SET pg_strom.enabled = on;
+SELECT * INTO test13g FROM rt_saop
+ WHERE a <> ALL('{1,2,3,5,8,13,21,34,55}'::int[]) AND b <> ALL('{0.25,1.50,2.75,10.00,33.25,50.50,NULL,99.75,100.00,124.75}'::numeric[]);
+SET pg_strom.enabled = off;
+SELECT * INTO test13p FROM rt_saop
+ WHERE a <> ALL('{1,2,3,5,8,13,21,34,55}'::int[]) AND b <> ALL('{0.25,1.50,2.75,10.00,33.25,50.50,NULL,99.75,100.00,124.75}'::numeric[]);
+(SELECT * FROM test13g EXCEPT SELECT * FROM test13p) ORDER BY id;
+(SELECT * FROM test13p EXCEPT SELECT * FROM test13g) ORDER BY id;
+-- array parameters of the generic plan
+SET plan_cache_mode = force_generic_plan;
+PREPARE saop_g(int[], text[]) AS
+SELECT id, a = ANY($1) v1, a <> ALL($1) v2, c = ANY($2) v3, c <> ALL($2) v4
+  FROM rt_saop
+ WHERE id > 0;
+PREPARE saop_p(int[], text[]) AS
+SELECT id, a = ANY($1) v1, a <> ALL($1) v2, c = ANY($2) v3, c <> ALL($2) v4
+  FROM rt_saop
+ WHERE id > 0;
+SET pg_strom.enabled = on;
+CREATE TABLE test14g AS EXECUTE saop_g('{1,2,3,5,8,13,21,34,55,NULL}'::int[], '{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]);
+CREATE TABLE test15g AS EXECUTE saop_g('{1,2,3,5,8,13,21,34}'::int[], '{k1,k10,k100,k2,k20,k200,k3,k30}'::text[]);
+SET pg_strom.enabled = off;
+CREATE TABLE test14p AS EXECUTE saop_p('{1,2,3,5,8,13,21,34,55,NULL}'::int[], '{k1,k10,k100,k2,k20,k200,k3,k30,k299,NULL,k4,k40}'::text[]);
+CREATE TABLE test15p AS EXECUTE saop_p('{1,2,3,5,8,13,21,34}'::int[], '{k1,k10,k100,k2,k20,k200,k3,k30}'::text[]);
+(SELECT * FROM test14g EXCEPT SELECT * FROM test14p) ORDER BY id;
+(SELECT * FROM test14p EXCEPT SELECT * FROM test14g) ORDER BY id;
+(SELECT * FROM test15g EXCEPT SELECT * FROM test15p) ORDER BY id;
+(SELECT * FROM test15p EXCEPT SELECT * FROM test15g) ORDER BY id;
+DEALLOCATE saop_g;
+DEALLOCATE saop_p;
+RESET plan_cache_mode;
+
 -- TODO: array operation on fdw_arrow
 
 -- should be empty result
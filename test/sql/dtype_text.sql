@@ -306,6 +306,216 @@ SELECT id, length(tc1) v1,
 (SELECT * FROM test32g EXCEPT SELECT * FROM test32p) ORDER BY id;
 (SELECT * FROM test32p EXCEPT SELECT * FROM test32g) ORDER BY id;
 
+-- pre-compiled LIKE / ILIKE matchers, including multibyte text
+CREATE TABLE rt_mbtext (
+  id    int,
+  bc    char(80)    COLLATE "C",
+  tc    text        COLLATE "C"
+);
+INSERT INTO rt_mbtext (
+  SELECT x, CASE x % 5
+            WHEN 0 THEN md5(x::text)
+            WHEN 1 THEN 'データベース' || md5(x::text) || 'です'
+            WHEN 2 THEN upper(md5(x::text)) || 'ＧＰＵ' || repeat('_', x % 3)
+            WHEN 3 THEN 'ÀÉÎ' || md5((x / 3)::text) || 'ｱｲｳ%'
+            ELSE NULL
+            END,
+            CASE x % 5
+            WHEN 0 THEN 'データベース' || md5(x::text) || 'です'
+            WHEN 1 THEN upper(md5(x::text)) || 'ＧＰＵ' || repeat('_', x % 3)
+            WHEN 2 THEN 'ÀÉÎ' || md5((x / 3)::text) || 'ｱｲｳ%'
+            WHEN 3 THEN md5(x::text)
+            ELSE NULL
+            END
+    FROM generate_series(1,4000) x
+);
+VACUUM ANALYZE rt_mbtext;
+-- prefix, suffix, substring and generic patterns
+SET pg_strom.enabled = on;
+SELECT id, tc LIKE 'データ%' v1,
+           tc LIKE '%です' v2,
+           tc LIKE '%ＧＰＵ%' v3,
+           tc LIKE 'ÀÉÎ%' v4,
+           tc LIKE '%ｱｲｳ\%' v5,
+           tc LIKE '%a%b%c%' v6
+  INTO test40g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc LIKE 'データ%' v1,
+           tc LIKE '%です' v2,
+           tc LIKE '%ＧＰＵ%' v3,
+           tc LIKE 'ÀÉÎ%' v4,
+           tc LIKE '%ｱｲｳ\%' v5,
+           tc LIKE '%a%b%c%' v6
+  INTO test40p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test40g EXCEPT SELECT * FROM test40p) ORDER BY id;
+(SELECT * FROM test40p EXCEPT SELECT * FROM test40g) ORDER BY id;
+-- runs of '_' over multibyte characters
+SET pg_strom.enabled = on;
+SELECT id, tc LIKE 'デ__ベ%' v1,
+           tc LIKE '%ＧＰ_' v2,
+           tc LIKE '%_____' v3,
+           tc LIKE '___%ｱ_ｳ_' v4,
+           tc LIKE '%\_\_' v5,
+           tc LIKE '%ＧＰＵ__' v6
+  INTO test41g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc LIKE 'デ__ベ%' v1,
+           tc LIKE '%ＧＰ_' v2,
+           tc LIKE '%_____' v3,
+           tc LIKE '___%ｱ_ｳ_' v4,
+           tc LIKE '%\_\_' v5,
+           tc LIKE '%ＧＰＵ__' v6
+  INTO test41p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test41g EXCEPT SELECT * FROM test41p) ORDER BY id;
+(SELECT * FROM test41p EXCEPT SELECT * FROM test41g) ORDER BY id;
+-- empty, exact and negative patterns
+SET pg_strom.enabled = on;
+SELECT id, tc LIKE '' v1,
+           tc LIKE '%' v2,
+           tc LIKE '%%%' v3,
+           tc NOT LIKE '%ＧＰＵ%' v4,
+           tc NOT LIKE 'ÀÉ%ｳ_' v5,
+           tc LIKE md5('1') v6
+  INTO test42g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc LIKE '' v1,
+           tc LIKE '%' v2,
+           tc LIKE '%%%' v3,
+           tc NOT LIKE '%ＧＰＵ%' v4,
+           tc NOT LIKE 'ÀÉ%ｳ_' v5,
+           tc LIKE md5('1') v6
+  INTO test42p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test42g EXCEPT SELECT * FROM test42p) ORDER BY id;
+(SELECT * FROM test42p EXCEPT SELECT * FROM test42g) ORDER BY id;
+-- LIKE on bpchar (with padding spaces)
+SET pg_strom.enabled = on;
+SELECT id, bc LIKE 'データ%' v1,
+           bc LIKE '%です' v2,
+           bc LIKE '%です%' v3,
+           bc LIKE '%ｱｲｳ\%%' v4,
+           bc NOT LIKE '%ＧＰＵ_%' v5,
+           bc LIKE '%' v6
+  INTO test43g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, bc LIKE 'データ%' v1,
+           bc LIKE '%です' v2,
+           bc LIKE '%です%' v3,
+           bc LIKE '%ｱｲｳ\%%' v4,
+           bc NOT LIKE '%ＧＰＵ_%' v5,
+           bc LIKE '%' v6
+  INTO test43p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test43g EXCEPT SELECT * FROM test43p) ORDER BY id;
+(SELECT * FROM test43p EXCEPT SELECT * FROM test43g) ORDER BY id;
+-- ILIKE
+SET pg_strom.enabled = on;
+SELECT id, tc ILIKE 'abc%' v1,
+           tc ILIKE '%DEF' v2,
+           tc ILIKE '%gpu%' v3,
+           tc ILIKE 'àéî%' v4,
+           tc NOT ILIKE '%A_C%' v5,
+           bc ILIKE '%ＧＰＵ%' v6
+  INTO test44g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc ILIKE 'abc%' v1,
+           tc ILIKE '%DEF' v2,
+           tc ILIKE '%gpu%' v3,
+           tc ILIKE 'àéî%' v4,
+           tc NOT ILIKE '%A_C%' v5,
+           bc ILIKE '%ＧＰＵ%' v6
+  INTO test44p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test44g EXCEPT SELECT * FROM test44p) ORDER BY id;
+(SELECT * FROM test44p EXCEPT SELECT * FROM test44g) ORDER BY id;
+
+-- regular expressions: anchors, alternation and bounds
+SET pg_strom.enabled = on;
+SELECT id, tc ~ '^データ' v1,
+           tc ~ 'です$' v2,
+           tc ~ '^[0-9a-f]+$' v3,
+           tc ~ '(ＧＰＵ|ｱｲｳ|beef)' v4,
+           tc ~ '[0-9]{3}' v5,
+           tc ~ '^.{32}$' v6
+  INTO test50g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc ~ '^データ' v1,
+           tc ~ 'です$' v2,
+           tc ~ '^[0-9a-f]+$' v3,
+           tc ~ '(ＧＰＵ|ｱｲｳ|beef)' v4,
+           tc ~ '[0-9]{3}' v5,
+           tc ~ '^.{32}$' v6
+  INTO test50p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test50g EXCEPT SELECT * FROM test50p) ORDER BY id;
+(SELECT * FROM test50p EXCEPT SELECT * FROM test50g) ORDER BY id;
+-- regular expressions: classes, case-insensitive and negative matches
+SET pg_strom.enabled = on;
+SELECT id, tc ~ '\d\d[a-f]' v1,
+           tc ~* '^ABC' v2,
+           tc ~* 'ＧＰＵ_{2}$' v3,
+           tc !~ '[a-c]{2,3}' v4,
+           tc !~* '^àé' v5,
+           tc ~ 'a{2,}' v6
+  INTO test51g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc ~ '\d\d[a-f]' v1,
+           tc ~* '^ABC' v2,
+           tc ~* 'ＧＰＵ_{2}$' v3,
+           tc !~ '[a-c]{2,3}' v4,
+           tc !~* '^àé' v5,
+           tc ~ 'a{2,}' v6
+  INTO test51p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test51g EXCEPT SELECT * FROM test51p) ORDER BY id;
+(SELECT * FROM test51p EXCEPT SELECT * FROM test51g) ORDER BY id;
+-- regexp_like(), and regular expressions not pushed down (back-references, lookahead, non-constant patterns)
+SET pg_strom.enabled = on;
+SELECT id, tc ~ '(a)\1' v1,
+           tc ~ 'a(?=b)' v2,
+           tc ~ '\m[0-9]' v3,
+           regexp_like(tc, 'ＧＰＵ', 'i') v4,
+           regexp_like(tc, '^[A-F0-9]+') v5,
+           tc ~ rtrim(bc) v6
+  INTO test52g
+  FROM rt_mbtext
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, tc ~ '(a)\1' v1,
+           tc ~ 'a(?=b)' v2,
+           tc ~ '\m[0-9]' v3,
+           regexp_like(tc, 'ＧＰＵ', 'i') v4,
+           regexp_like(tc, '^[A-F0-9]+') v5,
+           tc ~ rtrim(bc) v6
+  INTO test52p
+  FROM rt_mbtext
+ WHERE id > 0;
+(SELECT * FROM test52g EXCEPT SELECT * FROM test52p) ORDER BY id;
+(SELECT * FROM test52p EXCEPT SELECT * FROM test52g) ORDER BY id;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA regtest_dtype_text_temp CASCADE;
@@ -339,9 +339,78 @@ SELECT corrupted IS false FROM pgstrom.gpucache_info WHERE table_name='cache_cor
 EXPLAIN (costs off, verbose)
 SELECT count(*) FROM cache_corruption_test;
 
+---
+--- host-resident GPU Cache
+---
+CREATE TABLE cache_host_table (
+  id   int,
+  a    int4,
+  h    text
+);
+-- large enough to be loaded by the parallel workers
+INSERT INTO cache_host_table (
+  SELECT x, x % 1000, repeat(md5(x::text), 6)
+  FROM generate_series(1,400000) x
+);
+CREATE TRIGGER row_sync_host AFTER INSERT OR UPDATE OR DELETE ON cache_host_table FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger('max_num_rows=500000,redo_buffer_size=150m,host_resident=on');
+CREATE TRIGGER stmt_sync_host AFTER TRUNCATE ON cache_host_table FOR STATEMENT
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger();
+ALTER TABLE cache_host_table ENABLE ALWAYS TRIGGER row_sync_host;
+ALTER TABLE cache_host_table ENABLE ALWAYS TRIGGER stmt_sync_host;
+-- parallel initial loading, with the rows in-flight by the current transaction
+SET pg_strom.gpucache_load_parallel_workers = 4;
+BEGIN;
+DELETE FROM cache_host_table WHERE id % 100 = 1;
+UPDATE cache_host_table SET a = a + 1 WHERE id % 100 = 2;
+INSERT INTO cache_host_table (
+  SELECT x, x % 1000, md5(x::text)
+  FROM generate_series(400001,401000) x
+);
+COMMIT;
+RESET pg_strom.gpucache_load_parallel_workers;
+SELECT phase FROM pgstrom.gpucache_info WHERE table_name='cache_host_table' AND database_name=current_database();
+-- Copy the records to normal table(without GPU Cache)
+SET pg_strom.enable_gpucache = off;
+SELECT * INTO TEMPORARY normal_host_table FROM cache_host_table;
+RESET pg_strom.enable_gpucache;
+-- no rows are loaded twice
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM cache_host_table EXCEPT ALL SELECT * FROM normal_host_table) t;
+-- host-side scan on GPU Cache
+SET max_parallel_workers_per_gather = 0;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM cache_host_table EXCEPT ALL SELECT * FROM normal_host_table) t;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM normal_host_table EXCEPT ALL SELECT * FROM cache_host_table) t;
+SELECT count(*) = 0 AS ok FROM (SELECT id, a * 2 FROM cache_host_table WHERE a % 7 = 3
+                                EXCEPT ALL
+                                SELECT id, a * 2 FROM normal_host_table WHERE a % 7 = 3) t;
+SELECT count(*) = 0 AS ok FROM (SELECT id, a * 2 FROM normal_host_table WHERE a % 7 = 3
+                                EXCEPT ALL
+                                SELECT id, a * 2 FROM cache_host_table WHERE a % 7 = 3) t;
+-- parallel host-side scan on GPU Cache
+SET max_parallel_workers_per_gather = 2;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM cache_host_table EXCEPT ALL SELECT * FROM normal_host_table) t;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM normal_host_table EXCEPT ALL SELECT * FROM cache_host_table) t;
+RESET max_parallel_workers_per_gather;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+-- rows updated by the current transaction
+BEGIN;
+UPDATE cache_host_table  SET a = -1 WHERE id % 100 = 3;
+UPDATE normal_host_table SET a = -1 WHERE id % 100 = 3;
+DELETE FROM cache_host_table  WHERE id % 100 = 4;
+DELETE FROM normal_host_table WHERE id % 100 = 4;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM cache_host_table EXCEPT ALL SELECT * FROM normal_host_table) t;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM normal_host_table EXCEPT ALL SELECT * FROM cache_host_table) t;
+ROLLBACK;
+SELECT count(*) = 0 AS ok FROM (SELECT * FROM cache_host_table EXCEPT ALL SELECT * FROM normal_host_table) t;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA gpu_cache_temp_test CASCADE;
 
 -- Checking GPUCache is removed correctly.
-SELECT count(*) = 0 AS ok FROM pgstrom.gpucache_info WHERE table_name in ('cache_test_table','cache_corruption_test') AND database_name=current_database();
+SELECT count(*) = 0 AS ok FROM pgstrom.gpucache_info WHERE table_name in ('cache_test_table','cache_corruption_test','cache_host_table') AND database_name=current_database();